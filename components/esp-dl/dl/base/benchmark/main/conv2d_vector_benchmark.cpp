@@ -0,0 +1,294 @@
+#include "dl_base_conv2d_vector.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * The vector kernels of dl_base_conv2d_vector.hpp against the scalar loops of dl_base_conv2d.cpp and
+ * dl_base_depthwise_conv2d.cpp, on layers shaped like the ones of the pedestrian detect model.
+ *
+ * Both run through the same shell with a tail that keeps the accumulators, so every accumulator of every output pixel,
+ * borders included, is compared before the requantization could hide a difference. The time of the shell with each
+ * kernel is the average over the runs.
+ *
+ * Build it for a chip without an ISA backend, ESP32-C3 say, or with the host build of esp-dl.
+ */
+
+static const char *TAG = "conv2d_vector_benchmark";
+
+namespace {
+using namespace dl::base;
+
+// The scalar loops of dl_base_conv2d.cpp, conv2d_33cn is conv2d_hwcn unrolled.
+template <typename feature_t, typename buffer_t>
+void conv2d_11cn(buffer_t *buffer_ptr, feature_t *input_ptr, const ArgsType<feature_t> &args)
+{
+    const feature_t *filter_element = (const feature_t *)args.filter_element;
+    for (size_t output_c = 0; output_c < args.output_channel; output_c++) {
+        buffer_t acc = 0;
+        for (size_t input_c = 0; input_c < args.input_channel; input_c++) {
+            acc += input_ptr[input_c] * (*filter_element++);
+        }
+        buffer_ptr[output_c] = acc;
+    }
+}
+
+template <typename feature_t, typename buffer_t>
+void conv2d_hwcn(buffer_t *buffer_ptr, feature_t *input_ptr, const ArgsType<feature_t> &args)
+{
+    const feature_t *filter_element = (const feature_t *)args.filter_element;
+    for (size_t output_c = 0; output_c < args.output_channel; output_c++) {
+        feature_t *input_syx_dy = input_ptr;
+        buffer_t acc = 0;
+        for (size_t filter_y = 0; filter_y < args.filter_height; filter_y++) {
+            feature_t *input_syx_dyx = input_syx_dy;
+            for (size_t filter_x = 0; filter_x < args.filter_width; filter_x++) {
+                for (size_t input_c = 0; input_c < args.input_channel; input_c++) {
+                    acc += input_syx_dyx[input_c] * (*filter_element++);
+                }
+                input_syx_dyx += args.input_dilation_x_offset;
+            }
+            filter_element += args.filter_y_offset;
+            input_syx_dy += args.input_dilation_y_offset;
+        }
+        filter_element += args.filter_n_offset;
+        buffer_ptr[output_c] = acc;
+    }
+}
+
+// The scalar loop of dl_base_depthwise_conv2d.cpp, depthwise_conv2d_33c1 is it unrolled.
+template <typename feature_t, typename buffer_t>
+void depthwise_conv2d_hwc1(buffer_t *buffer_ptr, feature_t *input_ptr, const ArgsType<feature_t> &args)
+{
+    const feature_t *filter_element = (feature_t *)args.filter_element;
+    for (size_t filter_y = 0; filter_y < args.filter_height; filter_y++) {
+        feature_t *input_yx = input_ptr;
+        for (size_t filter_x = 0; filter_x < args.filter_width; filter_x++) {
+            for (size_t input_c = 0; input_c < args.input_channel; input_c++) {
+                buffer_ptr[input_c] += input_yx[input_c] * (*filter_element);
+                filter_element++;
+            }
+            input_yx += args.input_dilation_x_offset;
+        }
+        filter_element += args.filter_y_offset;
+        input_ptr += args.input_dilation_y_offset;
+    }
+}
+
+// Keeps the accumulators of every output pixel instead of requantizing them.
+template <typename feature_t, typename buffer_t>
+struct capture {
+    static feature_t *output;
+    static buffer_t *accumulators;
+
+    static void tail(feature_t *output_ptr, buffer_t *buffer_ptr, const ArgsType<feature_t> &args)
+    {
+        memcpy(accumulators + (output_ptr - output), buffer_ptr, args.output_channel * sizeof(buffer_t));
+        memset(buffer_ptr, 0, args.output_channel * sizeof(buffer_t));
+    }
+};
+
+template <typename feature_t, typename buffer_t>
+feature_t *capture<feature_t, buffer_t>::output = nullptr;
+template <typename feature_t, typename buffer_t>
+buffer_t *capture<feature_t, buffer_t>::accumulators = nullptr;
+
+typedef struct {
+    const char *name;
+    int height;
+    int width;
+    int input_channel;
+    int output_channel;
+    int filter_size;
+    int stride;
+    int padding;
+    bool depthwise;
+} layer_t;
+
+const layer_t layers[] = {
+    {"conv 3x3 /2, 3 -> 16", 224, 224, 3, 16, 3, 2, 1, false},
+    {"depthwise 3x3, 16", 112, 112, 16, 16, 3, 1, 1, true},
+    {"conv 1x1, 16 -> 16", 112, 112, 16, 16, 1, 1, 0, false},
+    {"conv 1x1, 32 -> 64", 28, 28, 32, 64, 1, 1, 0, false},
+    {"conv 3x3, 32 -> 32", 28, 28, 32, 32, 3, 1, 1, false},
+    {"conv 3x3, 24 -> 20", 28, 28, 24, 20, 3, 1, 0, false},
+    {"depthwise 3x3 /2, 64", 28, 28, 64, 64, 3, 2, 1, true},
+    {"depthwise 5x5, 96", 14, 14, 96, 96, 5, 1, 2, true},
+    {"conv 5x5, 16 -> 24", 28, 28, 16, 24, 5, 1, 2, false},
+};
+
+template <typename feature_t>
+void fill_random(feature_t *data, int size)
+{
+    for (int i = 0; i < size; i++) {
+        data[i] = (feature_t)(rand() % (sizeof(feature_t) == 1 ? 256 : 65536));
+    }
+}
+
+template <typename feature_t, typename buffer_t>
+int64_t run(ArgsType<feature_t> &args,
+            void (*c_impl_func)(buffer_t *, feature_t *, const ArgsType<feature_t> &),
+            void (*c_impl_func_sp)(buffer_t *, feature_t *, const ArgsType<feature_t> &),
+            void (*c_impl_func_sp_x2)(buffer_t *, feature_t *, const ArgsType<feature_t> &),
+            bool depthwise,
+            int runs)
+{
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < runs; i++) {
+        // The shells adjust the filter window in args at the borders.
+        ArgsType<feature_t> run_args = args;
+        if (depthwise) {
+            dwconv_operation_shell<feature_t, buffer_t>(run_args,
+                                                        nullptr,
+                                                        nullptr,
+                                                        c_impl_func,
+                                                        c_impl_func_sp,
+                                                        capture<feature_t, buffer_t>::tail,
+                                                        c_impl_func_sp_x2);
+        } else {
+            conv_operation_shell<feature_t, buffer_t>(run_args,
+                                                      nullptr,
+                                                      nullptr,
+                                                      c_impl_func,
+                                                      c_impl_func_sp,
+                                                      capture<feature_t, buffer_t>::tail,
+                                                      c_impl_func_sp_x2);
+        }
+    }
+    return (esp_timer_get_time() - start) / runs;
+}
+
+template <typename feature_t, typename buffer_t>
+bool benchmark(const layer_t &layer, dl::dtype_t dtype, int runs)
+{
+    int output_height = (layer.height + 2 * layer.padding - layer.filter_size) / layer.stride + 1;
+    int output_width = (layer.width + 2 * layer.padding - layer.filter_size) / layer.stride + 1;
+    int input_size = layer.height * layer.width * layer.input_channel;
+    int output_size = output_height * output_width * layer.output_channel;
+    int filter_size = layer.filter_size * layer.filter_size * layer.input_channel *
+        (layer.depthwise ? 1 : layer.output_channel);
+
+    feature_t *input = (feature_t *)heap_caps_malloc(input_size * sizeof(feature_t), MALLOC_CAP_DEFAULT);
+    feature_t *filter = (feature_t *)heap_caps_malloc(filter_size * sizeof(feature_t), MALLOC_CAP_DEFAULT);
+    feature_t *output = (feature_t *)heap_caps_malloc(output_size * sizeof(feature_t), MALLOC_CAP_DEFAULT);
+    buffer_t *reference = (buffer_t *)heap_caps_calloc(output_size, sizeof(buffer_t), MALLOC_CAP_DEFAULT);
+    buffer_t *vector = (buffer_t *)heap_caps_calloc(output_size, sizeof(buffer_t), MALLOC_CAP_DEFAULT);
+    if (!input || !filter || !output || !reference || !vector) {
+        ESP_LOGE(TAG, "Fail to allocate %s", layer.name);
+        heap_caps_free(input);
+        heap_caps_free(filter);
+        heap_caps_free(output);
+        heap_caps_free(reference);
+        heap_caps_free(vector);
+        return false;
+    }
+    fill_random(input, input_size);
+    fill_random(filter, filter_size);
+
+    std::vector<int> input_shape = {1, layer.height, layer.width, layer.input_channel};
+    std::vector<int> output_shape = {1, output_height, output_width, layer.output_channel};
+    std::vector<int> filter_shape = layer.depthwise
+        ? std::vector<int>{layer.filter_size, layer.filter_size, layer.input_channel, 1}
+        : std::vector<int>{layer.filter_size, layer.filter_size, layer.input_channel, layer.output_channel};
+    dl::TensorBase input_tensor(input_shape, input, 0, dtype, false);
+    dl::TensorBase output_tensor(output_shape, output, 0, dtype, false);
+    dl::TensorBase filter_tensor(filter_shape, filter, 0, dtype, false);
+    std::vector<int> padding(4, layer.padding);
+    ArgsType<feature_t> args = get_conv_operation_args<feature_t>(&output_tensor,
+                                                                  &input_tensor,
+                                                                  padding,
+                                                                  &filter_tensor,
+                                                                  layer.stride,
+                                                                  layer.stride,
+                                                                  1,
+                                                                  1,
+                                                                  layer.depthwise ? layer.input_channel : 1,
+                                                                  nullptr,
+                                                                  dl::Linear,
+                                                                  nullptr,
+                                                                  dl::RUNTIME_MODE_SINGLE_CORE)[0];
+
+    typedef void (*c_impl_func_t)(buffer_t *, feature_t *, const ArgsType<feature_t> &);
+    c_impl_func_t c_impl_func = nullptr;
+    c_impl_func_t c_impl_func_sp = nullptr;
+    c_impl_func_t c_impl_func_sp_x2 = nullptr;
+    if (layer.depthwise) {
+        c_impl_func_sp = depthwise_conv2d_hwc1<feature_t, buffer_t>;
+        c_impl_func = c_impl_func_sp;
+    } else {
+        c_impl_func_sp = layer.filter_size == 1 ? conv2d_11cn<feature_t, buffer_t> : conv2d_hwcn<feature_t, buffer_t>;
+        c_impl_func = c_impl_func_sp;
+    }
+    capture<feature_t, buffer_t>::output = output;
+    capture<feature_t, buffer_t>::accumulators = reference;
+    int64_t reference_us =
+        run<feature_t, buffer_t>(args, c_impl_func, c_impl_func_sp, nullptr, layer.depthwise, runs);
+
+    if (layer.depthwise) {
+        load_depthwise_conv2d_vector_c_func<feature_t, buffer_t>(c_impl_func, c_impl_func_sp, c_impl_func_sp_x2, args);
+    } else {
+        load_conv2d_vector_c_func<feature_t, buffer_t>(c_impl_func, c_impl_func_sp, c_impl_func_sp_x2, args);
+    }
+    capture<feature_t, buffer_t>::accumulators = vector;
+    int64_t vector_us =
+        run<feature_t, buffer_t>(args, c_impl_func, c_impl_func_sp, c_impl_func_sp_x2, layer.depthwise, runs);
+
+    int mismatch = 0;
+    for (int i = 0; i < output_size; i++) {
+        mismatch += reference[i] != vector[i];
+    }
+    uint64_t macs = (uint64_t)output_size * layer.filter_size * layer.filter_size *
+        (layer.depthwise ? 1 : layer.input_channel);
+    ESP_LOGI(TAG,
+             "%-24s %s  scalar: %8lld us, vector: %8lld us, x%5.2f, %7.1f MMACs/s, %s",
+             layer.name,
+             sizeof(feature_t) == 1 ? "s8 " : "s16",
+             (long long)reference_us,
+             (long long)vector_us,
+             vector_us > 0 ? (float)reference_us / vector_us : 0,
+             vector_us > 0 ? (float)macs / vector_us : 0,
+             mismatch ? "MISMATCH" : "bit exact");
+    if (mismatch) {
+        ESP_LOGE(TAG, "%d of %d accumulators differ", mismatch, output_size);
+    }
+
+    heap_caps_free(input);
+    heap_caps_free(filter);
+    heap_caps_free(output);
+    heap_caps_free(reference);
+    heap_caps_free(vector);
+    return mismatch == 0;
+}
+
+int benchmark_all(int runs)
+{
+    srand(1);
+    int failed = 0;
+    for (const layer_t &layer : layers) {
+        failed += !benchmark<int8_t, int32_t>(layer, dl::DATA_TYPE_INT8, runs);
+        failed += !benchmark<int16_t, DL_S16_BUFFER_TYPE>(layer, dl::DATA_TYPE_INT16, runs);
+    }
+    if (failed) {
+        ESP_LOGE(TAG, "%d layers failed", failed);
+    }
+    return failed;
+}
+} // namespace
+
+#if defined(ESP_PLATFORM)
+bool lut16_benchmark_all(int runs);    // lut16_benchmark.cpp, a host executable of its own
+bool resize2d_benchmark_all(int runs); // resize2d_benchmark.cpp, likewise
+
+extern "C" void app_main(void)
+{
+    benchmark_all(3);
+    lut16_benchmark_all(3);
+    resize2d_benchmark_all(3);
+}
+#else
+int main(int argc, char **argv)
+{
+    return benchmark_all(argc > 1 ? atoi(argv[1]) : 10) ? 1 : 0;
+}
+#endif
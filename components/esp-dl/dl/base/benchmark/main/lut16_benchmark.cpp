@@ -0,0 +1,181 @@
+#include "dl_base_lut16.hpp"
+#include "dl_math.hpp"
+#include "dl_module_hard_swish.hpp"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <cmath>
+#include <stdlib.h>
+
+/**
+ * The int16 lookup tables of dl_base_lut16.hpp against the float path of the activation modules, over every one of
+ * the 65536 inputs, at exponents like the ones of the int16 models.
+ *
+ * The table must stay within 1 LSB of the float path everywhere. The time per element is the average over the runs of
+ * the 65536 inputs in a shuffled order, the build time is the time to sample the activation at model build.
+ */
+
+static const char *TAG = "lut16_benchmark";
+
+namespace {
+using namespace dl;
+
+typedef struct {
+    const char *name;
+    base::Lut16::func_t func;
+    void (*float_path)(const int16_t *, int16_t *, int, int, int);
+    int input_exponent;
+    int output_exponent;
+} activation_t;
+
+// The int16 loop of the modules, with the activation inlined as in the module.
+template <float (*func)(float)>
+void float_path(const int16_t *input, int16_t *output, int size, int input_exponent, int output_exponent)
+{
+    float input_scale = DL_SCALE(input_exponent);
+    float output_scale = DL_RESCALE(output_exponent);
+    for (int i = 0; i < size; i++) {
+        float temp = func((float)input[i] * input_scale);
+        tool::truncate(output[i], tool::round(temp * output_scale));
+    }
+}
+
+float sigmoid(float x)
+{
+    return math::sigmoid(x);
+}
+
+float tanh(float x)
+{
+    return math::tanh(x);
+}
+
+float exp(float x)
+{
+    return expf(x);
+}
+
+float log(float x)
+{
+    return logf(x);
+}
+
+float sqrt(float x)
+{
+    return sqrtf(x);
+}
+
+#define ACTIVATION(name, func, input_exponent, output_exponent) \
+    {name, func, float_path<func>, input_exponent, output_exponent}
+
+const activation_t activations[] = {
+    ACTIVATION("Sigmoid", sigmoid, -12, -15),
+    ACTIVATION("Sigmoid", sigmoid, -10, -15),
+    ACTIVATION("Sigmoid", sigmoid, -8, -15),
+    ACTIVATION("Tanh", tanh, -12, -15),
+    ACTIVATION("Tanh", tanh, -10, -15),
+    ACTIVATION("Exp", exp, -12, -15),
+    ACTIVATION("Exp", exp, -13, -12),
+    ACTIVATION("HardSwish", module::HardSwish::hard_swish, -11, -11),
+    ACTIVATION("HardSwish", module::HardSwish::hard_swish, -8, -8),
+    ACTIVATION("Log", log, -8, -11),
+    // Sqrt keeps the float path, sqrtf is as fast as the table.
+    ACTIVATION("Sqrt", sqrt, -8, -8),
+    ACTIVATION("Sqrt", sqrt, -12, -10),
+};
+
+bool benchmark(const activation_t &activation, const int16_t *input, int16_t *reference, int16_t *output, int runs)
+{
+    const int size = 65536;
+    int64_t start = esp_timer_get_time();
+    base::Lut16 table(activation.func, activation.input_exponent, activation.output_exponent);
+    int64_t build_us = esp_timer_get_time() - start;
+    if (!table.get_size()) {
+        ESP_LOGI(TAG,
+                 "%-9s %3d %3d | more than %d samples, stays in float",
+                 activation.name,
+                 activation.input_exponent,
+                 activation.output_exponent,
+                 DL_LUT16_MAX_SAMPLES);
+        return true;
+    }
+
+    start = esp_timer_get_time();
+    for (int i = 0; i < runs; i++) {
+        activation.float_path(input, reference, size, activation.input_exponent, activation.output_exponent);
+    }
+    int64_t float_us = esp_timer_get_time() - start;
+    start = esp_timer_get_time();
+    for (int i = 0; i < runs; i++) {
+        table.forward(input, output, size);
+    }
+    int64_t table_us = esp_timer_get_time() - start;
+
+    int max_diff = 0, off_by_one = 0;
+    for (int i = 0; i < size; i++) {
+        int diff = DL_ABS(reference[i] - output[i]);
+        max_diff = DL_MAX(max_diff, diff);
+        off_by_one += diff == 1;
+    }
+    float elements = (float)size * runs;
+    ESP_LOGI(TAG,
+             "%-9s %3d %3d | %5d samples %6d B %8.1f us | float %7.2f ns  table %6.2f ns  x%5.1f | max %d LSB, %5d off "
+             "by 1 | %s",
+             activation.name,
+             activation.input_exponent,
+             activation.output_exponent,
+             table.get_size(),
+             table.get_size() * 2 + 256 * 4,
+             (float)build_us,
+             float_us * 1000.f / elements,
+             table_us * 1000.f / elements,
+             (float)float_us / DL_MAX(table_us, 1),
+             max_diff,
+             off_by_one,
+             max_diff <= 1 ? "ok" : "FAIL");
+    return max_diff <= 1;
+}
+} // namespace
+
+bool lut16_benchmark_all(int runs)
+{
+    const int size = 65536;
+    int16_t *input = (int16_t *)heap_caps_malloc(size * sizeof(int16_t), MALLOC_CAP_DEFAULT);
+    int16_t *reference = (int16_t *)heap_caps_malloc(size * sizeof(int16_t), MALLOC_CAP_DEFAULT);
+    int16_t *output = (int16_t *)heap_caps_malloc(size * sizeof(int16_t), MALLOC_CAP_DEFAULT);
+    if (!input || !reference || !output) {
+        ESP_LOGE(TAG, "Fail to allocate the buffers");
+        heap_caps_free(input);
+        heap_caps_free(reference);
+        heap_caps_free(output);
+        return false;
+    }
+    // Every input once, shuffled so the lookups do not walk the table in order.
+    srand(1);
+    for (int i = 0; i < size; i++) {
+        input[i] = i - 32768;
+    }
+    for (int i = size - 1; i > 0; i--) {
+        int j = rand() % (i + 1);
+        int16_t temp = input[i];
+        input[i] = input[j];
+        input[j] = temp;
+    }
+
+    ESP_LOGI(TAG, "activation in out | table, build time | time per element | error against the float path");
+    bool ok = true;
+    for (const activation_t &activation : activations) {
+        ok = benchmark(activation, input, reference, output, runs) && ok;
+    }
+    heap_caps_free(input);
+    heap_caps_free(reference);
+    heap_caps_free(output);
+    return ok;
+}
+
+#if !defined(ESP_PLATFORM)
+int main(int argc, char **argv)
+{
+    return lut16_benchmark_all(argc > 1 ? atoi(argv[1]) : 20) ? 0 : 1;
+}
+#endif
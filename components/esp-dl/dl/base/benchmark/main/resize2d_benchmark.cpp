@@ -0,0 +1,207 @@
+#include "dl_module_add.hpp"
+#include "dl_module_resize.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Resize2D against a float resize following ONNX, and Add(Resize(x), y) fused into one pass against the resize and
+ * the add one after the other, on a neck layer of a detect model: 20x20x64 upsampled to 40x40.
+ *
+ * Nearest must match the float resize exactly and linear stay within 1 LSB, the weights of the tables having a finite
+ * number of fraction bits. The fused add must be bit exact with the two modules. The time is the average over the
+ * runs.
+ */
+
+static const char *TAG = "resize2d_benchmark";
+
+namespace {
+using namespace dl;
+
+typedef struct {
+    const char *name;
+    resize_mode_t mode;
+    resize_coordinate_t coordinate;
+    resize_nearest_t nearest_mode;
+    float scale;
+    int shift; /*<! exponent of the resize output minus the one of the input */
+} resize_case_t;
+
+const resize_case_t cases[] = {
+    {"nearest asymmetric", RESIZE_NEAREST, RESIZE_ASYMMETRIC, RESIZE_FLOOR, 2.f, 0},
+    {"nearest half_pixel", RESIZE_NEAREST, RESIZE_HALF_PIXEL, RESIZE_ROUND_PREFER_FLOOR, 2.f, 1},
+    {"nearest align_corners", RESIZE_NEAREST, RESIZE_ALIGN_CORNERS, RESIZE_ROUND_PREFER_FLOOR, 2.f, 0},
+    {"nearest half_pixel", RESIZE_NEAREST, RESIZE_HALF_PIXEL, RESIZE_ROUND_PREFER_CEIL, 1.5f, 0},
+    {"linear half_pixel", RESIZE_LINEAR, RESIZE_HALF_PIXEL, RESIZE_ROUND_PREFER_FLOOR, 2.f, 0},
+    {"linear half_pixel", RESIZE_LINEAR, RESIZE_HALF_PIXEL, RESIZE_ROUND_PREFER_FLOOR, 2.f, 1},
+    {"linear pytorch_half_pixel", RESIZE_LINEAR, RESIZE_PYTORCH_HALF_PIXEL, RESIZE_ROUND_PREFER_FLOOR, 2.f, 0},
+    {"linear align_corners", RESIZE_LINEAR, RESIZE_ALIGN_CORNERS, RESIZE_ROUND_PREFER_FLOOR, 2.f, 0},
+    {"linear asymmetric", RESIZE_LINEAR, RESIZE_ASYMMETRIC, RESIZE_ROUND_PREFER_FLOOR, 2.f, -1},
+    {"linear half_pixel", RESIZE_LINEAR, RESIZE_HALF_PIXEL, RESIZE_ROUND_PREFER_FLOOR, 1.5f, 0},
+};
+
+// Input coordinate of output x along an axis, as ONNX Resize computes it.
+float source_coordinate(const resize_case_t &c, int x, int input_size, int output_size)
+{
+    if (c.coordinate == RESIZE_ALIGN_CORNERS) {
+        return output_size > 1 ? (float)x * (input_size - 1) / (output_size - 1) : 0.f;
+    } else if (c.coordinate == RESIZE_ASYMMETRIC) {
+        return x / c.scale;
+    } else if (c.coordinate == RESIZE_PYTORCH_HALF_PIXEL && output_size == 1) {
+        return 0.f;
+    }
+    return (x + 0.5f) / c.scale - 0.5f;
+}
+
+int nearest_index(const resize_case_t &c, float x, int input_size)
+{
+    int index;
+    if (c.nearest_mode == RESIZE_FLOOR) {
+        index = floorf(x);
+    } else if (c.nearest_mode == RESIZE_CEIL) {
+        index = ceilf(x);
+    } else if (x - floorf(x) == 0.5f) {
+        index = c.nearest_mode == RESIZE_ROUND_PREFER_FLOOR ? floorf(x) : ceilf(x);
+    } else {
+        index = roundf(x);
+    }
+    return DL_CLIP(index, 0, input_size - 1);
+}
+
+// The resize in float on the dequantized input, quantized to the exponent of the output.
+template <typename T>
+void float_resize(const resize_case_t &c, TensorBase *input, TensorBase *output)
+{
+    int in_h = input->shape[1], in_w = input->shape[2], channel = input->shape[3];
+    int out_h = output->shape[1], out_w = output->shape[2];
+    const T *input_ptr = (const T *)input->data;
+    T *output_ptr = (T *)output->data;
+    float input_scale = DL_SCALE(input->exponent);
+    float output_scale = DL_RESCALE(output->exponent);
+    for (int y = 0; y < out_h; y++) {
+        float sy = source_coordinate(c, y, in_h, out_h);
+        for (int x = 0; x < out_w; x++) {
+            float sx = source_coordinate(c, x, in_w, out_w);
+            for (int ch = 0; ch < channel; ch++) {
+                float value;
+                if (c.mode == RESIZE_NEAREST) {
+                    int iy = nearest_index(c, sy, in_h), ix = nearest_index(c, sx, in_w);
+                    value = input_ptr[(iy * in_w + ix) * channel + ch] * input_scale;
+                } else {
+                    float cy = DL_CLIP(sy, 0.f, (float)(in_h - 1));
+                    float cx = DL_CLIP(sx, 0.f, (float)(in_w - 1));
+                    int y0 = (int)cy, x0 = (int)cx;
+                    int y1 = DL_MIN(y0 + 1, in_h - 1), x1 = DL_MIN(x0 + 1, in_w - 1);
+                    float fy = cy - y0, fx = cx - x0;
+                    float top = input_ptr[(y0 * in_w + x0) * channel + ch] * (1 - fx) +
+                        input_ptr[(y0 * in_w + x1) * channel + ch] * fx;
+                    float bottom = input_ptr[(y1 * in_w + x0) * channel + ch] * (1 - fx) +
+                        input_ptr[(y1 * in_w + x1) * channel + ch] * fx;
+                    value = (top * (1 - fy) + bottom * fy) * input_scale;
+                }
+                tool::truncate(*output_ptr++, tool::round(value * output_scale));
+            }
+        }
+    }
+}
+
+template <typename T>
+int max_diff(TensorBase *a, TensorBase *b)
+{
+    int diff = 0;
+    for (int i = 0; i < a->get_size(); i++) {
+        diff = DL_MAX(diff, DL_ABS(((T *)a->data)[i] - ((T *)b->data)[i]));
+    }
+    return diff;
+}
+
+template <typename T>
+bool benchmark(const resize_case_t &c, int height, int width, int channel, int exponent, int runs)
+{
+    dtype_t dtype = sizeof(T) == 1 ? DATA_TYPE_INT8 : DATA_TYPE_INT16;
+    quant_type_t quant_type = sizeof(T) == 1 ? QUANT_TYPE_SYMM_8BIT : QUANT_TYPE_SYMM_16BIT;
+    int out_h = (int)(height * c.scale), out_w = (int)(width * c.scale);
+    TensorBase x({1, height, width, channel}, nullptr, exponent, dtype);
+    TensorBase y({1, out_h, out_w, channel}, nullptr, exponent + c.shift, dtype);
+    TensorBase resized({1, out_h, out_w, channel}, nullptr, exponent + c.shift, dtype);
+    TensorBase reference({1, out_h, out_w, channel}, nullptr, exponent + c.shift, dtype);
+    TensorBase sum({1, out_h, out_w, channel}, nullptr, exponent + c.shift, dtype);
+    TensorBase fused_sum({1, out_h, out_w, channel}, nullptr, exponent + c.shift, dtype);
+    srand(channel + c.shift);
+    int range = sizeof(T) == 1 ? 256 : 65536;
+    for (int i = 0; i < x.get_size(); i++) {
+        ((T *)x.data)[i] = rand() % range - range / 2;
+    }
+    for (int i = 0; i < y.get_size(); i++) {
+        ((T *)y.data)[i] = rand() % range - range / 2;
+    }
+
+    // The tensors of the model and the indexes the memory planner gives the modules, fused or not.
+    std::vector<TensorBase *> tensors = {&x, &y, &resized, &sum, &fused_sum};
+    module::Resize2D resize("resize", c.mode, c.scale, c.scale, quant_type, c.coordinate, c.nearest_mode);
+    module::Add add("add", MODULE_NON_INPLACE, quant_type);
+    resize.m_inputs_index = {0};
+    resize.m_outputs_index = {2};
+    add.m_inputs_index = {2, 1};
+    add.m_outputs_index = {3};
+    module::Resize2D fused_resize("fused_resize", c.mode, c.scale, c.scale, quant_type, c.coordinate, c.nearest_mode);
+    module::Add fused_add("fused_add", MODULE_NON_INPLACE, quant_type);
+    fused_resize.m_inputs_index = {0};
+    fused_resize.m_outputs_index = {2};
+    fused_add.m_inputs_index = {0, 1};
+    fused_add.m_outputs_index = {4};
+    fused_add.fuse_resize(&fused_resize, 0);
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < runs; i++) {
+        resize.forward(tensors, RUNTIME_MODE_AUTO);
+        add.forward(tensors, RUNTIME_MODE_AUTO);
+    }
+    int64_t separate_us = esp_timer_get_time() - start;
+    start = esp_timer_get_time();
+    for (int i = 0; i < runs; i++) {
+        fused_resize.forward(tensors, RUNTIME_MODE_AUTO);
+        fused_add.forward(tensors, RUNTIME_MODE_AUTO);
+    }
+    int64_t fused_us = esp_timer_get_time() - start;
+
+    float_resize<T>(c, &x, &reference);
+    int diff = max_diff<T>(&resized, &reference);
+    bool same = memcmp(sum.data, fused_sum.data, sum.get_bytes()) == 0;
+    bool ok = diff <= (c.mode == RESIZE_NEAREST ? 0 : 1) && same;
+    ESP_LOGI(TAG,
+             "%-5s %-25s x%.1f %2d | %d LSB | resize + add %8.1f us, fused %8.1f us, x%.2f | %s",
+             sizeof(T) == 1 ? "int8" : "int16",
+             c.name,
+             c.scale,
+             c.shift,
+             diff,
+             (float)separate_us / runs,
+             (float)fused_us / runs,
+             (float)separate_us / DL_MAX(fused_us, 1),
+             ok ? "ok" : (same ? "FAIL" : "FAIL, fused add differs"));
+    return ok;
+}
+} // namespace
+
+bool resize2d_benchmark_all(int runs)
+{
+    ESP_LOGI(TAG, "type  mode                      scale shift | error against float | time per run");
+    bool ok = true;
+    for (const resize_case_t &c : cases) {
+        ok = benchmark<int8_t>(c, 20, 20, 64, -6, runs) && ok;
+    }
+    for (const resize_case_t &c : cases) {
+        ok = benchmark<int16_t>(c, 20, 20, 64, -12, runs) && ok;
+    }
+    return ok;
+}
+
+#if !defined(ESP_PLATFORM)
+int main(int argc, char **argv)
+{
+    return resize2d_benchmark_all(argc > 1 ? atoi(argv[1]) : 100) ? 0 : 1;
+}
+#endif
@@ -1,9 +1,11 @@
 #pragma once
 
+#include "dl_base_tile.hpp"
 #include "dl_define.hpp"
 #include "dl_tensor_base.hpp"
 #include <assert.h>
 #include <functional>
+#include <limits.h>
 #include <stdint.h>
 #include <vector>
 
@@ -93,6 +95,16 @@ struct ArgsType {
     bool auto_split;
 };
 
+/**
+ * @brief Copy the args a kernel gets through void *. The shells adjust the filter window at the borders, they work on
+ * this copy so the args cached by the module stay intact.
+ */
+template <typename args_t>
+inline args_t copy_args(void *args_ptr)
+{
+    return *((args_t *)args_ptr);
+}
+
 typedef void (*c_impl_func_s16_t)(DL_S16_BUFFER_TYPE *, int16_t *, const ArgsType<int16_t> &);
 typedef void (*n_wise_func_s16_t)(int16_t *, DL_S16_BUFFER_TYPE *, const ArgsType<int16_t> &);
 
@@ -263,42 +275,74 @@ std::vector<ArgsType<feature_t>> get_conv_operation_args(TensorBase *output,
     if (malloc_debug_memory) {
         args.debug_value = tool::calloc_aligned(16, sizeof(int8_t), 16, MALLOC_CAP_8BIT);
     }
-    std::vector<ArgsType<feature_t>> m_args(1, args);
-    if (args.input_height > 4 * args.dilation_h * args.filter_height) {
-        if (runtime_mode == RUNTIME_MODE_MULTI_CORE ||
-            (runtime_mode == RUNTIME_MODE_AUTO && args.input_height >= 100 && args.input_width >= 50)) {
-            m_args.push_back(args);
-
-            // Divide this convolution into two tasks by splitting the input height.
-            // up
-            int dilation_filter_height = args.dilation_h * (args.filter_height - 1) + 1;
-            int half_step = (args.padding_h_head + args.padding_h_tail + args.input_height - dilation_filter_height) /
-                args.stride_y / 2;
-            m_args[0].input_height = dilation_filter_height - args.padding_h_head + half_step * args.stride_y;
-            m_args[0].padding_h_tail = 0;
-            m_args[0].output_height = half_step + 1;
-            // bottom
-            m_args[1].padding_h_head = 0;
-            m_args[1].input_height =
-                dilation_filter_height - args.stride_y + args.input_height - m_args[0].input_height;
-            m_args[1].input_element +=
-                (args.input_height - m_args[1].input_height) * args.input_width * args.input_channel;
-            m_args[1].output_height = args.output_height - m_args[0].output_height;
-            m_args[1].output_element +=
-                (args.output_height - m_args[1].output_height) * args.output_width * args.output_channel;
+    // Split the output rows into tiles, one per core when the layer is large enough to pay for the wakeup.
+    int dilation_filter_height = args.dilation_h * (args.filter_height - 1) + 1;
+    int64_t ops = (int64_t)args.output_height * args.output_width * args.output_channel * args.filter_height *
+        args.filter_width * (group == 1 ? args.input_channel : 1);
+    int n_tiles = get_tile_num(runtime_mode, ops, args.output_height);
+    if (n_tiles == 1) {
+        return std::vector<ArgsType<feature_t>>(1, args);
+    }
+    std::vector<row_tile_t> tiles = get_row_tiles(
+        args.input_height, args.output_height, dilation_filter_height, args.stride_y, args.padding_h_head, n_tiles);
+    std::vector<ArgsType<feature_t>> m_args(tiles.size(), args);
+    for (int i = 0; i < tiles.size(); i++) {
+        m_args[i].input_element += tiles[i].input_y * args.input_y_offset;
+        m_args[i].input_height = tiles[i].input_height;
+        m_args[i].output_element += tiles[i].output_y * args.output_y_offset;
+        m_args[i].output_height = tiles[i].output_height;
+        if (i > 0) {
+            m_args[i].padding_h_head = 0;
+        }
+        if (i < tiles.size() - 1) {
+            m_args[i].padding_h_tail = 0;
         }
     }
 
     return m_args;
 }
 
+/**
+ * @brief Runs the C implementation over n output pixels of a row with the full filter and moves input_ptr and
+ * output_ptr past them. c_impl_func_sp_x2, when given, computes two neighbouring pixels per call into
+ * buffer[0, output_channel) and buffer[output_channel, 2 * output_channel).
+ */
+template <typename feature_t, typename buffer_t>
+inline void c_impl_row(buffer_t *buffer,
+                       feature_t *&input_ptr,
+                       feature_t *&output_ptr,
+                       int n,
+                       const ArgsType<feature_t> &args,
+                       void (*c_impl_func_sp)(buffer_t *, feature_t *, const ArgsType<feature_t> &),
+                       void (*c_impl_func_sp_x2)(buffer_t *, feature_t *, const ArgsType<feature_t> &),
+                       void (*n_wise_tail)(feature_t *, buffer_t *, const ArgsType<feature_t> &))
+{
+    int i = 0;
+    if (c_impl_func_sp_x2) {
+        for (; i + 2 <= n; i += 2) {
+            c_impl_func_sp_x2(buffer, input_ptr, args);
+            n_wise_tail(output_ptr, buffer, args);
+            n_wise_tail(output_ptr + args.output_x_offset, buffer + args.output_channel, args);
+            input_ptr += 2 * args.input_stride_x_offset;
+            output_ptr += 2 * args.output_x_offset;
+        }
+    }
+    for (; i < n; i++) {
+        c_impl_func_sp(buffer, input_ptr, args);
+        n_wise_tail(output_ptr, buffer, args);
+        input_ptr += args.input_stride_x_offset;
+        output_ptr += args.output_x_offset;
+    }
+}
+
 template <typename feature_t, typename buffer_t>
 void conv_operation_shell(ArgsType<feature_t> &args,
                           ImplFunc_t<feature_t, feature_t> i_impl_func,
                           ImplFunc_t<feature_t, feature_t> i_impl_func_sp,
                           void (*c_impl_func)(buffer_t *, feature_t *, const ArgsType<feature_t> &),
                           void (*c_impl_func_sp)(buffer_t *, feature_t *, const ArgsType<feature_t> &),
-                          void (*n_wise_tail)(feature_t *, buffer_t *, const ArgsType<feature_t> &))
+                          void (*n_wise_tail)(feature_t *, buffer_t *, const ArgsType<feature_t> &),
+                          void (*c_impl_func_sp_x2)(buffer_t *, feature_t *, const ArgsType<feature_t> &) = nullptr)
 {
     feature_t *input_ptr = (feature_t *)args.input_element;
     feature_t *output_ptr = (feature_t *)args.output_element;
@@ -735,13 +779,14 @@ void conv_operation_shell(ArgsType<feature_t> &args,
             }
         } else // run c_impl_func
         {
-            buffer_t *buffer =
-                (buffer_t *)tool::calloc_aligned(args.output_channel, sizeof(buffer_t), 16, MALLOC_CAP_8BIT);
+            buffer_t *buffer = (buffer_t *)tool::calloc_aligned(
+                args.output_channel * (c_impl_func_sp_x2 ? 2 : 1), sizeof(buffer_t), 16, MALLOC_CAP_8BIT);
             feature_t *input_y_real;
             feature_t *input_x_real;
             feature_t *filter_ptr_y;
             feature_t *output_yx = output_ptr;
-            int filter_c_n_offset = args.output_channel;
+            // The C implementation keeps the filter in [N, H, W, C], a filter column is input_channel long.
+            int filter_c_n_offset = args.input_channel;
             int filter_c_n_ptr_offset = filter_c_n_offset;
 
             for (size_t output_y = 0; output_y < n_h_head; output_y++) {
@@ -818,12 +863,8 @@ void conv_operation_shell(ArgsType<feature_t> &args,
                 args.filter_width = filter_w;
                 args.filter_y_offset = 0; // ??? c， xtensa， tie 顺序不同
                 args.filter_element = filter_ptr_y;
-                for (size_t output_x = 0; output_x < n_w_body; output_x++) {
-                    c_impl_func_sp(buffer, input_x_real, args);
-                    n_wise_tail(output_yx, buffer, args);
-                    output_yx += args.output_x_offset;
-                    input_x_real += args.input_stride_x_offset;
-                }
+                c_impl_row(
+                    buffer, input_x_real, output_yx, n_w_body, args, c_impl_func_sp, c_impl_func_sp_x2, n_wise_tail);
 
                 for (size_t output_x = 0; output_x < n_w_tail; output_x++) {
                     args.filter_width = (args.padding_w_head + args.input_width -
@@ -919,19 +960,20 @@ void conv_operation_shell(ArgsType<feature_t> &args,
             }
         } else // run c_impl_func
         {
-            buffer_t *buffer =
-                (buffer_t *)tool::calloc_aligned(args.output_channel, sizeof(buffer_t), 16, MALLOC_CAP_8BIT);
+            buffer_t *buffer = (buffer_t *)tool::calloc_aligned(
+                args.output_channel * (c_impl_func_sp_x2 ? 2 : 1), sizeof(buffer_t), 16, MALLOC_CAP_8BIT);
             for (size_t output_y = 0; output_y < args.output_height; output_y++) {
                 feature_t *input_syx = input_ptr;
                 feature_t *output_yx = output_ptr;
 
-                for (size_t output_x = 0; output_x < args.output_width; output_x++) {
-                    c_impl_func_sp(buffer, input_syx, args);
-                    n_wise_tail(output_yx, buffer, args);
-
-                    input_syx += args.input_stride_x_offset;
-                    output_yx += args.output_x_offset;
-                }
+                c_impl_row(buffer,
+                           input_syx,
+                           output_yx,
+                           (int)args.output_width,
+                           args,
+                           c_impl_func_sp,
+                           c_impl_func_sp_x2,
+                           n_wise_tail);
                 input_ptr += args.input_stride_y_offset;
                 output_ptr += args.output_y_offset;
             }
@@ -962,6 +1004,7 @@ void conv_operation_shell(ArgsType<feature_t> &args,
  * @param c_impl_func
  * @param c_impl_func_sp
  * @param n_wise_tail
+ * @param c_impl_func_sp_x2 optional, c_impl_func_sp for two neighbouring output pixels, see c_impl_row
  */
 template <typename feature_t, typename buffer_t>
 void dwconv_operation_shell(ArgsType<feature_t> &args,
@@ -969,7 +1012,8 @@ void dwconv_operation_shell(ArgsType<feature_t> &args,
                             ImplFunc_t<feature_t, feature_t> i_impl_func_sp,
                             void (*c_impl_func)(buffer_t *, feature_t *, const ArgsType<feature_t> &),
                             void (*c_impl_func_sp)(buffer_t *, feature_t *, const ArgsType<feature_t> &),
-                            void (*n_wise_tail)(feature_t *, buffer_t *, const ArgsType<feature_t> &))
+                            void (*n_wise_tail)(feature_t *, buffer_t *, const ArgsType<feature_t> &),
+                            void (*c_impl_func_sp_x2)(buffer_t *, feature_t *, const ArgsType<feature_t> &) = nullptr)
 {
     feature_t *input_ptr = (feature_t *)args.input_element;
     feature_t *output_ptr = (feature_t *)args.output_element;
@@ -1490,8 +1534,8 @@ void dwconv_operation_shell(ArgsType<feature_t> &args,
             }
         } else // run c_impl_func
         {
-            buffer_t *buffer =
-                (buffer_t *)tool::calloc_aligned(args.output_channel, sizeof(buffer_t), 16, MALLOC_CAP_8BIT);
+            buffer_t *buffer = (buffer_t *)tool::calloc_aligned(
+                args.output_channel * (c_impl_func_sp_x2 ? 2 : 1), sizeof(buffer_t), 16, MALLOC_CAP_8BIT);
             feature_t *input_y_real;
             feature_t *input_x_real;
             feature_t *filter_ptr_y;
@@ -1571,12 +1615,8 @@ void dwconv_operation_shell(ArgsType<feature_t> &args,
                 args.filter_width = filter_w;
                 args.filter_y_offset = 0; // ??? c， xtensa， tie 顺序不同
                 args.filter_element = filter_ptr_y;
-                for (size_t output_x = 0; output_x < n_w_body; output_x++) {
-                    c_impl_func_sp(buffer, input_x_real, args);
-                    n_wise_tail(output_yx, buffer, args);
-                    output_yx += args.output_x_offset;
-                    input_x_real += args.input_stride_x_offset;
-                }
+                c_impl_row(
+                    buffer, input_x_real, output_yx, n_w_body, args, c_impl_func_sp, c_impl_func_sp_x2, n_wise_tail);
 
                 for (size_t output_x = 0; output_x < n_w_tail; output_x++) {
                     args.filter_width = (args.padding_w_head + args.input_width -
@@ -1673,19 +1713,20 @@ void dwconv_operation_shell(ArgsType<feature_t> &args,
         } else // run c_impl_func
         {
             args.filter_y_offset = 0;
-            buffer_t *buffer =
-                (buffer_t *)tool::calloc_aligned(args.output_channel, sizeof(buffer_t), 16, MALLOC_CAP_8BIT);
+            buffer_t *buffer = (buffer_t *)tool::calloc_aligned(
+                args.output_channel * (c_impl_func_sp_x2 ? 2 : 1), sizeof(buffer_t), 16, MALLOC_CAP_8BIT);
             for (size_t output_y = 0; output_y < args.output_height; output_y++) {
                 feature_t *input_syx = input_ptr;
                 feature_t *output_yx = output_ptr;
 
-                for (size_t output_x = 0; output_x < args.output_width; output_x++) {
-                    c_impl_func_sp(buffer, input_syx, args);
-                    n_wise_tail(output_yx, buffer, args);
-
-                    input_syx += args.input_stride_x_offset;
-                    output_yx += args.output_x_offset;
-                }
+                c_impl_row(buffer,
+                           input_syx,
+                           output_yx,
+                           (int)args.output_width,
+                           args,
+                           c_impl_func_sp,
+                           c_impl_func_sp_x2,
+                           n_wise_tail);
                 input_ptr += args.input_stride_y_offset;
                 output_ptr += args.output_y_offset;
             }
@@ -2370,17 +2411,65 @@ struct resizeArgsType {
 
     int output_shift; /*<! 12 */
     int output_scale; /*<! 13 */
+
+    int output_height;         /*<! 14 */
+    int output_width;          /*<! 15 */
+    const int32_t *table_y;    /*<! 16 see get_resize_axis_table(), nullptr for the 2x nearest kernel */
+    const int32_t *table_x;    /*<! 17 */
+    int weight_shift;          /*<! 18 linear: shift of the weighted sum to the output exponent */
+    feature_t *addend_element; /*<! 19 the other input of an Add fused into the resize, nullptr for none */
 };
 
+/**
+ * @brief Source of every output row or column of a resize along one axis.
+ *
+ * Nearest takes one entry per output, the offset of the input row or column. Linear takes three: the offset of the
+ * first input, the step to the second one and the weight of the second one with weight_bits fraction bits. Offsets
+ * are in elements, the index times stride.
+ *
+ * @param table         filled with output_size entries
+ * @param input_size    input length along the axis
+ * @param output_size   output length along the axis
+ * @param scale         scale along the axis
+ * @param resize_type   RESIZE_NEAREST or RESIZE_LINEAR
+ * @param coordinate    where an output samples the input
+ * @param nearest_mode  rounding of the coordinate of nearest
+ * @param stride        elements from one input row or column to the next
+ * @param weight_bits   fraction bits of the linear weights
+ */
+void get_resize_axis_table(std::vector<int32_t> &table,
+                           int input_size,
+                           int output_size,
+                           float scale,
+                           resize_mode_t resize_type,
+                           resize_coordinate_t coordinate,
+                           resize_nearest_t nearest_mode,
+                           int stride,
+                           int weight_bits);
+
+/**
+ * @brief Fraction bits of the weights of a linear resize. The weighted sum of int8 fits in int32, int16 takes int64.
+ */
+template <typename feature_t>
+constexpr int resize_weight_bits()
+{
+    return sizeof(feature_t) == 1 ? 11 : 20;
+}
+
 /**
  * @brief Get the resize operation args object
  *
  * @tparam feature_t
- * @param output
+ * @param output        output, or the resize output of a fused Add, which only gives the exponent
  * @param input
- * @param resize_type
+ * @param resize_type   RESIZE_NEAREST or RESIZE_LINEAR
+ * @param coordinate    where an output samples the input
+ * @param nearest_mode  rounding of the coordinate of nearest
  * @param scale_y
  * @param scale_x
+ * @param table_y       filled with the table of the rows, the args point to it
+ * @param table_x       filled with the table of the columns, the args point to it
+ * @param addend        the other input of an Add fused into the resize, of the output shape, nullptr for none
  * @param runtime_mode
  * @return std::vector<resizeArgsType<feature_t>>
  */
@@ -2388,16 +2477,24 @@ template <typename feature_t>
 std::vector<resizeArgsType<feature_t>> get_resize_operation_args(TensorBase *output,
                                                                  TensorBase *input,
                                                                  resize_mode_t resize_type,
+                                                                 resize_coordinate_t coordinate,
+                                                                 resize_nearest_t nearest_mode,
                                                                  float scale_y,
                                                                  float scale_x,
+                                                                 std::vector<int32_t> &table_y,
+                                                                 std::vector<int32_t> &table_x,
+                                                                 TensorBase *addend = nullptr,
                                                                  const runtime_mode_t runtime_mode = RUNTIME_MODE_AUTO)
 {
     resizeArgsType<feature_t> args;
     args.input_element = (feature_t *)input->get_element_ptr();
-    args.input_height = input->shape[1]; // inputs and output are the same shape
+    args.input_height = input->shape[1];
     args.input_width = input->shape[2];
     args.input_channel = input->shape[3];
     args.output_element = (feature_t *)output->get_element_ptr(); // output
+    args.output_height = output->shape[1];
+    args.output_width = output->shape[2];
+    args.addend_element = addend ? (feature_t *)addend->get_element_ptr() : nullptr;
 
     args.resize_type = resize_type;
     args.scale_y = scale_y;
@@ -2409,13 +2506,48 @@ std::vector<resizeArgsType<feature_t>> get_resize_operation_args(TensorBase *out
         args.output_scale = 1 << (-args.output_shift);
         args.output_shift = 0;
     }
+    const int weight_bits = resize_weight_bits<feature_t>();
+    args.weight_shift = 2 * weight_bits + output->exponent - input->exponent;
+    assert(resize_type == RESIZE_NEAREST || args.weight_shift > 0);
+
+    get_resize_axis_table(table_y,
+                          args.input_height,
+                          args.output_height,
+                          scale_y,
+                          resize_type,
+                          coordinate,
+                          nearest_mode,
+                          args.input_width * args.input_channel,
+                          weight_bits);
+    get_resize_axis_table(table_x,
+                          args.input_width,
+                          args.output_width,
+                          scale_x,
+                          resize_type,
+                          coordinate,
+                          nearest_mode,
+                          args.input_channel,
+                          weight_bits);
+    args.table_y = table_y.data();
+    args.table_x = table_x.data();
 
     // for ISA
     int u = 16 / sizeof(feature_t);
     args.c_div_x = input->shape[3] / u;
     args.c_remainder = (args.input_channel % u) * sizeof(feature_t);
-    if (args.resize_type == RESIZE_NEAREST) {
-        if (args.scale_y == 2 && args.scale_x == 2) {
+    if (args.resize_type == RESIZE_NEAREST && !args.addend_element && args.output_height == args.input_height * 2 &&
+        args.output_width == args.input_width * 2) {
+        // Every mode but asymmetric with ceil and align corners takes output row y from input row y / 2.
+        bool is_2x = true;
+        for (int i = 0; i < args.output_height && is_2x; i++) {
+            is_2x = table_y[i] == i / 2 * args.input_width * args.input_channel;
+        }
+        for (int i = 0; i < args.output_width && is_2x; i++) {
+            is_2x = table_x[i] == i / 2 * args.input_channel;
+        }
+        if (is_2x) {
+            args.table_y = nullptr;
+            args.table_x = nullptr;
             args.output_x_offset = args.input_channel;
             args.output_y_offset = args.input_channel * args.input_width * 2;
         }
@@ -2443,7 +2575,7 @@ void resize2d_operation_shell(const resizeArgsType<feature_t> &args,
 
     if (resize_i_impl_func) {
         if (args.resize_type == RESIZE_NEAREST) {
-            if (args.scale_y == 2 && args.scale_x == 2) {
+            if (!args.table_y) {
                 for (int i = 0; i < args.input_height; i++) {
                     for (int j = 0; j < args.input_width; j++) {
                         resize_i_impl_func(output_ptr, input_ptr, (void *const)&args);
@@ -2457,7 +2589,7 @@ void resize2d_operation_shell(const resizeArgsType<feature_t> &args,
     } else // run c_impl_func
     {
         if (args.resize_type == RESIZE_NEAREST) {
-            if (args.scale_y == 2 && args.scale_x == 2) {
+            if (!args.table_y) {
                 for (int i = 0; i < args.input_height; i++) {
                     for (int j = 0; j < args.input_width; j++) {
                         resize_c_impl_func(output_ptr, input_ptr, args);
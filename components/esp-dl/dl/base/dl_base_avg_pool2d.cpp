@@ -64,7 +64,7 @@ inline void load_avg_pool2d_hwc1_s16(ImplFunc_t<int16_t, int16_t> &i_impl_func,
 template <>
 void avg_pool2d<int16_t>(void *args_ptr)
 {
-    PoolArgsType<int16_t> &args = *((PoolArgsType<int16_t> *)args_ptr);
+    PoolArgsType<int16_t> args = copy_args<PoolArgsType<int16_t>>(args_ptr);
 
     ImplFunc_t<int16_t, int16_t> i_impl_func;
     ImplFunc_t<int16_t, int16_t> i_impl_func_sp;
@@ -113,7 +113,7 @@ inline void load_avg_pool2d_hwc1_s8(ImplFunc_t<int8_t, int8_t> &i_impl_func,
 template <>
 void avg_pool2d<int8_t>(void *args_ptr)
 {
-    PoolArgsType<int8_t> &args = *((PoolArgsType<int8_t> *)args_ptr);
+    PoolArgsType<int8_t> args = copy_args<PoolArgsType<int8_t>>(args_ptr);
 
     ImplFunc_t<int8_t, int8_t> i_impl_func;
     ImplFunc_t<int8_t, int8_t> i_impl_func_sp;
@@ -2,6 +2,7 @@
 
 #include "dl_base_activate_buffer.hpp"
 #include "dl_base_activate_output.hpp"
+#include "dl_base_conv2d_vector.hpp"
 #include "dl_base_isa.hpp"
 
 namespace dl {
@@ -613,8 +614,8 @@ inline void load_conv2d_33cn_s16(ImplFunc_t<int16_t, int16_t> &i_impl_func,
     return;
 
 #else // C/C++ implementation
-    c_impl_func_sp = conv2d_33cn<int16_t, int16_t, DL_S16_BUFFER_TYPE>;
-    c_impl_func = conv2d_hwcn<int16_t, int16_t, DL_S16_BUFFER_TYPE>;
+    c_impl_func_sp = conv2d_33cn<int16_t, DL_S16_BUFFER_TYPE>;
+    c_impl_func = conv2d_hwcn<int16_t, DL_S16_BUFFER_TYPE>;
     if (args.bias_element) {
         switch (args.activation_type) {
         case Linear:
@@ -837,7 +838,7 @@ inline void load_conv2d_hwcn_s16(ImplFunc_t<int16_t, int16_t> &i_impl_func,
     return;
 
 #else // C/C++ implement
-    c_impl_func_sp = conv2d_hwcn<int16_t, int16_t, DL_S16_BUFFER_TYPE>;
+    c_impl_func_sp = conv2d_hwcn<int16_t, DL_S16_BUFFER_TYPE>;
     c_impl_func = c_impl_func_sp;
     if (args.bias_element) {
         switch (args.activation_type) {
@@ -877,12 +878,13 @@ inline void load_conv2d_hwcn_s16(ImplFunc_t<int16_t, int16_t> &i_impl_func,
 template <>
 void conv2d<int16_t, int32_t, int64_t>(void *args_ptr)
 {
-    ArgsType<int16_t> &args = *((ArgsType<int16_t> *)args_ptr);
+    ArgsType<int16_t> args = copy_args<ArgsType<int16_t>>(args_ptr);
 
     ImplFunc_t<int16_t, int16_t> i_impl_func;
     ImplFunc_t<int16_t, int16_t> i_impl_func_sp;
     c_impl_func_s16_t c_impl_func = NULL;
     c_impl_func_s16_t c_impl_func_sp = NULL;
+    c_impl_func_s16_t c_impl_func_sp_x2 = NULL;
     n_wise_func_s16_t n_wise_func = NULL;
 
 #if CONFIG_ESP32P4_BOOST
@@ -899,8 +901,14 @@ void conv2d<int16_t, int32_t, int64_t>(void *args_ptr)
     {
         load_conv2d_hwcn_s16(i_impl_func, i_impl_func_sp, c_impl_func, c_impl_func_sp, n_wise_func, args);
     }
+#if DL_VECTOR_C_IMPL
+    if (!i_impl_func_sp) {
+        load_conv2d_vector_c_func<int16_t, int64_t>(c_impl_func, c_impl_func_sp, c_impl_func_sp_x2, args);
+    }
+#endif
 
-    conv_operation_shell<int16_t, int64_t>(args, i_impl_func, i_impl_func_sp, c_impl_func, c_impl_func_sp, n_wise_func);
+    conv_operation_shell<int16_t, int64_t>(
+        args, i_impl_func, i_impl_func_sp, c_impl_func, c_impl_func_sp, n_wise_func, c_impl_func_sp_x2);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1313,12 +1321,13 @@ inline void load_conv2d_s8_per_channel_c_func(c_impl_func_s8_t &c_impl_func,
 template <>
 void conv2d<int8_t, int32_t, int32_t>(void *args_ptr)
 {
-    ArgsType<int8_t> &args = *((ArgsType<int8_t> *)args_ptr);
+    ArgsType<int8_t> args = copy_args<ArgsType<int8_t>>(args_ptr);
 
     ImplFunc_t<int8_t, int8_t> i_impl_func;
     ImplFunc_t<int8_t, int8_t> i_impl_func_sp;
     c_impl_func_s8_t c_impl_func = NULL;
     c_impl_func_s8_t c_impl_func_sp = NULL;
+    c_impl_func_s8_t c_impl_func_sp_x2 = NULL;
     n_wise_func_s8_t n_wise_func = NULL;
 
 #if CONFIG_ESP32P4_BOOST
@@ -1335,9 +1344,13 @@ void conv2d<int8_t, int32_t, int32_t>(void *args_ptr)
 
     if (!i_impl_func || !i_impl_func_sp) {
         load_conv2d_s8_per_channel_c_func(c_impl_func, c_impl_func_sp, n_wise_func, args);
+#if DL_VECTOR_C_IMPL
+        load_conv2d_vector_c_func<int8_t, int32_t>(c_impl_func, c_impl_func_sp, c_impl_func_sp_x2, args);
+#endif
     }
 
-    conv_operation_shell<int8_t, int32_t>(args, i_impl_func, i_impl_func_sp, c_impl_func, c_impl_func_sp, n_wise_func);
+    conv_operation_shell<int8_t, int32_t>(
+        args, i_impl_func, i_impl_func_sp, c_impl_func, c_impl_func_sp, n_wise_func, c_impl_func_sp_x2);
 }
 } // namespace base
 } // namespace dl
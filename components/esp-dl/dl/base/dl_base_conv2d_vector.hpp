@@ -0,0 +1,577 @@
+#pragma once
+
+#include "dl_base.hpp"
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/**
+ * Vector kernels of the C implementation of Conv2D and depthwise Conv2D, for the targets and layers without an ISA
+ * kernel and for the host build. They are written with the vector extensions of GCC, which every target compiler
+ * lowers to what the chip has, with SSE2 and NEON versions of the multiply-accumulates on the host.
+ *
+ * They walk the filter and the input like the scalar loops of dl_base_conv2d.cpp and dl_base_depthwise_conv2d.cpp and
+ * accumulate in the same types, int32 for int8 and DL_S16_BUFFER_TYPE for int16, only in another order, so the results
+ * are bit exact.
+ */
+namespace dl {
+namespace base {
+namespace simd {
+typedef int8_t vs8x4_t __attribute__((vector_size(4)));
+typedef int8_t vs8x8_t __attribute__((vector_size(8)));
+typedef int16_t vs16x4_t __attribute__((vector_size(8)));
+typedef int16_t vs16x8_t __attribute__((vector_size(16)));
+typedef int32_t vs32x4_t __attribute__((vector_size(16)));
+typedef int32_t vs32x8_t __attribute__((vector_size(32)));
+typedef int64_t vs64x4_t __attribute__((vector_size(32)));
+typedef int64_t vs64x8_t __attribute__((vector_size(64)));
+
+// Feature maps and filters have no alignment guarantee per channel, memcpy keeps the loads legal. Vectors wider than
+// 16 bytes go by reference, which keeps the inline calls out of the vector ABI of the host.
+template <typename vector_t>
+inline void load(vector_t &value, const void *ptr)
+{
+    memcpy(&value, ptr, sizeof(vector_t));
+}
+
+template <typename vector_t>
+inline void store(void *ptr, const vector_t &value)
+{
+    memcpy(ptr, &value, sizeof(vector_t));
+}
+
+template <typename vector_t, typename feature_t>
+inline vs32x4_t widen4(const feature_t *ptr)
+{
+    vector_t value;
+    load(value, ptr);
+    return __builtin_convertvector(value, vs32x4_t);
+}
+
+/**
+ * @brief Dot product of 8 channels: mac() adds the products into the lanes of acc_t, sum() adds the lanes up.
+ */
+template <typename feature_t>
+struct dot8;
+
+template <>
+struct dot8<int8_t> {
+#if defined(__SSE2__)
+    typedef __m128i acc_t;
+
+    static inline acc_t zero() { return _mm_setzero_si128(); }
+
+    static inline __m128i widen(const int8_t *ptr)
+    {
+        __m128i value = _mm_loadl_epi64((const __m128i *)ptr);
+#if defined(__SSE4_1__)
+        return _mm_cvtepi8_epi16(value);
+#else
+        return _mm_srai_epi16(_mm_unpacklo_epi8(value, value), 8);
+#endif
+    }
+
+    // int8 x int8 pairs can not overflow the int32 lanes of madd.
+    static inline void mac(acc_t &acc, const int8_t *input, const int8_t *filter)
+    {
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(widen(input), widen(filter)));
+    }
+
+    static inline int32_t sum(acc_t acc)
+    {
+        acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0x4e));
+        acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0xb1));
+        return _mm_cvtsi128_si32(acc);
+    }
+#elif defined(__ARM_NEON)
+    typedef int32x4_t acc_t;
+
+    static inline acc_t zero() { return vdupq_n_s32(0); }
+
+    static inline void mac(acc_t &acc, const int8_t *input, const int8_t *filter)
+    {
+        acc = vpadalq_s16(acc, vmull_s8(vld1_s8(input), vld1_s8(filter)));
+    }
+
+    static inline int32_t sum(acc_t acc)
+    {
+        int32x2_t half = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+        return vget_lane_s32(vpadd_s32(half, half), 0);
+    }
+#else
+    typedef vs32x4_t acc_t;
+
+    static inline acc_t zero() { return (acc_t){0, 0, 0, 0}; }
+
+    static inline void mac(acc_t &acc, const int8_t *input, const int8_t *filter)
+    {
+        acc += widen4<vs8x4_t>(input) * widen4<vs8x4_t>(filter);
+        acc += widen4<vs8x4_t>(input + 4) * widen4<vs8x4_t>(filter + 4);
+    }
+
+    static inline int32_t sum(acc_t acc) { return acc[0] + acc[1] + acc[2] + acc[3]; }
+#endif
+};
+
+// int16 x int16 fits int32, the sums go to int64 lanes like DL_S16_BUFFER_TYPE.
+template <>
+struct dot8<int16_t> {
+#if defined(__SSE2__)
+    typedef __m128i acc_t;
+
+    static inline acc_t zero() { return _mm_setzero_si128(); }
+
+    /**
+     * A pair summed by madd lies in [-2^31 + 2^17, 2^31], only -32768 * -32768 twice reaches 2^31 and wraps to
+     * INT32_MIN, which no other pair gives. So INT32_MIN is 2^31 and the rest widens with its sign.
+     */
+    static inline void mac(acc_t &acc, const int16_t *input, const int16_t *filter)
+    {
+        __m128i pairs = _mm_madd_epi16(_mm_loadu_si128((const __m128i *)input),
+                                       _mm_loadu_si128((const __m128i *)filter));
+        __m128i sign = _mm_andnot_si128(_mm_cmpeq_epi32(pairs, _mm_set1_epi32(INT32_MIN)), _mm_srai_epi32(pairs, 31));
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(pairs, sign));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(pairs, sign));
+    }
+
+    static inline int64_t sum(acc_t acc)
+    {
+        int64_t lanes[2];
+        _mm_storeu_si128((__m128i *)lanes, acc);
+        return lanes[0] + lanes[1];
+    }
+#elif defined(__ARM_NEON)
+    typedef int64x2_t acc_t;
+
+    static inline acc_t zero() { return vdupq_n_s64(0); }
+
+    static inline void mac(acc_t &acc, const int16_t *input, const int16_t *filter)
+    {
+        int16x8_t a = vld1q_s16(input);
+        int16x8_t b = vld1q_s16(filter);
+        acc = vpadalq_s32(acc, vmull_s16(vget_low_s16(a), vget_low_s16(b)));
+        acc = vpadalq_s32(acc, vmull_s16(vget_high_s16(a), vget_high_s16(b)));
+    }
+
+    static inline int64_t sum(acc_t acc) { return vgetq_lane_s64(acc, 0) + vgetq_lane_s64(acc, 1); }
+#else
+    typedef vs64x4_t acc_t;
+
+    static inline acc_t zero() { return (acc_t){0, 0, 0, 0}; }
+
+    static inline void mac(acc_t &acc, const int16_t *input, const int16_t *filter)
+    {
+        vs32x4_t low = widen4<vs16x4_t>(input) * widen4<vs16x4_t>(filter);
+        vs32x4_t high = widen4<vs16x4_t>(input + 4) * widen4<vs16x4_t>(filter + 4);
+        acc += __builtin_convertvector(low, vs64x4_t) + __builtin_convertvector(high, vs64x4_t);
+    }
+
+    static inline int64_t sum(const acc_t &acc) { return acc[0] + acc[1] + acc[2] + acc[3]; }
+#endif
+};
+
+/**
+ * @brief Products of 8 channels kept per channel, for depthwise Conv2D: widen() loads the channels of the input or of
+ * the filter, mac() adds their products into the lanes of acc_t and add_to() adds the lanes to the buffer.
+ */
+template <typename feature_t>
+struct mul8;
+
+// int8 x int8 fits int16, the products widen to int32 only to be added.
+template <>
+struct mul8<int8_t> {
+#if defined(__SSE2__)
+    typedef __m128i value_t;
+    typedef struct {
+        __m128i low;
+        __m128i high;
+    } acc_t;
+
+    static inline void zero(acc_t &acc) { acc.low = acc.high = _mm_setzero_si128(); }
+
+    static inline value_t widen(const int8_t *ptr) { return dot8<int8_t>::widen(ptr); }
+
+    static inline void mac(acc_t &acc, value_t input, value_t filter)
+    {
+        __m128i product = _mm_mullo_epi16(input, filter);
+        __m128i sign = _mm_srai_epi16(product, 15);
+        acc.low = _mm_add_epi32(acc.low, _mm_unpacklo_epi16(product, sign));
+        acc.high = _mm_add_epi32(acc.high, _mm_unpackhi_epi16(product, sign));
+    }
+
+    static inline void add_to(int32_t *buffer_ptr, const acc_t &acc)
+    {
+        __m128i *buffer = (__m128i *)buffer_ptr;
+        _mm_storeu_si128(buffer, _mm_add_epi32(_mm_loadu_si128(buffer), acc.low));
+        _mm_storeu_si128(buffer + 1, _mm_add_epi32(_mm_loadu_si128(buffer + 1), acc.high));
+    }
+#elif defined(__ARM_NEON)
+    typedef int8x8_t value_t;
+    typedef struct {
+        int32x4_t low;
+        int32x4_t high;
+    } acc_t;
+
+    static inline void zero(acc_t &acc) { acc.low = acc.high = vdupq_n_s32(0); }
+
+    static inline value_t widen(const int8_t *ptr) { return vld1_s8(ptr); }
+
+    static inline void mac(acc_t &acc, value_t input, value_t filter)
+    {
+        int16x8_t product = vmull_s8(input, filter);
+        acc.low = vaddw_s16(acc.low, vget_low_s16(product));
+        acc.high = vaddw_s16(acc.high, vget_high_s16(product));
+    }
+
+    static inline void add_to(int32_t *buffer_ptr, const acc_t &acc)
+    {
+        vst1q_s32(buffer_ptr, vaddq_s32(vld1q_s32(buffer_ptr), acc.low));
+        vst1q_s32(buffer_ptr + 4, vaddq_s32(vld1q_s32(buffer_ptr + 4), acc.high));
+    }
+#else
+    typedef vs16x8_t value_t;
+    typedef vs32x8_t acc_t;
+
+    static inline void zero(acc_t &acc) { acc = (acc_t){0, 0, 0, 0, 0, 0, 0, 0}; }
+
+    static inline value_t widen(const int8_t *ptr)
+    {
+        vs8x8_t value;
+        load(value, ptr);
+        return __builtin_convertvector(value, value_t);
+    }
+
+    static inline void mac(acc_t &acc, value_t input, value_t filter)
+    {
+        acc += __builtin_convertvector(input * filter, vs32x8_t);
+    }
+
+    static inline void add_to(int32_t *buffer_ptr, const acc_t &acc)
+    {
+        acc_t buffer;
+        load(buffer, buffer_ptr);
+        store(buffer_ptr, buffer + acc);
+    }
+#endif
+};
+
+// int16 x int16 fits int32, the products widen to int64 like DL_S16_BUFFER_TYPE.
+template <>
+struct mul8<int16_t> {
+#if defined(__SSE2__)
+    typedef __m128i value_t;
+    typedef struct {
+        __m128i lanes[4];
+    } acc_t;
+
+    static inline void zero(acc_t &acc)
+    {
+        for (int i = 0; i < 4; i++) {
+            acc.lanes[i] = _mm_setzero_si128();
+        }
+    }
+
+    static inline value_t widen(const int16_t *ptr) { return _mm_loadu_si128((const __m128i *)ptr); }
+
+    static inline void add_widened(__m128i *lanes, __m128i product)
+    {
+        __m128i sign = _mm_srai_epi32(product, 31);
+        lanes[0] = _mm_add_epi64(lanes[0], _mm_unpacklo_epi32(product, sign));
+        lanes[1] = _mm_add_epi64(lanes[1], _mm_unpackhi_epi32(product, sign));
+    }
+
+    static inline void mac(acc_t &acc, value_t input, value_t filter)
+    {
+        __m128i low = _mm_mullo_epi16(input, filter);
+        __m128i high = _mm_mulhi_epi16(input, filter);
+        add_widened(acc.lanes, _mm_unpacklo_epi16(low, high));
+        add_widened(acc.lanes + 2, _mm_unpackhi_epi16(low, high));
+    }
+
+    static inline void add_to(int64_t *buffer_ptr, const acc_t &acc)
+    {
+        __m128i *buffer = (__m128i *)buffer_ptr;
+        for (int i = 0; i < 4; i++) {
+            _mm_storeu_si128(buffer + i, _mm_add_epi64(_mm_loadu_si128(buffer + i), acc.lanes[i]));
+        }
+    }
+#elif defined(__ARM_NEON)
+    typedef int16x8_t value_t;
+    typedef struct {
+        int64x2_t lanes[4];
+    } acc_t;
+
+    static inline void zero(acc_t &acc)
+    {
+        for (int i = 0; i < 4; i++) {
+            acc.lanes[i] = vdupq_n_s64(0);
+        }
+    }
+
+    static inline value_t widen(const int16_t *ptr) { return vld1q_s16(ptr); }
+
+    static inline void mac(acc_t &acc, value_t input, value_t filter)
+    {
+        int32x4_t low = vmull_s16(vget_low_s16(input), vget_low_s16(filter));
+        int32x4_t high = vmull_s16(vget_high_s16(input), vget_high_s16(filter));
+        acc.lanes[0] = vaddw_s32(acc.lanes[0], vget_low_s32(low));
+        acc.lanes[1] = vaddw_s32(acc.lanes[1], vget_high_s32(low));
+        acc.lanes[2] = vaddw_s32(acc.lanes[2], vget_low_s32(high));
+        acc.lanes[3] = vaddw_s32(acc.lanes[3], vget_high_s32(high));
+    }
+
+    static inline void add_to(int64_t *buffer_ptr, const acc_t &acc)
+    {
+        for (int i = 0; i < 4; i++) {
+            vst1q_s64(buffer_ptr + 2 * i, vaddq_s64(vld1q_s64(buffer_ptr + 2 * i), acc.lanes[i]));
+        }
+    }
+#else
+    typedef vs16x8_t value_t;
+    typedef vs64x8_t acc_t;
+
+    static inline void zero(acc_t &acc) { acc = (acc_t){0, 0, 0, 0, 0, 0, 0, 0}; }
+
+    static inline value_t widen(const int16_t *ptr)
+    {
+        value_t value;
+        load(value, ptr);
+        return value;
+    }
+
+    static inline void mac(acc_t &acc, value_t input, value_t filter)
+    {
+        vs32x8_t product = __builtin_convertvector(input, vs32x8_t) * __builtin_convertvector(filter, vs32x8_t);
+        acc += __builtin_convertvector(product, vs64x8_t);
+    }
+
+    static inline void add_to(int64_t *buffer_ptr, const acc_t &acc)
+    {
+        acc_t buffer;
+        load(buffer, buffer_ptr);
+        store(buffer_ptr, buffer + acc);
+    }
+#endif
+};
+} // namespace simd
+
+/**
+ * @brief Conv2D of P neighbouring output pixels, 4 output channels at a time, with the filter in [N, H, W, C]: every
+ * filter load serves P pixels and every input load 4 output channels. Pixel p goes to
+ * buffer_ptr[p * output_channel, (p + 1) * output_channel).
+ *
+ * FH and FW are the filter size of conv2d_11cn and conv2d_33cn, which only run over the full filter, and follow their
+ * offsets. 0 reads the size from args and steps the filter like conv2d_hwcn, which also serves the borders where the
+ * shell shrinks the window.
+ */
+template <typename feature_t, typename buffer_t, int FH, int FW, int P>
+inline void conv2d_vector(buffer_t *buffer_ptr, feature_t *input_ptr, const ArgsType<feature_t> &args)
+{
+    typedef simd::dot8<feature_t> dot;
+    const int filter_height = FH ? FH : args.filter_height;
+    const int filter_width = FW ? FW : args.filter_width;
+    const int input_channel = args.input_channel;
+    const int input_channel_8 = input_channel & ~7;
+    int filter_y_offset;
+    int filter_n_offset;
+    if (FH == 1 && FW == 1) {
+        filter_y_offset = input_channel;
+        filter_n_offset = input_channel;
+    } else if (FH == 3 && FW == 3) {
+        filter_y_offset = args.filter_y_offset_c;
+        filter_n_offset = args.filter_n_offset_c;
+    } else {
+        filter_y_offset = filter_width * input_channel + args.filter_y_offset;
+        filter_n_offset = filter_height * filter_y_offset + args.filter_n_offset;
+    }
+
+    const feature_t *filter_ptr = (const feature_t *)args.filter_element;
+    int output_c = 0;
+    for (; output_c + 4 <= args.output_channel; output_c += 4) {
+        typename dot::acc_t acc[4][P];
+        buffer_t acc_c[4][P];
+        for (int n = 0; n < 4; n++) {
+            for (int p = 0; p < P; p++) {
+                acc[n][p] = dot::zero();
+                acc_c[n][p] = 0;
+            }
+        }
+        for (int filter_y = 0; filter_y < filter_height; filter_y++) {
+            for (int filter_x = 0; filter_x < filter_width; filter_x++) {
+                const feature_t *input_yx =
+                    input_ptr + filter_y * args.input_dilation_y_offset + filter_x * args.input_dilation_x_offset;
+                const feature_t *filter_yx = filter_ptr + filter_y * filter_y_offset + filter_x * input_channel;
+                int input_c = 0;
+                for (; input_c < input_channel_8; input_c += 8) {
+                    for (int n = 0; n < 4; n++) {
+                        for (int p = 0; p < P; p++) {
+                            dot::mac(acc[n][p],
+                                     input_yx + p * args.input_stride_x_offset + input_c,
+                                     filter_yx + n * filter_n_offset + input_c);
+                        }
+                    }
+                }
+                for (; input_c < input_channel; input_c++) {
+                    for (int n = 0; n < 4; n++) {
+                        for (int p = 0; p < P; p++) {
+                            acc_c[n][p] += input_yx[p * args.input_stride_x_offset + input_c] *
+                                filter_yx[n * filter_n_offset + input_c];
+                        }
+                    }
+                }
+            }
+        }
+        for (int n = 0; n < 4; n++) {
+            for (int p = 0; p < P; p++) {
+                buffer_ptr[p * args.output_channel + output_c + n] = dot::sum(acc[n][p]) + acc_c[n][p];
+            }
+        }
+        filter_ptr += 4 * filter_n_offset;
+    }
+
+    for (; output_c < args.output_channel; output_c++) {
+        typename dot::acc_t acc[P];
+        buffer_t acc_c[P];
+        for (int p = 0; p < P; p++) {
+            acc[p] = dot::zero();
+            acc_c[p] = 0;
+        }
+        for (int filter_y = 0; filter_y < filter_height; filter_y++) {
+            for (int filter_x = 0; filter_x < filter_width; filter_x++) {
+                const feature_t *input_yx =
+                    input_ptr + filter_y * args.input_dilation_y_offset + filter_x * args.input_dilation_x_offset;
+                const feature_t *filter_yx = filter_ptr + filter_y * filter_y_offset + filter_x * input_channel;
+                int input_c = 0;
+                for (; input_c < input_channel_8; input_c += 8) {
+                    for (int p = 0; p < P; p++) {
+                        dot::mac(acc[p], input_yx + p * args.input_stride_x_offset + input_c, filter_yx + input_c);
+                    }
+                }
+                for (; input_c < input_channel; input_c++) {
+                    for (int p = 0; p < P; p++) {
+                        acc_c[p] += input_yx[p * args.input_stride_x_offset + input_c] * filter_yx[input_c];
+                    }
+                }
+            }
+        }
+        for (int p = 0; p < P; p++) {
+            buffer_ptr[p * args.output_channel + output_c] = dot::sum(acc[p]) + acc_c[p];
+        }
+        filter_ptr += filter_n_offset;
+    }
+}
+
+/**
+ * @brief Depthwise Conv2D of P neighbouring output pixels, 8 channels at a time, with the filter in [H, W, C]: every
+ * filter load serves P pixels. Adds into buffer_ptr like the scalar loops, pixel p at
+ * buffer_ptr[p * output_channel, (p + 1) * output_channel).
+ *
+ * FH and FW are the filter size of depthwise_conv2d_33c1, which only runs over the full filter, and follow its offsets.
+ * 0 reads the size from args and steps the filter like depthwise_conv2d_hwc1.
+ */
+template <typename feature_t, typename buffer_t, int FH, int FW, int P>
+inline void depthwise_conv2d_vector(buffer_t *buffer_ptr, feature_t *input_ptr, const ArgsType<feature_t> &args)
+{
+    typedef simd::mul8<feature_t> mul;
+    const int filter_height = FH ? FH : args.filter_height;
+    const int filter_width = FW ? FW : args.filter_width;
+    const int channel = args.input_channel;
+    const int filter_y_offset = FH && FW ? args.filter_y_offset_c : filter_width * channel + args.filter_y_offset;
+    const feature_t *filter_ptr = (const feature_t *)args.filter_element;
+
+    int c = 0;
+    for (; c + 8 <= channel; c += 8) {
+        typename mul::acc_t acc[P];
+        for (int p = 0; p < P; p++) {
+            mul::zero(acc[p]);
+        }
+        for (int filter_y = 0; filter_y < filter_height; filter_y++) {
+            for (int filter_x = 0; filter_x < filter_width; filter_x++) {
+                const feature_t *input_yx =
+                    input_ptr + filter_y * args.input_dilation_y_offset + filter_x * args.input_dilation_x_offset + c;
+                typename mul::value_t filter =
+                    mul::widen(filter_ptr + filter_y * filter_y_offset + filter_x * channel + c);
+                for (int p = 0; p < P; p++) {
+                    mul::mac(acc[p], mul::widen(input_yx + p * args.input_stride_x_offset), filter);
+                }
+            }
+        }
+        for (int p = 0; p < P; p++) {
+            mul::add_to(buffer_ptr + p * args.output_channel + c, acc[p]);
+        }
+    }
+
+    for (; c < channel; c++) {
+        for (int filter_y = 0; filter_y < filter_height; filter_y++) {
+            for (int filter_x = 0; filter_x < filter_width; filter_x++) {
+                const feature_t *input_yx =
+                    input_ptr + filter_y * args.input_dilation_y_offset + filter_x * args.input_dilation_x_offset + c;
+                feature_t filter = filter_ptr[filter_y * filter_y_offset + filter_x * channel + c];
+                for (int p = 0; p < P; p++) {
+                    buffer_ptr[p * args.output_channel + c] += input_yx[p * args.input_stride_x_offset] * filter;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Replaces the scalar C implementation of Conv2D with the vector kernels, c_impl_func_sp_x2 computes two
+ * output pixels of the body per call.
+ */
+template <typename feature_t, typename buffer_t>
+inline void load_conv2d_vector_c_func(void (*&c_impl_func)(buffer_t *, feature_t *, const ArgsType<feature_t> &),
+                                      void (*&c_impl_func_sp)(buffer_t *, feature_t *, const ArgsType<feature_t> &),
+                                      void (*&c_impl_func_sp_x2)(buffer_t *, feature_t *, const ArgsType<feature_t> &),
+                                      const ArgsType<feature_t> &args)
+{
+    if (args.filter_height == 1 && args.filter_width == 1) // Filter shape = [1, 1, C, N]
+    {
+        c_impl_func_sp = conv2d_vector<feature_t, buffer_t, 1, 1, 1>;
+        c_impl_func = c_impl_func_sp;
+        c_impl_func_sp_x2 = conv2d_vector<feature_t, buffer_t, 1, 1, 2>;
+    } else if (args.filter_height == 3 && args.filter_width == 3) // Filter shape = [3, 3, C, N]
+    {
+        c_impl_func_sp = conv2d_vector<feature_t, buffer_t, 3, 3, 1>;
+        c_impl_func = conv2d_vector<feature_t, buffer_t, 0, 0, 1>;
+        c_impl_func_sp_x2 = conv2d_vector<feature_t, buffer_t, 3, 3, 2>;
+    } else // Filter shape = [H, W, C, N]
+    {
+        c_impl_func_sp = conv2d_vector<feature_t, buffer_t, 0, 0, 1>;
+        c_impl_func = c_impl_func_sp;
+        c_impl_func_sp_x2 = conv2d_vector<feature_t, buffer_t, 0, 0, 2>;
+    }
+}
+
+/**
+ * @brief Replaces the scalar C implementation of depthwise Conv2D with the vector kernels, c_impl_func_sp_x2 computes
+ * two output pixels of the body per call.
+ */
+template <typename feature_t, typename buffer_t>
+inline void load_depthwise_conv2d_vector_c_func(
+    void (*&c_impl_func)(buffer_t *, feature_t *, const ArgsType<feature_t> &),
+    void (*&c_impl_func_sp)(buffer_t *, feature_t *, const ArgsType<feature_t> &),
+    void (*&c_impl_func_sp_x2)(buffer_t *, feature_t *, const ArgsType<feature_t> &),
+    const ArgsType<feature_t> &args)
+{
+    if (args.filter_height == 3 && args.filter_width == 3) // Filter shape = [3, 3, C, N]
+    {
+        c_impl_func_sp = depthwise_conv2d_vector<feature_t, buffer_t, 3, 3, 1>;
+        c_impl_func = depthwise_conv2d_vector<feature_t, buffer_t, 0, 0, 1>;
+        c_impl_func_sp_x2 = depthwise_conv2d_vector<feature_t, buffer_t, 3, 3, 2>;
+    } else // Filter shape = [H, W, C, N]
+    {
+        c_impl_func_sp = depthwise_conv2d_vector<feature_t, buffer_t, 0, 0, 1>;
+        c_impl_func = c_impl_func_sp;
+        c_impl_func_sp_x2 = depthwise_conv2d_vector<feature_t, buffer_t, 0, 0, 2>;
+    }
+}
+} // namespace base
+} // namespace dl
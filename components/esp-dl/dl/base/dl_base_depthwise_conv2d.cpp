@@ -2,6 +2,7 @@
 
 #include "dl_base_activate_buffer.hpp"
 #include "dl_base_activate_output.hpp"
+#include "dl_base_conv2d_vector.hpp"
 #include "dl_base_isa.hpp"
 
 namespace dl {
@@ -462,7 +463,7 @@ inline void load_depthwise_conv2d_hwc1_s16(ImplFunc_t<int16_t, int16_t> &i_impl_
 template <>
 void depthwise_conv2d<int16_t, int32_t, int64_t>(void *args_ptr)
 {
-    ArgsType<int16_t> &args = *((ArgsType<int16_t> *)args_ptr);
+    ArgsType<int16_t> args = copy_args<ArgsType<int16_t>>(args_ptr);
 
     ImplFunc_t<int16_t, int16_t> i_impl_func;
     ImplFunc_t<int16_t, int16_t> i_impl_func_sp;
@@ -481,6 +482,7 @@ void depthwise_conv2d<int16_t, int32_t, int64_t>(void *args_ptr)
     {
         load_depthwise_conv2d_hwc1_s16(i_impl_func, i_impl_func_sp, c_impl_func, c_impl_func_sp, n_wise_func, args);
     }
+    // No vector kernel for int16, with DL_S16_BUFFER_TYPE accumulators it measured no faster than the scalar loops.
     dwconv_operation_shell<int16_t, DL_S16_BUFFER_TYPE>(
         args, i_impl_func, i_impl_func_sp, c_impl_func, c_impl_func_sp, n_wise_func);
 }
@@ -790,12 +792,13 @@ inline void load_depthwise_conv2d_s8_per_channel_c_func(c_impl_func_s8_t &c_impl
 template <>
 void depthwise_conv2d<int8_t, int32_t, int32_t>(void *args_ptr)
 {
-    ArgsType<int8_t> &args = *((ArgsType<int8_t> *)args_ptr);
+    ArgsType<int8_t> args = copy_args<ArgsType<int8_t>>(args_ptr);
 
     ImplFunc_t<int8_t, int8_t> i_impl_func;
     ImplFunc_t<int8_t, int8_t> i_impl_func_sp;
     c_impl_func_s8_t c_impl_func = NULL;
     c_impl_func_s8_t c_impl_func_sp = NULL;
+    c_impl_func_s8_t c_impl_func_sp_x2 = NULL;
     n_wise_func_s8_t n_wise_func = NULL;
 
 #if CONFIG_ESP32P4_BOOST
@@ -810,9 +813,12 @@ void depthwise_conv2d<int8_t, int32_t, int32_t>(void *args_ptr)
 
     if (!i_impl_func || !i_impl_func_sp) {
         load_depthwise_conv2d_s8_per_channel_c_func(c_impl_func, c_impl_func_sp, n_wise_func, args);
+#if DL_VECTOR_C_IMPL
+        load_depthwise_conv2d_vector_c_func<int8_t, int32_t>(c_impl_func, c_impl_func_sp, c_impl_func_sp_x2, args);
+#endif
     }
     dwconv_operation_shell<int8_t, int32_t>(
-        args, i_impl_func, i_impl_func_sp, c_impl_func, c_impl_func_sp, n_wise_func);
+        args, i_impl_func, i_impl_func_sp, c_impl_func, c_impl_func_sp, n_wise_func, c_impl_func_sp_x2);
 }
 } // namespace base
 } // namespace dl
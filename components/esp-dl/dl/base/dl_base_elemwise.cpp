@@ -35,6 +35,90 @@ int calculate_elemwise_stride(std::vector<int> shape, int dim)
     return offset;
 }
 
+template <typename in_feature_t, typename out_feature_t>
+static void set_elemwise_isa_args(elemwiseArgsType<in_feature_t, out_feature_t> &args)
+{
+    int u = 16 / sizeof(in_feature_t);
+    int c_div_x = args.output_d0 / u;
+    args.c_remainder = (args.output_d0 % u) * sizeof(in_feature_t);
+    args.c_div_x_1 = c_div_x - 1;
+    args.c_div_2x_1 = DL_MAX(c_div_x / 2 - 1, 0);
+    args.c_left_x_1 = c_div_x - 2 * args.c_div_2x_1 - 1;
+}
+
+// Split an element-wise op into tiles. A 1D op is cut into runs of whole vectors, so every tile but the last keeps
+// 16 byte aligned pointers. Higher dimensional ops are cut along the outermost loop.
+template <typename in_feature_t, typename out_feature_t>
+static std::vector<elemwiseArgsType<in_feature_t, out_feature_t>> split_elemwise_args(
+    const elemwiseArgsType<in_feature_t, out_feature_t> &args, const runtime_mode_t runtime_mode)
+{
+    std::vector<elemwiseArgsType<in_feature_t, out_feature_t>> m_args;
+    if (args.dims == 1) {
+        int u = 16 / sizeof(in_feature_t);
+        int n_tiles = get_tile_num(runtime_mode, args.output_d0, args.output_d0 / u);
+        if (n_tiles == 1) {
+            return std::vector<elemwiseArgsType<in_feature_t, out_feature_t>>(1, args);
+        }
+        int chunk = (args.output_d0 / u + n_tiles - 1) / n_tiles * u;
+        for (int start = 0; start < args.output_d0; start += chunk) {
+            elemwiseArgsType<in_feature_t, out_feature_t> tile = args;
+            int length = DL_MIN(chunk, args.output_d0 - start);
+            tile.output_element += start;
+            tile.output_d0 = length;
+            if (args.input0_d0 != 1) {
+                tile.input0_element += start;
+                tile.input0_d0 = length;
+            }
+            if (args.input1_d0 != 1) {
+                tile.input1_element += start;
+                tile.input1_d0 = length;
+            }
+            set_elemwise_isa_args(tile);
+            m_args.push_back(tile);
+        }
+        return m_args;
+    }
+
+    // elements the output and input pointers advance by per iteration of the outermost loop
+    int outer, output_step, input0_step, input1_step;
+    int input0_d2_step = args.output_d1 * args.input0_d1_stride + args.input0_d2_stride;
+    int input1_d2_step = args.output_d1 * args.input1_d1_stride + args.input1_d2_stride;
+    if (args.dims == 2) {
+        outer = args.output_d1;
+        output_step = args.output_d0;
+        input0_step = args.input0_d1_stride;
+        input1_step = args.input1_d1_stride;
+    } else if (args.dims == 3) {
+        outer = args.output_d2;
+        output_step = args.output_d0 * args.output_d1;
+        input0_step = input0_d2_step;
+        input1_step = input1_d2_step;
+    } else {
+        outer = args.output_d3;
+        output_step = args.output_d0 * args.output_d1 * args.output_d2;
+        input0_step = args.output_d2 * input0_d2_step + args.input0_d3_stride;
+        input1_step = args.output_d2 * input1_d2_step + args.input1_d3_stride;
+    }
+    int n_tiles = get_tile_num(runtime_mode, (int64_t)outer * output_step, outer);
+    for (int i = 0; i < n_tiles; i++) {
+        elemwiseArgsType<in_feature_t, out_feature_t> tile = args;
+        int start = outer * i / n_tiles;
+        int end = outer * (i + 1) / n_tiles;
+        tile.output_element += start * output_step;
+        tile.input0_element += start * input0_step;
+        tile.input1_element += start * input1_step;
+        if (args.dims == 2) {
+            tile.output_d1 = end - start;
+        } else if (args.dims == 3) {
+            tile.output_d2 = end - start;
+        } else {
+            tile.output_d3 = end - start;
+        }
+        m_args.push_back(tile);
+    }
+    return m_args;
+}
+
 template <typename in_feature_t, typename out_feature_t>
 std::vector<elemwiseArgsType<in_feature_t, out_feature_t>> get_elemwise_operation_args(
     TensorBase *output, TensorBase *input0, TensorBase *input1, const runtime_mode_t runtime_mode)
@@ -157,12 +241,7 @@ std::vector<elemwiseArgsType<in_feature_t, out_feature_t>> get_elemwise_operatio
     }
 
     // for ISA
-    int u = 16 / sizeof(in_feature_t);
-    int c_div_x = args.output_d0 / u;
-    args.c_remainder = (args.output_d0 % u) * sizeof(in_feature_t);
-    args.c_div_x_1 = c_div_x - 1;
-    args.c_div_2x_1 = DL_MAX(c_div_x / 2 - 1, 0);
-    args.c_left_x_1 = c_div_x - 2 * args.c_div_2x_1 - 1;
+    set_elemwise_isa_args(args);
 
     args.mul_shift = output->exponent - input0->exponent - input1->exponent;
 
@@ -172,9 +251,7 @@ std::vector<elemwiseArgsType<in_feature_t, out_feature_t>> get_elemwise_operatio
     // args.mul_shift = DL_MAX(args.mul_shift, 0); //
     args.compare_mask = 1;
 
-    // todo:: support two core
-    std::vector<elemwiseArgsType<in_feature_t, out_feature_t>> m_args(1, args);
-    return m_args;
+    return split_elemwise_args(args, runtime_mode);
 }
 template std::vector<elemwiseArgsType<int8_t>> get_elemwise_operation_args(TensorBase *output,
                                                                            TensorBase *input0,
@@ -0,0 +1,93 @@
+#include "dl_base_lut16.hpp"
+#include <string.h>
+
+namespace dl {
+namespace base {
+namespace {
+// The quantized activation of the inputs of a segment, each computed once like the float path of the modules does.
+class SegmentCache {
+private:
+    Lut16::func_t m_func;
+    float m_input_scale;
+    float m_output_scale;
+    int m_start;
+    int m_values[257];
+    bool m_known[257];
+
+public:
+    SegmentCache(Lut16::func_t func, int input_exponent, int output_exponent) :
+        m_func(func), m_input_scale(DL_SCALE(input_exponent)), m_output_scale(DL_RESCALE(output_exponent))
+    {
+    }
+
+    void reset(int start)
+    {
+        m_start = start;
+        memset(m_known, 0, sizeof(m_known));
+    }
+
+    int operator[](int offset)
+    {
+        if (!m_known[offset]) {
+            int16_t value;
+            tool::truncate(value, tool::round(m_func((float)(m_start + offset) * m_input_scale) * m_output_scale));
+            m_values[offset] = value;
+            m_known[offset] = true;
+        }
+        return m_values[offset];
+    }
+};
+
+inline int interpolate(int low, int high, int frac, int shift)
+{
+    return low + (((high - low) * frac + ((1 << shift) >> 1)) >> shift);
+}
+
+// Whether steps of 2^shift stay within 1 LSB of every input of the segment.
+bool fits(SegmentCache &cache, int shift)
+{
+    int step = 1 << shift;
+    for (int start = 0; start < 256; start += step) {
+        int low = cache[start];
+        int high = cache[start + step];
+        for (int frac = 1; frac < step; frac++) {
+            if (DL_ABS(interpolate(low, high, frac, shift) - cache[start + frac]) > 1) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+} // namespace
+
+Lut16::Lut16(func_t func, int input_exponent, int output_exponent) :
+    m_segments(256), m_input_exponent(input_exponent), m_output_exponent(output_exponent)
+{
+    SegmentCache cache(func, input_exponent, output_exponent);
+    for (int segment = 0; segment < 256; segment++) {
+        cache.reset(segment * 256 - 32768);
+        int shift = 8;
+        while (shift > 0 && !fits(cache, shift)) {
+            shift--;
+        }
+        if (m_samples.size() + (256 >> shift) + 1 > DL_LUT16_MAX_SAMPLES) {
+            m_samples.clear();
+            m_samples.shrink_to_fit();
+            return;
+        }
+        m_segments[segment] = m_samples.size() << 4 | shift;
+        for (int offset = 0; offset <= 256; offset += 1 << shift) {
+            m_samples.push_back(cache[offset]);
+        }
+    }
+    m_samples.shrink_to_fit();
+}
+
+void Lut16::forward(const int16_t *input, int16_t *output, int size) const
+{
+    for (int i = 0; i < size; i++) {
+        output[i] = (*this)(input[i]);
+    }
+}
+} // namespace base
+} // namespace dl
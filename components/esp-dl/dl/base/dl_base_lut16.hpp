@@ -0,0 +1,73 @@
+#pragma once
+
+#include "dl_base.hpp"
+#include <vector>
+
+/**
+ * Largest table of an int16 activation, in samples. An activation which would need more, exp with a coarse input
+ * exponent say, keeps computing in float.
+ */
+#ifndef DL_LUT16_MAX_SAMPLES
+#define DL_LUT16_MAX_SAMPLES 8192
+#endif
+
+namespace dl {
+namespace base {
+/**
+ * @brief Two-level lookup table of an int16 activation, built from the exponents of its input and output.
+ *
+ * The first level splits the 65536 inputs into 256 segments by their high byte. Each segment samples the quantized
+ * activation every 2^shift inputs, its own shift from 0 to 8, and the samples of every segment are the second level.
+ * An input interpolates linearly between the two samples around it. A segment takes the largest step at which every
+ * one of its inputs stays within 1 LSB of the float path, so the saturated tails of sigmoid take 2 samples and a steep
+ * part one per input at worst. The build computes the float path once per input, about the cost of one Sigmoid over
+ * 65536 elements.
+ */
+class Lut16 {
+public:
+    typedef float (*func_t)(float);
+
+private:
+    std::vector<uint32_t> m_segments; /*<! offset of the first sample << 4 | shift */
+    std::vector<int16_t> m_samples;
+    int m_input_exponent;
+    int m_output_exponent;
+
+public:
+    /**
+     * @brief Build the table of func.
+     *
+     * @param func             the activation, in float, as the float path of the module computes it
+     * @param input_exponent   exponent of the input
+     * @param output_exponent  exponent of the output
+     */
+    Lut16(func_t func, int input_exponent, int output_exponent);
+
+    /**
+     * @brief Samples of the table, 0 when it would need more than DL_LUT16_MAX_SAMPLES.
+     */
+    int get_size() const { return m_samples.size(); }
+    int get_input_exponent() const { return m_input_exponent; }
+    int get_output_exponent() const { return m_output_exponent; }
+
+    int16_t operator()(int16_t input) const
+    {
+        int index = input + 32768;
+        uint32_t segment = m_segments[index >> 8];
+        int shift = segment & 15;
+        int low = index & 255;
+        const int16_t *sample = m_samples.data() + (segment >> 4) + (low >> shift);
+        int frac = low & ((1 << shift) - 1);
+        return sample[0] + (((sample[1] - sample[0]) * frac + ((1 << shift) >> 1)) >> shift);
+    }
+
+    /**
+     * @brief Look size inputs up, output may be input. The loop has no branch, so the compiler vectorizes it where the
+     * target can gather. Without gathers, on the chips and on the host without AVX2, lanes cost more than they save:
+     * the index and interpolation arithmetic in GCC vectors with the samples loaded one by one ran at half the speed of
+     * this loop on the host.
+     */
+    void forward(const int16_t *input, int16_t *output, int size) const;
+};
+} // namespace base
+} // namespace dl
@@ -31,7 +31,7 @@ inline void max_pool2d_hwc1(feature_t *input_ptr, feature_t *output_ptr, PoolArg
 template <>
 void max_pool2d<int16_t>(void *args_ptr)
 {
-    PoolArgsType<int16_t> &args = *((PoolArgsType<int16_t> *)args_ptr);
+    PoolArgsType<int16_t> args = copy_args<PoolArgsType<int16_t>>(args_ptr);
 
     ImplFunc_t<int16_t, int16_t> i_impl_func;
     ImplFunc_t<int16_t, int16_t> i_impl_func_sp;
@@ -58,7 +58,7 @@ void max_pool2d<int16_t>(void *args_ptr)
 template <>
 void max_pool2d<int8_t>(void *args_ptr)
 {
-    PoolArgsType<int8_t> &args = *((PoolArgsType<int8_t> *)args_ptr);
+    PoolArgsType<int8_t> args = copy_args<PoolArgsType<int8_t>>(args_ptr);
 
     ImplFunc_t<int8_t, int8_t> i_impl_func;
     ImplFunc_t<int8_t, int8_t> i_impl_func_sp;
@@ -47,6 +47,8 @@ void c_impl_mul_n_n(feature_t *output_ptr, feature_t *input0_ptr, feature_t *inp
 
 void elemwise_mul(elemwiseArgsType<int8_t> *args)
 {
+    // The C kernels take the product of all scales, fold it into a copy because the args are reused by later forwards.
+    elemwiseArgsType<int8_t> rescaled_args;
     int ilen = 16 / sizeof(int8_t);
     ImplFunc_t<int8_t, int8_t, int8_t> elemwise_func = c_impl_mul_n_n<int8_t>; // default impl
 
@@ -90,7 +92,9 @@ void elemwise_mul(elemwiseArgsType<int8_t> *args)
             elemwise_func = dl_tie728_s8_mul_w1_16_w2_16_unaligned;
         }
 #else
-        args->output_rescale = args->input0_scale * args->input1_scale * args->output_rescale;
+        rescaled_args = *args;
+        rescaled_args.output_rescale = args->input0_scale * args->input1_scale * args->output_rescale;
+        args = &rescaled_args;
         if (args->input1_d0 == 1) {
             elemwise_func = c_impl_mul_n_1<int8_t>;
         } else if (args->input0_d0 == 1) {
@@ -98,7 +102,9 @@ void elemwise_mul(elemwiseArgsType<int8_t> *args)
         }
 #endif
     } else {
-        args->output_rescale = args->input0_scale * args->input1_scale * args->output_rescale;
+        rescaled_args = *args;
+        rescaled_args.output_rescale = args->input0_scale * args->input1_scale * args->output_rescale;
+        args = &rescaled_args;
         if (args->input1_d0 == 1) {
             elemwise_func = c_impl_mul_n_1<int8_t>;
         } else if (args->input0_d0 == 1) {
@@ -126,6 +132,8 @@ void elemwise_mul(elemwiseArgsType<int8_t> *args)
 
 void elemwise_mul(elemwiseArgsType<int16_t> *args)
 {
+    // The C kernels take the product of all scales, fold it into a copy because the args are reused by later forwards.
+    elemwiseArgsType<int16_t> rescaled_args;
     int ilen = 16 / sizeof(int16_t);
     ImplFunc_t<int16_t, int16_t, int16_t> elemwise_func = c_impl_mul_n_n<int16_t>;
 
@@ -169,7 +177,9 @@ void elemwise_mul(elemwiseArgsType<int16_t> *args)
             elemwise_func = dl_tie728_s16_mul_w1_8_w2_8_unaligned;
         }
 #else
-        args->output_rescale = args->input0_scale * args->input1_scale * args->output_rescale;
+        rescaled_args = *args;
+        rescaled_args.output_rescale = args->input0_scale * args->input1_scale * args->output_rescale;
+        args = &rescaled_args;
         if (args->input1_d0 == 1) {
             elemwise_func = c_impl_mul_n_1<int16_t>;
         } else if (args->input0_d0 == 1) {
@@ -177,7 +187,9 @@ void elemwise_mul(elemwiseArgsType<int16_t> *args)
         }
 #endif
     } else {
-        args->output_rescale = args->input0_scale * args->input1_scale * args->output_rescale;
+        rescaled_args = *args;
+        rescaled_args.output_rescale = args->input0_scale * args->input1_scale * args->output_rescale;
+        args = &rescaled_args;
         if (args->input1_d0 == 1) {
             elemwise_func = c_impl_mul_n_1<int16_t>;
         } else if (args->input0_d0 == 1) {
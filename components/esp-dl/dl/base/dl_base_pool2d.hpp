@@ -125,7 +125,7 @@ std::vector<PoolArgsType<feature_t>> get_pool_args(TensorBase *output,
 #endif
     int c_div_x = input->shape[3] / u;
     if (args.c_remainder != 0 && args.input_x_offset % u == 0 && args.output_x_offset % u == 0 &&
-        !((unsigned)&args.input_element[0] & 15) && !((unsigned)&args.output_element[0] & 15)) {
+        !((uintptr_t)&args.input_element[0] & 15) && !((uintptr_t)&args.output_element[0] & 15)) {
         c_div_x += 1;
     }
     args.c_div_x_1 = c_div_x - 1;
@@ -138,8 +138,25 @@ std::vector<PoolArgsType<feature_t>> get_pool_args(TensorBase *output,
     args.stride_x = stride_x;
     args.stride_y = stride_y;
     // slice
-    std::vector<PoolArgsType<feature_t>> m_args(1, args);
-    if (runtime_mode == RUNTIME_MODE_MULTI_CORE) {
+    int64_t ops = (int64_t)args.output_height * args.output_width * args.output_channel * args.avg_pool_area;
+    int n_tiles = get_tile_num(runtime_mode, ops, args.output_height);
+    if (n_tiles == 1) {
+        return std::vector<PoolArgsType<feature_t>>(1, args);
+    }
+    std::vector<row_tile_t> tiles = get_row_tiles(
+        args.input_height, args.output_height, args.filter_height, args.stride_y, args.padding_h_head, n_tiles);
+    std::vector<PoolArgsType<feature_t>> m_args(tiles.size(), args);
+    for (int i = 0; i < tiles.size(); i++) {
+        m_args[i].input_element += tiles[i].input_y * args.input_y_offset;
+        m_args[i].input_height = tiles[i].input_height;
+        m_args[i].output_element += tiles[i].output_y * args.output_y_offset;
+        m_args[i].output_height = tiles[i].output_height;
+        if (i > 0) {
+            m_args[i].padding_h_head = 0;
+        }
+        if (i < tiles.size() - 1) {
+            m_args[i].padding_h_tail = 0;
+        }
     }
 
     return m_args;
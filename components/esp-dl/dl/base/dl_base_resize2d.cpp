@@ -1,9 +1,64 @@
 #include "dl_base_resize2d.hpp"
 
 #include "dl_base_isa.hpp"
+#include <math.h>
+#include <string.h>
 
 namespace dl {
 namespace base {
+void get_resize_axis_table(std::vector<int32_t> &table,
+                           int input_size,
+                           int output_size,
+                           float scale,
+                           resize_mode_t resize_type,
+                           resize_coordinate_t coordinate,
+                           resize_nearest_t nearest_mode,
+                           int stride,
+                           int weight_bits)
+{
+    table.clear();
+    table.reserve(resize_type == RESIZE_NEAREST ? output_size : output_size * 3);
+    for (int i = 0; i < output_size; i++) {
+        float x;
+        if (coordinate == RESIZE_ALIGN_CORNERS) {
+            x = output_size > 1 ? (float)i * (input_size - 1) / (output_size - 1) : 0.f;
+        } else if (coordinate == RESIZE_ASYMMETRIC) {
+            x = i / scale;
+        } else if (coordinate == RESIZE_PYTORCH_HALF_PIXEL && output_size == 1) {
+            x = 0.f;
+        } else {
+            x = (i + 0.5f) / scale - 0.5f;
+        }
+
+        if (resize_type == RESIZE_NEAREST) {
+            int index;
+            if (nearest_mode == RESIZE_FLOOR) {
+                index = floorf(x);
+            } else if (nearest_mode == RESIZE_CEIL) {
+                index = ceilf(x);
+            } else if (nearest_mode == RESIZE_ROUND_PREFER_CEIL) {
+                index = floorf(x + 0.5f);
+            } else {
+                index = ceilf(x - 0.5f);
+            }
+            index = DL_CLIP(index, 0, input_size - 1);
+            table.push_back(index * stride);
+        } else {
+            x = DL_CLIP(x, 0.f, (float)(input_size - 1));
+            int index = (int)x;
+            int weight = (int)((x - index) * (1 << weight_bits) + 0.5f);
+            if (weight == 1 << weight_bits) {
+                index++;
+                weight = 0;
+            }
+            int next = DL_MIN(index + 1, input_size - 1);
+            table.push_back(index * stride);
+            table.push_back((next - index) * stride);
+            table.push_back(weight);
+        }
+    }
+}
+
 template <typename feature_t>
 inline void resize2d_nearest_2x2_c1(feature_t *output_ptr, feature_t *input_ptr, const resizeArgsType<feature_t> &args)
 {
@@ -13,7 +68,8 @@ inline void resize2d_nearest_2x2_c1(feature_t *output_ptr, feature_t *input_ptr,
     feature_t *output_ptr_1_1 = output_ptr_1_0 + args.output_x_offset;
 
     for (int i = 0; i < args.input_channel; i++) {
-        feature_t output_value = tool::round((float)(*input_ptr++) * args.output_scale / (1 << args.output_shift));
+        feature_t output_value;
+        tool::truncate(output_value, tool::round((float)(*input_ptr++) * args.output_scale / (1 << args.output_shift)));
         *(output_ptr_0_0++) = output_value;
         *(output_ptr_0_1++) = output_value;
         *(output_ptr_1_0++) = output_value;
@@ -21,6 +77,129 @@ inline void resize2d_nearest_2x2_c1(feature_t *output_ptr, feature_t *input_ptr,
     }
 }
 
+// value >> shift rounded like tool::round(), shift > 0.
+template <typename acc_t>
+inline acc_t resize2d_shift_and_round(acc_t value, int shift)
+{
+#if CONFIG_IDF_TARGET_ESP32P4
+    return (value + (((acc_t)1 << (shift - 1)) - 1) + ((value >> shift) & 1)) >> shift;
+#else
+    return (value + ((acc_t)1 << (shift - 1))) >> shift;
+#endif
+}
+
+// The requantization of the 2x nearest kernel in integers, with the same result.
+inline int32_t resize2d_requantize(int32_t value, int output_scale, int output_shift)
+{
+    value *= output_scale;
+    return output_shift ? resize2d_shift_and_round<int32_t>(value, output_shift) : value;
+}
+
+// Any scale and coordinate mode through the tables, and the fused Add. The args are copied into locals: the stores
+// of int8 may alias them, the compiler would load them again for every element otherwise.
+template <typename feature_t, bool fused>
+void resize2d_nearest_c(const resizeArgsType<feature_t> &args)
+{
+    const int channel = args.input_channel;
+    const int output_width = args.output_width;
+    const int output_scale = args.output_scale;
+    const int output_shift = args.output_shift;
+    const bool requantize = output_scale != 1 || output_shift != 0;
+    const int32_t *table_x = args.table_x;
+    feature_t *output_ptr = args.output_element;
+    const feature_t *addend_ptr = args.addend_element;
+    for (int y = 0; y < args.output_height; y++) {
+        const feature_t *input_row = args.input_element + args.table_y[y];
+        for (int x = 0; x < output_width; x++) {
+            const feature_t *input_ptr = input_row + table_x[x];
+            if (!requantize && !fused) {
+                memcpy(output_ptr, input_ptr, channel * sizeof(feature_t));
+                output_ptr += channel;
+                continue;
+            }
+            for (int c = 0; c < channel; c++) {
+                feature_t value = input_ptr[c];
+                if (requantize) {
+                    tool::truncate(value, resize2d_requantize(value, output_scale, output_shift));
+                }
+                if (fused) {
+                    tool::truncate<int32_t>(output_ptr[c], value + addend_ptr[c]);
+                } else {
+                    output_ptr[c] = value;
+                }
+            }
+            output_ptr += channel;
+            if (fused) {
+                addend_ptr += channel;
+            }
+        }
+    }
+}
+
+/**
+ * Bilinear with the fixed-point weights of the tables: the two input rows are weighted per column, then the two
+ * results per row, so the sum carries twice the weight bits. int8 sums in int32, int16 in int64.
+ */
+template <typename feature_t, typename acc_t, bool fused>
+void resize2d_linear_c(const resizeArgsType<feature_t> &args)
+{
+    const acc_t one = (acc_t)1 << resize_weight_bits<feature_t>();
+    const int channel = args.input_channel;
+    const int output_width = args.output_width;
+    const int weight_shift = args.weight_shift;
+    const int32_t *table_x = args.table_x;
+    feature_t *output_ptr = args.output_element;
+    const feature_t *addend_ptr = args.addend_element;
+    for (int y = 0; y < args.output_height; y++) {
+        const int32_t *table_y = args.table_y + y * 3;
+        const feature_t *row0 = args.input_element + table_y[0];
+        const feature_t *row1 = row0 + table_y[1];
+        const acc_t weight_y1 = table_y[2];
+        const acc_t weight_y0 = one - weight_y1;
+        for (int x = 0; x < output_width; x++) {
+            const int32_t *column = table_x + x * 3;
+            const feature_t *input00 = row0 + column[0];
+            const feature_t *input01 = input00 + column[1];
+            const feature_t *input10 = row1 + column[0];
+            const feature_t *input11 = input10 + column[1];
+            const acc_t weight_x1 = column[2];
+            const acc_t weight_x0 = one - weight_x1;
+            for (int c = 0; c < channel; c++) {
+                acc_t top = input00[c] * weight_x0 + input01[c] * weight_x1;
+                acc_t bottom = input10[c] * weight_x0 + input11[c] * weight_x1;
+                feature_t value;
+                acc_t sum = top * weight_y0 + bottom * weight_y1;
+                tool::truncate(value, resize2d_shift_and_round<acc_t>(sum, weight_shift));
+                if (fused) {
+                    tool::truncate<int32_t>(output_ptr[c], value + addend_ptr[c]);
+                } else {
+                    output_ptr[c] = value;
+                }
+            }
+            output_ptr += channel;
+            if (fused) {
+                addend_ptr += channel;
+            }
+        }
+    }
+}
+
+template <typename feature_t, typename acc_t>
+void resize2d_c(const resizeArgsType<feature_t> &args)
+{
+    if (args.resize_type == RESIZE_NEAREST) {
+        if (args.addend_element) {
+            resize2d_nearest_c<feature_t, true>(args);
+        } else {
+            resize2d_nearest_c<feature_t, false>(args);
+        }
+    } else if (args.addend_element) {
+        resize2d_linear_c<feature_t, acc_t, true>(args);
+    } else {
+        resize2d_linear_c<feature_t, acc_t, false>(args);
+    }
+}
+
 inline void load_resized2d_nearest_2x2_c1_s8(ImplFunc_t<int8_t, int8_t> &i_impl_func,
                                              resize_c_impl_func_s8_t &c_impl_func,
                                              const resizeArgsType<int8_t> &args)
@@ -48,28 +227,25 @@ template <>
 void resize2d<int8_t>(void *args_ptr)
 {
     const resizeArgsType<int8_t> &args = *((resizeArgsType<int8_t> *)args_ptr);
-    if (args.resize_type == RESIZE_NEAREST) {
-        if (args.scale_y == 2 && args.scale_x == 2) {
-            ImplFunc_t<int8_t, int8_t> i_impl_func;
-            resize_c_impl_func_s8_t c_impl_func = NULL;
-            load_resized2d_nearest_2x2_c1_s8(i_impl_func, c_impl_func, args);
-            resize2d_operation_shell<int8_t>(args, i_impl_func, c_impl_func);
-        }
+    if (!args.table_y) {
+        ImplFunc_t<int8_t, int8_t> i_impl_func = NULL;
+        resize_c_impl_func_s8_t c_impl_func = NULL;
+        load_resized2d_nearest_2x2_c1_s8(i_impl_func, c_impl_func, args);
+        resize2d_operation_shell<int8_t>(args, i_impl_func, c_impl_func);
+    } else {
+        resize2d_c<int8_t, int32_t>(args);
     }
 }
 
 template <>
 void resize2d<int16_t>(void *args_ptr)
 {
-    // const resizeArgsType<int16_t> &args = *((resizeArgsType<int16_t> *)args_ptr);
-    // if (args.resize_type == RESIZE_NEAREST){
-    //     if (args.scale_y == 2 && args.scale_x == 2){
-    //         ImplFunc_t<int16_t, int16_t> i_impl_func;
-    //         resize_c_impl_func_s16_t c_impl_func = NULL;
-    //         load_resized2d_nearest_2x2_c1_s16(i_impl_func, c_impl_func, args);
-    //         resize2d_operation_shell<int16_t>(args, i_impl_func, c_impl_func);
-    //     }
-    // }
+    const resizeArgsType<int16_t> &args = *((resizeArgsType<int16_t> *)args_ptr);
+    if (!args.table_y) {
+        resize2d_operation_shell<int16_t>(args, NULL, resize2d_nearest_2x2_c1<int16_t>);
+    } else {
+        resize2d_c<int16_t, int64_t>(args);
+    }
 }
 
 } // namespace base
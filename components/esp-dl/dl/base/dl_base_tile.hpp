@@ -0,0 +1,90 @@
+#pragma once
+
+#include "dl_define.hpp"
+#include "sdkconfig.h"
+#include <stdint.h>
+#include <vector>
+
+// Minimum work of one tile, in MACs or element operations. Below it the wakeup of a worker core costs more than the
+// tile saves, so small layers stay on one core.
+#define DL_TILE_MIN_OPS (64 * 1024)
+
+namespace dl {
+namespace base {
+/**
+ * @brief Output and input rows of one row tile of a spatial op.
+ */
+typedef struct {
+    int output_y;      /*<! first output row of the tile */
+    int output_height; /*<! output rows of the tile */
+    int input_y;       /*<! first input row the tile reads */
+    int input_height;  /*<! input rows the tile reads, including the halo shared with its neighbours */
+} row_tile_t;
+
+/**
+ * @brief Cost model of the spatial split. Decide how many tiles a layer is split into.
+ *
+ * @param runtime_mode  Single-core never splits, multi-core always splits, auto splits when every tile keeps at
+ *                      least DL_TILE_MIN_OPS of work.
+ * @param ops           Work of the whole layer, in MACs or element operations.
+ * @param max_tiles     Upper bound given by the op, e.g. the number of output rows.
+ * @return Number of tiles, at least 1.
+ */
+inline int get_tile_num(runtime_mode_t runtime_mode, int64_t ops, int max_tiles)
+{
+    int n = 1;
+    if (runtime_mode == RUNTIME_MODE_MULTI_CORE) {
+        n = CONFIG_FREERTOS_NUMBER_OF_CORES;
+    } else if (runtime_mode == RUNTIME_MODE_AUTO) {
+        n = (int)DL_MIN(ops / DL_TILE_MIN_OPS, (int64_t)CONFIG_FREERTOS_NUMBER_OF_CORES);
+    }
+    return DL_MAX(DL_MIN(n, max_tiles), 1);
+}
+
+/**
+ * @brief Split the output rows of a conv or pool like op into row tiles.
+ *
+ * Tile boundaries are kept inside the body rows, so the head padding only belongs to the first tile and the tail
+ * padding only to the last one. Every tile reads the input rows its receptive field covers, neighbouring tiles
+ * overlap by filter_extent - stride_y rows.
+ *
+ * @param input_height   Input rows of the whole op
+ * @param output_height  Output rows of the whole op
+ * @param filter_extent  Dilated filter height, dilation_y * (filter_height - 1) + 1
+ * @param stride_y       Stride in y
+ * @param padding_head   Padding rows in front of the input
+ * @param n              Number of tiles wanted
+ * @return Non empty tiles in order, at most n.
+ */
+inline std::vector<row_tile_t> get_row_tiles(
+    int input_height, int output_height, int filter_extent, int stride_y, int padding_head, int n)
+{
+    int n_head = (padding_head + stride_y - 1) / stride_y;
+    int n_body = DL_MAX((input_height + padding_head - filter_extent) / stride_y + 1 - n_head, 0);
+    int body_end = n_head + n_body;
+
+    std::vector<row_tile_t> tiles;
+    tiles.reserve(n);
+    int output_y = 0;
+    for (int i = 0; i < n; i++) {
+        int output_end = (i == n - 1) ? output_height : (int64_t)output_height * (i + 1) / n;
+        output_end = DL_MAX(DL_MIN(output_end, body_end), n_head);
+        if (i == n - 1) {
+            output_end = output_height;
+        }
+        if (output_end <= output_y) {
+            continue;
+        }
+        row_tile_t tile;
+        tile.output_y = output_y;
+        tile.output_height = output_end - output_y;
+        tile.input_y = DL_MAX(output_y * stride_y - padding_head, 0);
+        int input_end = DL_MIN((output_end - 1) * stride_y - padding_head + filter_extent, input_height);
+        tile.input_height = input_end - tile.input_y;
+        tiles.push_back(tile);
+        output_y = output_end;
+    }
+    return tiles;
+}
+} // namespace base
+} // namespace dl
@@ -124,6 +124,26 @@ typedef enum {
 
 typedef enum { RESIZE_NEAREST, RESIZE_LINEAR, RESIZE_CUBIC } resize_mode_t;
 
+/**
+ * @brief Where an output pixel of a resize samples the input, the coordinate_transformation_mode of ONNX Resize
+ */
+typedef enum {
+    RESIZE_HALF_PIXEL,         /*<! (x + 0.5) / scale - 0.5 >*/
+    RESIZE_PYTORCH_HALF_PIXEL, /*<! as RESIZE_HALF_PIXEL, 0 for an output of length 1 >*/
+    RESIZE_ALIGN_CORNERS,      /*<! x * (input_length - 1) / (output_length - 1) >*/
+    RESIZE_ASYMMETRIC,         /*<! x / scale >*/
+} resize_coordinate_t;
+
+/**
+ * @brief Rounding of the coordinate of a nearest resize, the nearest_mode of ONNX Resize
+ */
+typedef enum {
+    RESIZE_ROUND_PREFER_FLOOR,
+    RESIZE_ROUND_PREFER_CEIL,
+    RESIZE_FLOOR,
+    RESIZE_CEIL,
+} resize_nearest_t;
+
 /**
  * @brief The mode of esp-dl runtime, single-core or multi-core
  */
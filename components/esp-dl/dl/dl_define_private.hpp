@@ -37,3 +37,8 @@
 #endif
 
 #define CONFIG_ACCURATE_INFER 1
+
+#ifndef DL_VECTOR_C_IMPL
+#define DL_VECTOR_C_IMPL 1 /*<! - 1: the C implementation of (depthwise) Conv2D runs dl_base_conv2d_vector.hpp >*/
+                           /*<! - 0: the scalar loops, the reference the vector kernels are bit exact with >*/
+#endif
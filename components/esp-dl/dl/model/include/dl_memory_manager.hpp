@@ -7,6 +7,21 @@
 
 namespace dl {
 namespace memory {
+class TensorInfo;
+
+/**
+ * @brief Where the memory manager placed one tensor, kept for the placement report.
+ */
+typedef struct {
+    std::string name;
+    size_t size;           /*<! bytes */
+    int time_begin;        /*<! first module of the lifetime, shared with the inplace leader */
+    int time_end;          /*<! first module after the lifetime, -1 if it is never freed */
+    uint32_t access_count; /*<! number of modules reading or writing the tensor */
+    bool is_internal;
+    bool is_inplaced;      /*<! shares the buffer of another tensor */
+    uint32_t offset;       /*<! offset in the internal ram or PSRAM arena */
+} tensor_placement_t;
 
 /**
  * @brief Memory manager base class, each model has its own memory manager
@@ -23,6 +38,8 @@ public:
     std::map<std::string, int> name2index; // Tensor name to index map
     size_t internal_size;                  // The bytes of internal ram
     size_t psram_size;                     // The bytes of psram
+    size_t zero_copy_bytes;                // The bytes per run concat, view and fused resize modules no longer copy
+    std::vector<tensor_placement_t> placements; // Placement of every tensor, same order as tensors
 
     /**
      * @brief Construct a new MemoryManager object.
@@ -33,7 +50,8 @@ public:
         tensors({}),
         alignment(alignment),
         internal_size(internal_size),
-        psram_size(0)
+        psram_size(0),
+        zero_copy_bytes(0)
     {
     }
 
@@ -67,6 +85,20 @@ public:
      */
     virtual void reset();
 
+    /**
+     * @brief Print where every tensor lives, its size, lifetime and access count.
+     */
+    void print_placement();
+
+    /**
+     * @brief Check whether a pointer is inside the internal ram arena of the tensors.
+     */
+    bool is_internal(const void *ptr)
+    {
+        return this->internal_root && ptr >= this->internal_root &&
+            (const uint8_t *)ptr < (const uint8_t *)this->internal_root + this->internal_size;
+    }
+
     /**
      * @brief Get tensor by index
      *
@@ -83,7 +115,7 @@ public:
      *
      * @return The TensorBase pointer
      */
-    TensorBase *get_tensor(std::string &name);
+    TensorBase *get_tensor(const std::string &name);
 
     /**
      * @brief Get tensor index by name
@@ -92,7 +124,7 @@ public:
      *
      * @return The TensorBase index
      */
-    int get_tensor_index(std::string &name);
+    int get_tensor_index(const std::string &name);
 
     /**
      * @brief Allocate root pointer by dl::tool::calloc_aligned API
@@ -136,6 +168,18 @@ public:
      * @brief Get internal ram root pointer
      */
     void *get_internal_root() { return this->internal_root; }
+
+protected:
+    /**
+     * @brief Count how many modules read or write every tensor, an output is written once and every input read
+     * once per module.
+     */
+    static std::vector<uint32_t> get_access_counts(std::vector<dl::module::Module *> &execution_plan, int tensor_num);
+
+    /**
+     * @brief Keep the planned placement of every tensor for print_placement(), call it before tensor_info is freed.
+     */
+    void record_placement(std::vector<TensorInfo *> &tensor_info, std::vector<dl::module::Module *> &execution_plan);
 };
 
 /**
@@ -156,6 +200,7 @@ private:
     uint32_t internal_offset; // Internal ram offset, used to allocate tensor on both PSRAM and internal ram
     bool is_internal;
     TensorInfo *m_leader_tensor;
+    uint32_t m_leader_offset; // Offset, in bytes, of this tensor inside the buffer of the leader tensor
     TensorInfo
         *m_follower_dirty_tensor; // Only reference the follower tensor which will modify the data of leader tensor.
 
@@ -170,7 +215,15 @@ public:
 
     ~TensorInfo() {}
 
-    void set_inplace_leader_tensor(TensorInfo *tensor);
+    /**
+     * @brief Place this tensor inside the buffer of the leader tensor, it is not allocated by itself anymore. The
+     * lifetime of the leader is extended to cover this tensor.
+     *
+     * @param tensor        The leader tensor, nullptr to break the link
+     * @param leader_offset Offset, in bytes, inside the leader, e.g. the position of a concat input in the output
+     */
+    void set_inplace_leader_tensor(TensorInfo *tensor, uint32_t leader_offset = 0);
+    TensorInfo *get_inplace_leader_tensor() { return m_leader_tensor; }
 
     void set_inplace_follower_tensor(TensorInfo *tensor) { m_follower_dirty_tensor = tensor; }
 
@@ -178,6 +231,12 @@ public:
 
     void update_time(int new_time);
 
+    /**
+     * @brief Start the lifetime at a later module, for a tensor nothing writes before it, e.g. the output of a Resize
+     * fused into the Add reading it.
+     */
+    void set_time_begin(int time_begin) { this->time_begin = time_begin; }
+
     TensorBase *create_tensor(void *internal_root, void *psram_root);
 
     bool is_inplaced() { return this->m_leader_tensor != nullptr; }
@@ -185,7 +244,7 @@ public:
     uint32_t get_offset()
     {
         if (m_leader_tensor) {
-            return m_leader_tensor->get_offset();
+            return m_leader_tensor->get_offset() + m_leader_offset;
         }
         return this->offset;
     }
@@ -201,7 +260,7 @@ public:
     uint32_t get_internal_offset()
     {
         if (m_leader_tensor) {
-            return m_leader_tensor->get_internal_offset();
+            return m_leader_tensor->get_internal_offset() + m_leader_offset;
         }
         return this->internal_offset;
     }
@@ -16,10 +16,35 @@ private:
     std::list<MemoryChunk *> internal_memory_list;
     std::list<MemoryChunk *> internal_free_list;
 
+protected:
     void get_tensor_info_from_fbs(fbs::FbsModel *fbs_model,
                                   std::vector<dl::module::Module *> execution_plan,
                                   std::vector<TensorInfo *> &tensor_info);
 
+    /**
+     * @brief Place the inputs of concat nodes directly at their offsets inside the concat output, so that the
+     * producers write there and the concat has nothing left to copy. Only done when the concat axis is the outermost
+     * non-trivial one, i.e. every input is one contiguous slice of the output.
+     *
+     * @return Bytes per run no longer copied by concat and view nodes.
+     */
+    size_t plan_zero_copy(fbs::FbsModel *fbs_model,
+                          std::vector<dl::module::Module *> &execution_plan,
+                          std::vector<TensorInfo *> &tensor_info);
+
+    /**
+     * @brief Fuse Add(Resize(x), y) into the Add, which then reads x and y and writes the sum without the resize
+     * output in between. Only done when the Add is the only reader of the resize output and y has the shape of the
+     * output. The Add reads x, so x lives until the Add, and the resize output, which nothing writes anymore, only
+     * lives from the Add on and shares the buffer of the Add output.
+     *
+     * @return Bytes per run the resize no longer writes and the Add no longer reads.
+     */
+    size_t plan_resize_add_fusion(fbs::FbsModel *fbs_model,
+                                  std::vector<dl::module::Module *> &execution_plan,
+                                  std::vector<TensorInfo *> &tensor_info);
+
+private:
     int simulate(std::vector<TensorInfo *> &tensor_info, int node_num);
 
     int simulate_with_internal_memory(std::vector<TensorInfo *> &tensor_info, int node_num);
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "dl_memory_manager_greedy.hpp"
+
+namespace dl {
+namespace memory {
+
+/**
+ * @brief Lifetime and placement of one buffer in a linear arena.
+ */
+typedef struct {
+    size_t size;           /*<! aligned size, in bytes */
+    int time_begin;        /*<! first step the buffer is alive */
+    int time_end;          /*<! first step the buffer is dead again, INT_MAX if it is never freed */
+    uint32_t offset;       /*<! offset inside the arena, valid after planning */
+    uint32_t access_count; /*<! reads and writes of all tensors sharing the buffer */
+    bool is_placed;
+    TensorInfo *tensor;
+} memory_block_t;
+
+/**
+ * @brief Offset planner. Every tensor gets a fixed offset inside one linear arena instead of a chunk of a simulated
+ * heap.
+ *
+ * MemoryManagerGreedy allocates in the order of the execution plan, so a small early tensor may take the hole a large
+ * later tensor needed. This planner knows all lifetimes up front and places tensors from the largest to the smallest,
+ * each one at the smallest gap between the tensors already placed whose lifetime overlaps it, see
+ * https://arxiv.org/abs/2001.03288. Graphs with few tensors are additionally searched by branch and bound over the
+ * placement order, which finds the minimal arena.
+ *
+ * With internal ram, the tensors accessed most often per step of their lifetime are packed into internal ram first, so
+ * short-lived tensors between hot layers win over large tensors that mostly wait, e.g. the graph input. Whatever does
+ * not fit goes to PSRAM. Both arenas are only as large as the plan needs, which makes the planner the right choice for
+ * DL_INTERNAL_SIZE_AUTO.
+ */
+class MemoryManagerLinear : public MemoryManagerGreedy {
+private:
+    int exhaustive_max;  // Graphs with at most this number of buffers are searched exhaustively
+    int search_limit;    // Maximum number of search nodes of one exhaustive search
+
+    /**
+     * @brief Place blocks by decreasing size, each one at the best fitting gap.
+     *
+     * @param blocks    Blocks to place
+     * @param capacity  Size of the arena, blocks that do not fit are left unplaced. 0 means unlimited.
+     * @return Size of the arena, in bytes
+     */
+    size_t plan_by_size(std::vector<memory_block_t *> &blocks, size_t capacity = 0);
+
+    /**
+     * @brief Pick the blocks for internal ram. Blocks are placed by decreasing access count per step of lifetime,
+     * each one at the best fitting gap, blocks that do not fit into capacity are left unplaced.
+     *
+     * @param blocks    Blocks to place
+     * @param capacity  Size of the internal ram budget
+     * @param node_num  Number of modules, caps the lifetime of buffers that are never freed
+     * @return Size of the arena, in bytes
+     */
+    size_t plan_internal(std::vector<memory_block_t *> &blocks, size_t capacity, int node_num);
+
+    /**
+     * @brief Search the placement order by branch and bound, every block is placed at the lowest offset it fits.
+     * Keeps the offsets of blocks if a smaller arena than upper_bound is found.
+     *
+     * @param blocks       Blocks to place, already placed by plan_by_size
+     * @param upper_bound  Size of the arena found by plan_by_size
+     * @return Size of the arena, in bytes
+     */
+    size_t plan_exhaustive(std::vector<memory_block_t *> &blocks, size_t upper_bound);
+
+    /**
+     * @brief Plan one arena, exhaustive if it is small enough.
+     */
+    size_t plan(std::vector<memory_block_t *> &blocks);
+
+public:
+    /**
+     * @brief Construct a new MemoryManagerLinear object.
+     *
+     * @param max_internal_size  Bytes of internal ram the tensors may use
+     * @param alignment          Alignment of every tensor, in bytes
+     * @param exhaustive_max     Arenas with at most this number of tensors are searched exhaustively, 0 disables it
+     * @param search_limit       Maximum number of search nodes of one exhaustive search
+     */
+    MemoryManagerLinear(int max_internal_size, int alignment = 16, int exhaustive_max = 12, int search_limit = 200000) :
+        MemoryManagerGreedy(max_internal_size, alignment), exhaustive_max(exhaustive_max), search_limit(search_limit)
+    {
+    }
+
+    ~MemoryManagerLinear() {}
+
+    /**
+     * @brief Allocate memory for each tensor, include all input and output tensors
+     *
+     * @param fbs_model       FlatBuffer's Model
+     * @param execution_plan  Topological sorted module list
+     *
+     * @return The output TensorBase vector
+     */
+    std::vector<TensorBase *> alloc(fbs::FbsModel *fbs_model, std::vector<dl::module::Module *> &execution_plan);
+};
+
+/**
+ * @brief Lower bound of the arena of a set of blocks, the largest sum of sizes alive at the same step.
+ */
+size_t get_memory_lower_bound(std::vector<memory_block_t *> &blocks);
+
+} // namespace memory
+} // namespace dl
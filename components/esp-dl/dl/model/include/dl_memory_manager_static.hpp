@@ -0,0 +1,45 @@
+#pragma once
+
+#include "dl_memory_manager.hpp"
+#include "dl_model_compiled.hpp"
+
+namespace dl {
+namespace memory {
+
+/**
+ * @brief Memory manager of a compiled model. The offsets of all tensors were planned at compile time, this one only
+ * allocates the two arenas and creates the tensors.
+ */
+class MemoryManagerStatic : public MemoryManagerBase {
+private:
+    const compiled_model_t *compiled_model;
+
+public:
+    /**
+     * @brief Construct a new MemoryManagerStatic object.
+     *
+     * @param compiled_model  The compiled model
+     * @param alignment       Alignment of the arenas, in bytes
+     */
+    MemoryManagerStatic(const compiled_model_t *compiled_model, int alignment = 16) :
+        MemoryManagerBase(compiled_model->internal_size, alignment), compiled_model(compiled_model)
+    {
+    }
+
+    ~MemoryManagerStatic() {}
+
+    /**
+     * @brief Allocate the arenas and create every tensor of the compiled model.
+     *
+     * If the internal ram arena can not be allocated, it is appended to the PSRAM arena instead.
+     *
+     * @param fbs_model       Unused, may be nullptr
+     * @param execution_plan  Modules created by the compiled model
+     *
+     * @return The output TensorBase vector
+     */
+    std::vector<TensorBase *> alloc(fbs::FbsModel *fbs_model, std::vector<dl::module::Module *> &execution_plan);
+};
+
+} // namespace memory
+} // namespace dl
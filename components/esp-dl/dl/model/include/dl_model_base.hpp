@@ -1,6 +1,10 @@
 #pragma once
 
 #include "dl_memory_manager.hpp"
+#include "dl_model_compiled.hpp"
+#include "dl_model_prefetcher.hpp"
+#include "dl_model_profiler.hpp"
+#include "dl_model_scheduler.hpp"
 #include "dl_module_base.hpp"
 #include "esp_log.h"
 #include "fbs_loader.hpp"
@@ -36,9 +40,33 @@
 
 namespace dl {
 
-// currently only support MEMORY_MANAGER_GREEDY
+// MEMORY_MANAGER_GREEDY: allocate in execution order, LINEAR_MEMORY_MANAGER: offset planning by size, see
+// dl_memory_manager_linear.hpp
 typedef enum { MEMORY_MANAGER_GREEDY = 0, LINEAR_MEMORY_MANAGER = 1 } memory_manager_t;
 
+// Pass as internal_size to let the model work out its internal ram budget from the largest free internal block.
+#define DL_INTERNAL_SIZE_AUTO (-1)
+// Internal ram left to the application in DL_INTERNAL_SIZE_AUTO mode, e.g. for task stacks and DMA buffers.
+#define DL_INTERNAL_SIZE_AUTO_RESERVE (48 * 1024)
+
+/**
+ * @brief A tensor of the model, resolved once by Model::resolve() instead of looking up its name on every inference.
+ *
+ * It holds the index of the tensor rather than the pointer, so it stays valid when the same model is built again,
+ * e.g. with another memory manager or internal ram budget.
+ */
+class TensorHandle {
+public:
+    int index; /*<! Index of the tensor in the memory manager, -1 if the name was not found */
+
+    TensorHandle(int index = -1) : index(index) {}
+
+    /**
+     * @brief Whether the name was found when the handle was resolved.
+     */
+    bool is_valid() const { return index >= 0; }
+};
+
 /**
  * @brief Neural Network Model.
  */
@@ -54,10 +82,46 @@ private:
     std::string name;                                        /*  The name of model */
     int64_t version;                                         /*  The version of model */
     std::string doc_string;                                  /*  doc string of model*/
+    // A worker of the graph scheduler runs whole modules instead of kernel tiles, so it needs more stack.
+    dl::module::ModuleWorkerPool worker_pool{4096}; /*<! Persistent workers for multi-core runs, started on first use >*/
+    bool graph_parallel = false;                    /*<! Run independent modules on all cores in multi-core modes >*/
+    ModelScheduler *scheduler = nullptr;            /*<! Dependency DAG of the execution plan, built on demand >*/
+    WeightPrefetcher *prefetcher = nullptr;         /*<! Copies the parameters of the next layer, see build() >*/
+    Profiler *profiler = nullptr;                   /*<! Records every module of every run, see set_profiler() >*/
+    std::vector<bool> param_pending;                /*<! Layers copied on first use, see set_lazy_param_copy() >*/
+    int param_pending_num = 0;                      /*<! Number of true entries of param_pending >*/
+    bool first_run = true;                          /*<! Nothing ran yet, the first run logs the time since boot >*/
+
+    /**
+     * @brief Forward every module of the execution plan, through the scheduler if graph parallelism is enabled.
+     */
+    void run_execution_plan(runtime_mode_t mode);
+
+    /**
+     * @brief Copy the parameters of a module pending in lazy mode before its first forward, see set_lazy_param_copy().
+     */
+    void materialize_params(int module_index);
+
+    /**
+     * @brief Copy the parameters of every module pending in lazy mode.
+     */
+    void materialize_all_params();
+
+    /**
+     * @brief Log how many bytes of parameters were copied and how many are read in place from the model data.
+     */
+    void log_param_placement();
+
+    /**
+     * @brief Log the latency of the first run and the time since boot when it finished.
+     */
+    void log_first_run(int64_t start_us);
 
 public:
     Model() {}
 
+    // CONFIG_DL_COMPILED_MODEL_ONLY leaves out the .espdl loader: these constructors, load() and build().
+#if !CONFIG_DL_COMPILED_MODEL_ONLY
     /**
      * @brief Create the Model object by rodata address or partition label.
      *
@@ -66,7 +130,7 @@ public:
      *                                     The label of partition while location is MODEL_LOCATION_IN_FLASH_PARTITION.
      *                                     The path of model while location is MODEL_LOCATION_IN_SDCARD.
      * @param location      The model location.
-     * @param internal_size  Internal ram size, in bytes
+     * @param internal_size  Internal ram size, in bytes, or DL_INTERNAL_SIZE_AUTO
      * @param mm_type        Type of memory manager
      * @param key           The key of encrypted model.
      * @param param_copy    Set to false to avoid copy model parameters from flash to psram.
@@ -91,7 +155,7 @@ public:
      *                                     The path of model while location is MODEL_LOCATION_IN_SDCARD.
      * @param model_index   The model index of packed models.
      * @param location      The model location.
-     * @param internal_size  Internal ram size, in bytes
+     * @param internal_size  Internal ram size, in bytes, or DL_INTERNAL_SIZE_AUTO
      * @param mm_type        Type of memory manager
      * @param key           The key of encrypted model.
      * @param param_copy    Set to false to avoid copy model parameters from flash to psram.
@@ -117,7 +181,7 @@ public:
      *                                     The path of model while location is MODEL_LOCATION_IN_SDCARD.
      * @param model_name   The model name of packed models.
      * @param location      The model location.
-     * @param internal_size  Internal ram size, in bytes
+     * @param internal_size  Internal ram size, in bytes, or DL_INTERNAL_SIZE_AUTO
      * @param mm_type        Type of memory manager
      * @param key           The key of encrypted model.
      * @param param_copy    Set to false to avoid copy model parameters from flash to psram.
@@ -138,16 +202,27 @@ public:
      * @brief Create the Model object by fbs_model.
      *
      * @param fbs_model      The fbs model.
-     * @param internal_size  Internal ram size, in bytes
+     * @param internal_size  Internal ram size, in bytes, or DL_INTERNAL_SIZE_AUTO
      * @param mm_type        Type of memory manager
      */
     Model(fbs::FbsModel *fbs_model, int internal_size = 0, memory_manager_t mm_type = MEMORY_MANAGER_GREEDY);
+#endif
+
+    /**
+     * @brief Create the Model object from a model compiled by tools/espdl_compiler.py, see load().
+     *
+     * @param compiled_model  The compiled model.
+     * @param rodata_address  The address of the .espdl file or of the pack of models it was compiled from.
+     * @param param_copy      Set to false to avoid copy model parameters from flash to psram.
+     */
+    Model(const compiled_model_t *compiled_model, const char *rodata_address, bool param_copy = true);
 
     /**
      * @brief Destroy the Model object.
      */
     virtual ~Model();
 
+#if !CONFIG_DL_COMPILED_MODEL_ONLY
     /**
      * @brief Load model graph and parameters from flash or sdcard.
      *
@@ -218,15 +293,30 @@ public:
      * @param fbs_model          The FlatBuffers model
      */
     virtual esp_err_t load(fbs::FbsModel *fbs_model);
+#endif
 
+    /**
+     * @brief Load a model compiled by tools/espdl_compiler.py. Nothing is parsed: the modules are created by the
+     * generated code and the tensors at the offsets planned at compile time, build() must not be called afterwards.
+     *
+     * @param compiled_model  The compiled model.
+     * @param rodata_address  The address of the .espdl file or of the pack of models it was compiled from, the
+     *                        parameters are read at fixed offsets of it. Encrypted models are not supported.
+     * @param param_copy      Set to false to avoid copy model parameters from flash to psram.
+     */
+    virtual esp_err_t load(const compiled_model_t *compiled_model, const char *rodata_address, bool param_copy = true);
+
+#if !CONFIG_DL_COMPILED_MODEL_ONLY
     /**
      * @brief Allocate memory for the model.
      *
-     * @param internal_size  Internal ram size, in bytes
+     * @param internal_size  Internal ram size, in bytes, or DL_INTERNAL_SIZE_AUTO
      * @param mm_type        Type of memory manager
-     * @param preload        Whether to preload the model's parameters to internal ram (not implemented yet)
+     * @param preload        Whether to prefetch the parameters of the next layer into internal ram while the current
+     *                       one runs, see set_weight_prefetch()
      */
     virtual void build(size_t internal_size, memory_manager_t mm_type = MEMORY_MANAGER_GREEDY, bool preload = false);
+#endif
 
     /**
      * @brief Run the model module by module.
@@ -256,6 +346,79 @@ public:
                      runtime_mode_t mode = RUNTIME_MODE_SINGLE_CORE,
                      std::map<std::string, TensorBase *> user_outputs = {});
 
+    /**
+     * @brief Schedule the graph instead of the layers on all cores.
+     *
+     * When enabled, run() with RUNTIME_MODE_AUTO or RUNTIME_MODE_MULTI_CORE forwards independent modules, e.g. the
+     * branches of a detection head, on different cores at the same time, while every single module runs on one core.
+     * RUNTIME_MODE_SINGLE_CORE still runs the execution plan in order. Whether this beats splitting every layer depends
+     * on the model, print_graph_parallelism() shows how much inter-op parallelism it exposes.
+     *
+     * @param enable  true to schedule the graph, false to go back to layer-wise multi-core.
+     */
+    virtual void set_graph_parallel(bool enable);
+
+    /**
+     * @brief Prefetch the filter and bias of the next layer from PSRAM into internal ram while the current layer runs.
+     *
+     * Two slots of internal ram are reserved beside the activations. The next run measures the latency of every layer
+     * with its parameters in PSRAM, the runs after it prefetch, print_weight_prefetch() reports the difference.
+     * Graph parallel runs do not prefetch, their order of the layers is not fixed.
+     *
+     * @param enable       true to prefetch, false to read the parameters in place again.
+     * @param buffer_size  Bytes of internal ram for both slots, or DL_WEIGHT_PREFETCH_SIZE_AUTO
+     */
+    virtual void set_weight_prefetch(bool enable, size_t buffer_size = DL_WEIGHT_PREFETCH_SIZE_AUTO);
+
+    /**
+     * @brief Print the latency every prefetched layer saved, see set_weight_prefetch().
+     */
+    virtual void print_weight_prefetch();
+
+    /**
+     * @brief Copy the filter and bias of a layer from flash into PSRAM on its first forward instead of when loading.
+     *
+     * The model must be loaded with param_copy = false from MODEL_LOCATION_IN_FLASH_RODATA or
+     * MODEL_LOCATION_IN_FLASH_PARTITION, so its parameters point into the mapped model. Loading and building then
+     * copy nothing, the first inference pays for the copies of the layers it runs and later ones read the parameters
+     * from PSRAM like param_copy = true. Parameters already in PSRAM, e.g. with CONFIG_SPIRAM_RODATA or from the
+     * sdcard, are never copied. Graph parallel and prefetching runs copy all pending layers before their first run.
+     *
+     * @param enable  true to copy on first use, false to keep reading the layers not run yet in place.
+     */
+    virtual void set_lazy_param_copy(bool enable);
+
+    /**
+     * @brief Record the latency, core, MACs, bytes and memory placement of every module of every run.
+     *
+     * It can be switched on and off between runs. Detectors also record their preprocess, model and postprocess
+     * phases into the profiler of their model. Profiler::print() shows the averages, Profiler::export_chrome_trace()
+     * writes the runs as a timeline.
+     *
+     * @param enable    true to record, false to stop and free the events.
+     * @param capacity  Number of events kept until Profiler::clear()
+     */
+    virtual void set_profiler(bool enable, int capacity = DL_PROFILER_DEFAULT_CAPACITY);
+
+    /**
+     * @brief Get the profiler enabled by set_profiler().
+     *
+     * @return dl::Profiler*, nullptr if profiling is off
+     */
+    virtual Profiler *get_profiler() { return profiler; }
+
+    /**
+     * @brief Print the inter-op parallelism of the model. After a graph parallel run, the measured latency of every
+     * module is used to print the bound of the speedup and the parallelism the last run achieved.
+     */
+    virtual void print_graph_parallelism();
+
+    /**
+     * @brief Print where the memory manager placed every activation, its lifetime and access count, then for every
+     * module how many of the activation bytes it touches are in internal ram and how many in PSRAM.
+     */
+    virtual void print_memory_placement();
+
     /**
      * @brief Get inputs of model
      *
@@ -272,6 +435,23 @@ public:
      */
     virtual TensorBase *get_intermediate(std::string name);
 
+    /**
+     * @brief Resolve the name of a tensor once, e.g. in the constructor of a postprocessor, to get the tensor on every
+     * inference without a string lookup.
+     *
+     * @param name  The name of the tensor
+     *
+     * @return The handle of the tensor, invalid if the model has no tensor with this name.
+     */
+    virtual TensorHandle resolve(const std::string &name);
+
+    /**
+     * @brief Get the tensor of a handle returned by resolve().
+     *
+     * @return The TensorBase*, nullptr if the handle is invalid. The same note as get_intermediate() applies.
+     */
+    TensorBase *get_tensor(TensorHandle handle) { return this->memory_manager->get_tensor(handle.index); }
+
     /**
      * @brief Get outputs of model
      *
@@ -290,6 +470,20 @@ public:
      * @return fbs::FbsModel *
      */
     virtual fbs::FbsModel *get_fbs_model() { return fbs_model; }
+
+    /**
+     * @brief Get the worker pool used by dual-core modules, e.g. to print its launch statistics.
+     *
+     * @return dl::module::ModuleWorkerPool*
+     */
+    virtual dl::module::ModuleWorkerPool *get_worker_pool() { return &worker_pool; }
+
+    /**
+     * @brief Get the memory manager, e.g. to read how many bytes its plan saved by zero copy and fusion.
+     *
+     * @return dl::memory::MemoryManagerBase*
+     */
+    virtual dl::memory::MemoryManagerBase *get_memory_manager() { return memory_manager; }
 };
 
 } // namespace dl
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "dl_module_base.hpp"
+#include "dl_tensor_base.hpp"
+#include "esp_heap_caps.h"
+#include <initializer_list>
+#include <vector>
+
+namespace dl {
+/**
+ * @brief One activation of a compiled model, placed at compile time.
+ */
+typedef struct {
+    const char *name;
+    dtype_t dtype;
+    int exponent;
+    int rank;
+    const int *shape;
+    bool is_internal; /*<! in the internal ram arena instead of the PSRAM arena */
+    uint32_t offset;  /*<! offset inside its arena, tensors sharing a buffer share the offset */
+} compiled_tensor_t;
+
+/**
+ * @brief A model compiled ahead of time by tools/espdl_compiler.py.
+ *
+ * The compiler resolves what dl::Model::load and the memory managers work out at boot: the execution order, the
+ * attributes of every module, the shape and offset of every activation and the offset of every parameter inside the
+ * .espdl file. What is left at run time is allocating the arenas and constructing the modules.
+ */
+typedef struct {
+    const char *name;               /*<! name of the graph */
+    const char *file_name;          /*<! name of the .espdl file, to find the model in a pack of models */
+    int64_t version;                /*<! version of the model */
+    uint32_t fbs_size;              /*<! size of the FlatBuffers data, checked against the .espdl file at load */
+    const compiled_tensor_t *tensors;
+    int tensor_num;
+    const int *inputs; /*<! indexes of the graph inputs in tensors */
+    int input_num;
+    const int *outputs; /*<! indexes of the graph outputs in tensors */
+    int output_num;
+    size_t psram_size;    /*<! bytes of the PSRAM arena */
+    size_t internal_size; /*<! bytes of the internal ram arena */
+    int module_num;
+    /**
+     * Append the modules in execution order, with their tensor indexes already set.
+     * model_data is the start of the .espdl model, the EDL2 header included.
+     */
+    void (*create_modules)(const uint8_t *model_data, bool param_copy, std::vector<module::Module *> &execution_plan);
+} compiled_model_t;
+
+namespace compiled {
+/**
+ * @brief Create the parameter stored at offset of the .espdl model.
+ */
+inline TensorBase *get_parameter(const uint8_t *model_data,
+                                 bool param_copy,
+                                 uint32_t offset,
+                                 std::vector<int> shape,
+                                 int exponent,
+                                 dtype_t dtype)
+{
+    return new TensorBase(shape, model_data + offset, exponent, dtype, param_copy, MALLOC_CAP_SPIRAM);
+}
+
+/**
+ * @brief Set the tensor indexes of a module and append it to the execution plan.
+ */
+inline void push_module(std::vector<module::Module *> &execution_plan,
+                        module::Module *module,
+                        std::initializer_list<int> inputs_index,
+                        std::initializer_list<int> outputs_index)
+{
+    module->m_inputs_index = inputs_index;
+    module->m_outputs_index = outputs_index;
+    execution_plan.push_back(module);
+}
+} // namespace compiled
+} // namespace dl
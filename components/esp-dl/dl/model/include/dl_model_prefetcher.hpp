@@ -0,0 +1,104 @@
+#pragma once
+
+#include "dl_model_profiler.hpp"
+#include "dl_module_base.hpp"
+#include "dl_tensor_base.hpp"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "soc/soc_caps.h"
+#include <vector>
+
+#if SOC_ASYNC_MEMCPY_SUPPORTED
+#include "esp_async_memcpy.h"
+#endif
+
+// Pass as buffer size to size both slots after the largest layer whose parameters are prefetched.
+#define DL_WEIGHT_PREFETCH_SIZE_AUTO (0)
+
+namespace dl {
+/**
+ * @brief Copy the parameters of the next layer from PSRAM into internal ram while the current layer runs.
+ *
+ * Two slots of internal ram are reserved and the layers with parameters take turns in them, so layer N+1 is copied
+ * into one slot by the DMA while layer N reads its parameters from the other one. Every layer keeps the same slot
+ * from run to run, the cache pointer of its filter and bias is set once and the cached kernel args stay valid.
+ *
+ * The first run after construction is a calibration run: the parameters are read from PSRAM and the latency of every
+ * layer is recorded, later runs prefetch and print() compares both.
+ *
+ * Parameters that are not in PSRAM, e.g. still in flash with param_copy = false, can not be read by the DMA and
+ * stay where they are, as do layers larger than one slot.
+ */
+class WeightPrefetcher {
+public:
+    /**
+     * @brief Construct a new WeightPrefetcher object.
+     *
+     * @param execution_plan  Modules in execution order, their tensors must already be allocated.
+     * @param buffer_size     Bytes of internal ram for both slots, or DL_WEIGHT_PREFETCH_SIZE_AUTO
+     */
+    WeightPrefetcher(std::vector<dl::module::Module *> &execution_plan, size_t buffer_size);
+
+    /**
+     * @brief Destroy the WeightPrefetcher object. The modules read their parameters from PSRAM again.
+     */
+    ~WeightPrefetcher();
+
+    /**
+     * @brief Whether any layer is prefetched.
+     */
+    bool is_enabled() const { return !m_layers.empty(); }
+
+    /**
+     * @brief Run all modules once in the order of the execution plan.
+     *
+     * @param tensors  Tensors of the memory manager.
+     * @param mode     Runtime mode of every module.
+     * @param profiler Records every module if not nullptr.
+     */
+    void run(std::vector<TensorBase *> &tensors, runtime_mode_t mode, Profiler *profiler = nullptr);
+
+    /**
+     * @brief Print the latency of every prefetched layer with its parameters in PSRAM and prefetched, and how much
+     * of the copy was not hidden behind the previous layer.
+     */
+    void print();
+
+private:
+    typedef struct {
+        int module_index;                  /*<! index into the execution plan >*/
+        int slot;                          /*<! 0 or 1 >*/
+        size_t size;                       /*<! aligned bytes of all parameters >*/
+        std::vector<TensorBase *> params;  /*<! filter, then bias >*/
+        int transfer_num;                  /*<! DMA transfers of the last copy, each one signals m_done once >*/
+        uint32_t baseline_us;              /*<! latency of the calibration run >*/
+        uint32_t module_us;                /*<! latency of the last run >*/
+        uint32_t wait_us;                  /*<! time the last run waited for the copy >*/
+    } prefetch_layer_t;
+
+    std::vector<dl::module::Module *> &m_plan;
+    std::vector<prefetch_layer_t> m_layers;
+    std::vector<int> m_layer_index; /*<! layer of every module of the plan, -1 if it is not prefetched >*/
+    void *m_slots[2];
+    size_t m_slot_size;
+    int m_skipped_num;   /*<! layers with parameters that are not prefetched >*/
+    bool m_calibrated;
+    int64_t m_baseline_run_us;
+    int64_t m_run_us;
+#if SOC_ASYNC_MEMCPY_SUPPORTED
+    async_memcpy_handle_t m_mcp;
+#endif
+    SemaphoreHandle_t m_done;
+    StaticSemaphore_t m_done_buffer;
+
+    /**
+     * @brief Start copying the parameters of layer k into its slot. Copies the CPU way if the DMA refuses them.
+     */
+    void issue(int k);
+
+    /**
+     * @brief Wait until the parameters of layer k are in its slot.
+     */
+    void wait(int k);
+};
+} // namespace dl
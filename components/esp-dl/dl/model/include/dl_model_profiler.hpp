@@ -0,0 +1,169 @@
+#pragma once
+
+#include "dl_module_base.hpp"
+#include "dl_tensor_base.hpp"
+#include "esp_err.h"
+#include <atomic>
+#include <stdio.h>
+#include <vector>
+
+// Events the profiler keeps before it drops the next ones, one event per module and run plus the phases.
+#define DL_PROFILER_DEFAULT_CAPACITY (2048)
+
+namespace dl {
+namespace memory {
+class MemoryManagerBase;
+}
+
+/**
+ * @brief Where the activations a module touches are.
+ */
+typedef enum {
+    PROFILE_MEMORY_NONE = 0,     /*<! not a module, e.g. a phase of a detector */
+    PROFILE_MEMORY_INTERNAL = 1, /*<! all in internal ram */
+    PROFILE_MEMORY_PSRAM = 2,    /*<! all in PSRAM */
+    PROFILE_MEMORY_MIXED = 3,    /*<! some in each */
+} profile_memory_t;
+
+/**
+ * @brief One recorded span, a module forward or a phase.
+ */
+typedef struct {
+    const char *name;       /*<! name of the module or the phase, nullptr for modules without a name */
+    const char *category;   /*<! "module" for modules, the caller's category for phases */
+    int module_index;       /*<! index in the execution plan, -1 for phases */
+    int core;               /*<! core the span started on */
+    uint32_t start_cycle;   /*<! cycle counter of that core */
+    uint32_t end_cycle;     /*<! cycle counter at the end, only meaningful if the span stayed on its core */
+    int64_t start_us;       /*<! shared timeline of all cores */
+    int64_t end_us;         /*<! shared timeline of all cores */
+    uint64_t macs;          /*<! multiply-accumulates of the module */
+    uint32_t bytes_read;    /*<! input activations and parameters */
+    uint32_t bytes_written; /*<! output activations */
+    profile_memory_t memory;
+} profile_event_t;
+
+/**
+ * @brief Collects the spans of Model::run, switched on and off at run time with Model::set_profiler().
+ *
+ * Spans are stored in an array allocated once, begin() reserves a slot with an atomic counter so graph parallel runs
+ * can record from all cores. Once the array is full further spans are counted as dropped, clear() starts over. The
+ * static cost of every module (MACs, bytes, placement) is computed once in set_modules(), the hot path only reads
+ * the clocks.
+ */
+class Profiler {
+public:
+    /**
+     * @brief Construct a new Profiler object.
+     *
+     * @param capacity  Number of events kept until clear()
+     */
+    Profiler(int capacity = DL_PROFILER_DEFAULT_CAPACITY);
+
+    ~Profiler();
+
+    /**
+     * @brief Compute the MACs, bytes and placement of every module, call it again after the model is built again.
+     */
+    void set_modules(std::vector<dl::module::Module *> &execution_plan,
+                     std::vector<TensorBase *> &tensors,
+                     dl::memory::MemoryManagerBase *memory_manager);
+
+    /**
+     * @brief Start a span.
+     *
+     * @return The event to pass to end(), nullptr if the profiler is full.
+     */
+    profile_event_t *begin(const char *name, const char *category);
+
+    /**
+     * @brief Start the span of a module of the execution plan passed to set_modules().
+     */
+    profile_event_t *begin_module(int module_index);
+
+    /**
+     * @brief End a span, nullptr is ignored.
+     */
+    void end(profile_event_t *event);
+
+    /**
+     * @brief Drop all events.
+     */
+    void clear();
+
+    int get_event_num();
+    int get_dropped_num() { return m_dropped_num.load(std::memory_order_relaxed); }
+    const profile_event_t *get_events() { return m_events; }
+
+    /**
+     * @brief Latency of a span in microseconds, measured in cycles when it stayed on its core.
+     */
+    static float get_duration_us(const profile_event_t &event);
+
+    /**
+     * @brief Print the average latency of every module and phase over the recorded runs, with MACs, bytes and placement.
+     */
+    void print();
+
+    /**
+     * @brief Write the events in the Chrome trace event format, to open with chrome://tracing or Perfetto.
+     *
+     * Every core is one thread of the trace, phases enclose the modules they ran.
+     *
+     * @param file  An opened file, e.g. on an SD card, or stdout
+     *
+     * @return ESP_OK if every event was written
+     */
+    esp_err_t export_chrome_trace(FILE *file);
+
+private:
+    typedef struct {
+        const char *name;
+        uint64_t macs;
+        uint32_t bytes_read;
+        uint32_t bytes_written;
+        profile_memory_t memory;
+    } module_cost_t;
+
+    profile_event_t *m_events;
+    int m_capacity;
+    std::atomic<int> m_event_num;
+    std::atomic<int> m_dropped_num;
+    std::vector<module_cost_t> m_modules;
+};
+
+/**
+ * @brief Consecutive phases of a pipeline, e.g. preprocess, model and postprocess. next() ends the running phase and
+ * starts the next one, the destructor ends the last one. Does nothing without a profiler.
+ */
+class ProfilerPhases {
+public:
+    ProfilerPhases(Profiler *profiler, const char *category) :
+        m_profiler(profiler), m_category(category), m_event(nullptr)
+    {
+    }
+
+    ~ProfilerPhases() { this->end(); }
+
+    void next(const char *name)
+    {
+        if (m_profiler) {
+            m_profiler->end(m_event);
+            m_event = m_profiler->begin(name, m_category);
+        }
+    }
+
+    void end()
+    {
+        if (m_profiler) {
+            m_profiler->end(m_event);
+            m_event = nullptr;
+        }
+    }
+
+private:
+    Profiler *m_profiler;
+    const char *m_category;
+    profile_event_t *m_event;
+};
+} // namespace dl
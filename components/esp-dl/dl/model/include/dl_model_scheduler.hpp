@@ -0,0 +1,107 @@
+#pragma once
+
+#include "dl_model_profiler.hpp"
+#include "dl_module_base.hpp"
+#include "dl_tensor_base.hpp"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <atomic>
+#include <vector>
+
+namespace dl {
+/**
+ * @brief Run independent modules of a model on all cores at the same time.
+ *
+ * The dependency DAG has two kinds of edges:
+ * - data edges, from the module producing a tensor to every module reading it.
+ * - memory edges. The memory manager reuses the buffer of a dead tensor for a later one, which is only safe in the
+ *   sequential order of the execution plan. Whenever the buffers of two tensors overlap, every module touching the
+ *   earlier tensor must finish before the module writing the later one starts.
+ * Edges always point forward in the execution plan, so the graph is acyclic and the execution plan stays one valid
+ * order of it.
+ *
+ * At run time the calling task and one worker per other core pull ready modules from a shared queue. Modules are
+ * forwarded with RUNTIME_MODE_SINGLE_CORE, the parallelism is between modules instead of inside them.
+ */
+class ModelScheduler {
+public:
+    /**
+     * @brief Construct a new ModelScheduler object.
+     *
+     * @param execution_plan  Modules in a valid topological order.
+     * @param tensors         Tensors of the memory manager, data must already be allocated.
+     */
+    ModelScheduler(std::vector<dl::module::Module *> &execution_plan, std::vector<TensorBase *> &tensors);
+
+    /**
+     * @brief Destroy the ModelScheduler object.
+     */
+    ~ModelScheduler();
+
+    /**
+     * @brief Run all modules once.
+     *
+     * @param tensors  Tensors of the memory manager.
+     * @param pool     Workers of the other cores, nullptr runs everything on the calling task.
+     * @param profiler Records every module with the core it ran on if not nullptr.
+     */
+    void run(std::vector<TensorBase *> &tensors, dl::module::ModuleWorkerPool *pool, Profiler *profiler = nullptr);
+
+    /**
+     * @brief Number of dependency edges, data and memory edges counted once.
+     */
+    int get_edge_num() const { return m_edge_num; }
+
+    /**
+     * @brief Number of memory edges that are not also data edges.
+     */
+    int get_memory_edge_num() const { return m_memory_edge_num; }
+
+    /**
+     * @brief Number of modules on the longest dependency chain.
+     */
+    int get_depth() const { return m_depth; }
+
+    /**
+     * @brief Largest number of modules sharing one level, the level of a module is its longest chain from the inputs.
+     */
+    int get_max_width() const { return m_max_width; }
+
+    /**
+     * @brief Print the inter-op parallelism the graph exposes and, after a run, what was achieved.
+     *
+     * Structural parallelism is modules / depth. Once a run has measured the latency of every module, the same is
+     * printed weighted by latency, i.e. the total work over the work on the critical path, which bounds the speedup of
+     * any inter-op schedule.
+     */
+    void print();
+
+private:
+    static void executor(void *arg);
+    void push_ready(int module_index);
+
+    std::vector<dl::module::Module *> &m_plan;
+    std::vector<TensorBase *> *m_tensors;
+    Profiler *m_profiler;
+    std::vector<std::vector<int>> m_successors; /*<! successors of every module, sorted, unique >*/
+    std::vector<int> m_predecessor_num;         /*<! number of predecessors of every module >*/
+    std::vector<int> m_roots;                   /*<! modules without predecessors >*/
+    int m_edge_num;
+    int m_memory_edge_num;
+    int m_depth;
+    int m_max_width;
+
+    std::atomic<int> *m_pending;  /*<! predecessors still running in this run >*/
+    std::atomic<int> *m_ready;    /*<! queue of ready modules, -1 until the slot is written >*/
+    std::atomic<int> m_ready_tail; /*<! next free slot of m_ready >*/
+    std::atomic<int> m_ready_head; /*<! next slot taken by an executor >*/
+    std::atomic<int> m_finished;
+    int m_executor_num;
+    SemaphoreHandle_t m_ready_sem; /*<! one count per ready module, plus one per executor at the end >*/
+    StaticSemaphore_t m_ready_sem_buffer;
+
+    std::vector<uint32_t> m_module_us;  /*<! latency of every module in the last run >*/
+    int64_t m_run_us;                   /*<! wall time of the last run >*/
+    std::atomic<int64_t> m_busy_us;     /*<! sum of module latencies of the last run >*/
+};
+} // namespace dl
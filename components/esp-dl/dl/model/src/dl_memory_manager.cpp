@@ -1,4 +1,7 @@
 #include "dl_memory_manager.hpp"
+#include "esp_log.h"
+
+static const char *TAG = "dl::memory::MemoryManagerBase";
 
 namespace dl {
 namespace memory {
@@ -15,6 +18,75 @@ void MemoryManagerBase::reset()
     }
     this->root_free();
     this->name2index.clear();
+    this->placements.clear();
+}
+
+std::vector<uint32_t> MemoryManagerBase::get_access_counts(std::vector<dl::module::Module *> &execution_plan,
+                                                           int tensor_num)
+{
+    std::vector<uint32_t> access_counts(tensor_num, 0);
+    for (dl::module::Module *module : execution_plan) {
+        for (int index : module->m_inputs_index) {
+            access_counts[index]++;
+        }
+        for (int index : module->m_outputs_index) {
+            access_counts[index]++;
+        }
+    }
+    return access_counts;
+}
+
+void MemoryManagerBase::record_placement(std::vector<TensorInfo *> &tensor_info,
+                                         std::vector<dl::module::Module *> &execution_plan)
+{
+    std::vector<uint32_t> access_counts = get_access_counts(execution_plan, tensor_info.size());
+    this->placements.clear();
+    this->placements.reserve(tensor_info.size());
+    for (int i = 0; i < tensor_info.size(); i++) {
+        TensorInfo *info = tensor_info[i];
+        tensor_placement_t placement;
+        placement.name = info->get_name();
+        placement.size = info->get_size();
+        placement.time_begin = info->get_time_begin();
+        placement.time_end = info->get_time_end();
+        placement.access_count = access_counts[i];
+        placement.is_internal = info->get_internal_state();
+        placement.is_inplaced = info->is_inplaced();
+        placement.offset = placement.is_internal ? info->get_internal_offset() : info->get_offset();
+        this->placements.push_back(placement);
+    }
+}
+
+void MemoryManagerBase::print_placement()
+{
+    uint64_t internal_traffic = 0;
+    uint64_t psram_traffic = 0;
+    for (tensor_placement_t &placement : this->placements) {
+        ESP_LOGI(TAG,
+                 "%-24s %8d bytes, time: [%d, %d), access: %2ld, %s%s, offset: %ld",
+                 placement.name.c_str(),
+                 placement.size,
+                 placement.time_begin,
+                 placement.time_end,
+                 placement.access_count,
+                 placement.is_internal ? "internal" : "psram",
+                 placement.is_inplaced ? " (inplace)" : "",
+                 placement.offset);
+        uint64_t traffic = (uint64_t)placement.size * placement.access_count;
+        if (placement.is_internal) {
+            internal_traffic += traffic;
+        } else {
+            psram_traffic += traffic;
+        }
+    }
+    ESP_LOGI(TAG,
+             "internal arena: %d bytes, psram arena: %d bytes, tensor traffic per run: internal %llu bytes, psram "
+             "%llu bytes (%.1f%% internal)",
+             this->internal_root ? this->internal_size : 0,
+             this->psram_root ? this->psram_size : 0,
+             internal_traffic,
+             psram_traffic,
+             internal_traffic + psram_traffic ? 100.f * internal_traffic / (internal_traffic + psram_traffic) : 0.f);
 }
 
 TensorBase *MemoryManagerBase::get_tensor(int index)
@@ -25,7 +97,7 @@ TensorBase *MemoryManagerBase::get_tensor(int index)
     return this->tensors[index];
 }
 
-TensorBase *MemoryManagerBase::get_tensor(std::string &name)
+TensorBase *MemoryManagerBase::get_tensor(const std::string &name)
 {
     auto it = this->name2index.find(name);
     if (it != name2index.end()) {
@@ -37,7 +109,7 @@ TensorBase *MemoryManagerBase::get_tensor(std::string &name)
     return nullptr;
 }
 
-int MemoryManagerBase::get_tensor_index(std::string &name)
+int MemoryManagerBase::get_tensor_index(const std::string &name)
 {
     auto it = this->name2index.find(name);
     if (it != name2index.end()) {
@@ -117,6 +189,7 @@ TensorInfo::TensorInfo(std::string &name,
     exponent(exponent),
     is_internal(is_internal),
     m_leader_tensor(nullptr),
+    m_leader_offset(0),
     m_follower_dirty_tensor(nullptr)
 {
     if (shape.size() > 0) {
@@ -143,13 +216,19 @@ TensorInfo::TensorInfo(std::string &name,
     this->internal_offset = 0;
 }
 
-void TensorInfo::set_inplace_leader_tensor(TensorInfo *tensor)
+void TensorInfo::set_inplace_leader_tensor(TensorInfo *tensor, uint32_t leader_offset)
 {
     this->m_leader_tensor = tensor;
+    this->m_leader_offset = tensor ? leader_offset : 0;
     if (tensor) {
-        if (tensor->time_end < this->time_end || this->time_end == -1) {
+        // time_end of -1 on the leader is a graph output, which must never be freed.
+        if (tensor->time_end != -1 && (tensor->time_end < this->time_end || this->time_end == -1)) {
             tensor->update_time(this->time_end);
         }
+        // A concat input is written before the concat output exists, the shared buffer lives from the earliest one.
+        if (this->time_begin < tensor->time_begin) {
+            tensor->time_begin = this->time_begin;
+        }
     }
 }
 
@@ -176,7 +255,8 @@ TensorBase *TensorInfo::create_tensor(void *internal_root, void *psram_root)
     TensorBase *tensor = nullptr;
     uint8_t *element = nullptr;
 
-    if (this->is_internal) {
+    // An inplaced tensor lives wherever its leader was placed.
+    if (this->get_internal_state()) {
         element = (uint8_t *)internal_root + this->get_internal_offset();
     } else {
         element = (uint8_t *)psram_root + this->get_offset();
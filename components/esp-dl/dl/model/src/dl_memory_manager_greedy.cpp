@@ -1,6 +1,7 @@
 #include <stdint.h>
 
 #include "dl_memory_manager_greedy.hpp"
+#include "dl_module_add.hpp"
 #include "esp_log.h"
 
 static const char *TAG = "MemoryManagerGreedy";
@@ -39,6 +40,8 @@ std::vector<TensorBase *> MemoryManagerGreedy::alloc(fbs::FbsModel *fbs_model,
     std::vector<TensorInfo *> tensor_info;
     // get all tensor info from flatbuffers
     this->get_tensor_info_from_fbs(fbs_model, execution_plan, tensor_info);
+    this->zero_copy_bytes = this->plan_resize_add_fusion(fbs_model, execution_plan, tensor_info);
+    this->zero_copy_bytes += this->plan_zero_copy(fbs_model, execution_plan, tensor_info);
 
     // simulate the memory allocation
     this->simulate_with_internal_memory(tensor_info, execution_plan.size());
@@ -48,10 +51,17 @@ std::vector<TensorBase *> MemoryManagerGreedy::alloc(fbs::FbsModel *fbs_model,
         psram_root = this->psram_root_calloc(psram_size);
     }
 
-    void *internal_root = nullptr;
-    if (!internal_memory_list.empty()) {
-        internal_root = this->internal_root_calloc(this->internal_size);
+    // Only the part of the internal budget the tensors reach is allocated, the rest stays free for the application.
+    size_t internal_size = 0;
+    for (int i = 0; i < tensor_info.size(); i++) {
+        TensorInfo *info = tensor_info[i];
+        if (!info->is_inplaced() && info->get_internal_state()) {
+            size_t aligned_size = (info->get_size() + this->alignment - 1) / this->alignment * this->alignment;
+            internal_size = std::max(internal_size, info->get_internal_offset() + aligned_size);
+        }
     }
+    void *internal_root = this->internal_root_calloc(internal_size);
+    this->record_placement(tensor_info, execution_plan);
 
     // start to allocate tensors
     this->tensors.reserve(tensor_info.size());
@@ -80,6 +90,7 @@ void MemoryManagerGreedy::free()
     }
     this->root_free();
     this->name2index.clear();
+    this->placements.clear();
     this->free_memory_list();
 }
 
@@ -202,6 +213,191 @@ void MemoryManagerGreedy::get_tensor_info_from_fbs(fbs::FbsModel *fbs_model,
     }
 }
 
+size_t MemoryManagerGreedy::plan_zero_copy(fbs::FbsModel *fbs_model,
+                                          std::vector<dl::module::Module *> &execution_plan,
+                                          std::vector<TensorInfo *> &tensor_info)
+{
+    std::vector<std::string> graph_inputs = fbs_model->get_graph_inputs();
+    std::vector<std::string> graph_outputs = fbs_model->get_graph_outputs();
+    std::vector<std::string> sorted_nodes = fbs_model->topological_sort();
+    std::vector<std::string> op_inputs;
+    std::vector<std::string> op_outputs;
+
+    // Tensors other tensors are inplaced into. Their buffer is shared, so they can not move into a concat output.
+    std::vector<bool> is_leader(tensor_info.size(), false);
+    for (int i = 0; i < tensor_info.size(); i++) {
+        TensorInfo *leader = tensor_info[i]->get_inplace_leader_tensor();
+        if (leader) {
+            is_leader[std::find(tensor_info.begin(), tensor_info.end(), leader) - tensor_info.begin()] = true;
+        }
+    }
+
+    size_t view_bytes = 0;
+    size_t concat_bytes = 0;
+    int concat_num = 0;
+    for (int i = 0; i < execution_plan.size(); i++) {
+        dl::module::Module *module = execution_plan[i];
+        if (module->inplace == MODULE_INPLACE_UNCHANGED_BUFFER && module->m_outputs_index.size() == 1 &&
+            tensor_info[module->m_outputs_index[0]]->is_inplaced()) {
+            view_bytes += tensor_info[module->m_outputs_index[0]]->get_size();
+            continue;
+        }
+        if (fbs_model->get_operation_type(sorted_nodes[i]) != "Concat" || module->m_outputs_index.size() != 1) {
+            continue;
+        }
+
+        fbs_model->get_operation_inputs_and_outputs(sorted_nodes[i], op_inputs, op_outputs);
+        TensorInfo *output = tensor_info[module->m_outputs_index[0]];
+        std::vector<int> shape = output->get_shape();
+        int axis = 0;
+        fbs_model->get_operation_attribute(sorted_nodes[i], "axis", axis);
+        if (axis < 0) {
+            axis += shape.size();
+        }
+        int outer = 1;
+        for (int j = 0; j < axis; j++) {
+            outer *= shape[j];
+        }
+        if (outer != 1 || output->is_inplaced() || module->m_inputs_index.size() != op_inputs.size()) {
+            continue;
+        }
+
+        // Every input must be an intermediate tensor of its own, read for the last time by this concat and
+        // starting at an aligned offset inside the output.
+        bool eligible = true;
+        uint32_t offset = 0;
+        for (int j = 0; j < module->m_inputs_index.size() && eligible; j++) {
+            int index = module->m_inputs_index[j];
+            TensorInfo *input = tensor_info[index];
+            std::string name = input->get_name();
+            eligible = offset % this->alignment == 0 && input->get_time_end() == i + 1 && !input->is_inplaced() &&
+                !is_leader[index] && !input->get_inplace_follower_tensor() &&
+                std::count(module->m_inputs_index.begin(), module->m_inputs_index.end(), index) == 1 &&
+                std::find(graph_inputs.begin(), graph_inputs.end(), name) == graph_inputs.end() &&
+                std::find(graph_outputs.begin(), graph_outputs.end(), name) == graph_outputs.end();
+            offset += input->get_size();
+        }
+        if (!eligible || offset != output->get_size()) {
+            continue;
+        }
+
+        offset = 0;
+        for (int j = 0; j < module->m_inputs_index.size(); j++) {
+            TensorInfo *input = tensor_info[module->m_inputs_index[j]];
+            input->set_inplace_leader_tensor(output, offset);
+            offset += input->get_size();
+        }
+        is_leader[module->m_outputs_index[0]] = true;
+        concat_bytes += output->get_size();
+        concat_num++;
+    }
+
+    ESP_LOGI(TAG,
+             "Zero copy: %d concat, %d bytes; views: %d bytes; removed copy per run: %d bytes\n",
+             concat_num,
+             concat_bytes,
+             view_bytes,
+             concat_bytes + view_bytes);
+    return concat_bytes + view_bytes;
+}
+
+size_t MemoryManagerGreedy::plan_resize_add_fusion(fbs::FbsModel *fbs_model,
+                                                  std::vector<dl::module::Module *> &execution_plan,
+                                                  std::vector<TensorInfo *> &tensor_info)
+{
+    std::vector<std::string> graph_outputs = fbs_model->get_graph_outputs();
+    std::vector<std::string> sorted_nodes = fbs_model->topological_sort();
+
+    // Producer, as an index into the execution plan, readers and inplace followers of every tensor.
+    std::vector<int> producer(tensor_info.size(), -1);
+    std::vector<int> reader_num(tensor_info.size(), 0);
+    std::vector<int> follower_num(tensor_info.size(), 0);
+    for (int i = 0; i < execution_plan.size(); i++) {
+        for (int index : execution_plan[i]->m_outputs_index) {
+            producer[index] = i;
+        }
+        for (int index : execution_plan[i]->m_inputs_index) {
+            reader_num[index]++;
+        }
+    }
+    for (int i = 0; i < tensor_info.size(); i++) {
+        TensorInfo *leader = tensor_info[i]->get_inplace_leader_tensor();
+        if (leader) {
+            follower_num[std::find(tensor_info.begin(), tensor_info.end(), leader) - tensor_info.begin()]++;
+        }
+    }
+
+    size_t fused_bytes = 0;
+    int fused_num = 0;
+    for (int i = 0; i < execution_plan.size(); i++) {
+        dl::module::Module *module = execution_plan[i];
+        if (fbs_model->get_operation_type(sorted_nodes[i]) != "Add" || module->m_inputs_index.size() != 2 ||
+            module->m_outputs_index.size() != 1) {
+            continue;
+        }
+
+        TensorInfo *output = tensor_info[module->m_outputs_index[0]];
+        for (int k = 0; k < 2; k++) {
+            int resized_index = module->m_inputs_index[k];
+            int addend_index = module->m_inputs_index[1 - k];
+            int j = producer[resized_index];
+            if (j < 0 || fbs_model->get_operation_type(sorted_nodes[j]) != "Resize" ||
+                execution_plan[j]->quant_type != module->quant_type || execution_plan[j]->m_inputs_index.size() != 1) {
+                continue;
+            }
+
+            // The resize output is only read by this Add and shares its buffer with nothing but the Add output, the
+            // other input has the output shape and is not the resize input.
+            int input_index = execution_plan[j]->m_inputs_index[0];
+            TensorInfo *input = tensor_info[input_index];
+            TensorInfo *resized = tensor_info[resized_index];
+            std::string name = resized->get_name();
+            bool output_inplaced = output->get_inplace_leader_tensor() == resized;
+            bool eligible = reader_num[resized_index] == 1 && follower_num[resized_index] == output_inplaced &&
+                !resized->is_inplaced() && resized->get_shape() == output->get_shape() &&
+                tensor_info[addend_index]->get_shape() == output->get_shape() && addend_index != input_index &&
+                std::find(graph_outputs.begin(), graph_outputs.end(), name) == graph_outputs.end();
+            // The Add reads x now, nothing may write its buffer after the resize: a tensor x is inplaced into must
+            // have no other follower changing it.
+            TensorInfo *below = input;
+            for (TensorInfo *leader = input->get_inplace_leader_tensor(); eligible && leader;
+                 leader = leader->get_inplace_leader_tensor()) {
+                eligible = !leader->get_inplace_follower_tensor() || leader->get_inplace_follower_tensor() == below;
+                below = leader;
+            }
+            if (!eligible) {
+                continue;
+            }
+
+            // As for any input of the Add, a follower changing x must not be inplaced into it anymore.
+            TensorInfo *follower = input->get_inplace_follower_tensor();
+            if (follower) {
+                input->set_inplace_follower_tensor(nullptr);
+                follower->set_inplace_leader_tensor(nullptr);
+            }
+            if (std::find(graph_outputs.begin(), graph_outputs.end(), input->get_name()) == graph_outputs.end()) {
+                input->update_time(i + 1);
+            }
+            module->m_inputs_index[k] = input_index;
+            reader_num[input_index]++;
+            reader_num[resized_index]--;
+
+            resized->set_time_begin(i);
+            if (!output_inplaced) {
+                resized->set_inplace_leader_tensor(output);
+            }
+            static_cast<dl::module::Add *>(module)->fuse_resize(static_cast<dl::module::Resize2D *>(execution_plan[j]),
+                                                                k);
+            fused_bytes += resized->get_size() * 2;
+            fused_num++;
+            break;
+        }
+    }
+
+    ESP_LOGI(TAG, "Resize fused into Add: %d, removed copy per run: %d bytes\n", fused_num, fused_bytes);
+    return fused_bytes;
+}
+
 void MemoryManagerGreedy::set_preload_addr(std::vector<dl::module::Module *> execution_plan)
 {
     void *internal_root = this->get_internal_root();
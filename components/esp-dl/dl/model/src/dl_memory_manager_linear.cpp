@@ -0,0 +1,335 @@
+#include <algorithm>
+#include <limits.h>
+#include <stdint.h>
+
+#include "dl_memory_manager_linear.hpp"
+#include "esp_log.h"
+
+static const char *TAG = "MemoryManagerLinear";
+
+namespace dl {
+namespace memory {
+
+static inline bool is_overlapped(const memory_block_t *a, const memory_block_t *b)
+{
+    return a->time_begin < b->time_end && b->time_begin < a->time_end;
+}
+
+/**
+ * @brief Placed blocks whose lifetime overlaps block, sorted by offset.
+ */
+static void get_placed_neighbors(memory_block_t *block,
+                                 std::vector<memory_block_t *> &blocks,
+                                 std::vector<memory_block_t *> &neighbors)
+{
+    neighbors.clear();
+    for (memory_block_t *other : blocks) {
+        if (other != block && other->is_placed && is_overlapped(block, other)) {
+            neighbors.push_back(other);
+        }
+    }
+    std::sort(neighbors.begin(), neighbors.end(), [](memory_block_t *a, memory_block_t *b) {
+        return a->offset < b->offset;
+    });
+}
+
+/**
+ * @brief Lowest offset of a gap between the neighbors that holds size bytes, the end of the highest neighbor if
+ * there is none.
+ */
+static size_t get_first_fit(std::vector<memory_block_t *> &neighbors, size_t size)
+{
+    size_t prev_end = 0;
+    for (memory_block_t *other : neighbors) {
+        if (other->offset >= prev_end + size) {
+            return prev_end;
+        }
+        prev_end = std::max(prev_end, (size_t)other->offset + other->size);
+    }
+    return prev_end;
+}
+
+/**
+ * @brief Offset of the smallest gap between the neighbors that holds size bytes, the end of the highest neighbor if
+ * there is none.
+ */
+static size_t get_best_fit(std::vector<memory_block_t *> &neighbors, size_t size)
+{
+    size_t prev_end = 0;
+    size_t best_offset = SIZE_MAX;
+    size_t best_gap = SIZE_MAX;
+    for (memory_block_t *other : neighbors) {
+        if (other->offset >= prev_end + size && other->offset - prev_end < best_gap) {
+            best_gap = other->offset - prev_end;
+            best_offset = prev_end;
+        }
+        prev_end = std::max(prev_end, (size_t)other->offset + other->size);
+    }
+    return best_offset == SIZE_MAX ? prev_end : best_offset;
+}
+
+size_t get_memory_lower_bound(std::vector<memory_block_t *> &blocks)
+{
+    // Sweep over the steps where a block begins, the live bytes only grow there.
+    size_t lower_bound = 0;
+    for (memory_block_t *block : blocks) {
+        size_t live = 0;
+        for (memory_block_t *other : blocks) {
+            if (other->time_begin <= block->time_begin && block->time_begin < other->time_end) {
+                live += other->size;
+            }
+        }
+        lower_bound = std::max(lower_bound, live);
+    }
+    return lower_bound;
+}
+
+/**
+ * @brief Place blocks in the given order, each one at the best fitting gap between the placed blocks.
+ */
+static size_t place_blocks(std::vector<memory_block_t *> &order, std::vector<memory_block_t *> &blocks, size_t capacity)
+{
+    size_t arena_size = 0;
+    std::vector<memory_block_t *> neighbors;
+    for (memory_block_t *block : blocks) {
+        block->is_placed = false;
+    }
+    for (memory_block_t *block : order) {
+        get_placed_neighbors(block, blocks, neighbors);
+        size_t offset = get_best_fit(neighbors, block->size);
+        if (capacity && offset + block->size > capacity) {
+            // The best fitting gap is not necessarily the lowest one, try the lowest before giving up.
+            offset = get_first_fit(neighbors, block->size);
+            if (offset + block->size > capacity) {
+                continue;
+            }
+        }
+        block->offset = offset;
+        block->is_placed = true;
+        arena_size = std::max(arena_size, offset + block->size);
+    }
+    return arena_size;
+}
+
+size_t MemoryManagerLinear::plan_by_size(std::vector<memory_block_t *> &blocks, size_t capacity)
+{
+    std::vector<memory_block_t *> order = blocks;
+    std::stable_sort(order.begin(), order.end(), [](memory_block_t *a, memory_block_t *b) {
+        if (a->size != b->size) {
+            return a->size > b->size;
+        }
+        return a->time_end - a->time_begin > b->time_end - b->time_begin;
+    });
+    return place_blocks(order, blocks, capacity);
+}
+
+size_t MemoryManagerLinear::plan_internal(std::vector<memory_block_t *> &blocks, size_t capacity, int node_num)
+{
+    // Every access to a block in internal ram instead of PSRAM saves about the same per byte, while the block holds
+    // its bytes for its whole lifetime. Accesses per step of lifetime is the saving per byte and step of the budget.
+    std::vector<memory_block_t *> order = blocks;
+    auto get_lifetime = [node_num](memory_block_t *block) {
+        return (int64_t)std::max(std::min(block->time_end, node_num) - block->time_begin, 1);
+    };
+    std::stable_sort(order.begin(), order.end(), [&get_lifetime](memory_block_t *a, memory_block_t *b) {
+        int64_t density_a = (int64_t)a->access_count * get_lifetime(b);
+        int64_t density_b = (int64_t)b->access_count * get_lifetime(a);
+        if (density_a != density_b) {
+            return density_a > density_b;
+        }
+        return a->size > b->size;
+    });
+    return place_blocks(order, blocks, capacity);
+}
+
+/**
+ * @brief State of the branch and bound search over placement orders.
+ */
+typedef struct {
+    std::vector<memory_block_t *> *blocks;
+    std::vector<uint32_t> best_offsets;
+    size_t best_size;
+    size_t lower_bound;
+    int nodes;
+    int search_limit;
+} exhaustive_search_t;
+
+static void search_placement(exhaustive_search_t &search, int placed_num, size_t arena_size)
+{
+    std::vector<memory_block_t *> &blocks = *search.blocks;
+    int n = blocks.size();
+    if (placed_num == n) {
+        if (arena_size < search.best_size) {
+            search.best_size = arena_size;
+            for (int i = 0; i < n; i++) {
+                search.best_offsets[i] = blocks[i]->offset;
+            }
+        }
+        return;
+    }
+
+    std::vector<memory_block_t *> neighbors;
+    for (int i = 0; i < n && search.best_size > search.lower_bound && search.nodes < search.search_limit; i++) {
+        memory_block_t *block = blocks[i];
+        if (block->is_placed) {
+            continue;
+        }
+        // Blocks of the same size and lifetime are interchangeable, only the first unplaced one is tried.
+        bool duplicated = false;
+        for (int j = 0; j < i && !duplicated; j++) {
+            duplicated = !blocks[j]->is_placed && blocks[j]->size == block->size &&
+                blocks[j]->time_begin == block->time_begin && blocks[j]->time_end == block->time_end;
+        }
+        if (duplicated) {
+            continue;
+        }
+
+        get_placed_neighbors(block, blocks, neighbors);
+        size_t offset = get_first_fit(neighbors, block->size);
+        size_t new_size = std::max(arena_size, offset + block->size);
+        if (new_size >= search.best_size) {
+            continue;
+        }
+        search.nodes++;
+        block->offset = offset;
+        block->is_placed = true;
+        search_placement(search, placed_num + 1, new_size);
+        block->is_placed = false;
+    }
+}
+
+size_t MemoryManagerLinear::plan_exhaustive(std::vector<memory_block_t *> &blocks, size_t upper_bound)
+{
+    // Any packing is reached by placing its blocks in the order of their offsets, each one at the lowest offset it
+    // fits, so searching all orders with first fit finds the minimum.
+    exhaustive_search_t search;
+    search.blocks = &blocks;
+    search.best_size = upper_bound;
+    search.lower_bound = get_memory_lower_bound(blocks);
+    search.nodes = 0;
+    search.search_limit = this->search_limit;
+    search.best_offsets.resize(blocks.size());
+    for (int i = 0; i < blocks.size(); i++) {
+        search.best_offsets[i] = blocks[i]->offset;
+        blocks[i]->is_placed = false;
+    }
+
+    search_placement(search, 0, 0);
+
+    for (int i = 0; i < blocks.size(); i++) {
+        blocks[i]->offset = search.best_offsets[i];
+        blocks[i]->is_placed = true;
+    }
+    ESP_LOGI(TAG,
+             "Exhaustive search: %d tensors, %d nodes%s, %d -> %d bytes, lower bound: %d bytes",
+             blocks.size(),
+             search.nodes,
+             search.nodes >= search.search_limit ? " (limit reached)" : "",
+             upper_bound,
+             search.best_size,
+             search.lower_bound);
+    return search.best_size;
+}
+
+size_t MemoryManagerLinear::plan(std::vector<memory_block_t *> &blocks)
+{
+    size_t arena_size = this->plan_by_size(blocks);
+    if (blocks.size() > 1 && blocks.size() <= this->exhaustive_max) {
+        arena_size = this->plan_exhaustive(blocks, arena_size);
+    }
+    return arena_size;
+}
+
+std::vector<TensorBase *> MemoryManagerLinear::alloc(fbs::FbsModel *fbs_model,
+                                                     std::vector<dl::module::Module *> &execution_plan)
+{
+    std::vector<TensorInfo *> tensor_info;
+    // get all tensor info from flatbuffers
+    this->get_tensor_info_from_fbs(fbs_model, execution_plan, tensor_info);
+    this->zero_copy_bytes = this->plan_resize_add_fusion(fbs_model, execution_plan, tensor_info);
+    this->zero_copy_bytes += this->plan_zero_copy(fbs_model, execution_plan, tensor_info);
+
+    // Tensors inplaced into another one share its buffer, only the leaders need a block.
+    int node_num = execution_plan.size();
+    std::vector<uint32_t> access_counts = get_access_counts(execution_plan, tensor_info.size());
+    std::map<TensorInfo *, int> block_index;
+    std::vector<memory_block_t> blocks;
+    blocks.reserve(tensor_info.size());
+    for (int i = 0; i < tensor_info.size(); i++) {
+        TensorInfo *info = tensor_info[i];
+        if (info->is_inplaced()) {
+            continue;
+        }
+        block_index.emplace(info, blocks.size());
+        memory_block_t block;
+        block.size = (info->get_size() + this->alignment - 1) / this->alignment * this->alignment;
+        block.time_begin = info->get_time_begin();
+        block.time_end = info->get_time_end();
+        if (block.time_end < 0 || block.time_end >= node_num) {
+            block.time_end = INT_MAX;
+        }
+        block.offset = 0;
+        block.access_count = 0;
+        block.is_placed = false;
+        block.tensor = info;
+        blocks.push_back(block);
+    }
+    for (int i = 0; i < tensor_info.size(); i++) {
+        TensorInfo *root = tensor_info[i];
+        while (root->get_inplace_leader_tensor()) {
+            root = root->get_inplace_leader_tensor();
+        }
+        blocks[block_index[root]].access_count += access_counts[i];
+    }
+
+    std::vector<memory_block_t *> psram_blocks;
+    size_t internal_size = 0;
+    if (this->internal_size > this->alignment) {
+        std::vector<memory_block_t *> all_blocks;
+        for (memory_block_t &block : blocks) {
+            all_blocks.push_back(&block);
+        }
+        internal_size = this->plan_internal(all_blocks, this->internal_size, node_num);
+        for (memory_block_t *block : all_blocks) {
+            if (block->is_placed) {
+                block->tensor->set_internal_offset(block->offset);
+            } else {
+                psram_blocks.push_back(block);
+            }
+        }
+    } else {
+        for (memory_block_t &block : blocks) {
+            psram_blocks.push_back(&block);
+        }
+    }
+
+    size_t psram_size = this->plan(psram_blocks);
+    for (memory_block_t *block : psram_blocks) {
+        block->tensor->set_offset(block->offset);
+    }
+    ESP_LOGI(TAG,
+             "Maximum psram size: %d, Maximum internal ram size: %d, lower bound: %d\n",
+             psram_size,
+             internal_size,
+             get_memory_lower_bound(psram_blocks));
+
+    void *psram_root = this->psram_root_calloc(psram_size);
+    void *internal_root = this->internal_root_calloc(internal_size);
+    this->record_placement(tensor_info, execution_plan);
+
+    // start to allocate tensors
+    this->tensors.reserve(tensor_info.size());
+    for (int i = 0; i < tensor_info.size(); i++) {
+        this->tensors.push_back(tensor_info[i]->create_tensor(internal_root, psram_root));
+    }
+
+    // free TensorInfo vector
+    for (int i = 0; i < tensor_info.size(); i++) {
+        delete tensor_info[i];
+    }
+
+    return this->tensors;
+}
+
+} // namespace memory
+} // namespace dl
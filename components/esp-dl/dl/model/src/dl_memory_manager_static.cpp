@@ -0,0 +1,42 @@
+#include "dl_memory_manager_static.hpp"
+#include "esp_log.h"
+
+static const char *TAG = "MemoryManagerStatic";
+
+namespace dl {
+namespace memory {
+
+std::vector<TensorBase *> MemoryManagerStatic::alloc(fbs::FbsModel *fbs_model,
+                                                     std::vector<dl::module::Module *> &execution_plan)
+{
+    size_t psram_size = this->compiled_model->psram_size;
+    size_t internal_size = this->compiled_model->internal_size;
+    uint8_t *internal_root = (uint8_t *)this->internal_root_calloc(internal_size);
+    uint8_t *psram_root = nullptr;
+    if (internal_size && !internal_root) {
+        ESP_LOGW(TAG, "Fail to allocate %d bytes of internal ram, the tensors planned there go to PSRAM", internal_size);
+        size_t aligned_size = (psram_size + this->alignment - 1) / this->alignment * this->alignment;
+        psram_root = (uint8_t *)this->psram_root_calloc(aligned_size + internal_size);
+        internal_root = psram_root ? psram_root + aligned_size : nullptr;
+    } else {
+        psram_root = (uint8_t *)this->psram_root_calloc(psram_size);
+    }
+    if ((psram_size && !psram_root) || (internal_size && !internal_root)) {
+        ESP_LOGE(TAG, "Fail to allocate the tensor arenas");
+        return this->tensors;
+    }
+    ESP_LOGI(TAG, "psram size: %d, internal ram size: %d\n", psram_size, internal_size);
+
+    this->tensors.reserve(this->compiled_model->tensor_num);
+    for (int i = 0; i < this->compiled_model->tensor_num; i++) {
+        const compiled_tensor_t &info = this->compiled_model->tensors[i];
+        uint8_t *element = (info.is_internal ? internal_root : psram_root) + info.offset;
+        std::vector<int> shape(info.shape, info.shape + info.rank);
+        this->tensors.push_back(new TensorBase(shape, element, info.exponent, info.dtype, false));
+        this->name2index.emplace(info.name, i);
+    }
+    return this->tensors;
+}
+
+} // namespace memory
+} // namespace dl
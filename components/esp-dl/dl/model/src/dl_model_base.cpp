@@ -1,14 +1,22 @@
 #include <stdint.h>
+#include <string.h>
 
-#include "dl_memory_manager_greedy.hpp"
+#include "dl_memory_manager_static.hpp"
 #include "dl_model_base.hpp"
-#include "dl_module_creator.hpp"
+#include "esp_memory_utils.h"
+#include "esp_timer.h"
 #include "fbs_model.hpp"
+#if !CONFIG_DL_COMPILED_MODEL_ONLY
+#include "dl_memory_manager_greedy.hpp"
+#include "dl_memory_manager_linear.hpp"
+#include "dl_module_creator.hpp"
+#endif
 
 static const char *TAG = "dl::Model";
 
 namespace dl {
 
+#if !CONFIG_DL_COMPILED_MODEL_ONLY
 Model::Model(const char *name,
              fbs::model_location_type_t location,
              int internal_size,
@@ -53,9 +61,16 @@ Model::Model(fbs::FbsModel *fbs_model, int internal_size, memory_manager_t mm_ty
         this->build(internal_size, mm_type);
     }
 }
+#endif
+
+Model::Model(const compiled_model_t *compiled_model, const char *rodata_address, bool param_copy)
+{
+    this->load(compiled_model, rodata_address, param_copy);
+}
 
 Model::~Model()
 {
+#if !CONFIG_DL_COMPILED_MODEL_ONLY
     // If fbs_loader is NULL, this means fbs_model is created outside this class. So don't delete it.
     if (fbs_loader) {
         delete fbs_loader;
@@ -64,7 +79,17 @@ Model::~Model()
             delete fbs_model;
         }
     }
+#endif
 
+    if (scheduler) {
+        delete scheduler;
+    }
+    if (prefetcher) {
+        delete prefetcher;
+    }
+    if (profiler) {
+        delete profiler;
+    }
     if (memory_manager) {
         delete memory_manager;
     }
@@ -75,6 +100,7 @@ Model::~Model()
     }
 }
 
+#if !CONFIG_DL_COMPILED_MODEL_ONLY
 esp_err_t Model::load(const char *name, fbs::model_location_type_t location, uint8_t *key, bool param_copy)
 {
     fbs_loader = new fbs::FbsLoader(name, location);
@@ -140,21 +166,132 @@ esp_err_t Model::load(fbs::FbsModel *fbs_model)
         }
         execution_plan.push_back(module);
     }
+    if (ret == ESP_OK) {
+        this->log_param_placement();
+    }
 
     this->memory_manager = nullptr;
     return ret;
 }
+#endif
 
+/**
+ * @brief Find the .espdl model a compiled model was compiled from, in a single file or in a pack of models.
+ */
+static const uint8_t *get_compiled_model_data(const compiled_model_t *compiled_model, const uint8_t *data)
+{
+    if (memcmp(data, "PDL2", 4) == 0) {
+        uint32_t model_num = ((const uint32_t *)data)[1];
+        const uint8_t *model_data = nullptr;
+        size_t name_len = strlen(compiled_model->file_name);
+        for (int i = 0; i < model_num && !model_data; i++) {
+            const uint32_t *entry = (const uint32_t *)(data + 8 + 12 * i);
+            if (entry[2] == name_len && memcmp(data + entry[1], compiled_model->file_name, name_len) == 0) {
+                model_data = data + entry[0];
+            }
+        }
+        data = model_data;
+    }
+    if (!data || memcmp(data, "EDL2", 4) != 0) {
+        ESP_LOGE(TAG, "Can not find the model %s.", compiled_model->file_name);
+        return nullptr;
+    }
+    const uint32_t *header = (const uint32_t *)data;
+    if (header[1] != 0) {
+        ESP_LOGE(TAG, "Compiled models do not support encryption.");
+        return nullptr;
+    }
+    if (header[2] != compiled_model->fbs_size) {
+        ESP_LOGE(TAG, "The model %s does not match the compiled model, compile it again.", compiled_model->file_name);
+        return nullptr;
+    }
+    return data;
+}
+
+esp_err_t Model::load(const compiled_model_t *compiled_model, const char *rodata_address, bool param_copy)
+{
+    const uint8_t *model_data = get_compiled_model_data(compiled_model, (const uint8_t *)rodata_address);
+    if (!model_data) {
+        return ESP_FAIL;
+    }
+    this->name = compiled_model->name;
+    this->version = compiled_model->version;
+    ESP_LOGI(TAG, "compiled model:%s, version:%lld\n", this->name.c_str(), this->version);
+
+    execution_plan.clear();
+    execution_plan.reserve(compiled_model->module_num);
+    compiled_model->create_modules(model_data, param_copy, execution_plan);
+    this->log_param_placement();
+
+    this->memory_manager = new dl::memory::MemoryManagerStatic(compiled_model);
+    if (this->memory_manager->alloc(nullptr, this->execution_plan).size() != compiled_model->tensor_num) {
+        return ESP_FAIL;
+    }
+    // Modules set up their state from the input shapes, e.g. Concat its copy sizes, like the memory managers of the
+    // file loader do while planning.
+    for (dl::module::Module *module : this->execution_plan) {
+        std::vector<std::vector<int>> input_shapes;
+        for (int index : module->m_inputs_index) {
+            input_shapes.push_back(this->memory_manager->tensors[index]->shape);
+        }
+        std::vector<std::vector<int>> output_shapes = module->get_output_shape(input_shapes);
+        for (int i = 0; i < module->m_outputs_index.size(); i++) {
+            if (i >= output_shapes.size() ||
+                output_shapes[i] != this->memory_manager->tensors[module->m_outputs_index[i]]->shape) {
+                ESP_LOGE(TAG, "%s: the output shape differs from the compiled model.", module->name);
+                return ESP_FAIL;
+            }
+        }
+    }
+    this->inputs.clear();
+    this->outputs.clear();
+    for (int i = 0; i < compiled_model->input_num; i++) {
+        int index = compiled_model->inputs[i];
+        this->inputs.emplace(compiled_model->tensors[index].name, this->memory_manager->tensors[index]);
+    }
+    for (int i = 0; i < compiled_model->output_num; i++) {
+        int index = compiled_model->outputs[i];
+        this->outputs.emplace(compiled_model->tensors[index].name, this->memory_manager->tensors[index]);
+    }
+    if (this->graph_parallel) {
+        this->scheduler = new ModelScheduler(this->execution_plan, this->memory_manager->tensors);
+    }
+    return ESP_OK;
+}
+
+#if !CONFIG_DL_COMPILED_MODEL_ONLY
 void Model::build(size_t internal_size, memory_manager_t mm_type, bool preload)
 {
+    if (!this->fbs_model) {
+        ESP_LOGE(TAG, "Nothing to build, the memory of compiled models is planned at compile time.");
+        return;
+    }
     int max_available_internal_size = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL) * 0.8;
-    if (internal_size > max_available_internal_size) {
+    if (internal_size == (size_t)DL_INTERNAL_SIZE_AUTO) {
+        // The tensors must fit into one block, the memory managers only allocate the part of the budget they use.
+        size_t largest_free_block = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        internal_size = largest_free_block > DL_INTERNAL_SIZE_AUTO_RESERVE
+            ? largest_free_block - DL_INTERNAL_SIZE_AUTO_RESERVE
+            : 0;
+        ESP_LOGI(TAG,
+                 "Internal ram budget: %d bytes, largest free internal block: %d bytes",
+                 internal_size,
+                 largest_free_block);
+    } else if (internal_size > max_available_internal_size) {
         ESP_LOGW(TAG, "The maximum available internal memory is %d", max_available_internal_size);
         internal_size = max_available_internal_size;
     }
 
     // If memory manager has been created, delete it and reset all modules
     this->fbs_model->load_map();
+    if (this->scheduler) {
+        delete this->scheduler;
+        this->scheduler = nullptr;
+    }
+    if (this->prefetcher) {
+        delete this->prefetcher;
+        this->prefetcher = nullptr;
+    }
     if (this->memory_manager) {
         delete this->memory_manager;
         for (int i = 0; i < execution_plan.size(); i++) {
@@ -167,6 +304,8 @@ void Model::build(size_t internal_size, memory_manager_t mm_type, bool preload)
 
     if (mm_type == MEMORY_MANAGER_GREEDY) {
         this->memory_manager = new dl::memory::MemoryManagerGreedy(internal_size);
+    } else if (mm_type == LINEAR_MEMORY_MANAGER) {
+        this->memory_manager = new dl::memory::MemoryManagerLinear(internal_size);
     }
     this->memory_manager->alloc(this->fbs_model, this->execution_plan);
 
@@ -185,19 +324,230 @@ void Model::build(size_t internal_size, memory_manager_t mm_type, bool preload)
     }
 
     this->fbs_model->clear_map();
+    if (this->graph_parallel) {
+        this->scheduler = new ModelScheduler(this->execution_plan, this->memory_manager->tensors);
+    }
+    if (preload) {
+        this->set_weight_prefetch(true);
+    }
+    if (this->profiler) {
+        this->profiler->set_modules(this->execution_plan, this->memory_manager->tensors, this->memory_manager);
+    }
 }
+#endif
 
-void Model::run(runtime_mode_t mode)
+void Model::set_weight_prefetch(bool enable, size_t buffer_size)
 {
-    // execute each module.
+    if (!this->memory_manager) {
+        ESP_LOGW(TAG, "The model is not built.");
+        return;
+    }
+    if (this->prefetcher) {
+        delete this->prefetcher;
+        this->prefetcher = nullptr;
+    }
+    if (enable) {
+        // Only parameters in PSRAM are prefetched.
+        this->materialize_all_params();
+        this->prefetcher = new WeightPrefetcher(this->execution_plan, buffer_size);
+    }
+}
+
+void Model::print_weight_prefetch()
+{
+    if (!this->prefetcher) {
+        ESP_LOGW(TAG, "Weight prefetch is not enabled.");
+        return;
+    }
+    this->prefetcher->print();
+}
+
+void Model::set_lazy_param_copy(bool enable)
+{
+    this->param_pending.assign(this->execution_plan.size(), false);
+    this->param_pending_num = 0;
+    if (!enable) {
+        return;
+    }
+    size_t pending_bytes = 0;
     for (int i = 0; i < execution_plan.size(); i++) {
         dl::module::Module *module = execution_plan[i];
-        if (module) {
-            module->forward(this->memory_manager->tensors, mode);
-        } else {
+        if (!module) {
+            break;
+        }
+        for (TensorBase *param : module->get_preload_tensors()) {
+            if (!param->auto_free && !esp_ptr_external_ram(param->data)) {
+                this->param_pending[i] = true;
+                pending_bytes += param->get_bytes();
+            }
+        }
+        this->param_pending_num += this->param_pending[i];
+    }
+    ESP_LOGI(TAG, "%d layers copy %d bytes of parameters on first use", this->param_pending_num, pending_bytes);
+}
+
+void Model::materialize_params(int module_index)
+{
+    if (!this->param_pending_num || !this->param_pending[module_index]) {
+        return;
+    }
+    dl::module::Module *module = execution_plan[module_index];
+    for (TensorBase *param : module->get_preload_tensors()) {
+        if (!esp_ptr_external_ram(param->data)) {
+            param->materialize();
+        }
+    }
+    // The cached kernel args point at the parameters.
+    delete module->m_args_cache;
+    module->m_args_cache = nullptr;
+    this->param_pending[module_index] = false;
+    this->param_pending_num--;
+}
+
+void Model::materialize_all_params()
+{
+    for (int i = 0; i < this->param_pending.size() && this->param_pending_num; i++) {
+        this->materialize_params(i);
+    }
+}
+
+void Model::log_param_placement()
+{
+    size_t copied_bytes = 0;
+    size_t in_place_bytes = 0;
+    for (dl::module::Module *module : execution_plan) {
+        if (!module) {
+            break;
+        }
+        for (TensorBase *param : module->get_preload_tensors()) {
+            (param->auto_free ? copied_bytes : in_place_bytes) += param->get_bytes();
+        }
+    }
+    ESP_LOGI(TAG,
+             "filter and bias: %d bytes copied, %d bytes read in place from the model",
+             copied_bytes,
+             in_place_bytes);
+}
+
+void Model::log_first_run(int64_t start_us)
+{
+    int64_t end_us = esp_timer_get_time();
+    ESP_LOGI(TAG, "first run: %lld us, finished %lld us after boot", end_us - start_us, end_us);
+    this->first_run = false;
+}
+
+void Model::set_profiler(bool enable, int capacity)
+{
+    if (this->profiler) {
+        delete this->profiler;
+        this->profiler = nullptr;
+    }
+    if (!enable) {
+        return;
+    }
+    if (!this->memory_manager) {
+        ESP_LOGW(TAG, "The model is not built.");
+        return;
+    }
+    this->profiler = new Profiler(capacity);
+    this->profiler->set_modules(this->execution_plan, this->memory_manager->tensors, this->memory_manager);
+}
+
+void Model::set_graph_parallel(bool enable)
+{
+    this->graph_parallel = enable;
+    if (enable && !this->scheduler && this->memory_manager) {
+        this->scheduler = new ModelScheduler(this->execution_plan, this->memory_manager->tensors);
+    }
+}
+
+void Model::print_graph_parallelism()
+{
+    if (!this->memory_manager) {
+        ESP_LOGW(TAG, "The model is not built.");
+        return;
+    }
+    if (this->scheduler) {
+        this->scheduler->print();
+    } else {
+        ModelScheduler scheduler(this->execution_plan, this->memory_manager->tensors);
+        scheduler.print();
+    }
+}
+
+void Model::print_memory_placement()
+{
+    if (!this->memory_manager) {
+        ESP_LOGW(TAG, "The model is not built.");
+        return;
+    }
+    this->memory_manager->print_placement();
+
+    // A module is internal ram bound when all the activations it touches are in internal ram.
+    int internal_num = 0;
+    for (int i = 0; i < execution_plan.size(); i++) {
+        dl::module::Module *module = execution_plan[i];
+        if (!module) {
             break;
         }
+        size_t internal_bytes = 0;
+        size_t psram_bytes = 0;
+        std::vector<int> indexes = module->m_inputs_index;
+        indexes.insert(indexes.end(), module->m_outputs_index.begin(), module->m_outputs_index.end());
+        for (int index : indexes) {
+            TensorBase *tensor = this->memory_manager->tensors[index];
+            if (this->memory_manager->is_internal(tensor->data)) {
+                internal_bytes += tensor->get_bytes();
+            } else {
+                psram_bytes += tensor->get_bytes();
+            }
+        }
+        const char *state = psram_bytes == 0 ? "internal" : (internal_bytes == 0 ? "psram" : "mixed");
+        internal_num += psram_bytes == 0;
+        ESP_LOGI(TAG,
+                 "%-24s activations internal: %8d bytes, psram: %8d bytes, %s",
+                 module->name,
+                 internal_bytes,
+                 psram_bytes,
+                 state);
     }
+    ESP_LOGI(TAG, "%d of %d modules only touch internal ram", internal_num, execution_plan.size());
+}
+
+void Model::run_execution_plan(runtime_mode_t mode)
+{
+    int64_t start_us = this->first_run ? esp_timer_get_time() : 0;
+    dl::module::ModuleWorkerPool::Scope pool_scope(mode == RUNTIME_MODE_SINGLE_CORE ? nullptr : &worker_pool);
+    if (this->graph_parallel && this->scheduler && mode != RUNTIME_MODE_SINGLE_CORE) {
+        this->materialize_all_params();
+        this->scheduler->run(this->memory_manager->tensors, &worker_pool, this->profiler);
+    } else if (this->prefetcher && this->prefetcher->is_enabled()) {
+        this->materialize_all_params();
+        this->prefetcher->run(this->memory_manager->tensors, mode, this->profiler);
+    } else {
+        // execute each module.
+        for (int i = 0; i < execution_plan.size(); i++) {
+            dl::module::Module *module = execution_plan[i];
+            if (module) {
+                this->materialize_params(i);
+                profile_event_t *event = this->profiler ? this->profiler->begin_module(i) : nullptr;
+                module->forward(this->memory_manager->tensors, mode);
+                if (event) {
+                    this->profiler->end(event);
+                }
+            } else {
+                break;
+            }
+        }
+    }
+    if (this->first_run) {
+        this->log_first_run(start_us);
+    }
+}
+
+void Model::run(runtime_mode_t mode)
+{
+    this->run_execution_plan(mode);
 }
 
 void Model::run(TensorBase *input, runtime_mode_t mode)
@@ -212,16 +562,7 @@ void Model::run(TensorBase *input, runtime_mode_t mode)
         return;
     }
 
-    // execute each module.
-    for (int i = 0; i < execution_plan.size(); i++) {
-        dl::module::Module *module = execution_plan[i];
-        if (module) {
-            // ESP_LOGI(TAG, "module: %d\n", i);
-            module->forward(this->memory_manager->tensors, mode);
-        } else {
-            break;
-        }
-    }
+    this->run_execution_plan(mode);
 }
 
 void Model::run(std::map<std::string, TensorBase *> &user_inputs,
@@ -251,25 +592,39 @@ void Model::run(std::map<std::string, TensorBase *> &user_inputs,
         }
     }
 
+    // The intermediate tensors for debug are copied right after their module, which needs the plan order.
+    if (user_outputs.empty()) {
+        this->run_execution_plan(mode);
+        return;
+    }
+
+    // Resolve the names once, the loop below only compares indexes.
+    std::vector<std::pair<int, TensorBase *>> debug_outputs;
+    for (auto user_outputs_iter = user_outputs.begin(); user_outputs_iter != user_outputs.end(); user_outputs_iter++) {
+        TensorHandle handle = this->resolve(user_outputs_iter->first);
+        if (handle.is_valid()) {
+            debug_outputs.emplace_back(handle.index, user_outputs_iter->second);
+        }
+    }
+
+    int64_t start_us = this->first_run ? esp_timer_get_time() : 0;
+    dl::module::ModuleWorkerPool::Scope pool_scope(mode == RUNTIME_MODE_SINGLE_CORE ? nullptr : &worker_pool);
     // execute each module.
     for (int i = 0; i < execution_plan.size(); i++) {
         dl::module::Module *module = execution_plan[i];
         if (module) {
+            this->materialize_params(i);
+            profile_event_t *event = this->profiler ? this->profiler->begin_module(i) : nullptr;
             module->forward(this->memory_manager->tensors, mode);
+            if (event) {
+                this->profiler->end(event);
+            }
             // get the intermediate tensor for debug.
-            if (!user_outputs.empty()) {
-                for (auto user_outputs_iter = user_outputs.begin(); user_outputs_iter != user_outputs.end();
-                     user_outputs_iter++) {
-                    int user_tensor_index =
-                        this->memory_manager->get_tensor_index(const_cast<std::string &>(user_outputs_iter->first));
-                    if (user_tensor_index >= 0) {
-                        std::vector<int> outputs_index = module->get_outputs_index();
-                        for (int i = 0; i < outputs_index.size(); i++) {
-                            if (user_tensor_index == outputs_index[i]) {
-                                user_outputs_iter->second->assign(this->memory_manager->tensors[user_tensor_index]);
-                                break;
-                            }
-                        }
+            for (auto &debug_output : debug_outputs) {
+                for (int output_index : module->m_outputs_index) {
+                    if (debug_output.first == output_index) {
+                        debug_output.second->assign(this->memory_manager->tensors[output_index]);
+                        break;
                     }
                 }
             }
@@ -277,7 +632,9 @@ void Model::run(std::map<std::string, TensorBase *> &user_inputs,
             break;
         }
     }
-    return;
+    if (this->first_run) {
+        this->log_first_run(start_us);
+    }
 }
 
 std::map<std::string, TensorBase *> &Model::get_inputs()
@@ -294,6 +651,19 @@ TensorBase *Model::get_intermediate(std::string name)
     return this->memory_manager->get_tensor(name);
 }
 
+TensorHandle Model::resolve(const std::string &name)
+{
+    if (!this->memory_manager) {
+        ESP_LOGE(TAG, "The model is not built.");
+        return TensorHandle();
+    }
+    int index = this->memory_manager->get_tensor_index(name);
+    if (index < 0) {
+        ESP_LOGE(TAG, "The model has no tensor named %s.", name.c_str());
+    }
+    return TensorHandle(index);
+}
+
 std::map<std::string, TensorBase *> &Model::get_outputs()
 {
     return this->outputs;
@@ -0,0 +1,261 @@
+#include "dl_model_prefetcher.hpp"
+#include "esp_attr.h"
+#include "esp_cache.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_memory_utils.h"
+#include "esp_timer.h"
+#include <algorithm>
+
+static const char *TAG = "dl::WeightPrefetcher";
+
+namespace dl {
+
+#if SOC_ASYNC_MEMCPY_SUPPORTED
+static bool IRAM_ATTR on_copy_done(async_memcpy_handle_t mcp, async_memcpy_event_t *event, void *arg)
+{
+    BaseType_t task_woken = pdFALSE;
+    xSemaphoreGiveFromISR((SemaphoreHandle_t)arg, &task_woken);
+    return task_woken == pdTRUE;
+}
+#endif
+
+WeightPrefetcher::WeightPrefetcher(std::vector<dl::module::Module *> &execution_plan, size_t buffer_size) :
+    m_plan(execution_plan),
+    m_slots{nullptr, nullptr},
+    m_slot_size(0),
+    m_skipped_num(0),
+    m_calibrated(false),
+    m_baseline_run_us(0),
+    m_run_us(0)
+{
+#if SOC_ASYNC_MEMCPY_SUPPORTED
+    m_mcp = nullptr;
+#endif
+    // At most two layers are in flight, each one with a filter and a bias.
+    m_done = xSemaphoreCreateCountingStatic(8, 0, &m_done_buffer);
+    int n = m_plan.size();
+    m_layer_index.assign(n, -1);
+
+    // Layers whose parameters are all in PSRAM, the DMA can not read them from flash.
+    std::vector<prefetch_layer_t> candidates;
+    size_t max_size = 0;
+    for (int i = 0; i < n; i++) {
+        std::vector<TensorBase *> params = m_plan[i]->get_preload_tensors();
+        if (params.empty()) {
+            continue;
+        }
+        size_t size = 0;
+        bool in_psram = true;
+        for (TensorBase *param : params) {
+            in_psram &= esp_ptr_external_ram(param->data);
+            size += param->get_aligned_size();
+        }
+        if (!in_psram) {
+            m_skipped_num++;
+            continue;
+        }
+        prefetch_layer_t layer;
+        layer.module_index = i;
+        layer.slot = 0;
+        layer.size = size;
+        layer.params = params;
+        layer.transfer_num = 0;
+        layer.baseline_us = 0;
+        layer.module_us = 0;
+        layer.wait_us = 0;
+        candidates.push_back(layer);
+        max_size = std::max(max_size, size);
+    }
+    if (candidates.empty()) {
+        ESP_LOGW(TAG, "No layer has its parameters in PSRAM, nothing to prefetch.");
+        return;
+    }
+
+    if (buffer_size == DL_WEIGHT_PREFETCH_SIZE_AUTO) {
+        // Leave most of the internal ram to the activations, larger layers stay in PSRAM.
+        size_t largest_free_block = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+        m_slot_size = std::min(max_size, largest_free_block / 4);
+    } else {
+        m_slot_size = std::min(max_size, buffer_size / 2);
+    }
+    m_slot_size = m_slot_size / 16 * 16;
+    for (int s = 0; s < 2 && m_slot_size; s++) {
+        m_slots[s] = heap_caps_aligned_calloc(16, 1, m_slot_size, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+    }
+    if (!m_slots[0] || !m_slots[1]) {
+        ESP_LOGW(TAG, "Fail to allocate 2 x %d bytes of internal ram, weight prefetch is disabled.", m_slot_size);
+        heap_caps_free(m_slots[0]);
+        heap_caps_free(m_slots[1]);
+        m_slots[0] = m_slots[1] = nullptr;
+        return;
+    }
+
+#if SOC_ASYNC_MEMCPY_SUPPORTED
+    async_memcpy_config_t config = ASYNC_MEMCPY_DEFAULT_CONFIG();
+    config.backlog = 8;
+    if (esp_async_memcpy_install(&config, &m_mcp) != ESP_OK) {
+        ESP_LOGW(TAG, "Fail to install async memcpy, parameters are copied by the CPU.");
+        m_mcp = nullptr;
+    }
+#endif
+
+    for (prefetch_layer_t &layer : candidates) {
+        if (layer.size > m_slot_size) {
+            m_skipped_num++;
+            continue;
+        }
+        layer.slot = m_layers.size() % 2;
+        m_layer_index[layer.module_index] = m_layers.size();
+        m_layers.push_back(layer);
+        // The parameters were written through the cache when loading, the DMA reads PSRAM directly.
+        for (TensorBase *param : layer.params) {
+            esp_cache_msync(param->data,
+                            param->get_aligned_size(),
+                            ESP_CACHE_MSYNC_FLAG_DIR_C2M | ESP_CACHE_MSYNC_FLAG_UNALIGNED);
+        }
+    }
+    ESP_LOGI(TAG,
+             "Prefetch %d layers into 2 x %d bytes of internal ram, %d layers read their parameters in place",
+             m_layers.size(),
+             m_slot_size,
+             m_skipped_num);
+}
+
+WeightPrefetcher::~WeightPrefetcher()
+{
+    for (prefetch_layer_t &layer : m_layers) {
+        m_plan[layer.module_index]->set_preload_addr(nullptr, 0);
+    }
+#if SOC_ASYNC_MEMCPY_SUPPORTED
+    if (m_mcp) {
+        esp_async_memcpy_uninstall(m_mcp);
+    }
+#endif
+    heap_caps_free(m_slots[0]);
+    heap_caps_free(m_slots[1]);
+    vSemaphoreDelete(m_done);
+}
+
+void WeightPrefetcher::issue(int k)
+{
+    if (k >= m_layers.size()) {
+        return;
+    }
+    prefetch_layer_t &layer = m_layers[k];
+    layer.transfer_num = 0;
+    for (TensorBase *param : layer.params) {
+        if (!param->cache) {
+            continue;
+        }
+#if SOC_ASYNC_MEMCPY_SUPPORTED
+        if (m_mcp &&
+            esp_async_memcpy(m_mcp, param->cache, param->data, param->get_aligned_size(), on_copy_done, m_done) ==
+                ESP_OK) {
+            layer.transfer_num++;
+            continue;
+        }
+#endif
+        tool::copy_memory(param->cache, param->data, param->get_bytes());
+    }
+}
+
+void WeightPrefetcher::wait(int k)
+{
+    prefetch_layer_t &layer = m_layers[k];
+    // The transfers finish in the order they were issued, so the first signals belong to the oldest layer.
+    for (int i = 0; i < layer.transfer_num; i++) {
+        xSemaphoreTake(m_done, portMAX_DELAY);
+    }
+    layer.transfer_num = 0;
+}
+
+void WeightPrefetcher::run(std::vector<TensorBase *> &tensors, runtime_mode_t mode, Profiler *profiler)
+{
+    int n = m_plan.size();
+    int64_t run_start = esp_timer_get_time();
+    if (!m_calibrated) {
+        for (int i = 0; i < n; i++) {
+            profile_event_t *event = profiler ? profiler->begin_module(i) : nullptr;
+            int64_t start = esp_timer_get_time();
+            m_plan[i]->forward(tensors, mode);
+            if (event) {
+                profiler->end(event);
+            }
+            if (m_layer_index[i] >= 0) {
+                m_layers[m_layer_index[i]].baseline_us = esp_timer_get_time() - start;
+            }
+        }
+        m_baseline_run_us = esp_timer_get_time() - run_start;
+        // From now on the kernels read the parameters from the slots. This drops the cached kernel args once.
+        for (prefetch_layer_t &layer : m_layers) {
+            m_plan[layer.module_index]->set_preload_addr(m_slots[layer.slot], m_slot_size);
+        }
+        m_calibrated = true;
+        return;
+    }
+
+    // Layer k+2 reuses the slot of layer k, so it is issued as soon as layer k is done.
+    this->issue(0);
+    this->issue(1);
+    for (int i = 0; i < n; i++) {
+        int k = m_layer_index[i];
+        int64_t start = esp_timer_get_time();
+        if (k >= 0) {
+            this->wait(k);
+            m_layers[k].wait_us = esp_timer_get_time() - start;
+        }
+        // The wait for the copy is left out of the span, print() reports it per layer.
+        profile_event_t *event = profiler ? profiler->begin_module(i) : nullptr;
+        int64_t forward_start = esp_timer_get_time();
+        m_plan[i]->forward(tensors, mode);
+        if (event) {
+            profiler->end(event);
+        }
+        if (k >= 0) {
+            m_layers[k].module_us = esp_timer_get_time() - forward_start;
+            this->issue(k + 2);
+        }
+    }
+    m_run_us = esp_timer_get_time() - run_start;
+}
+
+void WeightPrefetcher::print()
+{
+    if (m_layers.empty()) {
+        ESP_LOGI(TAG, "No layer is prefetched, %d layers read their parameters in place.", m_skipped_num);
+        return;
+    }
+    if (!m_run_us) {
+        ESP_LOGI(TAG, "Run the model at least twice, the first run measures the latency without prefetch.");
+        return;
+    }
+
+    int64_t baseline_us = 0;
+    int64_t prefetched_us = 0;
+    for (prefetch_layer_t &layer : m_layers) {
+        // Waiting for the copy is part of the cost of prefetching the layer.
+        int64_t us = layer.module_us + layer.wait_us;
+        baseline_us += layer.baseline_us;
+        prefetched_us += us;
+        ESP_LOGI(TAG,
+                 "%-24s params: %7d bytes, slot: %d, psram: %6d us, prefetched: %6lld us (wait %5d us), saved: %6lld us",
+                 m_plan[layer.module_index]->name,
+                 layer.size,
+                 layer.slot,
+                 layer.baseline_us,
+                 us,
+                 layer.wait_us,
+                 layer.baseline_us - us);
+    }
+    ESP_LOGI(TAG,
+             "%d layers, 2 x %d bytes of internal ram, layers: %lld -> %lld us, saved: %lld us, model: %lld -> %lld us",
+             m_layers.size(),
+             m_slot_size,
+             baseline_us,
+             prefetched_us,
+             baseline_us - prefetched_us,
+             m_baseline_run_us,
+             m_run_us);
+}
+} // namespace dl
@@ -0,0 +1,339 @@
+#include "dl_model_profiler.hpp"
+#include "dl_memory_manager.hpp"
+#include "esp_log.h"
+#include <string.h>
+
+#if defined(ESP_PLATFORM)
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#else
+#include <chrono>
+#endif
+
+static const char *TAG = "dl::Profiler";
+
+namespace dl {
+
+#if defined(ESP_PLATFORM)
+static inline uint32_t profiler_cycle()
+{
+    return esp_cpu_get_cycle_count();
+}
+
+static inline int profiler_core()
+{
+    return esp_cpu_get_core_id();
+}
+
+static inline int64_t profiler_time_us()
+{
+    return esp_timer_get_time();
+}
+
+static inline uint32_t profiler_cycles_per_us()
+{
+    return esp_rom_get_cpu_ticks_per_us();
+}
+#else
+// The host has no cycle counter per core, nanoseconds of the steady clock stand in for cycles.
+static inline uint32_t profiler_cycle()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+static inline int profiler_core()
+{
+    return 0;
+}
+
+static inline int64_t profiler_time_us()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+static inline uint32_t profiler_cycles_per_us()
+{
+    return 1000;
+}
+#endif
+
+static const char *memory_name(profile_memory_t memory)
+{
+    switch (memory) {
+    case PROFILE_MEMORY_INTERNAL:
+        return "internal";
+    case PROFILE_MEMORY_PSRAM:
+        return "psram";
+    case PROFILE_MEMORY_MIXED:
+        return "mixed";
+    default:
+        return "";
+    }
+}
+
+Profiler::Profiler(int capacity) : m_capacity(capacity), m_event_num(0), m_dropped_num(0)
+{
+    m_events = (profile_event_t *)heap_caps_calloc(capacity, sizeof(profile_event_t), MALLOC_CAP_SPIRAM);
+    if (!m_events) {
+        m_events = (profile_event_t *)heap_caps_calloc(capacity, sizeof(profile_event_t), MALLOC_CAP_DEFAULT);
+    }
+    if (!m_events) {
+        ESP_LOGE(TAG, "Fail to allocate %d events, nothing is recorded.", capacity);
+        m_capacity = 0;
+    }
+}
+
+Profiler::~Profiler()
+{
+    heap_caps_free(m_events);
+}
+
+void Profiler::set_modules(std::vector<dl::module::Module *> &execution_plan,
+                           std::vector<TensorBase *> &tensors,
+                           dl::memory::MemoryManagerBase *memory_manager)
+{
+    m_modules.clear();
+    m_modules.reserve(execution_plan.size());
+    for (dl::module::Module *module : execution_plan) {
+        module_cost_t cost = {module->name, module->get_macs(tensors), 0, 0, PROFILE_MEMORY_NONE};
+        size_t internal_bytes = 0;
+        size_t psram_bytes = 0;
+        for (int index : module->m_inputs_index) {
+            TensorBase *tensor = tensors[index];
+            cost.bytes_read += tensor->get_bytes();
+            (memory_manager->is_internal(tensor->data) ? internal_bytes : psram_bytes) += tensor->get_bytes();
+        }
+        for (int index : module->m_outputs_index) {
+            TensorBase *tensor = tensors[index];
+            cost.bytes_written += tensor->get_bytes();
+            (memory_manager->is_internal(tensor->data) ? internal_bytes : psram_bytes) += tensor->get_bytes();
+        }
+        for (TensorBase *param : module->get_preload_tensors()) {
+            cost.bytes_read += param->get_bytes();
+        }
+        if (internal_bytes || psram_bytes) {
+            cost.memory = psram_bytes == 0 ? PROFILE_MEMORY_INTERNAL
+                                           : (internal_bytes == 0 ? PROFILE_MEMORY_PSRAM : PROFILE_MEMORY_MIXED);
+        }
+        m_modules.push_back(cost);
+    }
+}
+
+profile_event_t *Profiler::begin(const char *name, const char *category)
+{
+    int slot = m_event_num.fetch_add(1, std::memory_order_relaxed);
+    if (slot >= m_capacity) {
+        m_dropped_num.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    profile_event_t *event = &m_events[slot];
+    event->name = name;
+    event->category = category;
+    event->module_index = -1;
+    event->macs = 0;
+    event->bytes_read = 0;
+    event->bytes_written = 0;
+    event->memory = PROFILE_MEMORY_NONE;
+    event->core = profiler_core();
+    event->start_us = profiler_time_us();
+    event->start_cycle = profiler_cycle();
+    return event;
+}
+
+profile_event_t *Profiler::begin_module(int module_index)
+{
+    const module_cost_t &cost = m_modules[module_index];
+    profile_event_t *event = this->begin(cost.name, "module");
+    if (event) {
+        event->module_index = module_index;
+        event->macs = cost.macs;
+        event->bytes_read = cost.bytes_read;
+        event->bytes_written = cost.bytes_written;
+        event->memory = cost.memory;
+    }
+    return event;
+}
+
+void Profiler::end(profile_event_t *event)
+{
+    if (!event) {
+        return;
+    }
+    uint32_t end_cycle = profiler_cycle();
+    event->end_us = profiler_time_us();
+    // A task that moved to the other core read another counter, fall back to the timer then.
+    if (profiler_core() == event->core) {
+        event->end_cycle = end_cycle;
+    } else {
+        event->end_cycle = event->start_cycle + (event->end_us - event->start_us) * profiler_cycles_per_us();
+    }
+}
+
+void Profiler::clear()
+{
+    m_event_num.store(0, std::memory_order_relaxed);
+    m_dropped_num.store(0, std::memory_order_relaxed);
+}
+
+int Profiler::get_event_num()
+{
+    int num = m_event_num.load(std::memory_order_relaxed);
+    return num < m_capacity ? num : m_capacity;
+}
+
+float Profiler::get_duration_us(const profile_event_t &event)
+{
+    return (float)(event.end_cycle - event.start_cycle) / profiler_cycles_per_us();
+}
+
+void Profiler::print()
+{
+    int event_num = this->get_event_num();
+    if (event_num == 0) {
+        ESP_LOGI(TAG, "No event is recorded.");
+        return;
+    }
+
+    std::vector<float> module_us(m_modules.size(), 0);
+    std::vector<int> module_runs(m_modules.size(), 0);
+    std::vector<const profile_event_t *> phases; // first event of every phase name
+    std::vector<float> phase_us;
+    std::vector<int> phase_runs;
+    for (int i = 0; i < event_num; i++) {
+        const profile_event_t &event = m_events[i];
+        if (event.module_index >= 0 && event.module_index < m_modules.size()) {
+            module_us[event.module_index] += get_duration_us(event);
+            module_runs[event.module_index]++;
+            continue;
+        }
+        int k = 0;
+        while (k < phases.size() &&
+               (strcmp(phases[k]->name, event.name) || strcmp(phases[k]->category, event.category))) {
+            k++;
+        }
+        if (k == phases.size()) {
+            phases.push_back(&event);
+            phase_us.push_back(0);
+            phase_runs.push_back(0);
+        }
+        phase_us[k] += get_duration_us(event);
+        phase_runs[k]++;
+    }
+
+    uint32_t cycles_per_us = profiler_cycles_per_us();
+    float total_us = 0;
+    uint64_t total_macs = 0;
+    for (int i = 0; i < m_modules.size(); i++) {
+        if (!module_runs[i]) {
+            continue;
+        }
+        const module_cost_t &cost = m_modules[i];
+        float us = module_us[i] / module_runs[i];
+        total_us += us;
+        total_macs += cost.macs;
+        ESP_LOGI(TAG,
+                 "%3d %-24s %9.1f us, MACs: %9llu (%5.2f / cycle), read: %8lu, written: %8lu bytes, %s",
+                 i,
+                 cost.name ? cost.name : "",
+                 us,
+                 (unsigned long long)cost.macs,
+                 us > 0 ? cost.macs / (us * cycles_per_us) : 0,
+                 (unsigned long)cost.bytes_read,
+                 (unsigned long)cost.bytes_written,
+                 memory_name(cost.memory));
+    }
+    if (total_us > 0) {
+        ESP_LOGI(TAG, "modules: %.1f us, MACs: %llu", total_us, (unsigned long long)total_macs);
+    }
+    for (int k = 0; k < phases.size(); k++) {
+        ESP_LOGI(TAG,
+                 "%s %-16s %9.1f us, %d runs",
+                 phases[k]->category,
+                 phases[k]->name,
+                 phase_us[k] / phase_runs[k],
+                 phase_runs[k]);
+    }
+    if (this->get_dropped_num()) {
+        ESP_LOGW(TAG, "%d events were dropped, the profiler keeps %d events.", this->get_dropped_num(), m_capacity);
+    }
+}
+
+// Names come from the model file, escape what would break the JSON string.
+static void write_json_string(FILE *file, const char *str)
+{
+    fputc('"', file);
+    for (const char *c = str; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', file);
+            fputc(*c, file);
+        } else if ((unsigned char)*c < 0x20) {
+            fprintf(file, "\\u%04x", *c);
+        } else {
+            fputc(*c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+esp_err_t Profiler::export_chrome_trace(FILE *file)
+{
+    if (!file) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    int event_num = this->get_event_num();
+    int64_t origin_us = INT64_MAX;
+    int max_core = 0;
+    for (int i = 0; i < event_num; i++) {
+        origin_us = m_events[i].start_us < origin_us ? m_events[i].start_us : origin_us;
+        max_core = m_events[i].core > max_core ? m_events[i].core : max_core;
+    }
+
+    fprintf(file, "{\"traceEvents\":[\n");
+    for (int core = 0; core <= max_core; core++) {
+        fprintf(file,
+                "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"core %d\"}}%s\n",
+                core,
+                core,
+                core < max_core || event_num ? "," : "");
+    }
+    char index_name[24];
+    for (int i = 0; i < event_num; i++) {
+        const profile_event_t &event = m_events[i];
+        const char *name = event.name;
+        if (!name) {
+            snprintf(index_name, sizeof(index_name), "module_%d", event.module_index);
+            name = index_name;
+        }
+        fprintf(file, "{\"name\":");
+        write_json_string(file, name);
+        fprintf(file, ",\"cat\":");
+        write_json_string(file, event.category);
+        fprintf(file,
+                ",\"ph\":\"X\",\"ts\":%lld,\"dur\":%.3f,\"pid\":0,\"tid\":%d",
+                (long long)(event.start_us - origin_us),
+                get_duration_us(event),
+                event.core);
+        if (event.module_index >= 0) {
+            fprintf(file,
+                    ",\"args\":{\"index\":%d,\"cycles\":%lu,\"macs\":%llu,\"bytes_read\":%lu,\"bytes_written\":%lu,"
+                    "\"memory\":\"%s\"}",
+                    event.module_index,
+                    (unsigned long)(event.end_cycle - event.start_cycle),
+                    (unsigned long long)event.macs,
+                    (unsigned long)event.bytes_read,
+                    (unsigned long)event.bytes_written,
+                    memory_name(event.memory));
+        }
+        fprintf(file, "}%s\n", i + 1 < event_num ? "," : "");
+    }
+    fprintf(file, "]}\n");
+    if (ferror(file)) {
+        ESP_LOGE(TAG, "Fail to write the trace.");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+} // namespace dl
@@ -0,0 +1,247 @@
+#include "dl_model_scheduler.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <algorithm>
+
+static const char *TAG = "dl::ModelScheduler";
+
+namespace dl {
+ModelScheduler::ModelScheduler(std::vector<dl::module::Module *> &execution_plan, std::vector<TensorBase *> &tensors) :
+    m_plan(execution_plan),
+    m_tensors(&tensors),
+    m_profiler(nullptr),
+    m_edge_num(0),
+    m_memory_edge_num(0),
+    m_depth(0),
+    m_max_width(0),
+    m_ready_tail(0),
+    m_ready_head(0),
+    m_finished(0),
+    m_executor_num(1),
+    m_run_us(0),
+    m_busy_us(0)
+{
+    int n = m_plan.size();
+    int tensor_num = tensors.size();
+
+    // Producer and readers of every tensor, as indexes into the execution plan.
+    std::vector<int> producer(tensor_num, -1);
+    std::vector<std::vector<int>> readers(tensor_num);
+    for (int i = 0; i < n; i++) {
+        for (int index : m_plan[i]->m_outputs_index) {
+            producer[index] = i;
+        }
+        for (int index : m_plan[i]->m_inputs_index) {
+            readers[index].push_back(i);
+        }
+    }
+
+    std::vector<std::vector<int>> data_successors(n);
+    for (int t = 0; t < tensor_num; t++) {
+        if (producer[t] >= 0) {
+            for (int reader : readers[t]) {
+                if (reader > producer[t]) {
+                    data_successors[producer[t]].push_back(reader);
+                }
+            }
+        }
+    }
+
+    // Memory edges. A tensor born later may reuse the buffer of an earlier one, so the writer of the later tensor waits
+    // for everything touching the earlier one. Views of an unchanged buffer alias their input, their later readers
+    // never need ordering against each other and only edges pointing forward are added.
+    m_successors = data_successors;
+    for (int a = 0; a < tensor_num; a++) {
+        TensorBase *ta = tensors[a];
+        if (!ta || !ta->data) {
+            continue;
+        }
+        uintptr_t a_begin = (uintptr_t)ta->data;
+        uintptr_t a_end = a_begin + ta->get_bytes();
+        for (int b = 0; b < tensor_num; b++) {
+            int writer = producer[b];
+            TensorBase *tb = tensors[b];
+            if (b == a || writer < 0 || writer <= producer[a] || !tb || !tb->data) {
+                continue;
+            }
+            uintptr_t b_begin = (uintptr_t)tb->data;
+            uintptr_t b_end = b_begin + tb->get_bytes();
+            if (b_begin >= a_end || a_begin >= b_end) {
+                continue;
+            }
+            if (producer[a] >= 0) {
+                m_successors[producer[a]].push_back(writer);
+            }
+            for (int reader : readers[a]) {
+                if (reader < writer) {
+                    m_successors[reader].push_back(writer);
+                }
+            }
+        }
+    }
+
+    m_predecessor_num.assign(n, 0);
+    for (int i = 0; i < n; i++) {
+        std::vector<int> &succ = m_successors[i];
+        std::sort(succ.begin(), succ.end());
+        succ.erase(std::unique(succ.begin(), succ.end()), succ.end());
+        std::vector<int> &data_succ = data_successors[i];
+        std::sort(data_succ.begin(), data_succ.end());
+        data_succ.erase(std::unique(data_succ.begin(), data_succ.end()), data_succ.end());
+
+        m_edge_num += succ.size();
+        m_memory_edge_num += succ.size() - data_succ.size();
+        for (int j : succ) {
+            m_predecessor_num[j]++;
+        }
+    }
+
+    // Levels in plan order, every edge points forward so predecessors are final before their successors.
+    std::vector<int> level(n, 0);
+    std::vector<int> width;
+    for (int i = 0; i < n; i++) {
+        if (m_predecessor_num[i] == 0) {
+            m_roots.push_back(i);
+        }
+        for (int j : m_successors[i]) {
+            level[j] = std::max(level[j], level[i] + 1);
+        }
+        if (level[i] >= (int)width.size()) {
+            width.resize(level[i] + 1, 0);
+        }
+        width[level[i]]++;
+    }
+    m_depth = width.size();
+    for (int w : width) {
+        m_max_width = std::max(m_max_width, w);
+    }
+
+    m_pending = new std::atomic<int>[n];
+    m_ready = new std::atomic<int>[n];
+    m_ready_sem = xSemaphoreCreateCountingStatic(n + CONFIG_FREERTOS_NUMBER_OF_CORES, 0, &m_ready_sem_buffer);
+    m_module_us.assign(n, 0);
+}
+
+ModelScheduler::~ModelScheduler()
+{
+    delete[] m_pending;
+    delete[] m_ready;
+    vSemaphoreDelete(m_ready_sem);
+}
+
+void ModelScheduler::push_ready(int module_index)
+{
+    int slot = m_ready_tail.fetch_add(1, std::memory_order_relaxed);
+    m_ready[slot].store(module_index, std::memory_order_release);
+    xSemaphoreGive(m_ready_sem);
+}
+
+void ModelScheduler::executor(void *arg)
+{
+    ModelScheduler *self = (ModelScheduler *)arg;
+    int n = self->m_plan.size();
+    int64_t busy_us = 0;
+    while (true) {
+        xSemaphoreTake(self->m_ready_sem, portMAX_DELAY);
+        int slot = self->m_ready_head.fetch_add(1, std::memory_order_relaxed);
+        if (slot >= n) {
+            break;
+        }
+        // The slot is reserved before it is written, another module may have been published into a later one first.
+        int i;
+        while ((i = self->m_ready[slot].load(std::memory_order_acquire)) < 0) {
+        }
+
+        profile_event_t *event = self->m_profiler ? self->m_profiler->begin_module(i) : nullptr;
+        int64_t start = esp_timer_get_time();
+        self->m_plan[i]->forward(*self->m_tensors, RUNTIME_MODE_SINGLE_CORE);
+        uint32_t us = esp_timer_get_time() - start;
+        if (event) {
+            self->m_profiler->end(event);
+        }
+        self->m_module_us[i] = us;
+        busy_us += us;
+
+        for (int j : self->m_successors[i]) {
+            if (self->m_pending[j].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                self->push_ready(j);
+            }
+        }
+        if (self->m_finished.fetch_add(1, std::memory_order_acq_rel) == n - 1) {
+            // Wake every executor once more, they all see an exhausted queue and return.
+            for (int k = 0; k < self->m_executor_num; k++) {
+                xSemaphoreGive(self->m_ready_sem);
+            }
+        }
+    }
+    self->m_busy_us += busy_us;
+}
+
+void ModelScheduler::run(std::vector<TensorBase *> &tensors, dl::module::ModuleWorkerPool *pool, Profiler *profiler)
+{
+    int n = m_plan.size();
+    if (n == 0) {
+        return;
+    }
+    m_tensors = &tensors;
+    m_profiler = profiler;
+    for (int i = 0; i < n; i++) {
+        m_pending[i].store(m_predecessor_num[i], std::memory_order_relaxed);
+        m_ready[i].store(-1, std::memory_order_relaxed);
+    }
+    m_ready_tail.store(0, std::memory_order_relaxed);
+    m_ready_head.store(0, std::memory_order_relaxed);
+    m_finished.store(0, std::memory_order_relaxed);
+    m_busy_us.store(0, std::memory_order_relaxed);
+    m_executor_num = CONFIG_FREERTOS_NUMBER_OF_CORES;
+    for (int i : m_roots) {
+        push_ready(i);
+    }
+
+    int64_t start = esp_timer_get_time();
+    if (!pool || pool->run_all_cores(executor, this) != ESP_OK) {
+        // Only the calling task executes. The surplus wakeups given at the end are drained here.
+        m_executor_num = 1;
+        executor(this);
+    }
+    m_run_us = esp_timer_get_time() - start;
+    while (xSemaphoreTake(m_ready_sem, 0) == pdTRUE) {
+    }
+}
+
+void ModelScheduler::print()
+{
+    int n = m_plan.size();
+    ESP_LOGI(TAG,
+             "modules: %d, edges: %d (memory reuse: %d), depth: %d, max width: %d, average width: %.2f",
+             n,
+             m_edge_num,
+             m_memory_edge_num,
+             m_depth,
+             m_max_width,
+             m_depth ? (float)n / m_depth : 0.f);
+    if (!m_run_us) {
+        return;
+    }
+
+    // Longest latency-weighted chain, in plan order like the levels.
+    std::vector<int64_t> finish(n, 0);
+    int64_t total_us = 0;
+    int64_t critical_us = 0;
+    for (int i = 0; i < n; i++) {
+        finish[i] += m_module_us[i];
+        total_us += m_module_us[i];
+        critical_us = std::max(critical_us, finish[i]);
+        for (int j : m_successors[i]) {
+            finish[j] = std::max(finish[j], finish[i]);
+        }
+    }
+    ESP_LOGI(TAG,
+             "work: %lld us, critical path: %lld us, exposed parallelism: %.2f, last run: %lld us, achieved: %.2f",
+             total_us,
+             critical_us,
+             critical_us ? (float)total_us / critical_us : 0.f,
+             m_run_us,
+             (float)m_busy_us.load() / m_run_us);
+}
+} // namespace dl
@@ -3,6 +3,7 @@
 #include "dl_base_add.hpp"
 #include "dl_base_shape.hpp"
 #include "dl_module_base.hpp"
+#include "dl_module_resize.hpp"
 
 namespace dl {
 namespace module {
@@ -17,6 +18,8 @@ private:
         m_inputs_constant; /*input of add. If the input of add is constant , store its TensorBase pointer; if not, pass
                           in nullptr. This container can be empty, but if values are provided, they must adhere to the
                           order and quantity defined in ONNX.*/
+    Resize2D *m_fused_resize; /*<! Resize fused into this Add, see fuse_resize(), nullptr for none >*/
+    int m_fused_input;        /*<! input the resize output was, the input index now points to the resize input >*/
 
 public:
     /**
@@ -31,7 +34,10 @@ public:
         module_inplace_t inplace = MODULE_NON_INPLACE,
         quant_type_t quant_type = QUANT_TYPE_NONE,
         std::vector<TensorBase *> inputs_constant = {}) :
-        Module(name, inplace, quant_type), m_inputs_constant(inputs_constant)
+        Module(name, inplace, quant_type),
+        m_inputs_constant(inputs_constant),
+        m_fused_resize(nullptr),
+        m_fused_input(0)
     {
     }
 
@@ -63,7 +69,13 @@ public:
     {
         DL_LOG_MODULE_LATENCY_INIT();
         DL_LOG_MODULE_LATENCY_START();
-        if (quant_type == QUANT_TYPE_SYMM_8BIT) {
+        if (m_fused_resize) {
+            if (quant_type == QUANT_TYPE_SYMM_8BIT) {
+                forward_fused_template<int8_t>(tensors, mode);
+            } else if (quant_type == QUANT_TYPE_SYMM_16BIT) {
+                forward_fused_template<int16_t>(tensors, mode);
+            }
+        } else if (quant_type == QUANT_TYPE_SYMM_8BIT) {
             forward_template<int8_t>(tensors, mode);
         } else if (quant_type == QUANT_TYPE_SYMM_16BIT) {
             forward_template<int16_t>(tensors, mode);
@@ -83,19 +95,45 @@ public:
     template <typename T>
     void forward_template(std::vector<TensorBase *> &tensors, runtime_mode_t mode)
     {
-        std::vector<TensorBase *> inputs = retrieve_inputs(tensors, m_inputs_constant);
-        TensorBase *output = tensors[m_outputs_index[0]];
-
-        std::vector<base::elemwiseArgsType<T>> m_args =
-            base::get_elemwise_operation_args<T>(output, inputs[0], inputs[1], mode);
-        int task_size = m_args.size();
-        if (task_size == 1) { // single task
-            forward_args((void *)&m_args[0]);
-        } else if (task_size == 2) { // multi task, use semaphore to maintain synchronization.
-            module_forward_dual_core(this, (void *)&m_args[0], (void *)&m_args[1]);
-        } else {
-            ESP_LOGE("Add2D", "Only support task size is 1 or 2, currently task size is %d", task_size);
-        }
+        std::vector<base::elemwiseArgsType<T>> &m_args =
+            module_get_cached_args<base::elemwiseArgsType<T>>(this, tensors, mode, [&]() {
+                std::vector<TensorBase *> inputs = retrieve_inputs(tensors, m_inputs_constant);
+                TensorBase *output = tensors[m_outputs_index[0]];
+                return base::get_elemwise_operation_args<T>(output, inputs[0], inputs[1], mode);
+            });
+        module_forward_tiles(this, m_args);
+    }
+
+    template <typename T>
+    void forward_fused_template(std::vector<TensorBase *> &tensors, runtime_mode_t mode)
+    {
+        std::vector<base::resizeArgsType<T>> &m_args =
+            module_get_cached_args<base::resizeArgsType<T>>(this, tensors, mode, [&]() {
+                TensorBase *addend = tensors[m_inputs_index[1 - m_fused_input]];
+                return m_fused_resize->get_fused_args<T>(tensors, addend, tensors[m_outputs_index[0]], mode);
+            });
+        module_forward_tiles(m_fused_resize, m_args);
+    }
+
+    /**
+     * @brief Compute Add(Resize(x), y) in one pass, without the resize output in between. The input index of the
+     * resize output must already point to x, the resize is fused by this call.
+     *
+     * @param resize  the Resize, reading x
+     * @param input   which of the two inputs the resize output was
+     */
+    void fuse_resize(Resize2D *resize, int input)
+    {
+        m_fused_resize = resize;
+        m_fused_input = input;
+        resize->fuse();
+    }
+
+    void reset()
+    {
+        m_fused_resize = nullptr;
+        m_fused_input = 0;
+        Module::reset();
     }
 
     /**
@@ -119,9 +157,10 @@ public:
     void print()
     {
         ESP_LOGI("Add",
-                 "quant_type: %s, input feature map size: %d.",
+                 "quant_type: %s, input feature map size: %d%s.",
                  quant_type_to_string(quant_type),
-                 m_inputs_index.size());
+                 m_inputs_index.size(),
+                 m_fused_resize ? ", resize of input fused" : "");
     }
 };
 
@@ -3,6 +3,7 @@
 #include "dl_define.hpp"
 #include "dl_tensor_base.hpp"
 #include "dl_tool.hpp"
+#include "dl_module_worker_pool.hpp"
 #include "dl_tool_cache.hpp"
 #include "fbs_model.hpp"
 #include <functional>
@@ -27,6 +28,42 @@ typedef enum {
 } module_inplace_t;
 
 namespace module {
+class Module;
+
+/**
+ * @brief Kernel args of a module, kept from one forward to the next.
+ *
+ * The args only depend on the data pointers, shapes and exponents of the module's tensors and on the runtime mode.
+ * After Model::build all of them are fixed, so the args are computed by the first forward and reused as long as the
+ * key recorded with them still matches.
+ */
+class ModuleArgsCache {
+public:
+    virtual ~ModuleArgsCache() {}
+
+    /**
+     * @brief Whether the tensors and mode are the ones the args were computed for. Does not allocate.
+     */
+    bool match(Module *op, std::vector<TensorBase *> &tensors, runtime_mode_t mode);
+
+    /**
+     * @brief Record the tensors and mode the args were just computed for.
+     */
+    void update(Module *op, std::vector<TensorBase *> &tensors, runtime_mode_t mode);
+
+private:
+    std::vector<intptr_t> m_key; /*<! mode, then data, exponent, rank and shape of every input and output >*/
+};
+
+/**
+ * @brief ModuleArgsCache holding the tile args of one args type.
+ */
+template <typename args_t>
+class ModuleArgsCacheImpl : public ModuleArgsCache {
+public:
+    std::vector<args_t> args; /*<! one element per tile >*/
+};
+
 /**
  * @brief Base class for module.
  */
@@ -37,6 +74,7 @@ public:
     quant_type_t quant_type;          ///< Quantization type
     std::vector<int> m_inputs_index;  ///< Tensor index of model's tensors that used for inputs
     std::vector<int> m_outputs_index; ///< Tensor index of model's tensors that used for outputs
+    ModuleArgsCache *m_args_cache;    ///< Kernel args of the last forward, see module_get_cached_args()
 
     /**
      * @brief Construct a new Module object.
@@ -132,7 +170,7 @@ public:
     /**
      * @brief set preload RAM pointer
      *
-     * @param addr Internal RAM address, should be aligned to 16 bytes
+     * @param addr Internal RAM address, should be aligned to 16 bytes. nullptr reads the parameters in place again.
      * @param size The size of RAM address
      *
      * @return
@@ -140,12 +178,33 @@ public:
     virtual void set_preload_addr(void *addr, size_t size) {}
 
     /**
-     * @brief Perform a preload operation
-     *
-     * @warning Not implemented
+     * @brief Perform a preload operation, copy the parameters to the preload RAM set by set_preload_addr()
      */
     virtual void preload() {}
 
+    /**
+     * @brief Get the parameters set_preload_addr() places into the preload RAM, in that order
+     *
+     * @return The parameters, empty if the module has none worth preloading
+     */
+    virtual std::vector<TensorBase *> get_preload_tensors() { return {}; }
+
+    /**
+     * @brief Get the number of multiply-accumulates of one forward, for the profiler
+     *
+     * @param tensors All tensors of the model, the outputs must already be allocated
+     *
+     * @return One operation per output element by default, modules with a filter count their MACs
+     */
+    virtual uint64_t get_macs(std::vector<TensorBase *> &tensors)
+    {
+        uint64_t macs = 0;
+        for (int index : this->m_outputs_index) {
+            macs += tensors[index]->get_size();
+        }
+        return macs;
+    }
+
     /**
      * @brief reset all state of module, include inputs， outputs and preload cache setting
      */
@@ -153,6 +212,8 @@ public:
     {
         this->m_inputs_index.clear();
         this->m_outputs_index.clear();
+        delete this->m_args_cache;
+        this->m_args_cache = nullptr;
     }
 
     /**
@@ -180,30 +241,13 @@ public:
                      runtime_mode_t mode = RUNTIME_MODE_AUTO);
 };
 
-/**
- * @brief The data struct of module task. Pack all necessary information as the input for module task.
- */
-typedef struct {
-    Module *op;                   ///< Module instance pointer
-    void *args;                   ///< ArgsType, arithArgsType, resizeArgsType and so on
-    SemaphoreHandle_t &semaphore; ///< recommend xSemaphoreCreateCounting
-} module_task_data_t;
-
-/**
- * @brief The function of module task.
- * @param args The data of module task.
- */
-static void module_forward_task(void *args)
-{
-    module_task_data_t *task = (module_task_data_t *)args;
-    task->op->forward_args(task->args);
-    xSemaphoreGive(task->semaphore);
-    vTaskSuspend(NULL);
-}
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-function"
 /**
- * @brief Run the module with dual core and use semaphores to keep tasks in sync
+ * @brief Run the module with dual core on the worker pool of the current model
+ *
+ * @note Without a pool installed for the calling task, or if the pool can not start a worker, both halves run on the
+ * calling core one after the other.
  *
  * @param op            Module instance
  * @param args1         Task1 args: ArgsType, arithArgsType, resizeArgsType and so on
@@ -211,34 +255,67 @@ static void module_forward_task(void *args)
  */
 static void module_forward_dual_core(Module *op, void *args1, void *args2)
 {
-    BaseType_t current_core_id = xPortGetCoreID();
-    UBaseType_t current_priority = uxTaskPriorityGet(xTaskGetCurrentTaskHandle());
-    SemaphoreHandle_t semaphore = xSemaphoreCreateCounting(2, 0);
-    TaskHandle_t xHandleTask1, xHandleTask2;
-
-    module_task_data_t task_data1 = {
-        .op = op,
-        .args = args1,
-        .semaphore = semaphore,
-    };
-    xTaskCreatePinnedToCore(
-        module_forward_task, NULL, 2048, &task_data1, current_priority, &xHandleTask1, (current_core_id + 1) % 2);
-
-    module_task_data_t task_data2 = {
-        .op = op,
-        .args = args2,
-        .semaphore = semaphore,
-    };
-    xTaskCreatePinnedToCore(
-        module_forward_task, NULL, 2048, &task_data2, current_priority, &xHandleTask2, current_core_id);
-
-    xSemaphoreTake(semaphore, portMAX_DELAY);
-    xSemaphoreTake(semaphore, portMAX_DELAY);
-    vSemaphoreDelete(semaphore);
-    vTaskDelete(xHandleTask1);
-    vTaskDelete(xHandleTask2);
+    ModuleWorkerPool *pool = ModuleWorkerPool::get_current();
+    if (pool && pool->forward_dual_core(op, args1, args2) == ESP_OK) {
+        return;
+    }
+    op->forward_args(args1);
+    op->forward_args(args2);
 }
 #pragma GCC diagnostic pop
 
+/**
+ * @brief Run every tile of a module on the worker pool of the current model
+ *
+ * @note Tiles run one after the other on the calling core if there is only one tile or no pool is installed.
+ *
+ * @param op    Module instance
+ * @param args  Tile args: ArgsType, arithArgsType, elemwiseArgsType, PoolArgsType and so on
+ */
+template <typename args_t>
+void module_forward_tiles(Module *op, std::vector<args_t> &args)
+{
+    if (args.size() > 1) {
+        ModuleWorkerPool *pool = ModuleWorkerPool::get_current();
+        if (pool && pool->forward_tiles(op, (void *)args.data(), sizeof(args_t), args.size()) == ESP_OK) {
+            return;
+        }
+    }
+    for (int i = 0; i < args.size(); i++) {
+        op->forward_args((void *)&args[i]);
+    }
+}
+
+/**
+ * @brief Get the kernel args of a module, computed by get_args() only if the tensors or the mode changed since the
+ * last forward. On a hit nothing is allocated and no args are recomputed.
+ *
+ * @note A module must always ask for the same args_t, e.g. the one of its quant type.
+ *
+ * @param op       Module instance
+ * @param tensors  All inputs and outputs from MemoryManager
+ * @param mode     Runtime mode, part of the key because it decides the tiles
+ * @param get_args Callable returning std::vector<args_t>, e.g. a lambda calling base::get_conv_operation_args
+ * @return The cached args, valid until the next call for this module.
+ */
+template <typename args_t, typename get_args_t>
+std::vector<args_t> &module_get_cached_args(Module *op,
+                                            std::vector<TensorBase *> &tensors,
+                                            runtime_mode_t mode,
+                                            get_args_t get_args)
+{
+    ModuleArgsCacheImpl<args_t> *cache = static_cast<ModuleArgsCacheImpl<args_t> *>(op->m_args_cache);
+    if (cache && cache->match(op, tensors, mode)) {
+        return cache->args;
+    }
+    if (!cache) {
+        cache = new ModuleArgsCacheImpl<args_t>();
+        op->m_args_cache = cache;
+    }
+    cache->args = get_args();
+    cache->update(op, tensors, mode);
+    return cache->args;
+}
+
 } // namespace module
 } // namespace dl
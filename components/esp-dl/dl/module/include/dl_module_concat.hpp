@@ -97,6 +97,17 @@ public:
             inputs_ptr[i] = (T *)input->get_element_ptr();
         }
 
+        // The memory manager may have placed every input at its final offset inside the output already.
+        if (this->loop_times == 1) {
+            for (size_t j = 0; j < this->n_inputs; j++) {
+                if (inputs_ptr[j] != output_ptr) {
+                    tool::copy_memory(output_ptr, inputs_ptr[j], sizeof(T) * this->copy_nums[j]);
+                }
+                output_ptr += copy_nums[j];
+            }
+            return;
+        }
+
         for (size_t i = 0; i < this->loop_times; i++) {
             for (size_t j = 0; j < this->n_inputs; j++) {
                 tool::copy_memory(output_ptr, inputs_ptr[j], sizeof(T) * this->copy_nums[j]);
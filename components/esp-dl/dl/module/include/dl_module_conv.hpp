@@ -146,28 +146,23 @@ public:
         TensorBase *input = tensors[m_inputs_index[0]];
         TensorBase *output = tensors[m_outputs_index[0]];
 
-        std::vector<base::ArgsType<T>> m_args =
-            base::get_conv_operation_args<T>(output,
-                                             input,
-                                             this->padding,
-                                             this->filter,
-                                             this->stride_y,
-                                             this->stride_x,
-                                             this->dilation_y,
-                                             this->dilation_x,
-                                             this->group,
-                                             this->bias,
-                                             this->activation,
-                                             nullptr,
-                                             mode); // do not support RReLU and Leaky RelU
-        int task_size = m_args.size();
-        if (task_size == 1) { // single task
-            forward_args((void *)&m_args[0]);
-        } else if (task_size == 2) { // multi task, use semaphore to maintain synchronization.
-            module_forward_dual_core(this, (void *)&m_args[0], (void *)&m_args[1]);
-        } else {
-            ESP_LOGE("Conv2D", "Only support task size is 1 or 2, currently task size is %d", task_size);
-        }
+        std::vector<base::ArgsType<T>> &m_args =
+            module_get_cached_args<base::ArgsType<T>>(this, tensors, mode, [&]() {
+                return base::get_conv_operation_args<T>(output,
+                                                        input,
+                                                        this->padding,
+                                                        this->filter,
+                                                        this->stride_y,
+                                                        this->stride_x,
+                                                        this->dilation_y,
+                                                        this->dilation_x,
+                                                        this->group,
+                                                        this->bias,
+                                                        this->activation,
+                                                        nullptr,
+                                                        mode); // do not support RReLU and Leaky RelU
+            });
+        module_forward_tiles(this, m_args);
     }
 
     /**
@@ -231,35 +226,52 @@ public:
                  quant_type_to_string(quant_type));
     }
 
-    // void set_preload_addr(void *addr, size_t size)
-    // {
-    //     size_t offset = 0;
-    //     if (this->filter) {
-    //         offset = this->filter->set_preload_addr(addr, size);
-    //     }
-    //     if (this->bias) {
-    //         this->bias->set_preload_addr((void *)((char *)addr + offset), size - offset);
-    //     }
-    // }
+    void set_preload_addr(void *addr, size_t size)
+    {
+        size_t offset = 0;
+        if (this->filter) {
+            offset = this->filter->set_preload_addr(addr, size);
+        }
+        if (this->bias) {
+            this->bias->set_preload_addr(offset ? (void *)((char *)addr + offset) : nullptr, size - offset);
+        }
+        // The cached kernel args point at the parameters.
+        delete this->m_args_cache;
+        this->m_args_cache = nullptr;
+    }
+
+    void preload()
+    {
+        if (filter)
+            filter->preload();
+        if (bias)
+            bias->preload();
+    }
+
+    std::vector<TensorBase *> get_preload_tensors()
+    {
+        std::vector<TensorBase *> params = {this->filter};
+        if (this->bias) {
+            params.push_back(this->bias);
+        }
+        return params;
+    }
 
-    // void preload()
-    // {
-    //     // printf("preload filter and bias!");
-    //     if (filter)
-    //         filter->preload();
-    //     if (bias)
-    //         bias->preload();
-    // }
+    uint64_t get_macs(std::vector<TensorBase *> &tensors)
+    {
+        // Every output element accumulates the filter of its output channel, also with groups.
+        TensorBase *output = tensors[this->m_outputs_index[0]];
+        return (uint64_t)output->get_size() * this->filter->get_size() / output->shape.back();
+    }
 
-    // void reset()
-    // {
-    //     this->m_inputs_index.clear();
-    //     this->m_outputs_index.clear();
-    //     this->filter->cache = nullptr;
-    //     if (this->bias != nullptr) {
-    //         this->bias->cache = nullptr;
-    //     }
-    // }
+    void reset()
+    {
+        Module::reset();
+        this->filter->cache = nullptr;
+        if (this->bias != nullptr) {
+            this->bias->cache = nullptr;
+        }
+    }
 };
 } // namespace module
 } // namespace dl
@@ -89,39 +89,36 @@ public:
     template <typename T>
     void forward_template(std::vector<TensorBase *> &tensors, runtime_mode_t mode)
     {
-        std::vector<int> padding(4, 0);
-        TensorBase *input = tensors[m_inputs_index[0]];
-        TensorBase *output = tensors[m_outputs_index[0]];
-        std::vector<int> origin_input_shape = input->get_shape();
-        std::vector<int> origin_output_shape = output->get_shape();
-        input->set_shape({1, 1, input->get_size() / origin_input_shape.back(), origin_input_shape.back()});
-        output->set_shape({1, 1, output->get_size() / origin_output_shape.back(), origin_output_shape.back()});
-
-        std::vector<base::ArgsType<T>> m_args =
-            base::get_conv_operation_args<T>(output,
-                                             input,
-                                             padding,
-                                             this->filter,
-                                             1 /*stride_y*/,
-                                             1 /*stride_x*/,
-                                             1 /*dilation_y*/,
-                                             1 /*dilation_x*/,
-                                             1 /*group*/,
-                                             this->bias,
-                                             this->activation,
-                                             nullptr,
-                                             mode); // do not support PReLU and Leaky RelU
-        int task_size = m_args.size();
-        if (task_size == 1) { // single task
-            forward_args((void *)&m_args[0]);
-        } else if (task_size == 2) { // multi task, use semaphore to maintain synchronization.
-            ESP_LOGI("Gemm", "two task...");
-            module_forward_dual_core(this, (void *)&m_args[0], (void *)&m_args[1]);
-        } else {
-            ESP_LOGE("Gemm", "Only support task size is 1 or 2, currently task size is %d", task_size);
-        }
-        input->set_shape(origin_input_shape);
-        output->set_shape(origin_output_shape);
+        // The args see input and output as 1 x 1 x N x C, the shapes are only changed while computing them.
+        std::vector<base::ArgsType<T>> &m_args =
+            module_get_cached_args<base::ArgsType<T>>(this, tensors, mode, [&]() {
+                std::vector<int> padding(4, 0);
+                TensorBase *input = tensors[m_inputs_index[0]];
+                TensorBase *output = tensors[m_outputs_index[0]];
+                std::vector<int> origin_input_shape = input->get_shape();
+                std::vector<int> origin_output_shape = output->get_shape();
+                input->set_shape({1, 1, input->get_size() / origin_input_shape.back(), origin_input_shape.back()});
+                output->set_shape(
+                    {1, 1, output->get_size() / origin_output_shape.back(), origin_output_shape.back()});
+                std::vector<base::ArgsType<T>> args =
+                    base::get_conv_operation_args<T>(output,
+                                                     input,
+                                                     padding,
+                                                     this->filter,
+                                                     1 /*stride_y*/,
+                                                     1 /*stride_x*/,
+                                                     1 /*dilation_y*/,
+                                                     1 /*dilation_x*/,
+                                                     1 /*group*/,
+                                                     this->bias,
+                                                     this->activation,
+                                                     nullptr,
+                                                     mode); // do not support PReLU and Leaky RelU
+                input->set_shape(origin_input_shape);
+                output->set_shape(origin_output_shape);
+                return args;
+            });
+        module_forward_tiles(this, m_args);
     }
 
     void forward(std::vector<TensorBase *> &tensors, runtime_mode_t mode = RUNTIME_MODE_AUTO)
@@ -177,6 +174,53 @@ public:
                  activation_type_to_string(activation),
                  quant_type_to_string(quant_type));
     }
+
+    void set_preload_addr(void *addr, size_t size)
+    {
+        size_t offset = 0;
+        if (this->filter) {
+            offset = this->filter->set_preload_addr(addr, size);
+        }
+        if (this->bias) {
+            this->bias->set_preload_addr(offset ? (void *)((char *)addr + offset) : nullptr, size - offset);
+        }
+        // The cached kernel args point at the parameters.
+        delete this->m_args_cache;
+        this->m_args_cache = nullptr;
+    }
+
+    void preload()
+    {
+        if (filter)
+            filter->preload();
+        if (bias)
+            bias->preload();
+    }
+
+    std::vector<TensorBase *> get_preload_tensors()
+    {
+        std::vector<TensorBase *> params = {this->filter};
+        if (this->bias) {
+            params.push_back(this->bias);
+        }
+        return params;
+    }
+
+    uint64_t get_macs(std::vector<TensorBase *> &tensors)
+    {
+        // Every output element accumulates the filter of its output channel, also with groups.
+        TensorBase *output = tensors[this->m_outputs_index[0]];
+        return (uint64_t)output->get_size() * this->filter->get_size() / output->shape.back();
+    }
+
+    void reset()
+    {
+        Module::reset();
+        this->filter->cache = nullptr;
+        if (this->bias != nullptr) {
+            this->bias->cache = nullptr;
+        }
+    }
 };
 } // namespace module
 } // namespace dl
@@ -69,16 +69,17 @@ public:
         TensorBase *input = tensors[m_inputs_index[0]];
         TensorBase *output = tensors[m_outputs_index[0]];
 
-        std::vector<base::PoolArgsType<T>> m_args =
-            base::get_pool_args<T>(output, input, {0, 0, 0, 0}, {input->shape[1], input->shape[2]}, 1, 1, mode);
-        int task_size = m_args.size();
-        if (task_size == 1) { // single task
-            forward_args((void *)&m_args[0]);
-        } else if (task_size == 2) { // multi task, use semaphore to maintain synchronization.
-            module_forward_dual_core(this, (void *)&m_args[0], (void *)&m_args[1]);
-        } else {
-            ESP_LOGE("GlobalAveragePool2D", "Only support task size is 1 or 2, currently task size is %d", task_size);
-        }
+        std::vector<base::PoolArgsType<T>> &m_args =
+            module_get_cached_args<base::PoolArgsType<T>>(this, tensors, mode, [&]() {
+                return base::get_pool_args<T>(output,
+                                              input,
+                                              {0, 0, 0, 0},
+                                              {input->shape[1], input->shape[2]},
+                                              1,
+                                              1,
+                                              mode);
+            });
+        module_forward_tiles(this, m_args);
     }
 
     /**
@@ -62,12 +62,13 @@ public:
         float input_scale = DL_SCALE(input->exponent);
         float output_scale = DL_RESCALE(output->exponent);
         for (size_t i = 0; i < input->size; i++) {
-            float temp = input_ptr[i] * input_scale;
-            temp = DL_MAX(0, DL_MIN(1, 0.166667 * temp + 0.5)) * temp;
+            float temp = hard_swish(input_ptr[i] * input_scale);
             tool::truncate(output_ptr[i], tool::round(temp * output_scale));
         }
     }
 
+    static float hard_swish(float x) { return DL_MAX(0, DL_MIN(1, 0.166667 * x + 0.5)) * x; }
+
     void forward_args(void *args) {}
 
     /**
@@ -87,6 +88,13 @@ public:
             } else {
                 op = new HardSwish(node_name.c_str(), MODULE_INPLACE_CHANGED_BUFFER, quant_type);
             }
+        } else if (quant_type == QUANT_TYPE_SYMM_16BIT) {
+            base::Lut16 *table16 = LUT::create_int16_table(fbs_model, node_name, hard_swish);
+            if (table16) {
+                op = new LUT(node_name.c_str(), table16, MODULE_INPLACE_CHANGED_BUFFER);
+            } else {
+                op = new HardSwish(node_name.c_str(), MODULE_INPLACE_CHANGED_BUFFER, quant_type);
+            }
         } else {
             op = new HardSwish(node_name.c_str(), MODULE_INPLACE_CHANGED_BUFFER, quant_type);
         }
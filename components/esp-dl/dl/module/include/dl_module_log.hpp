@@ -93,6 +93,13 @@ public:
             } else {
                 op = new Log(node_name.c_str(), MODULE_INPLACE_CHANGED_BUFFER, quant_type);
             }
+        } else if (quant_type == QUANT_TYPE_SYMM_16BIT) {
+            base::Lut16 *table16 = LUT::create_int16_table(fbs_model, node_name, logf);
+            if (table16) {
+                op = new LUT(node_name.c_str(), table16, MODULE_INPLACE_CHANGED_BUFFER);
+            } else {
+                op = new Log(node_name.c_str(), MODULE_INPLACE_CHANGED_BUFFER, quant_type);
+            }
         } else {
             op = new Log(node_name.c_str(), MODULE_INPLACE_CHANGED_BUFFER, quant_type);
         }
@@ -1,11 +1,13 @@
 #pragma once
 
+#include "dl_base_lut16.hpp"
 #include "dl_module_base.hpp"
 
 namespace dl {
 namespace module {
 /**
- * NOTE:int16 using linear interpolation + lookup table.
+ * NOTE:int16 using linear interpolation + lookup table, either the table of the model or a two-level table built from
+ * the exponents of the activation at model build, see create_int16_table().
  *
  * @tparam feature_t supports int16_t and int8_t,
  *         - int16_t: stands for operation in int16_t quantize
@@ -13,8 +15,9 @@ namespace module {
  */
 class LUT : public Module {
 private:
-    TensorBase *table; /*LUT loop up table*/
-    int step;          /*LUT loop up table step: only available for int16.*/
+    TensorBase *table;    /*LUT loop up table*/
+    int step;             /*LUT loop up table step: only available for int16.*/
+    base::Lut16 *table16; /*two-level table built at model build: only available for int16.*/
 public:
     /**
      * @brief Construct a new LUT object.
@@ -30,11 +33,27 @@ public:
     {
         this->table = table;
         this->step = 1;
+        this->table16 = nullptr;
         if (quant_type == QUANT_TYPE_SYMM_16BIT) {
             this->step = 65536 / (this->table->get_size() - 1);
         }
     }
 
+    /**
+     * @brief Construct a new int16 LUT object from a two-level table.
+     *
+     * @param name            name of module
+     * @param table16         table of the activation, the module takes it over
+     * @param inplace         inplace type.
+     */
+    LUT(const char *name, base::Lut16 *table16, module_inplace_t inplace = MODULE_INPLACE_CHANGED_BUFFER) :
+        Module(name, inplace, QUANT_TYPE_SYMM_16BIT)
+    {
+        this->table = nullptr;
+        this->step = 1;
+        this->table16 = table16;
+    }
+
     /**
      * @brief Destroy the LUT object.
      */
@@ -44,6 +63,10 @@ public:
             delete this->table;
             this->table = nullptr;
         }
+        if (this->table16) {
+            delete this->table16;
+            this->table16 = nullptr;
+        }
     }
 
     std::vector<std::vector<int>> get_output_shape(std::vector<std::vector<int>> &input_shapes)
@@ -58,9 +81,14 @@ public:
         DL_LOG_MODULE_LATENCY_START();
         TensorBase *input = tensors[m_inputs_index[0]];
         TensorBase *output = tensors[m_outputs_index[0]];
-        assert(output->exponent == this->table->exponent);
 
-        if (quant_type == QUANT_TYPE_SYMM_8BIT) {
+        if (this->table16) {
+            assert(input->exponent == this->table16->get_input_exponent());
+            assert(output->exponent == this->table16->get_output_exponent());
+            this->table16->forward(
+                (int16_t *)input->get_element_ptr(), (int16_t *)output->get_element_ptr(), input->size);
+        } else if (quant_type == QUANT_TYPE_SYMM_8BIT) {
+            assert(output->exponent == this->table->exponent);
             int8_t *input_ptr = (int8_t *)input->get_element_ptr();
             int8_t *output_ptr = (int8_t *)output->get_element_ptr();
             int8_t *table_ptr = (int8_t *)(this->table->get_element_ptr());
@@ -71,6 +99,7 @@ public:
             int16_t *input_ptr = (int16_t *)input->get_element_ptr();
             int16_t *output_ptr = (int16_t *)output->get_element_ptr();
             int16_t *table_ptr = (int16_t *)(this->table->get_element_ptr());
+            assert(output->exponent == this->table->exponent);
 
             if (this->step == 1) {
                 for (size_t i = 0; i < input->size; i++) {
@@ -94,6 +123,30 @@ public:
 
     void forward_args(void *args) {}
 
+    /**
+     * @brief Build the two-level table of an int16 activation from the exponents of its input and output.
+     *
+     * @param fbs_model   model
+     * @param node_name   node of the activation
+     * @param func        the activation in float, as the float path of the module computes it
+     * @return the table, nullptr when it would take more than DL_LUT16_MAX_SAMPLES samples
+     */
+    static base::Lut16 *create_int16_table(fbs::FbsModel *fbs_model, std::string node_name, base::Lut16::func_t func)
+    {
+        std::vector<std::string> inputs, outputs;
+        fbs_model->get_operation_inputs_and_outputs(node_name, inputs, outputs);
+        if (inputs.empty() || outputs.empty()) {
+            return nullptr;
+        }
+        base::Lut16 *table16 = new base::Lut16(
+            func, fbs_model->get_value_info_exponent(inputs[0]), fbs_model->get_value_info_exponent(outputs[0]));
+        if (!table16->get_size()) {
+            delete table16;
+            return nullptr;
+        }
+        return table16;
+    }
+
     /**
      * @brief deserialize LUT module instance by node serialization information
      */
@@ -79,20 +79,16 @@ public:
     template <typename T>
     void forward_template(std::vector<TensorBase *> &tensors, runtime_mode_t mode)
     {
-        std::vector<TensorBase *> inputs = retrieve_inputs(tensors, m_inputs_constant);
-
-        TensorBase *output = tensors[m_outputs_index[0]];
-
-        std::vector<base::elemwiseArgsType<T>> m_args =
-            base::get_elemwise_operation_args<T>(output, inputs[0], inputs[1], mode); // get element-wise operation args
-        int task_size = m_args.size();
-        if (task_size == 1) {
-            forward_args((void *)&m_args[0]); // single task
-        } else if (task_size == 2) {
-            module_forward_dual_core(this, (void *)&m_args[0], (void *)&m_args[1]); // two task
-        } else {
-            ESP_LOGE("Mul", "Only support task size is 1 or 2, currently task size is %d", task_size);
-        }
+        std::vector<base::elemwiseArgsType<T>> &m_args =
+            module_get_cached_args<base::elemwiseArgsType<T>>(this, tensors, mode, [&]() {
+                std::vector<TensorBase *> inputs = retrieve_inputs(tensors, m_inputs_constant);
+                TensorBase *output = tensors[m_outputs_index[0]];
+                return base::get_elemwise_operation_args<T>(output,
+                                                            inputs[0],
+                                                            inputs[1],
+                                                            mode); // get element-wise operation args
+            });
+        module_forward_tiles(this, m_args);
     }
 
     /**
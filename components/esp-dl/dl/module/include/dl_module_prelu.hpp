@@ -91,15 +91,11 @@ public:
         TensorBase *input = tensors[m_inputs_index[0]];
         TensorBase *output = tensors[m_outputs_index[0]];
 
-        std::vector<base::ArgsType<T>> m_args = base::get_activation_args<T>(output, input, PReLU, m_alpha, mode);
-        int task_size = m_args.size();
-        if (task_size == 1) { // single task
-            forward_args((void *)&m_args[0]);
-        } else if (task_size == 2) { // multi task, use semaphore to maintain synchronization.
-            module_forward_dual_core(this, (void *)&m_args[0], (void *)&m_args[1]);
-        } else {
-            ESP_LOGE("PRelu", "Only support task size is 1 or 2, currently task size is %d", task_size);
-        }
+        std::vector<base::ArgsType<T>> &m_args =
+            module_get_cached_args<base::ArgsType<T>>(this, tensors, mode, [&]() {
+                return base::get_activation_args<T>(output, input, PReLU, m_alpha, mode);
+            });
+        module_forward_tiles(this, m_args);
     }
 
     /**
@@ -14,24 +14,41 @@ namespace module {
  */
 class Resize2D : public Module {
 private:
-    const resize_mode_t resize_type; /*<! one of RESIZE_NEAREST or RESIZE_LINEAR or RESIZE_CUBIC >*/
-    const float scale_y;             /*<! scale in height >*/
-    const float scale_x;             /*<! scale in width >*/
+    const resize_mode_t resize_type;      /*<! one of RESIZE_NEAREST or RESIZE_LINEAR >*/
+    const resize_coordinate_t coordinate; /*<! where an output pixel samples the input >*/
+    const resize_nearest_t nearest_mode;  /*<! rounding of the coordinate of RESIZE_NEAREST >*/
+    const float scale_y;                  /*<! scale in height >*/
+    const float scale_x;                  /*<! scale in width >*/
+    std::vector<int32_t> m_table_y;       /*<! source rows, see base::get_resize_axis_table() >*/
+    std::vector<int32_t> m_table_x;       /*<! source columns >*/
+    bool m_fused;                         /*<! the Add reading the output computes it, see fuse() >*/
+
 public:
     /**
      * @brief Construct a new Resize2D object.
      *
      * @param name               name of module
-     * @param resize_type        one of RESIZE_NEAREST or RESIZE_LINEAR or RESIZE_CUBIC
+     * @param resize_type        one of RESIZE_NEAREST or RESIZE_LINEAR
      * @param scale_y            scale in height
      * @param scale_x            scale in width
+     * @param quant_type         quantize type
+     * @param coordinate         where an output pixel samples the input
+     * @param nearest_mode       rounding of the coordinate of RESIZE_NEAREST
      */
     Resize2D(const char *name = NULL,
              const resize_mode_t resize_type = RESIZE_NEAREST,
              const float scale_y = 2.f,
              const float scale_x = 2.f,
-             quant_type_t quant_type = QUANT_TYPE_NONE) :
-        Module(name, MODULE_NON_INPLACE, quant_type), resize_type(resize_type), scale_y(scale_y), scale_x(scale_x)
+             quant_type_t quant_type = QUANT_TYPE_NONE,
+             const resize_coordinate_t coordinate = RESIZE_HALF_PIXEL,
+             const resize_nearest_t nearest_mode = RESIZE_ROUND_PREFER_FLOOR) :
+        Module(name, MODULE_NON_INPLACE, quant_type),
+        resize_type(resize_type),
+        coordinate(coordinate),
+        nearest_mode(nearest_mode),
+        scale_y(scale_y),
+        scale_x(scale_x),
+        m_fused(false)
     {
     }
 
@@ -58,6 +75,9 @@ public:
 
     void forward(std::vector<dl::TensorBase *> &tensors, runtime_mode_t mode)
     {
+        if (m_fused) {
+            return;
+        }
         DL_LOG_MODULE_LATENCY_INIT();
         DL_LOG_MODULE_LATENCY_START();
         if (quant_type == QUANT_TYPE_SYMM_8BIT) {
@@ -83,16 +103,100 @@ public:
         TensorBase *input = tensors[m_inputs_index[0]];
         TensorBase *output = tensors[m_outputs_index[0]];
 
-        std::vector<base::resizeArgsType<T>> m_args =
-            base::get_resize_operation_args<T>(output, input, RESIZE_NEAREST, scale_y, scale_x);
-        int task_size = m_args.size();
-        if (task_size == 1) { // single task
-            forward_args((void *)&m_args[0]);
-        } else if (task_size == 2) { // multi task, use semaphore to maintain synchronization.
-            module_forward_dual_core(this, (void *)&m_args[0], (void *)&m_args[1]);
-        } else {
-            ESP_LOGE("Resize2D", "Only support task size is 1 or 2, currently task size is %d", task_size);
+        std::vector<base::resizeArgsType<T>> &m_args =
+            module_get_cached_args<base::resizeArgsType<T>>(this, tensors, mode, [&]() {
+                return base::get_resize_operation_args<T>(
+                    output, input, resize_type, coordinate, nearest_mode, scale_y, scale_x, m_table_y, m_table_x);
+            });
+        module_forward_tiles(this, m_args);
+    }
+
+    /**
+     * @brief Hand the output to the Add reading it, which then computes resize(input) + addend in one pass and never
+     * reads the output. This resize does nothing anymore, its output is not written. The memory planner fuses the
+     * pairs, reset() undoes it.
+     */
+    void fuse() { m_fused = true; }
+
+    bool is_fused() { return m_fused; }
+
+    /**
+     * @brief Args of the Add this resize is fused into, run by forward_args() of this module.
+     *
+     * @param tensors  All inputs and outputs from MemoryManager
+     * @param addend   The other input of the Add, of the output shape
+     * @param output   The output of the Add
+     * @param mode     Runtime mode
+     */
+    template <typename T>
+    std::vector<base::resizeArgsType<T>> get_fused_args(std::vector<TensorBase *> &tensors,
+                                                        TensorBase *addend,
+                                                        TensorBase *output,
+                                                        runtime_mode_t mode)
+    {
+        TensorBase *input = tensors[m_inputs_index[0]];
+        TensorBase *resized = tensors[m_outputs_index[0]];
+        std::vector<base::resizeArgsType<T>> args = base::get_resize_operation_args<T>(resized,
+                                                                                       input,
+                                                                                       resize_type,
+                                                                                       coordinate,
+                                                                                       nearest_mode,
+                                                                                       scale_y,
+                                                                                       scale_x,
+                                                                                       m_table_y,
+                                                                                       m_table_x,
+                                                                                       addend,
+                                                                                       mode);
+        for (base::resizeArgsType<T> &tile : args) {
+            tile.output_element = (T *)output->get_element_ptr();
+        }
+        return args;
+    }
+
+    void reset()
+    {
+        m_fused = false;
+        Module::reset();
+    }
+
+    /**
+     * @brief The coordinate_transformation_mode of ONNX Resize, half_pixel when unknown.
+     */
+    static resize_coordinate_t get_coordinate(const std::string &node_name, const std::string &value)
+    {
+        if (value == "pytorch_half_pixel") {
+            return RESIZE_PYTORCH_HALF_PIXEL;
+        } else if (value == "align_corners") {
+            return RESIZE_ALIGN_CORNERS;
+        } else if (value == "asymmetric") {
+            return RESIZE_ASYMMETRIC;
+        } else if (value != "half_pixel") {
+            ESP_LOGW("Resize2D",
+                     "%s: coordinate mode %s is not supported, half_pixel used.",
+                     node_name.c_str(),
+                     value.c_str());
+        }
+        return RESIZE_HALF_PIXEL;
+    }
+
+    /**
+     * @brief The nearest_mode of ONNX Resize, round_prefer_floor when unknown.
+     */
+    static resize_nearest_t get_nearest_mode(const std::string &node_name, const std::string &value)
+    {
+        if (value == "round_prefer_ceil") {
+            return RESIZE_ROUND_PREFER_CEIL;
+        } else if (value == "floor") {
+            return RESIZE_FLOOR;
+        } else if (value == "ceil") {
+            return RESIZE_CEIL;
+        } else if (value != "round_prefer_floor") {
+            ESP_LOGW("Resize2D",
+                     "%s: nearest mode %s is not supported, round_prefer_floor used.",
+                     node_name.c_str(),
+                     value.c_str());
         }
+        return RESIZE_ROUND_PREFER_FLOOR;
     }
 
     /**
@@ -103,21 +207,43 @@ public:
         Module *op = nullptr;
         quant_type_t quant_type;
         resize_mode_t resize_mode;
+        // Read as strings, FbsModel may be the prebuilt library which knows no resize enums but the mode.
+        std::string coordinate = "half_pixel";
+        std::string nearest_mode = "round_prefer_floor";
         fbs_model->get_operation_attribute(node_name, "quant_type", quant_type);
         fbs_model->get_operation_attribute(node_name, "mode", resize_mode);
+        fbs_model->get_operation_attribute(node_name, "coordinate_transformation_mode", coordinate);
+        fbs_model->get_operation_attribute(node_name, "nearest_mode", nearest_mode);
+        if (resize_mode == RESIZE_CUBIC) {
+            ESP_LOGW("Resize2D", "%s: cubic is not supported, resized as linear.", node_name.c_str());
+            resize_mode = RESIZE_LINEAR;
+        }
         dl::TensorBase *resize_scales_tensor = fbs_model->get_operation_parameter(node_name, 2);
         assert(resize_scales_tensor->shape.size() == 1 && resize_scales_tensor->shape[0] == 4);
         float *resize_scales = (float *)resize_scales_tensor->get_element_ptr();
 
         // Create module
         if (quant_type == QUANT_TYPE_SYMM_8BIT || quant_type == QUANT_TYPE_SYMM_16BIT) {
-            op = new Resize2D(node_name.c_str(), resize_mode, resize_scales[2], resize_scales[3], quant_type);
+            op = new Resize2D(node_name.c_str(),
+                              resize_mode,
+                              resize_scales[2],
+                              resize_scales[3],
+                              quant_type,
+                              get_coordinate(node_name, coordinate),
+                              get_nearest_mode(node_name, nearest_mode));
         }
         delete resize_scales_tensor;
         return op;
     }
 
-    void print() { ESP_LOGI("Resize2D", "quant_type: %s.", quant_type_to_string(quant_type)); }
+    void print()
+    {
+        ESP_LOGI("Resize2D",
+                 "quant_type: %s, mode: %s%s.",
+                 quant_type_to_string(quant_type),
+                 resize_type == RESIZE_NEAREST ? "nearest" : "linear",
+                 m_fused ? ", fused into the Add reading it" : "");
+    }
 };
 } // namespace module
 } // namespace dl
@@ -0,0 +1,133 @@
+#pragma once
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#include <atomic>
+#include <stdint.h>
+
+namespace dl {
+namespace module {
+class Module;
+
+/**
+ * @brief Persistent core-pinned workers for running one module on all cores.
+ *
+ * Every dual-core forward used to create two tasks, a counting semaphore and delete all of them again. The pool keeps
+ * one worker task per core, created on first use. A dispatch stores the job in the worker of the other core, wakes it
+ * with a task notification, runs the second half on the calling task and waits on one counting semaphore.
+ * A pool may only be driven by one task at a time, dl::Model owns one and installs it for the duration of run().
+ */
+class ModuleWorkerPool {
+public:
+    /**
+     * @brief Install a pool as the current pool of the calling task, restore the previous one on destruction.
+     */
+    class Scope {
+    public:
+        Scope(ModuleWorkerPool *pool);
+        ~Scope();
+
+    private:
+        ModuleWorkerPool *m_prev; /*<! pool that was current before this scope >*/
+    };
+
+    /**
+     * @brief Construct a new ModuleWorkerPool object. No task is created until the first dispatch.
+     *
+     * @param stack_size Stack size of every worker task, in bytes.
+     */
+    ModuleWorkerPool(uint32_t stack_size = 2048);
+
+    /**
+     * @brief Stop and delete all worker tasks.
+     */
+    ~ModuleWorkerPool();
+
+    /**
+     * @brief Run op->forward_args(args1) on the other core and op->forward_args(args2) on the calling core, return
+     * when both are done.
+     *
+     * @return ESP_OK if the work was shared, otherwise no forward_args was called and the caller must run both halves.
+     */
+    esp_err_t forward_dual_core(Module *op, void *args1, void *args2);
+
+    /**
+     * @brief Run op->forward_args() on n args laid out every args_stride bytes. The calling task and the workers of the
+     * other cores pull tiles from a shared counter until all are done, so n may exceed the number of cores.
+     *
+     * @return ESP_OK if the work was shared, otherwise no forward_args was called and the caller must run all tiles.
+     */
+    esp_err_t forward_tiles(Module *op, void *args, size_t args_stride, int n);
+
+    /**
+     * @brief Run func(arg) on the calling core and on the worker of every other core at the same time, return when all
+     * of them returned. func does its own work sharing, e.g. the graph scheduler pulls ready modules from a shared queue.
+     *
+     * @return ESP_OK if func also ran on the workers, otherwise func was not called and the caller must run it alone.
+     */
+    esp_err_t run_all_cores(void (*func)(void *), void *arg);
+
+    /**
+     * @brief Get the pool installed for the calling task, nullptr if there is none.
+     */
+    static ModuleWorkerPool *get_current();
+
+    /**
+     * @brief Number of jobs dispatched to workers so far.
+     */
+    uint32_t get_dispatch_count() const { return m_dispatch_count; }
+
+    /**
+     * @brief Average time from dispatch until the worker starts the job, in microseconds.
+     */
+    uint32_t get_avg_launch_us() const;
+
+    /**
+     * @brief Average time the calling task waits at the barrier after finishing its own half, in microseconds.
+     */
+    uint32_t get_avg_wait_us() const;
+
+    /**
+     * @brief Reset launch statistics.
+     */
+    void reset_stats();
+
+    /**
+     * @brief Print launch statistics.
+     */
+    void print_stats();
+
+private:
+    typedef struct {
+        TaskHandle_t handle;           /*<! worker task, nullptr until started >*/
+        ModuleWorkerPool *pool;        /*<! owner of the worker >*/
+        Module *op;                    /*<! module of the pending job, nullptr without func asks the worker to exit >*/
+        void *args;                    /*<! args of the pending job, nullptr for a tiled job >*/
+        void (*func)(void *);          /*<! function of the pending job, takes precedence over op >*/
+        void *func_arg;                /*<! argument of func >*/
+        int64_t dispatch_us;           /*<! esp_timer time of the dispatch >*/
+    } worker_t;
+
+    esp_err_t start_worker(int core_id);
+    void stop_worker(worker_t &worker);
+    static void worker_task(void *arg);
+    void run_tiles(Module *op);
+    void sync_priority();
+
+    worker_t m_workers[CONFIG_FREERTOS_NUMBER_OF_CORES];
+    uint32_t m_stack_size;
+    UBaseType_t m_priority;          /*<! priority the workers currently run at >*/
+    SemaphoreHandle_t m_done;        /*<! given by every worker when its job is finished >*/
+    StaticSemaphore_t m_done_buffer;
+    char *m_tile_args;               /*<! args of the current tiled job >*/
+    size_t m_tile_stride;
+    int m_tile_num;
+    std::atomic<int> m_next_tile;    /*<! next tile to be taken by any core >*/
+    uint32_t m_dispatch_count;
+    int64_t m_launch_us;             /*<! accumulated by the workers >*/
+    int64_t m_wait_us;
+};
+} // namespace module
+} // namespace dl
@@ -7,8 +7,50 @@ using namespace dl;
 
 namespace dl {
 namespace module {
+bool ModuleArgsCache::match(Module *op, std::vector<TensorBase *> &tensors, runtime_mode_t mode)
+{
+    if (m_key.empty() || m_key[0] != mode) {
+        return false;
+    }
+    int k = 1;
+    for (int pass = 0; pass < 2; pass++) {
+        std::vector<int> &indexes = pass ? op->m_outputs_index : op->m_inputs_index;
+        for (int index : indexes) {
+            TensorBase *tensor = tensors[index];
+            int rank = tensor->shape.size();
+            if (k + 3 + rank > m_key.size() || m_key[k] != (intptr_t)tensor->data ||
+                m_key[k + 1] != tensor->exponent || m_key[k + 2] != rank) {
+                return false;
+            }
+            k += 3;
+            for (int i = 0; i < rank; i++, k++) {
+                if (m_key[k] != tensor->shape[i]) {
+                    return false;
+                }
+            }
+        }
+    }
+    return k == m_key.size();
+}
+
+void ModuleArgsCache::update(Module *op, std::vector<TensorBase *> &tensors, runtime_mode_t mode)
+{
+    m_key.clear();
+    m_key.push_back(mode);
+    for (int pass = 0; pass < 2; pass++) {
+        std::vector<int> &indexes = pass ? op->m_outputs_index : op->m_inputs_index;
+        for (int index : indexes) {
+            TensorBase *tensor = tensors[index];
+            m_key.push_back((intptr_t)tensor->data);
+            m_key.push_back(tensor->exponent);
+            m_key.push_back(tensor->shape.size());
+            m_key.insert(m_key.end(), tensor->shape.begin(), tensor->shape.end());
+        }
+    }
+}
+
 Module::Module(const char *name, module_inplace_t inplace, quant_type_t quant_type) :
-    inplace(inplace), quant_type(quant_type)
+    inplace(inplace), quant_type(quant_type), m_args_cache(nullptr)
 {
 #if CONFIG_DL_DEBUG
     if (name) {
@@ -25,6 +67,7 @@ Module::Module(const char *name, module_inplace_t inplace, quant_type_t quant_ty
 
 Module::~Module()
 {
+    delete this->m_args_cache;
     if (this->name) {
         free((void *)this->name);
     }
@@ -87,6 +130,8 @@ void Module::run(TensorBase *input, TensorBase *output, runtime_mode_t mode)
     std::vector<dl::TensorBase *> tensors = {input, output};
     m_inputs_index.push_back(0);
     m_outputs_index.push_back(1);
+    ModuleWorkerPool pool;
+    ModuleWorkerPool::Scope pool_scope(ModuleWorkerPool::get_current() ? ModuleWorkerPool::get_current() : &pool);
     forward(tensors, mode);
 }
 
@@ -103,6 +148,9 @@ void Module::run(std::vector<dl::TensorBase *> inputs, std::vector<dl::TensorBas
         m_outputs_index.push_back(tensors.size() - 1);
     }
 
+    // Standalone modules get a pool for this call only, its workers start on the first dual-core dispatch.
+    ModuleWorkerPool pool;
+    ModuleWorkerPool::Scope pool_scope(ModuleWorkerPool::get_current() ? ModuleWorkerPool::get_current() : &pool);
     forward(tensors, mode);
 }
 
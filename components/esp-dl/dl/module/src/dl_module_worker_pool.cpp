@@ -0,0 +1,260 @@
+#include "dl_module_worker_pool.hpp"
+#include "dl_module_base.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "dl::module::ModuleWorkerPool";
+
+namespace dl {
+namespace module {
+static thread_local ModuleWorkerPool *s_current_pool = nullptr;
+
+ModuleWorkerPool::Scope::Scope(ModuleWorkerPool *pool) : m_prev(s_current_pool)
+{
+    s_current_pool = pool;
+}
+
+ModuleWorkerPool::Scope::~Scope()
+{
+    s_current_pool = m_prev;
+}
+
+ModuleWorkerPool::ModuleWorkerPool(uint32_t stack_size) :
+    m_stack_size(stack_size),
+    m_priority(0),
+    m_tile_args(nullptr),
+    m_tile_stride(0),
+    m_tile_num(0),
+    m_next_tile(0),
+    m_dispatch_count(0),
+    m_launch_us(0),
+    m_wait_us(0)
+{
+    for (int i = 0; i < CONFIG_FREERTOS_NUMBER_OF_CORES; i++) {
+        m_workers[i] = {.handle = nullptr,
+                        .pool = this,
+                        .op = nullptr,
+                        .args = nullptr,
+                        .func = nullptr,
+                        .func_arg = nullptr,
+                        .dispatch_us = 0};
+    }
+    m_done = xSemaphoreCreateCountingStatic(CONFIG_FREERTOS_NUMBER_OF_CORES, 0, &m_done_buffer);
+}
+
+ModuleWorkerPool::~ModuleWorkerPool()
+{
+    for (int i = 0; i < CONFIG_FREERTOS_NUMBER_OF_CORES; i++) {
+        stop_worker(m_workers[i]);
+    }
+    vSemaphoreDelete(m_done);
+}
+
+ModuleWorkerPool *ModuleWorkerPool::get_current()
+{
+    return s_current_pool;
+}
+
+esp_err_t ModuleWorkerPool::start_worker(int core_id)
+{
+    worker_t &worker = m_workers[core_id];
+    if (xTaskCreatePinnedToCore(worker_task, "dl_worker", m_stack_size, &worker, m_priority, &worker.handle, core_id) !=
+        pdPASS) {
+        worker.handle = nullptr;
+        ESP_LOGE(TAG, "Failed to create worker on core %d", core_id);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void ModuleWorkerPool::stop_worker(worker_t &worker)
+{
+    if (!worker.handle) {
+        return;
+    }
+    worker.op = nullptr;
+    worker.func = nullptr;
+    xTaskNotifyGive(worker.handle);
+    xSemaphoreTake(m_done, portMAX_DELAY);
+    worker.handle = nullptr;
+}
+
+void ModuleWorkerPool::worker_task(void *arg)
+{
+    worker_t *worker = (worker_t *)arg;
+    ModuleWorkerPool *pool = worker->pool;
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (!worker->op && !worker->func) {
+            break;
+        }
+        pool->m_launch_us += esp_timer_get_time() - worker->dispatch_us;
+        if (worker->func) {
+            worker->func(worker->func_arg);
+        } else if (worker->args) {
+            worker->op->forward_args(worker->args);
+        } else {
+            pool->run_tiles(worker->op);
+        }
+        xSemaphoreGive(pool->m_done);
+    }
+    xSemaphoreGive(pool->m_done);
+    vTaskDelete(NULL);
+}
+
+void ModuleWorkerPool::sync_priority()
+{
+    // Workers follow the priority of the task driving the model, like the per-forward tasks did.
+    UBaseType_t priority = uxTaskPriorityGet(NULL);
+    if (priority != m_priority) {
+        m_priority = priority;
+        for (int i = 0; i < CONFIG_FREERTOS_NUMBER_OF_CORES; i++) {
+            if (m_workers[i].handle) {
+                vTaskPrioritySet(m_workers[i].handle, priority);
+            }
+        }
+    }
+}
+
+void ModuleWorkerPool::run_tiles(Module *op)
+{
+    int i;
+    while ((i = m_next_tile.fetch_add(1, std::memory_order_relaxed)) < m_tile_num) {
+        op->forward_args(m_tile_args + i * m_tile_stride);
+    }
+}
+
+esp_err_t ModuleWorkerPool::forward_tiles(Module *op, void *args, size_t args_stride, int n)
+{
+#if CONFIG_FREERTOS_NUMBER_OF_CORES > 1
+    sync_priority();
+    m_tile_args = (char *)args;
+    m_tile_stride = args_stride;
+    m_tile_num = n;
+    m_next_tile.store(0, std::memory_order_relaxed);
+
+    int current_core = xPortGetCoreID();
+    int dispatched = 0;
+    int64_t dispatch_us = esp_timer_get_time();
+    for (int i = 1; i < CONFIG_FREERTOS_NUMBER_OF_CORES && dispatched < n - 1; i++) {
+        int core_id = (current_core + i) % CONFIG_FREERTOS_NUMBER_OF_CORES;
+        worker_t &worker = m_workers[core_id];
+        if (!worker.handle && start_worker(core_id) != ESP_OK) {
+            continue;
+        }
+        worker.op = op;
+        worker.args = nullptr;
+        worker.func = nullptr;
+        worker.dispatch_us = dispatch_us;
+        xTaskNotifyGive(worker.handle);
+        dispatched++;
+    }
+    if (!dispatched) {
+        return ESP_FAIL;
+    }
+    run_tiles(op);
+
+    int64_t wait_start = esp_timer_get_time();
+    for (int i = 0; i < dispatched; i++) {
+        xSemaphoreTake(m_done, portMAX_DELAY);
+    }
+    m_wait_us += esp_timer_get_time() - wait_start;
+    m_dispatch_count += dispatched;
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t ModuleWorkerPool::forward_dual_core(Module *op, void *args1, void *args2)
+{
+#if CONFIG_FREERTOS_NUMBER_OF_CORES > 1
+    sync_priority();
+    int core_id = (xPortGetCoreID() + 1) % CONFIG_FREERTOS_NUMBER_OF_CORES;
+    worker_t &worker = m_workers[core_id];
+    if (!worker.handle && start_worker(core_id) != ESP_OK) {
+        return ESP_FAIL;
+    }
+
+    worker.op = op;
+    worker.args = args1;
+    worker.func = nullptr;
+    worker.dispatch_us = esp_timer_get_time();
+    xTaskNotifyGive(worker.handle);
+    op->forward_args(args2);
+
+    int64_t wait_start = esp_timer_get_time();
+    xSemaphoreTake(m_done, portMAX_DELAY);
+    m_wait_us += esp_timer_get_time() - wait_start;
+    m_dispatch_count++;
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t ModuleWorkerPool::run_all_cores(void (*func)(void *), void *arg)
+{
+#if CONFIG_FREERTOS_NUMBER_OF_CORES > 1
+    sync_priority();
+    int current_core = xPortGetCoreID();
+    int dispatched = 0;
+    int64_t dispatch_us = esp_timer_get_time();
+    for (int i = 1; i < CONFIG_FREERTOS_NUMBER_OF_CORES; i++) {
+        int core_id = (current_core + i) % CONFIG_FREERTOS_NUMBER_OF_CORES;
+        worker_t &worker = m_workers[core_id];
+        if (!worker.handle && start_worker(core_id) != ESP_OK) {
+            continue;
+        }
+        worker.op = nullptr;
+        worker.args = nullptr;
+        worker.func = func;
+        worker.func_arg = arg;
+        worker.dispatch_us = dispatch_us;
+        xTaskNotifyGive(worker.handle);
+        dispatched++;
+    }
+    if (!dispatched) {
+        return ESP_FAIL;
+    }
+    func(arg);
+
+    int64_t wait_start = esp_timer_get_time();
+    for (int i = 0; i < dispatched; i++) {
+        xSemaphoreTake(m_done, portMAX_DELAY);
+    }
+    m_wait_us += esp_timer_get_time() - wait_start;
+    m_dispatch_count += dispatched;
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+uint32_t ModuleWorkerPool::get_avg_launch_us() const
+{
+    return m_dispatch_count ? (uint32_t)(m_launch_us / m_dispatch_count) : 0;
+}
+
+uint32_t ModuleWorkerPool::get_avg_wait_us() const
+{
+    return m_dispatch_count ? (uint32_t)(m_wait_us / m_dispatch_count) : 0;
+}
+
+void ModuleWorkerPool::reset_stats()
+{
+    m_dispatch_count = 0;
+    m_launch_us = 0;
+    m_wait_us = 0;
+}
+
+void ModuleWorkerPool::print_stats()
+{
+    ESP_LOGI(TAG,
+             "dispatch: %lu, avg launch: %lu us, avg barrier wait: %lu us",
+             m_dispatch_count,
+             get_avg_launch_us(),
+             get_avg_wait_us());
+}
+} // namespace module
+} // namespace dl
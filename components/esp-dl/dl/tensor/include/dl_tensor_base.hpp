@@ -455,7 +455,7 @@ public:
     virtual void preload()
     {
         if (this->cache) {
-            tool::copy_memory(this->cache, this->cache, this->get_bytes());
+            tool::copy_memory(this->cache, this->data, this->get_bytes());
         }
     }
 
@@ -470,6 +470,14 @@ public:
      */
     void reset_bias_layout(quant_type_t op_quant_type, bool is_depthwise);
 
+    /**
+     * @brief Copy the data into memory of the Tensor's own if the Tensor points at memory it does not own, e.g. at a
+     * parameter read in place from a model in flash.
+     *
+     * @return true if the data was copied, false if the Tensor already owned its data or the allocation failed
+     */
+    bool materialize();
+
     /**
      * @brief print the information of TensorBase
      *
@@ -505,12 +505,30 @@ void TensorBase::reset_bias_layout(quant_type_t op_quant_type, bool is_depthwise
             (reinterpret_cast<int64_t *>(dst_ptr_head))[j] = src_ptr[i];
         }
 
-        heap_caps_free(this->data);
+        if (this->auto_free) {
+            heap_caps_free(this->data);
+        }
         this->data = dst_ptr;
+        this->auto_free = true;
     }
 #endif
 }
 
+bool TensorBase::materialize()
+{
+    if (this->auto_free || !this->data) {
+        return false;
+    }
+    void *data = tool::malloc_aligned(this->get_aligned_size(), this->get_dtype_bytes(), 16, this->caps);
+    if (!data) {
+        return false;
+    }
+    tool::copy_memory(data, this->data, this->get_bytes());
+    this->data = data;
+    this->auto_free = true;
+    return true;
+}
+
 void TensorBase::print(bool print_data)
 {
     ESP_LOGI(__FUNCTION__,
@@ -0,0 +1,113 @@
+#include "dl_module_creator.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "fbs_loader.hpp"
+#include <stdlib.h>
+
+/**
+ * Load time of FbsModel, the steps dl::Model::load goes through before it plans the memory: create the FbsModel,
+ * index the graph, sort the nodes and create every module, which reads the attributes and the parameters.
+ *
+ * Build it once with CONFIG_DL_FBS_MODEL_PREBUILT and once without to compare fbs_loader/lib/<target>/libfbs_model.a
+ * with fbs_loader/src/fbs_model.cpp on the chip. The host build of esp-dl builds it too, with the model path as
+ * argument.
+ */
+
+static const char *TAG = "fbs_model_benchmark";
+
+typedef struct {
+    int64_t create;
+    int64_t load_map;
+    int64_t topological_sort;
+    int64_t create_modules;
+} load_time_t;
+
+static esp_err_t load_once(fbs::FbsLoader *fbs_loader, load_time_t &time)
+{
+    int64_t start = esp_timer_get_time();
+    fbs::FbsModel *fbs_model = fbs_loader->load();
+    if (!fbs_model) {
+        return ESP_FAIL;
+    }
+    int64_t created = esp_timer_get_time();
+    fbs_model->load_map();
+    int64_t mapped = esp_timer_get_time();
+    std::vector<std::string> sorted_nodes = fbs_model->topological_sort();
+    int64_t sorted = esp_timer_get_time();
+
+    dl::module::ModuleCreator *module_creator = dl::module::ModuleCreator::get_instance();
+    std::vector<dl::module::Module *> modules;
+    esp_err_t ret = ESP_OK;
+    for (const std::string &node_name : sorted_nodes) {
+        dl::module::Module *module =
+            module_creator->create(fbs_model, fbs_model->get_operation_type(node_name), node_name);
+        if (!module) {
+            ESP_LOGE(TAG, "Can not create %s", node_name.c_str());
+            ret = ESP_FAIL;
+            break;
+        }
+        modules.push_back(module);
+    }
+    int64_t end = esp_timer_get_time();
+
+    time.create += created - start;
+    time.load_map += mapped - created;
+    time.topological_sort += sorted - mapped;
+    time.create_modules += end - sorted;
+
+    for (dl::module::Module *module : modules) {
+        delete module;
+    }
+    fbs_model->clear_map();
+    delete fbs_model;
+    return ret;
+}
+
+static void benchmark(const char *model, fbs::model_location_type_t location, int runs)
+{
+#if CONFIG_DL_FBS_MODEL_PREBUILT
+    ESP_LOGI(TAG, "FbsModel: prebuilt libfbs_model.a");
+#else
+    ESP_LOGI(TAG, "FbsModel: fbs_model.cpp");
+#endif
+    fbs::FbsLoader *fbs_loader = new fbs::FbsLoader(model, location);
+    load_time_t time = {};
+    // The first load warms the caches and the heap, it is not counted.
+    load_time_t warm_up = {};
+    if (load_once(fbs_loader, warm_up) != ESP_OK) {
+        delete fbs_loader;
+        return;
+    }
+    for (int i = 0; i < runs; i++) {
+        load_once(fbs_loader, time);
+    }
+    delete fbs_loader;
+
+    ESP_LOGI(TAG, "%d loads, average in us:", runs);
+    ESP_LOGI(TAG, "create:           %8.1f", (float)time.create / runs);
+    ESP_LOGI(TAG, "load_map:         %8.1f", (float)time.load_map / runs);
+    ESP_LOGI(TAG, "topological_sort: %8.1f", (float)time.topological_sort / runs);
+    ESP_LOGI(TAG, "create modules:   %8.1f", (float)time.create_modules / runs);
+    ESP_LOGI(TAG,
+             "total:            %8.1f",
+             (float)(time.create + time.load_map + time.topological_sort + time.create_modules) / runs);
+}
+
+#if defined(ESP_PLATFORM)
+extern const uint8_t model_espdl[] asm("_binary_pedestrian_detect_pico_s8_v1_espdl_start");
+
+extern "C" void app_main(void)
+{
+    benchmark((const char *)model_espdl, fbs::MODEL_LOCATION_IN_FLASH_RODATA, 20);
+}
+#else
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        printf("usage: %s <model.espdl> [runs]\n", argv[0]);
+        return 1;
+    }
+    benchmark(argv[1], fbs::MODEL_LOCATION_IN_SDCARD, argc > 2 ? atoi(argv[2]) : 20);
+    return 0;
+}
+#endif
@@ -5,6 +5,7 @@
 #include "esp_log.h"
 #include <limits>
 #include <map>
+#include <string_view>
 #include <typeinfo>
 #include <unordered_map>
 #include <vector>
@@ -358,6 +359,8 @@ public:
     bool m_param_copy; ///< copy flatbuffers param or not.
 
 private:
+#if CONFIG_DL_FBS_MODEL_PREBUILT
+    // Layout of the members fbs_loader/lib/<target>/libfbs_model.a was built with.
     bool m_auto_free;
     const uint8_t *m_data;
     const void *m_model;
@@ -366,5 +369,23 @@ private:
     std::map<std::string, const void *> m_name_to_value_info_map;
     std::unordered_map<std::string, const void *> m_name_to_test_inputs_value_map;
     std::unordered_map<std::string, const void *> m_name_to_test_outputs_value_map;
+#else
+    typedef std::unordered_map<std::string_view, const void *> name_map_t;
+
+    bool m_auto_free;
+    const uint8_t *m_data;
+    const void *m_model;
+    // Names point into the model data, filled by load_map() so lookups do not scan the graph.
+    name_map_t m_name_to_node_map;
+    name_map_t m_name_to_initial_tensor_map;
+    name_map_t m_name_to_value_info_map;
+    name_map_t m_name_to_test_inputs_value_map;
+    name_map_t m_name_to_test_outputs_value_map;
+
+    const void *find_node(const std::string &node_name);
+    const void *find_initial_tensor(const std::string &tensor_name);
+    const void *find_value_info(const std::string &var_name);
+    const void *find_attribute(const std::string &node_name, const std::string &attribute_name);
+#endif
 };
 } // namespace fbs
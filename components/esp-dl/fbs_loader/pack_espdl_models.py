@@ -43,20 +43,20 @@ def get_model_format(filename):
         return format
 
 
-def read_data(filename, format):
+def read_data(filename, format, align=16):
     """
     Read binary data, like index and mndata
     """
     data = None
     with open(filename, "rb") as f:
         data = f.read()
-    if format == "EDL2" and len(data) % 16 != 0:
-        padding = 16 - len(data) % 16
+    if format == "EDL2" and len(data) % align != 0:
+        padding = align - len(data) % align
         data += struct.pack("x") * padding
     return data
 
 
-def pack_models(model_path_or_dir, out_file="models.espdl"):
+def pack_models(model_path_or_dir, out_file="models.espdl", align=16):
     """
     Pack all models into one binary file by the following format:
     {
@@ -99,9 +99,15 @@ def pack_models(model_path_or_dir, out_file="models.espdl"):
         zero padding
     }
 
+    The parameters inside an EDL2 model are aligned to 16 bytes relative to its data, so every EDL2 model starts at
+    a multiple of align. Embedded with target_add_aligned_binary_data() or flashed to a partition, the parameters
+    can be read in place from flash with param_copy = false.
+
     model_path: the path of models
     out_file: the ouput binary filename
+    align: alignment of every EDL2 model in the pack, a power of two and at least 16, e.g. the cache line size
     """
+    assert align >= 16 and align & (align - 1) == 0, "align must be a power of two and at least 16."
 
     if len(model_path_or_dir) == 1:
         model_path_or_dir = Path(model_path_or_dir[0])
@@ -128,7 +134,7 @@ def pack_models(model_path_or_dir, out_file="models.espdl"):
     name_length = 0
     for model_file in model_files:
         model_names.append(model_file.name)
-        model_bins.append(read_data(model_file, format))
+        model_bins.append(read_data(model_file, format, align))
         name_length += len(model_file.name)
         print(model_file.name)
 
@@ -143,7 +149,7 @@ def pack_models(model_path_or_dir, out_file="models.espdl"):
         data_offset = name_offset + name_length
         padding_bin = b""
     else:
-        data_offset = (name_offset + name_length + 15) & ~15
+        data_offset = (name_offset + name_length + align - 1) & ~(align - 1)
         padding_bin = struct.pack("x") * (data_offset - name_offset - name_length)
     name_bin = None
     data_bin = None
@@ -181,6 +187,13 @@ if __name__ == "__main__":
         default="models.espdl",
         help="the path of binary file",
     )
+    parser.add_argument(
+        "-a",
+        "--align",
+        type=int,
+        default=16,
+        help="the alignment of every model in the pack, at least 16",
+    )
     args = parser.parse_args()
 
-    pack_models(args.model_path, out_file=args.out_file)
+    pack_models(args.model_path, out_file=args.out_file, align=args.align)
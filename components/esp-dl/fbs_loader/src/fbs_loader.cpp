@@ -1,8 +1,15 @@
 #include "fbs_loader.hpp"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 #include "mbedtls/aes.h"
+#include <algorithm>
 
 static const char *TAG = "FbsLoader";
 
+// Bytes of an encrypted model read from the sdcard at a time, one chunk is decrypted while the next one is read.
+#define FBS_LOADER_CHUNK_SIZE (32 * 1024)
+
 namespace fbs {
 
 /**
@@ -29,6 +36,93 @@ void fbs_aes_crypt_ctr(const uint8_t *ciphertext, uint8_t *plaintext, size_t siz
     mbedtls_aes_free(&aes_ctx);
 }
 
+typedef struct {
+    FILE *file;
+    uint8_t *data;
+    size_t size;
+    bool failed;                   /*<! A read came back short, set before chunk_ready is given >*/
+    SemaphoreHandle_t chunk_ready; /*<! Given once per chunk read >*/
+    SemaphoreHandle_t done;        /*<! Given when the reader stops >*/
+} fbs_stream_t;
+
+static void fbs_stream_reader(void *arg)
+{
+    fbs_stream_t *stream = (fbs_stream_t *)arg;
+    for (size_t offset = 0; offset < stream->size; offset += FBS_LOADER_CHUNK_SIZE) {
+        size_t n = std::min((size_t)FBS_LOADER_CHUNK_SIZE, stream->size - offset);
+        if (fread(stream->data + offset, 1, n, stream->file) != n) {
+            stream->failed = true;
+            xSemaphoreGive(stream->chunk_ready);
+            break;
+        }
+        xSemaphoreGive(stream->chunk_ready);
+    }
+    xSemaphoreGive(stream->done);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Read the data of a model from a file into its final buffer, decrypting it in place chunk by chunk.
+ *
+ * A reader task reads chunk k + 1 from the file while chunk k is decrypted, so no second buffer of the model size is
+ * needed and the sdcard does not wait for the AES. Without the task the chunks are read and decrypted in turn.
+ *
+ * @param file  File positioned at the data of the model
+ * @param data  Buffer of size bytes
+ * @param size  Size of the data
+ * @param key   128-bit AES key, nullptr if the model is not encrypted
+ * @return ESP_OK on success, ESP_FAIL if the file is shorter than size
+ */
+static esp_err_t fbs_read_model(FILE *file, uint8_t *data, size_t size, const uint8_t *key)
+{
+    if (!key) {
+        return fread(data, 1, size, file) == size ? ESP_OK : ESP_FAIL;
+    }
+
+    mbedtls_aes_context aes_ctx;
+    size_t nc_offset = 0;
+    uint8_t nonce[16] = {
+        0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F};
+    uint8_t stream_block[16];
+    mbedtls_aes_init(&aes_ctx);
+    mbedtls_aes_setkey_enc(&aes_ctx, key, 128); // 128-bit key
+
+    size_t chunk_num = (size + FBS_LOADER_CHUNK_SIZE - 1) / FBS_LOADER_CHUNK_SIZE;
+    fbs_stream_t stream = {file, data, size, false, nullptr, nullptr};
+    stream.chunk_ready = xSemaphoreCreateCounting(chunk_num ? chunk_num : 1, 0);
+    stream.done = xSemaphoreCreateBinary();
+    bool streaming = stream.chunk_ready && stream.done &&
+        xTaskCreate(fbs_stream_reader, "fbs_reader", 4096, &stream, uxTaskPriorityGet(NULL), NULL) == pdPASS;
+
+    esp_err_t ret = ESP_OK;
+    for (size_t i = 0; i < chunk_num; i++) {
+        uint8_t *chunk = data + i * FBS_LOADER_CHUNK_SIZE;
+        size_t n = std::min((size_t)FBS_LOADER_CHUNK_SIZE, size - i * FBS_LOADER_CHUNK_SIZE);
+        if (streaming) {
+            xSemaphoreTake(stream.chunk_ready, portMAX_DELAY);
+        } else {
+            stream.failed = fread(chunk, 1, n, file) != n;
+        }
+        if (stream.failed) {
+            ret = ESP_FAIL;
+            break;
+        }
+        // CTR mode keeps its counter across calls, so decrypting the chunks one by one equals decrypting all at once.
+        mbedtls_aes_crypt_ctr(&aes_ctx, n, &nc_offset, nonce, stream_block, chunk, chunk);
+    }
+    if (streaming) {
+        xSemaphoreTake(stream.done, portMAX_DELAY);
+    }
+    if (stream.chunk_ready) {
+        vSemaphoreDelete(stream.chunk_ready);
+    }
+    if (stream.done) {
+        vSemaphoreDelete(stream.done);
+    }
+    mbedtls_aes_free(&aes_ctx);
+    return ret;
+}
+
 /**
     FBS_FILE_FORMAT_EDL1:
     {
@@ -243,11 +337,37 @@ FbsModel *create_fbs_model(const char *fbs_buf,
         fseek(f, offset + 4, SEEK_SET);
         fread(&mode, 4, 1, f);
         fread(&size, 4, 1, f);
+        if (mode > 1) {
+            ESP_LOGE(TAG, "Unsupported cryptographic mode %lu of %s.", (unsigned long)mode, fbs_buf);
+            fclose(f);
+            return nullptr;
+        }
+        if (mode == 1 && key == NULL) {
+            ESP_LOGE(TAG, "This is a cryptographic model, please enter the secret key!");
+            fclose(f);
+            return nullptr;
+        }
         model_buf = (char *)dl::tool::malloc_aligned(size, 1, 16, MALLOC_CAP_8BIT | MALLOC_CAP_SPIRAM);
+        if (!model_buf) {
+            ESP_LOGE(TAG, "Failed to allocate %lu bytes for %s.", (unsigned long)size, fbs_buf);
+            fclose(f);
+            return nullptr;
+        }
         if (format == FBS_FILE_FORMAT_EDL2 || format == FBS_FILE_FORMAT_PDL2) {
             fseek(f, 4, SEEK_CUR);
         }
-        fread(model_buf, size, 1, f);
+        // An encrypted model is decrypted in place while it is read, there is no second copy of it.
+        esp_err_t ret = fbs_read_model(f, (uint8_t *)model_buf, size, mode == 1 ? key : nullptr);
+        fclose(f);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to read %s.", fbs_buf);
+            heap_caps_free(model_buf);
+            return nullptr;
+        }
+        if (mode == 1) {
+            bool real_param_copy = format == FBS_FILE_FORMAT_EDL1 || format == FBS_FILE_FORMAT_PDL1;
+            return new FbsModel(model_buf, true, real_param_copy);
+        }
     }
 
     if (mode != 0 && key == NULL) {
@@ -274,9 +394,12 @@ FbsModel *create_fbs_model(const char *fbs_buf,
                 bool address_align = !(reinterpret_cast<uintptr_t>(model_buf) & 0xf);
                 real_param_copy = param_copy;
                 if (!param_copy && !address_align) {
-                    ESP_LOGW(
-                        TAG,
-                        "Failed to set param_copy to false, The address of fbs model is not aligned with 16 bytes.");
+                    // The kernels need 16 bytes aligned parameters, they are aligned inside the model data only.
+                    ESP_LOGW(TAG,
+                             "Failed to set param_copy to false, the model data at %p is not aligned with 16 bytes. "
+                             "Embed the model with target_add_aligned_binary_data() and pack it with "
+                             "pack_espdl_models.py.",
+                             model_buf);
                     real_param_copy = true;
                 }
 #if CONFIG_SPIRAM_RODATA
@@ -290,9 +413,6 @@ FbsModel *create_fbs_model(const char *fbs_buf,
     } else if (mode == 1) { // 128-bit AES encryption
         uint8_t *m_data = (uint8_t *)dl::tool::malloc_aligned(size, 1, 16, MALLOC_CAP_8BIT | MALLOC_CAP_SPIRAM);
         fbs_aes_crypt_ctr((const uint8_t *)model_buf, m_data, size, key);
-        if (model_location == MODEL_LOCATION_IN_SDCARD) {
-            heap_caps_free(model_buf);
-        }
         if (format == FBS_FILE_FORMAT_EDL1 || format == FBS_FILE_FORMAT_PDL1) {
             return new FbsModel(m_data, true, true);
         } else {
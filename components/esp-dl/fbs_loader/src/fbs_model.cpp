@@ -0,0 +1,579 @@
+#include "fbs_model.hpp"
+#include "fbs_schema.hpp"
+#include <algorithm>
+
+static const char *TAG = "FbsModel";
+
+namespace fbs {
+
+/**
+ * @brief Find a table by name, in the map once load_map() filled it, by scanning the tables otherwise.
+ */
+template <typename T>
+static const void *find_table(const std::unordered_map<std::string_view, const void *> &map,
+                              schema::Vector<schema::TableOffset<T>> tables,
+                              std::string_view name)
+{
+    if (!map.empty()) {
+        auto iter = map.find(name);
+        return iter == map.end() ? nullptr : iter->second;
+    }
+    for (uint32_t i = 0; i < tables.size(); i++) {
+        T table = tables[i];
+        if (table.name() == name) {
+            return table.get_pointer();
+        }
+    }
+    return nullptr;
+}
+
+template <typename T>
+static void insert_tables(std::unordered_map<std::string_view, const void *> &map,
+                          schema::Vector<schema::TableOffset<T>> tables)
+{
+    for (uint32_t i = 0; i < tables.size(); i++) {
+        T table = tables[i];
+        map.emplace(table.name(), table.get_pointer());
+    }
+}
+
+static std::vector<int> to_int_vector(schema::Vector<schema::Scalar<int64_t>> values)
+{
+    std::vector<int> ret(values.size());
+    for (uint32_t i = 0; i < values.size(); i++) {
+        ret[i] = values[i];
+    }
+    return ret;
+}
+
+static std::vector<int> get_value_info_shape(schema::ValueInfo value_info)
+{
+    schema::Vector<schema::TableOffset<schema::Dimension>> dims = value_info.value_info_type().value().shape().dim();
+    std::vector<int> shape(dims.size());
+    for (uint32_t i = 0; i < dims.size(); i++) {
+        shape[i] = dims[i].value().dim_value();
+    }
+    return shape;
+}
+
+/**
+ * @brief Create a tensor of an initializer or of a tensor attribute, pointing into the model data unless deep.
+ */
+static dl::TensorBase *create_tensor(schema::Tensor tensor, bool deep, uint32_t caps)
+{
+    schema::Vector<schema::Scalar<int64_t>> exponents = tensor.exponents();
+    return new dl::TensorBase(to_int_vector(tensor.dims()),
+                              tensor.raw_data(),
+                              exponents.size() ? exponents[0] : 0,
+                              static_cast<dl::dtype_t>(tensor.data_type()),
+                              deep,
+                              caps);
+}
+
+static schema::Graph get_graph(const void *model)
+{
+    return schema::Model((const uint8_t *)model).graph();
+}
+
+FbsModel::FbsModel(const void *data, bool auto_free, bool param_copy) :
+    m_param_copy(param_copy), m_auto_free(auto_free), m_data((const uint8_t *)data), m_model(nullptr)
+{
+    if (m_data) {
+        m_model = schema::get_model(m_data).get_pointer();
+    }
+}
+
+FbsModel::~FbsModel()
+{
+    this->clear_map();
+    if (m_auto_free && m_data) {
+        heap_caps_free(const_cast<uint8_t *>(m_data));
+    }
+    m_data = nullptr;
+    m_model = nullptr;
+}
+
+void FbsModel::print()
+{
+    schema::Graph graph = get_graph(m_model);
+    schema::Vector<schema::TableOffset<schema::Node>> nodes = graph.node();
+    ESP_LOGI(TAG,
+             "model: %s, version: %lld, nodes: %ld, initializers: %ld",
+             this->get_model_name().c_str(),
+             this->get_model_version(),
+             (long)nodes.size(),
+             (long)graph.initializer().size());
+    for (uint32_t i = 0; i < nodes.size(); i++) {
+        schema::Node node = nodes[i];
+        std::string line = std::string(node.op_type()) + " " + std::string(node.name()) + ": (";
+        for (uint32_t j = 0; j < node.input().size(); j++) {
+            line += (j ? ", " : "") + std::string(node.input()[j]);
+        }
+        line += ") -> (";
+        for (uint32_t j = 0; j < node.output().size(); j++) {
+            line += (j ? ", " : "") + std::string(node.output()[j]);
+        }
+        ESP_LOGI(TAG, "%s)", line.c_str());
+    }
+}
+
+void FbsModel::load_map()
+{
+    this->clear_map();
+    schema::Graph graph = get_graph(m_model);
+
+    m_name_to_node_map.reserve(graph.node().size());
+    insert_tables(m_name_to_node_map, graph.node());
+    m_name_to_initial_tensor_map.reserve(graph.initializer().size());
+    insert_tables(m_name_to_initial_tensor_map, graph.initializer());
+    m_name_to_value_info_map.reserve(graph.value_info().size() + graph.input().size() + graph.output().size());
+    insert_tables(m_name_to_value_info_map, graph.value_info());
+    insert_tables(m_name_to_value_info_map, graph.input());
+    insert_tables(m_name_to_value_info_map, graph.output());
+    insert_tables(m_name_to_test_inputs_value_map, graph.test_inputs_value());
+    insert_tables(m_name_to_test_outputs_value_map, graph.test_outputs_value());
+}
+
+void FbsModel::clear_map()
+{
+    m_name_to_node_map = name_map_t();
+    m_name_to_initial_tensor_map = name_map_t();
+    m_name_to_value_info_map = name_map_t();
+    m_name_to_test_inputs_value_map = name_map_t();
+    m_name_to_test_outputs_value_map = name_map_t();
+}
+
+const void *FbsModel::find_node(const std::string &node_name)
+{
+    return find_table(m_name_to_node_map, get_graph(m_model).node(), node_name);
+}
+
+const void *FbsModel::find_initial_tensor(const std::string &tensor_name)
+{
+    return find_table(m_name_to_initial_tensor_map, get_graph(m_model).initializer(), tensor_name);
+}
+
+const void *FbsModel::find_value_info(const std::string &var_name)
+{
+    // The map holds the graph inputs and outputs too, see load_map().
+    schema::Graph graph = get_graph(m_model);
+    const void *value_info = find_table(m_name_to_value_info_map, graph.value_info(), var_name);
+    if (!value_info) {
+        value_info = find_table(m_name_to_value_info_map, graph.input(), var_name);
+    }
+    if (!value_info) {
+        value_info = find_table(m_name_to_value_info_map, graph.output(), var_name);
+    }
+    return value_info;
+}
+
+const void *FbsModel::find_attribute(const std::string &node_name, const std::string &attribute_name)
+{
+    schema::Node node((const uint8_t *)this->find_node(node_name));
+    // A node has a handful of attributes, a scan is cheaper than a map.
+    schema::Vector<schema::TableOffset<schema::Attribute>> attributes = node.attribute();
+    for (uint32_t i = 0; i < attributes.size(); i++) {
+        schema::Attribute attribute = attributes[i];
+        if (attribute.name() == attribute_name) {
+            return attribute.get_pointer();
+        }
+    }
+    return nullptr;
+}
+
+std::vector<std::string> FbsModel::topological_sort()
+{
+    schema::Vector<schema::TableOffset<schema::Node>> nodes = get_graph(m_model).node();
+    int node_num = nodes.size();
+
+    std::unordered_map<std::string_view, int> producer;
+    for (int i = 0; i < node_num; i++) {
+        schema::Vector<schema::String> outputs = nodes[i].output();
+        for (uint32_t j = 0; j < outputs.size(); j++) {
+            producer.emplace(outputs[j], i);
+        }
+    }
+
+    // Edges from producer to reader, every pair once, then grouped by producer.
+    std::vector<std::pair<int, int>> edges;
+    std::vector<int> pending(node_num, 0);
+    for (int i = 0; i < node_num; i++) {
+        schema::Vector<schema::String> inputs = nodes[i].input();
+        size_t first_edge = edges.size();
+        for (uint32_t j = 0; j < inputs.size(); j++) {
+            auto iter = producer.find(inputs[j]);
+            if (iter != producer.end() && iter->second != i) {
+                edges.emplace_back(iter->second, i);
+            }
+        }
+        std::sort(edges.begin() + first_edge, edges.end());
+        edges.erase(std::unique(edges.begin() + first_edge, edges.end()), edges.end());
+        pending[i] = edges.size() - first_edge;
+    }
+    std::stable_sort(edges.begin(), edges.end(), [](const std::pair<int, int> &a, const std::pair<int, int> &b) {
+        return a.first < b.first;
+    });
+    std::vector<int> first_reader(node_num + 1, 0);
+    for (const std::pair<int, int> &edge : edges) {
+        first_reader[edge.first + 1]++;
+    }
+    for (int i = 0; i < node_num; i++) {
+        first_reader[i + 1] += first_reader[i];
+    }
+
+    // Kahn's algorithm, nodes that get ready together keep the order of the file.
+    std::vector<int> order;
+    order.reserve(node_num);
+    for (int i = 0; i < node_num; i++) {
+        if (pending[i] == 0) {
+            order.push_back(i);
+        }
+    }
+    for (size_t head = 0; head < order.size(); head++) {
+        int i = order[head];
+        for (int e = first_reader[i]; e < first_reader[i + 1]; e++) {
+            int reader = edges[e].second;
+            if (--pending[reader] == 0) {
+                order.push_back(reader);
+            }
+        }
+    }
+    if (order.size() != node_num) {
+        ESP_LOGE(TAG, "The graph has a cycle, %d of %d nodes are sorted.", (int)order.size(), node_num);
+    }
+
+    std::vector<std::string> sorted_nodes;
+    sorted_nodes.reserve(order.size());
+    for (int i : order) {
+        sorted_nodes.emplace_back(nodes[i].name());
+    }
+    return sorted_nodes;
+}
+
+esp_err_t FbsModel::get_operation_attribute(std::string node_name, std::string attribute_name, int &ret_value)
+{
+    schema::Attribute attribute((const uint8_t *)this->find_attribute(node_name, attribute_name));
+    if (!attribute.is_valid()) {
+        return ESP_FAIL;
+    }
+    ret_value = attribute.i();
+    return ESP_OK;
+}
+
+esp_err_t FbsModel::get_operation_attribute(std::string node_name, std::string attribute_name, float &ret_value)
+{
+    schema::Attribute attribute((const uint8_t *)this->find_attribute(node_name, attribute_name));
+    if (!attribute.is_valid()) {
+        return ESP_FAIL;
+    }
+    ret_value = attribute.f();
+    return ESP_OK;
+}
+
+esp_err_t FbsModel::get_operation_attribute(std::string node_name, std::string attribute_name, std::string &ret_value)
+{
+    schema::Attribute attribute((const uint8_t *)this->find_attribute(node_name, attribute_name));
+    if (!attribute.is_valid()) {
+        return ESP_FAIL;
+    }
+    ret_value = attribute.s();
+    return ESP_OK;
+}
+
+esp_err_t FbsModel::get_operation_attribute(std::string node_name,
+                                            std::string attribute_name,
+                                            std::vector<int> &ret_value)
+{
+    schema::Attribute attribute((const uint8_t *)this->find_attribute(node_name, attribute_name));
+    if (!attribute.is_valid()) {
+        return ESP_FAIL;
+    }
+    ret_value = to_int_vector(attribute.ints());
+    return ESP_OK;
+}
+
+esp_err_t FbsModel::get_operation_attribute(std::string node_name,
+                                            std::string attribute_name,
+                                            std::vector<float> &ret_value)
+{
+    schema::Attribute attribute((const uint8_t *)this->find_attribute(node_name, attribute_name));
+    if (!attribute.is_valid()) {
+        return ESP_FAIL;
+    }
+    schema::Vector<schema::Scalar<float>> floats = attribute.floats();
+    ret_value.resize(floats.size());
+    for (uint32_t i = 0; i < floats.size(); i++) {
+        ret_value[i] = floats[i];
+    }
+    return ESP_OK;
+}
+
+esp_err_t FbsModel::get_operation_attribute(std::string node_name,
+                                            std::string attribute_name,
+                                            dl::quant_type_t &ret_value)
+{
+    ret_value = dl::QUANT_TYPE_NONE;
+    schema::Attribute attribute((const uint8_t *)this->find_attribute(node_name, attribute_name));
+    std::string_view value = attribute.s();
+    if (value == "S8") {
+        ret_value = dl::QUANT_TYPE_SYMM_8BIT;
+    } else if (value == "S16") {
+        ret_value = dl::QUANT_TYPE_SYMM_16BIT;
+    } else if (value == "S32") {
+        ret_value = dl::QUANT_TYPE_SYMM_32BIT;
+    } else if (value == "F32") {
+        ret_value = dl::QUANT_TYPE_FLOAT32;
+    } else {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t FbsModel::get_operation_attribute(std::string node_name,
+                                            std::string attribute_name,
+                                            dl::activation_type_t &ret_value)
+{
+    ret_value = dl::Linear;
+    schema::Attribute attribute((const uint8_t *)this->find_attribute(node_name, attribute_name));
+    std::string_view value = attribute.s();
+    if (value == "Relu") {
+        ret_value = dl::ReLU;
+    } else if (value == "LeakyRelu") {
+        ret_value = dl::LeakyReLU;
+    } else if (value == "PRelu") {
+        ret_value = dl::PReLU;
+    } else if (value != "Linear") {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t FbsModel::get_operation_attribute(std::string node_name,
+                                            std::string attribute_name,
+                                            dl::resize_mode_t &ret_value)
+{
+    ret_value = dl::RESIZE_NEAREST;
+    schema::Attribute attribute((const uint8_t *)this->find_attribute(node_name, attribute_name));
+    std::string_view value = attribute.s();
+    if (value == "linear") {
+        ret_value = dl::RESIZE_LINEAR;
+    } else if (value == "cubic") {
+        ret_value = dl::RESIZE_CUBIC;
+    } else if (value != "nearest") {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t FbsModel::get_operation_attribute(std::string node_name,
+                                            std::string attribute_name,
+                                            dl::TensorBase *&ret_value)
+{
+    ret_value = nullptr;
+    schema::Attribute attribute((const uint8_t *)this->find_attribute(node_name, attribute_name));
+    schema::Tensor tensor = attribute.t();
+    if (!tensor.is_valid()) {
+        return ESP_FAIL;
+    }
+    ret_value = create_tensor(tensor, m_param_copy, MALLOC_CAP_SPIRAM);
+    return ESP_OK;
+}
+
+esp_err_t FbsModel::get_operation_output_shape(std::string node_name, int index, std::vector<int> &ret_value)
+{
+    schema::Node node((const uint8_t *)this->find_node(node_name));
+    schema::Vector<schema::String> outputs = node.output();
+    if (index < 0 || index >= outputs.size()) {
+        return ESP_FAIL;
+    }
+    schema::ValueInfo value_info((const uint8_t *)this->find_value_info(std::string(outputs[index])));
+    if (!value_info.is_valid()) {
+        return ESP_FAIL;
+    }
+    ret_value = fbs::get_value_info_shape(value_info);
+    return ESP_OK;
+}
+
+esp_err_t FbsModel::get_operation_inputs_and_outputs(std::string node_name,
+                                                     std::vector<std::string> &inputs,
+                                                     std::vector<std::string> &outputs)
+{
+    inputs.clear();
+    outputs.clear();
+    schema::Node node((const uint8_t *)this->find_node(node_name));
+    if (!node.is_valid()) {
+        return ESP_FAIL;
+    }
+    schema::Vector<schema::String> node_inputs = node.input();
+    schema::Vector<schema::String> node_outputs = node.output();
+    inputs.reserve(node_inputs.size());
+    for (uint32_t i = 0; i < node_inputs.size(); i++) {
+        inputs.emplace_back(node_inputs[i]);
+    }
+    outputs.reserve(node_outputs.size());
+    for (uint32_t i = 0; i < node_outputs.size(); i++) {
+        outputs.emplace_back(node_outputs[i]);
+    }
+    return ESP_OK;
+}
+
+std::string FbsModel::get_operation_type(std::string node_name)
+{
+    return std::string(schema::Node((const uint8_t *)this->find_node(node_name)).op_type());
+}
+
+dl::TensorBase *FbsModel::get_operation_parameter(std::string node_name, int index, uint32_t caps)
+{
+    schema::Node node((const uint8_t *)this->find_node(node_name));
+    schema::Vector<schema::String> inputs = node.input();
+    if (index < 0 || index >= inputs.size()) {
+        return nullptr;
+    }
+    schema::Tensor tensor((const uint8_t *)this->find_initial_tensor(std::string(inputs[index])));
+    if (!tensor.is_valid()) {
+        return nullptr;
+    }
+    return create_tensor(tensor, m_param_copy, caps);
+}
+
+dl::TensorBase *FbsModel::get_operation_lut(std::string node_name, uint32_t caps, std::string attribute_name)
+{
+    schema::Attribute attribute((const uint8_t *)this->find_attribute(node_name, attribute_name));
+    if (!attribute.is_valid()) {
+        return nullptr;
+    }
+    schema::Tensor tensor((const uint8_t *)this->find_initial_tensor(std::string(attribute.s())));
+    if (!tensor.is_valid()) {
+        return nullptr;
+    }
+    return create_tensor(tensor, m_param_copy, caps);
+}
+
+bool FbsModel::is_parameter(std::string name)
+{
+    return this->find_initial_tensor(name) != nullptr;
+}
+
+const void *FbsModel::get_tensor_raw_data(std::string tensor_name)
+{
+    return schema::Tensor((const uint8_t *)this->find_initial_tensor(tensor_name)).raw_data();
+}
+
+dl::dtype_t FbsModel::get_tensor_dtype(std::string tensor_name)
+{
+    schema::Tensor tensor((const uint8_t *)this->find_initial_tensor(tensor_name));
+    return static_cast<dl::dtype_t>(tensor.data_type());
+}
+
+std::vector<int> FbsModel::get_tensor_shape(std::string tensor_name)
+{
+    return to_int_vector(schema::Tensor((const uint8_t *)this->find_initial_tensor(tensor_name)).dims());
+}
+
+std::vector<int> FbsModel::get_tensor_exponents(std::string tensor_name)
+{
+    return to_int_vector(schema::Tensor((const uint8_t *)this->find_initial_tensor(tensor_name)).exponents());
+}
+
+dl::dtype_t FbsModel::get_value_info_dtype(std::string var_name)
+{
+    schema::ValueInfo value_info((const uint8_t *)this->find_value_info(var_name));
+    return static_cast<dl::dtype_t>(value_info.value_info_type().value().elem_type());
+}
+
+std::vector<int> FbsModel::get_value_info_shape(std::string var_name)
+{
+    return fbs::get_value_info_shape(schema::ValueInfo((const uint8_t *)this->find_value_info(var_name)));
+}
+
+int FbsModel::get_value_info_exponent(std::string var_name)
+{
+    schema::Vector<schema::Scalar<int64_t>> exponents =
+        schema::ValueInfo((const uint8_t *)this->find_value_info(var_name)).exponents();
+    if (exponents.size() > 1) {
+        ESP_LOGW(TAG, "%s is quantized per channel, only the first exponent is returned.", var_name.c_str());
+    }
+    return exponents.size() ? exponents[0] : 0;
+}
+
+const void *FbsModel::get_test_input_tensor_raw_data(std::string tensor_name)
+{
+    schema::Graph graph = get_graph(m_model);
+    schema::Tensor tensor(
+        (const uint8_t *)find_table(m_name_to_test_inputs_value_map, graph.test_inputs_value(), tensor_name));
+    return tensor.raw_data();
+}
+
+const void *FbsModel::get_test_output_tensor_raw_data(std::string tensor_name)
+{
+    schema::Graph graph = get_graph(m_model);
+    schema::Tensor tensor(
+        (const uint8_t *)find_table(m_name_to_test_outputs_value_map, graph.test_outputs_value(), tensor_name));
+    return tensor.raw_data();
+}
+
+dl::TensorBase *FbsModel::get_test_input_tensor(std::string tensor_name, uint32_t caps)
+{
+    schema::Graph graph = get_graph(m_model);
+    schema::Tensor tensor(
+        (const uint8_t *)find_table(m_name_to_test_inputs_value_map, graph.test_inputs_value(), tensor_name));
+    return tensor.is_valid() ? create_tensor(tensor, true, caps) : nullptr;
+}
+
+dl::TensorBase *FbsModel::get_test_output_tensor(std::string tensor_name, uint32_t caps)
+{
+    schema::Graph graph = get_graph(m_model);
+    schema::Tensor tensor(
+        (const uint8_t *)find_table(m_name_to_test_outputs_value_map, graph.test_outputs_value(), tensor_name));
+    return tensor.is_valid() ? create_tensor(tensor, true, caps) : nullptr;
+}
+
+std::vector<std::string> FbsModel::get_test_outputs_name()
+{
+    schema::Vector<schema::TableOffset<schema::Tensor>> tensors = get_graph(m_model).test_outputs_value();
+    std::vector<std::string> names;
+    names.reserve(tensors.size());
+    for (uint32_t i = 0; i < tensors.size(); i++) {
+        names.emplace_back(tensors[i].name());
+    }
+    return names;
+}
+
+std::vector<std::string> FbsModel::get_graph_inputs()
+{
+    schema::Vector<schema::TableOffset<schema::ValueInfo>> inputs = get_graph(m_model).input();
+    std::vector<std::string> names;
+    names.reserve(inputs.size());
+    for (uint32_t i = 0; i < inputs.size(); i++) {
+        names.emplace_back(inputs[i].name());
+    }
+    return names;
+}
+
+std::vector<std::string> FbsModel::get_graph_outputs()
+{
+    schema::Vector<schema::TableOffset<schema::ValueInfo>> outputs = get_graph(m_model).output();
+    std::vector<std::string> names;
+    names.reserve(outputs.size());
+    for (uint32_t i = 0; i < outputs.size(); i++) {
+        names.emplace_back(outputs[i].name());
+    }
+    return names;
+}
+
+std::string FbsModel::get_model_name()
+{
+    return std::string(get_graph(m_model).name());
+}
+
+int64_t FbsModel::get_model_version()
+{
+    return schema::Model((const uint8_t *)m_model).model_version();
+}
+
+std::string FbsModel::get_model_doc_string()
+{
+    return std::string(schema::Model((const uint8_t *)m_model).doc_string());
+}
+
+} // namespace fbs
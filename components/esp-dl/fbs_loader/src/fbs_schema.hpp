@@ -0,0 +1,228 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <string_view>
+
+/**
+ * Accessors of the espdl FlatBuffers schema written by esp-ppq, in the shape of the code flatc generates: every table
+ * is a pointer into the model data, fields are read through the vtable on access and nothing is copied. Only the
+ * tables and fields FbsModel reads are declared, the field slots follow the schema:
+ *
+ *     Model:          ir_version(0), opset_import(1), ..., model_version(5), doc_string(6), graph(7)
+ *     Graph:          node(0), name(1), initializer(2), doc_string(3), input(4), output(5), value_info(6),
+ *                     quantization_annotation(7), test_inputs_value(8), test_outputs_value(9)
+ *     Node:           input(0), output(1), name(2), op_type(3), domain(4), attribute(5), doc_string(6)
+ *     Attribute:      name(0), ref_attr_name(1), doc_string(2), attr_type(3), f(4), i(5), s(6), t(7), g(8), ...,
+ *                     floats(10), ints(11)
+ *     Tensor:         dims(0), data_type(1), ..., name(6), ..., raw_data(8), ..., exponents(13)
+ *     ValueInfo:      name(0), value_info_type(1), doc_string(2), exponents(3)
+ *     TypeInfo:       value_type(0), value(1) -> TensorTypeInfo
+ *     TensorTypeInfo: elem_type(0), shape(1) -> TensorShape(dim(0)) -> Dimension(value(0)) -> DimensionValue
+ *     DimensionValue: dim_type(0), dim_value(1), dim_param(2)
+ */
+namespace fbs {
+namespace schema {
+
+typedef enum {
+    ATTRIBUTE_TYPE_UNDEFINED = 0,
+    ATTRIBUTE_TYPE_FLOAT = 1,
+    ATTRIBUTE_TYPE_INT = 2,
+    ATTRIBUTE_TYPE_STRING = 3,
+    ATTRIBUTE_TYPE_TENSOR = 4,
+    ATTRIBUTE_TYPE_GRAPH = 5,
+    ATTRIBUTE_TYPE_FLOATS = 6,
+    ATTRIBUTE_TYPE_INTS = 7,
+} attribute_type_t;
+
+// The data is little endian like the chips, memcpy keeps unaligned reads legal.
+template <typename T>
+inline T read_scalar(const uint8_t *p)
+{
+    T value;
+    memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+inline const uint8_t *follow_offset(const uint8_t *p)
+{
+    return p + read_scalar<uint32_t>(p);
+}
+
+/**
+ * @brief A vector of scalars, of structs or of offsets to tables and strings.
+ */
+template <typename T>
+class Vector {
+public:
+    Vector(const uint8_t *p = nullptr) : m_p(p) {}
+    uint32_t size() const { return m_p ? read_scalar<uint32_t>(m_p) : 0; }
+    const uint8_t *data() const { return m_p ? m_p + 4 : nullptr; }
+    auto operator[](uint32_t i) const { return T::read(data() + i * T::element_size); }
+
+private:
+    const uint8_t *m_p;
+};
+
+template <typename T>
+struct Scalar {
+    static const uint32_t element_size = sizeof(T);
+    static T read(const uint8_t *p) { return read_scalar<T>(p); }
+};
+
+struct String {
+    static const uint32_t element_size = 4;
+    static std::string_view read(const uint8_t *p) { return view(follow_offset(p)); }
+    static std::string_view view(const uint8_t *p)
+    {
+        return p ? std::string_view((const char *)p + 4, read_scalar<uint32_t>(p)) : std::string_view();
+    }
+};
+
+class Table {
+public:
+    Table(const uint8_t *p = nullptr) : m_p(p) {}
+    bool is_valid() const { return m_p != nullptr; }
+    const uint8_t *get_pointer() const { return m_p; }
+
+protected:
+    // A missing table reads as a table without fields.
+    const uint8_t *field(int slot) const
+    {
+        if (!m_p) {
+            return nullptr;
+        }
+        const uint8_t *vtable = m_p - read_scalar<int32_t>(m_p);
+        uint16_t vtable_size = read_scalar<uint16_t>(vtable);
+        uint16_t offset = 4 + 2 * slot < vtable_size ? read_scalar<uint16_t>(vtable + 4 + 2 * slot) : 0;
+        return offset ? m_p + offset : nullptr;
+    }
+
+    template <typename T>
+    T get_scalar(int slot, T default_value = 0) const
+    {
+        const uint8_t *p = this->field(slot);
+        return p ? read_scalar<T>(p) : default_value;
+    }
+
+    const uint8_t *get_offset(int slot) const
+    {
+        const uint8_t *p = this->field(slot);
+        return p ? follow_offset(p) : nullptr;
+    }
+
+    std::string_view get_string(int slot) const { return String::view(this->get_offset(slot)); }
+
+    const uint8_t *m_p;
+};
+
+template <typename T>
+struct TableOffset {
+    static const uint32_t element_size = 4;
+    static T read(const uint8_t *p) { return T(follow_offset(p)); }
+};
+
+class DimensionValue : public Table {
+public:
+    using Table::Table;
+    int64_t dim_value() const { return get_scalar<int64_t>(1); }
+};
+
+class Dimension : public Table {
+public:
+    using Table::Table;
+    DimensionValue value() const { return DimensionValue(get_offset(0)); }
+};
+
+class TensorShape : public Table {
+public:
+    using Table::Table;
+    Vector<TableOffset<Dimension>> dim() const { return get_offset(0); }
+};
+
+class TensorTypeInfo : public Table {
+public:
+    using Table::Table;
+    int32_t elem_type() const { return get_scalar<int32_t>(0); }
+    TensorShape shape() const { return TensorShape(get_offset(1)); }
+};
+
+class TypeInfo : public Table {
+public:
+    using Table::Table;
+    TensorTypeInfo value() const { return TensorTypeInfo(get_offset(1)); }
+};
+
+class ValueInfo : public Table {
+public:
+    using Table::Table;
+    std::string_view name() const { return get_string(0); }
+    TypeInfo value_info_type() const { return TypeInfo(get_offset(1)); }
+    Vector<Scalar<int64_t>> exponents() const { return get_offset(3); }
+};
+
+class Tensor : public Table {
+public:
+    using Table::Table;
+    Vector<Scalar<int64_t>> dims() const { return get_offset(0); }
+    int32_t data_type() const { return get_scalar<int32_t>(1); }
+    std::string_view name() const { return get_string(6); }
+    // A vector of 16 bytes structs, so the data is aligned like the model.
+    const uint8_t *raw_data() const { return Vector<Scalar<uint8_t>>(get_offset(8)).data(); }
+    Vector<Scalar<int64_t>> exponents() const { return get_offset(13); }
+};
+
+class Attribute : public Table {
+public:
+    using Table::Table;
+    std::string_view name() const { return get_string(0); }
+    int32_t attr_type() const { return get_scalar<int32_t>(3); }
+    float f() const { return get_scalar<float>(4); }
+    int64_t i() const { return get_scalar<int64_t>(5); }
+    std::string_view s() const { return String::view(get_offset(6)); }
+    Tensor t() const { return Tensor(get_offset(7)); }
+    Vector<Scalar<float>> floats() const { return get_offset(10); }
+    Vector<Scalar<int64_t>> ints() const { return get_offset(11); }
+};
+
+class Node : public Table {
+public:
+    using Table::Table;
+    Vector<String> input() const { return get_offset(0); }
+    Vector<String> output() const { return get_offset(1); }
+    std::string_view name() const { return get_string(2); }
+    std::string_view op_type() const { return get_string(3); }
+    Vector<TableOffset<Attribute>> attribute() const { return get_offset(5); }
+};
+
+class Graph : public Table {
+public:
+    using Table::Table;
+    Vector<TableOffset<Node>> node() const { return get_offset(0); }
+    std::string_view name() const { return get_string(1); }
+    Vector<TableOffset<Tensor>> initializer() const { return get_offset(2); }
+    Vector<TableOffset<ValueInfo>> input() const { return get_offset(4); }
+    Vector<TableOffset<ValueInfo>> output() const { return get_offset(5); }
+    Vector<TableOffset<ValueInfo>> value_info() const { return get_offset(6); }
+    Vector<TableOffset<Tensor>> test_inputs_value() const { return get_offset(8); }
+    Vector<TableOffset<Tensor>> test_outputs_value() const { return get_offset(9); }
+};
+
+class Model : public Table {
+public:
+    using Table::Table;
+    int64_t model_version() const { return get_scalar<int64_t>(5); }
+    std::string_view doc_string() const { return get_string(6); }
+    Graph graph() const { return Graph(get_offset(7)); }
+};
+
+/**
+ * @brief The root table of the model data.
+ */
+inline Model get_model(const void *data)
+{
+    return Model(follow_offset((const uint8_t *)data));
+}
+
+} // namespace schema
+} // namespace fbs
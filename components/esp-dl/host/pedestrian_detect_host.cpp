@@ -0,0 +1,135 @@
+#include "dl_image_bmp.hpp"
+#include "dl_model_profiler.hpp"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "pedestrian_detect.hpp"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "pedestrian_detect_host";
+
+// Gives the runner the model under the detector, to switch the profiler on.
+class HostPico : public pedestrian_detect::Pico {
+public:
+    HostPico(const char *model_name) : pedestrian_detect::Pico(model_name) {}
+    dl::Model *get_model() { return m_model; }
+};
+
+static void usage(const char *name)
+{
+    printf("usage: %s <model.espdl> [image.bmp] [-n runs] [-t trace.json] [-l]\n", name);
+    printf("  without an image a synthetic 640x480 RGB888 image is used\n");
+    printf("  -l copies the parameters of every layer on its first run instead of reading them in place\n");
+}
+
+// Horizontal and vertical gradients, stable across runs so latency and results can be compared.
+static dl::image::img_t make_synthetic_img(int width, int height)
+{
+    dl::image::img_t img = {nullptr, width, height, dl::image::DL_IMAGE_PIX_TYPE_RGB888};
+    uint8_t *data = (uint8_t *)heap_caps_malloc(width * height * 3, MALLOC_CAP_SPIRAM);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            uint8_t *pixel = data + (y * width + x) * 3;
+            pixel[0] = x * 255 / width;
+            pixel[1] = y * 255 / height;
+            pixel[2] = ((x / 32 + y / 32) & 1) ? 200 : 50;
+        }
+    }
+    img.data = data;
+    return img;
+}
+
+int main(int argc, char **argv)
+{
+    const char *model_path = nullptr;
+    const char *img_path = nullptr;
+    const char *trace_path = nullptr;
+    int runs = 10;
+    bool lazy_param_copy = false;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+            runs = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (!strcmp(argv[i], "-l")) {
+            lazy_param_copy = true;
+        } else if (!model_path) {
+            model_path = argv[i];
+        } else if (!img_path) {
+            img_path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!model_path || runs <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    dl::image::img_t img;
+    if (img_path) {
+        if (dl::image::read_bmp(img, img_path) != ESP_OK) {
+            return 1;
+        }
+    } else {
+        img = make_synthetic_img(640, 480);
+    }
+
+    int64_t create_start = esp_timer_get_time();
+    HostPico *detect = new HostPico(model_path);
+    dl::Model *model = detect->get_model();
+    int64_t create_end = esp_timer_get_time();
+    if (lazy_param_copy) {
+        model->set_lazy_param_copy(true);
+    }
+    if (trace_path) {
+        model->set_profiler(true);
+    }
+
+    // The first run touches every buffer once, it is left out of the latency.
+    std::span<const dl::detect::result_t> first = detect->run(img);
+    int result_num = first.size();
+    int64_t start = esp_timer_get_time();
+    ESP_LOGI(TAG,
+             "created the detector in %.3f ms, first run %.3f ms, %.3f ms after start",
+             (create_end - create_start) / 1000.f,
+             (start - create_end) / 1000.f,
+             start / 1000.f);
+    for (int i = 0; i < runs; i++) {
+        std::span<const dl::detect::result_t> res = detect->run(img);
+        if (res.size() != result_num) {
+            ESP_LOGW(TAG, "run %d found %d boxes, the first run found %d", i, (int)res.size(), result_num);
+        }
+    }
+    int64_t end = esp_timer_get_time();
+    ESP_LOGI(TAG, "%d runs, %.3f ms per run", runs, (end - start) / 1000.f / runs);
+
+    for (const auto &res : detect->run(img)) {
+        ESP_LOGI(TAG,
+                 "[category: %d, score: %f, x1: %d, y1: %d, x2: %d, y2: %d]",
+                 res.category,
+                 res.score,
+                 res.box[0],
+                 res.box[1],
+                 res.box[2],
+                 res.box[3]);
+    }
+
+    if (trace_path) {
+        dl::Profiler *profiler = model->get_profiler();
+        profiler->print();
+        FILE *f = fopen(trace_path, "w");
+        if (!f || profiler->export_chrome_trace(f) != ESP_OK) {
+            ESP_LOGE(TAG, "Fail to write %s", trace_path);
+        }
+        if (f) {
+            fclose(f);
+        }
+    }
+
+    delete detect;
+    heap_caps_free(img.data);
+    return 0;
+}
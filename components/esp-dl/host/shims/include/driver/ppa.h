@@ -0,0 +1,2 @@
+#pragma once
+// The PPA is only used on ESP32-P4, the host build includes the header for its declarations only.
@@ -0,0 +1,20 @@
+#pragma once
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Nanoseconds of the monotonic clock stand in for the cycle counter, i.e. a 1 GHz cpu.
+ */
+uint32_t esp_cpu_get_cycle_count(void);
+
+/**
+ * @brief The core the calling task was pinned to, 0 for threads not created through xTaskCreatePinnedToCore.
+ */
+int esp_cpu_get_core_id(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,34 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#define MALLOC_CAP_EXEC (1 << 0)
+#define MALLOC_CAP_32BIT (1 << 1)
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT (1 << 12)
+
+// Internal ram the host reports, the ESP32-S3 leaves about this much to the application. The internal ram budget of
+// the memory managers is planned against it like on the chip. PSRAM is the host memory.
+#ifndef HOST_INTERNAL_RAM_SIZE
+#define HOST_INTERNAL_RAM_SIZE (320 * 1024)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void *heap_caps_malloc(size_t size, uint32_t caps);
+void *heap_caps_calloc(size_t n, size_t size, uint32_t caps);
+void *heap_caps_realloc(void *ptr, size_t size, uint32_t caps);
+void *heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps);
+void *heap_caps_aligned_calloc(size_t alignment, size_t n, size_t size, uint32_t caps);
+void heap_caps_free(void *ptr);
+size_t heap_caps_get_free_size(uint32_t caps);
+size_t heap_caps_get_largest_free_block(uint32_t caps);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,16 @@
+#pragma once
+#include "sdkconfig.h"
+#include <stdio.h>
+
+// Same output as the default esp_log format, without colors and timestamps.
+#define ESP_LOG_LEVEL_PRINT(letter, tag, format, ...) printf(letter " (%s): " format "\n", tag, ##__VA_ARGS__)
+
+#define ESP_LOGE(tag, format, ...) ESP_LOG_LEVEL_PRINT("E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) ESP_LOG_LEVEL_PRINT("W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) ESP_LOG_LEVEL_PRINT("I", tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) \
+    do {                           \
+    } while (0)
+#define ESP_LOGV(tag, format, ...) \
+    do {                           \
+    } while (0)
@@ -0,0 +1,15 @@
+#pragma once
+#include <stdbool.h>
+
+// The host has a single kind of memory, nothing counts as PSRAM.
+static inline bool esp_ptr_external_ram(const void *p)
+{
+    (void)p;
+    return false;
+}
+
+static inline bool esp_ptr_internal(const void *p)
+{
+    (void)p;
+    return true;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "esp_err.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// The host has no flash partitions, esp_partition_find_first() finds nothing and models are loaded from files.
+
+typedef enum { ESP_PARTITION_TYPE_APP = 0x00, ESP_PARTITION_TYPE_DATA = 0x01 } esp_partition_type_t;
+typedef enum { ESP_PARTITION_SUBTYPE_ANY = 0xff } esp_partition_subtype_t;
+typedef enum { ESP_PARTITION_MMAP_DATA, ESP_PARTITION_MMAP_INST } esp_partition_mmap_memory_t;
+typedef uint32_t esp_partition_mmap_handle_t;
+
+typedef struct {
+    esp_partition_type_t type;
+    esp_partition_subtype_t subtype;
+    uint32_t address;
+    uint32_t size;
+    char label[17];
+} esp_partition_t;
+
+static inline const esp_partition_t *esp_partition_find_first(esp_partition_type_t type,
+                                                              esp_partition_subtype_t subtype,
+                                                              const char *label)
+{
+    (void)type;
+    (void)subtype;
+    (void)label;
+    return NULL;
+}
+
+static inline esp_err_t esp_partition_mmap(const esp_partition_t *partition,
+                                           size_t offset,
+                                           size_t size,
+                                           esp_partition_mmap_memory_t memory,
+                                           const void **out_ptr,
+                                           esp_partition_mmap_handle_t *out_handle)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+static inline void esp_partition_munmap(esp_partition_mmap_handle_t handle)
+{
+    (void)handle;
+}
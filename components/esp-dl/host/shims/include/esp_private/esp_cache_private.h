@@ -0,0 +1,10 @@
+#pragma once
+#include "esp_cache.h"
+#include <stdint.h>
+
+static inline esp_err_t esp_cache_get_alignment(uint32_t heap_caps, size_t *out_alignment)
+{
+    (void)heap_caps;
+    *out_alignment = 64;
+    return ESP_OK;
+}
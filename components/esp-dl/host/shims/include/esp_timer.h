@@ -0,0 +1,15 @@
+#pragma once
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Microseconds of the monotonic clock, like the time since boot on the chip.
+ */
+int64_t esp_timer_get_time(void);
+
+#ifdef __cplusplus
+}
+#endif
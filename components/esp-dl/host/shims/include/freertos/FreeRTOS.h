@@ -0,0 +1,38 @@
+#pragma once
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "sdkconfig.h"
+#include <assert.h>
+#include <stdint.h>
+
+// Like on the chip, FreeRTOS.h also brings the sdkconfig, heap caps and assert.
+
+// FreeRTOS on top of pthreads, enough for the worker pool, the graph scheduler and the weight prefetcher. A tick is
+// one millisecond.
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define configMAX_PRIORITIES 25
+#define tskNO_AFFINITY 0x7fffffff
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief The core the calling task was pinned to, see esp_cpu_get_core_id().
+ */
+BaseType_t xPortGetCoreID(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,29 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_semaphore *SemaphoreHandle_t;
+
+// Storage of a static semaphore, large enough for the mutex and condition variable of the host semaphore.
+typedef union {
+    unsigned char storage[192];
+    long double align;
+} StaticSemaphore_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count);
+SemaphoreHandle_t xSemaphoreCreateCountingStatic(UBaseType_t max_count,
+                                                 UBaseType_t initial_count,
+                                                 StaticSemaphore_t *buffer);
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks_to_wait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t *higher_priority_task_woken);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,39 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Start a thread that reports core_id from xPortGetCoreID(). Priorities and stack sizes are ignored.
+ */
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task,
+                                   const char *name,
+                                   uint32_t stack_depth,
+                                   void *arg,
+                                   UBaseType_t priority,
+                                   TaskHandle_t *created_task,
+                                   BaseType_t core_id);
+
+BaseType_t xTaskCreate(
+    TaskFunction_t task, const char *name, uint32_t stack_depth, void *arg, UBaseType_t priority, TaskHandle_t *created_task);
+
+/**
+ * @brief Only deleting the calling task is supported, the thread ends when its function returns right after.
+ */
+void vTaskDelete(TaskHandle_t task);
+
+void vTaskDelay(TickType_t ticks);
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task);
+void vTaskPrioritySet(TaskHandle_t task, UBaseType_t priority);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear_count_on_exit, TickType_t ticks_to_wait);
+
+#ifdef __cplusplus
+}
+#endif
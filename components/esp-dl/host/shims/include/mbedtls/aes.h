@@ -0,0 +1,33 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// The subset of the mbedtls AES API the model loader uses, backed by a small software AES-128.
+
+#define MBEDTLS_ERR_AES_INVALID_KEY_LENGTH -0x0020
+
+typedef struct {
+    uint32_t round_keys[44];
+} mbedtls_aes_context;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void mbedtls_aes_init(mbedtls_aes_context *ctx);
+void mbedtls_aes_free(mbedtls_aes_context *ctx);
+int mbedtls_aes_setkey_enc(mbedtls_aes_context *ctx, const unsigned char *key, unsigned int keybits);
+int mbedtls_aes_crypt_ecb(mbedtls_aes_context *ctx, int mode, const unsigned char input[16], unsigned char output[16]);
+int mbedtls_aes_crypt_ctr(mbedtls_aes_context *ctx,
+                          size_t length,
+                          size_t *nc_off,
+                          unsigned char nonce_counter[16],
+                          unsigned char stream_block[16],
+                          const unsigned char *input,
+                          unsigned char *output);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define MBEDTLS_AES_ENCRYPT 1
@@ -0,0 +1,10 @@
+#pragma once
+// Configuration of the host build. No CONFIG_IDF_TARGET_* is set, so every module takes its C reference path.
+
+#define CONFIG_FREERTOS_NUMBER_OF_CORES 2
+#define CONFIG_SPIRAM 1
+
+#define CONFIG_PEDESTRIAN_DETECT_PICO_S8_V1 1
+#define CONFIG_PEDESTRIAN_DETECT_MODEL_TYPE 0
+#define CONFIG_PEDESTRIAN_DETECT_MODEL_IN_SDCARD 1
+#define CONFIG_PEDESTRIAN_DETECT_MODEL_LOCATION 2
@@ -0,0 +1,2 @@
+#pragma once
+// No SOC_* capability is set on the host, e.g. parameters are prefetched by the cpu instead of the async memcpy.
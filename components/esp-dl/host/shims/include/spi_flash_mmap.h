@@ -0,0 +1,10 @@
+#pragma once
+#include <stdint.h>
+
+typedef enum { SPI_FLASH_MMAP_DATA, SPI_FLASH_MMAP_INST } spi_flash_mmap_memory_t;
+
+static inline uint32_t spi_flash_mmap_get_free_pages(spi_flash_mmap_memory_t memory)
+{
+    (void)memory;
+    return 0;
+}
@@ -0,0 +1,240 @@
+#include "esp_cpu.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+
+struct host_semaphore {
+    std::mutex mutex;
+    std::condition_variable cond;
+    UBaseType_t count;
+    UBaseType_t max_count;
+    bool is_static;
+};
+
+struct host_task {
+    TaskFunction_t func;
+    void *arg;
+    int core_id;
+    UBaseType_t priority;
+    std::mutex mutex;
+    std::condition_variable cond;
+    uint32_t notify_count;
+};
+
+static_assert(sizeof(host_semaphore) <= sizeof(StaticSemaphore_t), "StaticSemaphore_t is too small");
+
+static thread_local host_task *s_current_task = nullptr;
+
+static int64_t steady_time_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Like on the chips, the timer counts from boot, i.e. from the start of the process.
+static const int64_t s_boot_time_ns = steady_time_ns();
+
+extern "C" int64_t esp_timer_get_time(void)
+{
+    return (steady_time_ns() - s_boot_time_ns) / 1000;
+}
+
+extern "C" uint32_t esp_cpu_get_cycle_count(void)
+{
+    return (uint32_t)steady_time_ns();
+}
+
+extern "C" int esp_cpu_get_core_id(void)
+{
+    return s_current_task ? s_current_task->core_id : 0;
+}
+
+extern "C" BaseType_t xPortGetCoreID(void)
+{
+    return esp_cpu_get_core_id();
+}
+
+// Waits like a FreeRTOS block time: 0 polls, portMAX_DELAY waits forever, anything else waits that many ticks.
+template <typename Predicate>
+static bool wait_ticks(std::condition_variable &cond,
+                       std::unique_lock<std::mutex> &lock,
+                       TickType_t ticks,
+                       Predicate ready)
+{
+    if (ticks == portMAX_DELAY) {
+        cond.wait(lock, ready);
+        return true;
+    }
+    return cond.wait_for(lock, std::chrono::milliseconds(ticks * portTICK_PERIOD_MS), ready);
+}
+
+extern "C" SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count)
+{
+    host_semaphore *semaphore = new (std::nothrow) host_semaphore();
+    if (semaphore) {
+        semaphore->count = initial_count;
+        semaphore->max_count = max_count;
+        semaphore->is_static = false;
+    }
+    return semaphore;
+}
+
+extern "C" SemaphoreHandle_t xSemaphoreCreateCountingStatic(UBaseType_t max_count,
+                                                            UBaseType_t initial_count,
+                                                            StaticSemaphore_t *buffer)
+{
+    host_semaphore *semaphore = new (buffer->storage) host_semaphore();
+    semaphore->count = initial_count;
+    semaphore->max_count = max_count;
+    semaphore->is_static = true;
+    return semaphore;
+}
+
+extern "C" SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return xSemaphoreCreateCounting(1, 0);
+}
+
+extern "C" SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return xSemaphoreCreateCounting(1, 1);
+}
+
+extern "C" void vSemaphoreDelete(SemaphoreHandle_t semaphore)
+{
+    if (semaphore->is_static) {
+        semaphore->~host_semaphore();
+    } else {
+        delete semaphore;
+    }
+}
+
+extern "C" BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks_to_wait)
+{
+    std::unique_lock<std::mutex> lock(semaphore->mutex);
+    if (!wait_ticks(semaphore->cond, lock, ticks_to_wait, [semaphore] { return semaphore->count > 0; })) {
+        return pdFALSE;
+    }
+    semaphore->count--;
+    return pdTRUE;
+}
+
+extern "C" BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+    // Notified under the lock: the woken taker may delete the semaphore as soon as the lock is released.
+    std::lock_guard<std::mutex> lock(semaphore->mutex);
+    if (semaphore->count >= semaphore->max_count) {
+        return pdFALSE;
+    }
+    semaphore->count++;
+    semaphore->cond.notify_one();
+    return pdTRUE;
+}
+
+extern "C" BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t *higher_priority_task_woken)
+{
+    if (higher_priority_task_woken) {
+        *higher_priority_task_woken = pdFALSE;
+    }
+    return xSemaphoreGive(semaphore);
+}
+
+extern "C" BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task,
+                                              const char *name,
+                                              uint32_t stack_depth,
+                                              void *arg,
+                                              UBaseType_t priority,
+                                              TaskHandle_t *created_task,
+                                              BaseType_t core_id)
+{
+    host_task *handle = new (std::nothrow) host_task();
+    if (!handle) {
+        return pdFAIL;
+    }
+    handle->func = task;
+    handle->arg = arg;
+    handle->core_id = core_id == tskNO_AFFINITY ? 0 : core_id;
+    handle->priority = priority;
+    handle->notify_count = 0;
+    if (created_task) {
+        *created_task = handle;
+    }
+    // The handle lives as long as the thread, like the TCB of a task that deletes itself.
+    std::thread([handle] {
+        s_current_task = handle;
+        handle->func(handle->arg);
+        delete handle;
+    }).detach();
+    return pdPASS;
+}
+
+extern "C" BaseType_t xTaskCreate(
+    TaskFunction_t task, const char *name, uint32_t stack_depth, void *arg, UBaseType_t priority, TaskHandle_t *created_task)
+{
+    return xTaskCreatePinnedToCore(task, name, stack_depth, arg, priority, created_task, tskNO_AFFINITY);
+}
+
+extern "C" void vTaskDelete(TaskHandle_t task)
+{
+    if (task && task != s_current_task) {
+        fprintf(stderr, "vTaskDelete: only the calling task can be deleted on the host\n");
+        abort();
+    }
+}
+
+extern "C" void vTaskDelay(TickType_t ticks)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks * portTICK_PERIOD_MS));
+}
+
+extern "C" UBaseType_t uxTaskPriorityGet(TaskHandle_t task)
+{
+    host_task *t = task ? task : s_current_task;
+    return t ? t->priority : 1;
+}
+
+extern "C" void vTaskPrioritySet(TaskHandle_t task, UBaseType_t priority)
+{
+    host_task *t = task ? task : s_current_task;
+    if (t) {
+        t->priority = priority;
+    }
+}
+
+extern "C" TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return s_current_task;
+}
+
+extern "C" BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    // Notified under the lock: the woken task may return and delete its handle as soon as the lock is released.
+    std::lock_guard<std::mutex> lock(task->mutex);
+    task->notify_count++;
+    task->cond.notify_one();
+    return pdPASS;
+}
+
+extern "C" uint32_t ulTaskNotifyTake(BaseType_t clear_count_on_exit, TickType_t ticks_to_wait)
+{
+    host_task *task = s_current_task;
+    if (!task) {
+        fprintf(stderr, "ulTaskNotifyTake: the calling thread was not created by xTaskCreatePinnedToCore\n");
+        abort();
+    }
+    std::unique_lock<std::mutex> lock(task->mutex);
+    if (!wait_ticks(task->cond, lock, ticks_to_wait, [task] { return task->notify_count > 0; })) {
+        return 0;
+    }
+    uint32_t count = task->notify_count;
+    task->notify_count = clear_count_on_exit ? 0 : count - 1;
+    return count;
+}
@@ -0,0 +1,59 @@
+#include "esp_heap_caps.h"
+#include <cstdlib>
+#include <cstring>
+
+// PSRAM of the module the application targets, reported as free for MALLOC_CAP_SPIRAM.
+#define HOST_PSRAM_SIZE (8 * 1024 * 1024)
+
+// All allocations come from the host heap, the caps only change what the free size queries report.
+
+extern "C" void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    return malloc(size);
+}
+
+extern "C" void *heap_caps_calloc(size_t n, size_t size, uint32_t caps)
+{
+    return calloc(n, size);
+}
+
+extern "C" void *heap_caps_realloc(void *ptr, size_t size, uint32_t caps)
+{
+    return realloc(ptr, size);
+}
+
+extern "C" void *heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps)
+{
+    void *ptr = nullptr;
+    if (alignment < sizeof(void *)) {
+        alignment = sizeof(void *);
+    }
+    if (posix_memalign(&ptr, alignment, size ? size : 1) != 0) {
+        return nullptr;
+    }
+    return ptr;
+}
+
+extern "C" void *heap_caps_aligned_calloc(size_t alignment, size_t n, size_t size, uint32_t caps)
+{
+    void *ptr = heap_caps_aligned_alloc(alignment, n * size, caps);
+    if (ptr) {
+        memset(ptr, 0, n * size);
+    }
+    return ptr;
+}
+
+extern "C" void heap_caps_free(void *ptr)
+{
+    free(ptr);
+}
+
+extern "C" size_t heap_caps_get_free_size(uint32_t caps)
+{
+    return (caps & MALLOC_CAP_INTERNAL) ? HOST_INTERNAL_RAM_SIZE : HOST_PSRAM_SIZE;
+}
+
+extern "C" size_t heap_caps_get_largest_free_block(uint32_t caps)
+{
+    return heap_caps_get_free_size(caps);
+}
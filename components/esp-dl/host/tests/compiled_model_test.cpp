@@ -0,0 +1,87 @@
+#include "dl_model_base.hpp"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "pedestrian_detect_compiled.hpp"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * The model compiled by tools/espdl_compiler.py at build time against the same .espdl file loaded by dl::Model, on
+ * random inputs: every output must be byte identical, over a few runs so state left by the first one shows up.
+ */
+
+static const char *TAG = "compiled_model_test";
+
+namespace {
+uint8_t *read_file(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        ESP_LOGE(TAG, "Fail to open %s", path);
+        return nullptr;
+    }
+    fseek(f, 0, SEEK_END);
+    size_t size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *data = (uint8_t *)heap_caps_aligned_alloc(16, size, MALLOC_CAP_SPIRAM);
+    if (data && fread(data, 1, size, f) != size) {
+        heap_caps_free(data);
+        data = nullptr;
+    }
+    fclose(f);
+    return data;
+}
+
+bool run_and_compare(dl::Model *reference, dl::Model *compiled, int seed)
+{
+    srand(seed);
+    std::map<std::string, dl::TensorBase *> &inputs = reference->get_inputs();
+    std::map<std::string, dl::TensorBase *> &compiled_inputs = compiled->get_inputs();
+    for (auto &input : inputs) {
+        dl::TensorBase *compiled_input = compiled_inputs.at(input.first);
+        uint8_t *data = (uint8_t *)input.second->data;
+        for (int i = 0; i < input.second->get_bytes(); i++) {
+            data[i] = rand();
+        }
+        memcpy(compiled_input->data, data, input.second->get_bytes());
+    }
+    reference->run(dl::RUNTIME_MODE_SINGLE_CORE);
+    compiled->run(dl::RUNTIME_MODE_SINGLE_CORE);
+
+    bool same = true;
+    std::map<std::string, dl::TensorBase *> &compiled_outputs = compiled->get_outputs();
+    for (auto &output : reference->get_outputs()) {
+        dl::TensorBase *compiled_output = compiled_outputs.at(output.first);
+        bool equal = output.second->shape == compiled_output->shape &&
+            memcmp(output.second->data, compiled_output->data, output.second->get_bytes()) == 0;
+        if (!equal) {
+            ESP_LOGE(TAG, "run %d: output %s differs", seed, output.first.c_str());
+        }
+        same = same && equal;
+    }
+    return same;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        printf("usage: %s <pedestrian_detect_pico_s8_v1.espdl>\n", argv[0]);
+        return 1;
+    }
+    uint8_t *model_data = read_file(argv[1]);
+    if (!model_data) {
+        return 1;
+    }
+    dl::Model *reference = new dl::Model(argv[1], fbs::MODEL_LOCATION_IN_SDCARD);
+    dl::Model *compiled = new dl::Model(&pedestrian_detect_compiled, (const char *)model_data);
+    bool same = compiled->get_outputs().size() == reference->get_outputs().size();
+    for (int i = 0; same && i < 3; i++) {
+        same = run_and_compare(reference, compiled, i);
+    }
+    ESP_LOGI(TAG, "%s", same ? "compiled outputs are identical to the loaded model" : "FAIL");
+    delete compiled;
+    delete reference;
+    heap_caps_free(model_data);
+    return same ? 0 : 1;
+}
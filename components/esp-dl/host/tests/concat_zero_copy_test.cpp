@@ -0,0 +1,180 @@
+#include "test_graph.hpp"
+
+/**
+ * Concat without copy, see MemoryManagerGreedy::plan_zero_copy(): the producers write straight into the concat output.
+ * Small graphs run through dl::Model under both memory managers and a few internal ram budgets must give outputs byte
+ * identical to a run copying every input, and zero copy exactly the concats expected.
+ */
+
+static const char *TAG = "concat_zero_copy_test";
+
+namespace {
+typedef struct {
+    const char *name;
+    std::vector<uint8_t> (*build)(dl::dtype_t dtype);
+    int zero_copy_elements; /*<! elements of the concat outputs expected without copy */
+} graph_t;
+
+// Producers of a Mul and a Resize concatenated along H, the output read by another Mul.
+std::vector<uint8_t> build_height(dl::dtype_t dtype)
+{
+    test::GraphBuilder graph("height", dtype);
+    graph.add_input("x0", {1, 4, 8, 16}, -4);
+    graph.add_input("y0", {1, 4, 8, 16}, -4);
+    graph.add_input("x1", {1, 2, 4, 16}, -5);
+    graph.add_input("x2", {1, 2, 8, 16}, -4);
+    graph.add_input("y2", {1, 2, 8, 16}, -3);
+    graph.add_input("w", {1, 10, 8, 16}, -4);
+    graph.add_value("m0", {1, 4, 8, 16}, -4);
+    graph.add_value("r1", {1, 4, 8, 16}, -5);
+    graph.add_value("m2", {1, 2, 8, 16}, -5);
+    graph.add_value("c", {1, 10, 8, 16}, -4);
+    graph.add_value("o", {1, 10, 8, 16}, -4);
+    graph.add_output("o");
+    graph.add_node("Mul", {"x0", "y0"}, {"m0"});
+    graph.add_resize("x1", "r1", 2.f, "nearest", "asymmetric", "floor");
+    graph.add_node("Mul", {"x2", "y2"}, {"m2"});
+    graph.add_node("Concat", {"m0", "r1", "m2"}, {"c"}, {test::int_attribute("axis", 1)});
+    graph.add_node("Mul", {"c", "w"}, {"o"});
+    return graph.build();
+}
+
+// The concat output is the graph output.
+std::vector<uint8_t> build_output(dl::dtype_t dtype)
+{
+    test::GraphBuilder graph("output", dtype);
+    graph.add_input("x", {1, 4, 4, 8}, -4);
+    graph.add_input("y", {1, 4, 4, 8}, -4);
+    graph.add_value("m0", {1, 4, 4, 8}, -4);
+    graph.add_value("m1", {1, 4, 4, 8}, -4);
+    graph.add_value("c", {1, 8, 4, 8}, -4);
+    graph.add_output("c");
+    graph.add_node("Mul", {"x", "y"}, {"m0"});
+    graph.add_node("Mul", {"y", "x"}, {"m1"});
+    graph.add_node("Concat", {"m0", "m1"}, {"c"}, {test::int_attribute("axis", 1)});
+    return graph.build();
+}
+
+// m0 is read again after the first concat, which has to copy it. The second concat is the last reader of both its
+// inputs and copies nothing.
+std::vector<uint8_t> build_read_later(dl::dtype_t dtype)
+{
+    test::GraphBuilder graph("read_later", dtype);
+    graph.add_input("x", {1, 4, 8, 16}, -4);
+    graph.add_input("y", {1, 4, 8, 16}, -4);
+    graph.add_value("m0", {1, 4, 8, 16}, -4);
+    graph.add_value("m1", {1, 4, 8, 16}, -4);
+    graph.add_value("c", {1, 8, 8, 16}, -4);
+    graph.add_value("o", {1, 12, 8, 16}, -4);
+    graph.add_output("o");
+    graph.add_node("Mul", {"x", "y"}, {"m0"});
+    graph.add_node("Mul", {"x", "x"}, {"m1"});
+    graph.add_node("Concat", {"m0", "m1"}, {"c"}, {test::int_attribute("axis", 1)});
+    graph.add_node("Concat", {"c", "m0"}, {"o"}, {test::int_attribute("axis", 1)});
+    return graph.build();
+}
+
+// Along C of NHWC the inputs interleave in the output, they have to be copied.
+std::vector<uint8_t> build_channel(dl::dtype_t dtype)
+{
+    test::GraphBuilder graph("channel", dtype);
+    graph.add_input("x", {1, 4, 8, 16}, -4);
+    graph.add_input("y", {1, 4, 8, 16}, -4);
+    graph.add_input("w", {1, 4, 8, 32}, -4);
+    graph.add_value("m0", {1, 4, 8, 16}, -4);
+    graph.add_value("m1", {1, 4, 8, 16}, -4);
+    graph.add_value("c", {1, 4, 8, 32}, -4);
+    graph.add_value("o", {1, 4, 8, 32}, -4);
+    graph.add_output("o");
+    graph.add_node("Mul", {"x", "y"}, {"m0"});
+    graph.add_node("Mul", {"y", "y"}, {"m1"});
+    graph.add_node("Concat", {"m0", "m1"}, {"c"}, {test::int_attribute("axis", 3)});
+    graph.add_node("Mul", {"c", "w"}, {"o"});
+    return graph.build();
+}
+
+// The output of the first concat is already an input of the second one placed in its output: it can not move again.
+std::vector<uint8_t> build_nested(dl::dtype_t dtype)
+{
+    test::GraphBuilder graph("nested", dtype);
+    graph.add_input("x", {1, 2, 8, 16}, -4);
+    graph.add_input("y", {1, 2, 8, 16}, -4);
+    graph.add_input("w", {1, 6, 8, 16}, -4);
+    graph.add_value("m0", {1, 2, 8, 16}, -4);
+    graph.add_value("m1", {1, 2, 8, 16}, -4);
+    graph.add_value("m2", {1, 2, 8, 16}, -4);
+    graph.add_value("c1", {1, 4, 8, 16}, -4);
+    graph.add_value("c2", {1, 6, 8, 16}, -4);
+    graph.add_value("o", {1, 6, 8, 16}, -4);
+    graph.add_output("o");
+    graph.add_node("Mul", {"x", "y"}, {"m0"});
+    graph.add_node("Mul", {"x", "x"}, {"m1"});
+    graph.add_node("Mul", {"y", "y"}, {"m2"});
+    graph.add_node("Concat", {"m0", "m1"}, {"c1"}, {test::int_attribute("axis", 1)});
+    graph.add_node("Concat", {"c1", "m2"}, {"c2"}, {test::int_attribute("axis", 1)});
+    graph.add_node("Mul", {"c2", "w"}, {"o"});
+    return graph.build();
+}
+
+// The second input would start at an unaligned offset of the output.
+std::vector<uint8_t> build_unaligned(dl::dtype_t dtype)
+{
+    test::GraphBuilder graph("unaligned", dtype);
+    graph.add_input("x", {1, 1, 3, 5}, -4);
+    graph.add_input("y", {1, 1, 3, 5}, -4);
+    graph.add_input("w", {1, 2, 3, 5}, -4);
+    graph.add_value("m0", {1, 1, 3, 5}, -4);
+    graph.add_value("m1", {1, 1, 3, 5}, -4);
+    graph.add_value("c", {1, 2, 3, 5}, -4);
+    graph.add_value("o", {1, 2, 3, 5}, -4);
+    graph.add_output("o");
+    graph.add_node("Mul", {"x", "y"}, {"m0"});
+    graph.add_node("Mul", {"y", "x"}, {"m1"});
+    graph.add_node("Concat", {"m0", "m1"}, {"c"}, {test::int_attribute("axis", 1)});
+    graph.add_node("Mul", {"c", "w"}, {"o"});
+    return graph.build();
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const graph_t graphs[] = {
+        {"height", build_height, 10 * 8 * 16},
+        {"output", build_output, 8 * 4 * 8},
+        {"read_later", build_read_later, 12 * 8 * 16},
+        {"channel", build_channel, 0},
+        {"nested", build_nested, 4 * 8 * 16},
+        {"unaligned", build_unaligned, 0},
+    };
+    const dl::memory_manager_t mm_types[] = {dl::MEMORY_MANAGER_GREEDY, dl::LINEAR_MEMORY_MANAGER};
+    const int internal_sizes[] = {0, 2048, 1 << 20};
+
+    bool pass = true;
+    for (const graph_t &graph : graphs) {
+        for (dl::dtype_t dtype : {dl::DATA_TYPE_INT8, dl::DATA_TYPE_INT16}) {
+            std::vector<uint8_t> data = graph.build(dtype);
+            for (dl::memory_manager_t mm_type : mm_types) {
+                for (int internal_size : internal_sizes) {
+                    size_t zero_copy_bytes = 0;
+                    bool same = test::check_graph(TAG, data, mm_type, internal_size, zero_copy_bytes);
+                    size_t expected = graph.zero_copy_elements * (dtype == dl::DATA_TYPE_INT8 ? 1 : 2);
+                    if (zero_copy_bytes != expected) {
+                        ESP_LOGE(TAG, "zero copy of %zu bytes, expected %zu", zero_copy_bytes, expected);
+                        same = false;
+                    }
+                    if (!same) {
+                        ESP_LOGE(TAG,
+                                 "%s, %s, memory manager %d, internal %d: FAIL",
+                                 graph.name,
+                                 dtype == dl::DATA_TYPE_INT8 ? "int8" : "int16",
+                                 mm_type,
+                                 internal_size);
+                    }
+                    pass = pass && same;
+                }
+            }
+        }
+    }
+    ESP_LOGI(TAG, "%s", pass ? "zero copy outputs are identical to the copying run" : "FAIL");
+    return pass ? 0 : 1;
+}
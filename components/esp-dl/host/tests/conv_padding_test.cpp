@@ -0,0 +1,114 @@
+#include "dl_module_conv.hpp"
+#include "esp_log.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * The padded C path of conv_operation_shell clips the filter window at the borders. A padded Conv2D must give the
+ * output of the same Conv2D without padding run on the input zero padded by hand, which only takes the body path.
+ */
+
+static const char *TAG = "conv_padding_test";
+
+namespace {
+typedef struct {
+    std::vector<int> input_shape; /*<! [1, H, W, C] */
+    int filter_size;
+    int output_channel;
+    int stride;
+    std::vector<int> padding; /*<! [top, bottom, left, right] */
+} conv_case_t;
+
+dl::TensorBase *conv2d(dl::TensorBase *input,
+                       dl::TensorBase *filter,
+                       const std::vector<int> &padding,
+                       int stride,
+                       dl::quant_type_t quant_type)
+{
+    dl::module::Conv2D conv(new dl::TensorBase(filter->shape, filter->data, filter->exponent, filter->dtype),
+                            nullptr,
+                            dl::Linear,
+                            padding,
+                            stride,
+                            stride,
+                            1,
+                            1,
+                            "conv",
+                            1,
+                            quant_type);
+    std::vector<std::vector<int>> input_shapes = {input->shape};
+    dl::TensorBase *output = new dl::TensorBase(conv.get_output_shape(input_shapes)[0], nullptr, -3, input->dtype);
+    std::vector<dl::TensorBase *> tensors = {input, output};
+    conv.m_inputs_index = {0};
+    conv.m_outputs_index = {1};
+    conv.forward(tensors, dl::RUNTIME_MODE_SINGLE_CORE);
+    return output;
+}
+
+template <typename T>
+bool check(const conv_case_t &c, dl::dtype_t dtype, dl::quant_type_t quant_type)
+{
+    std::vector<int> shape = c.input_shape;
+    dl::TensorBase *input = new dl::TensorBase(shape, nullptr, -4, dtype);
+    dl::TensorBase *filter =
+        new dl::TensorBase({c.filter_size, c.filter_size, shape[3], c.output_channel}, nullptr, -7, dtype);
+    for (dl::TensorBase *tensor : {input, filter}) {
+        T *data = (T *)tensor->data;
+        for (int i = 0; i < tensor->get_size(); i++) {
+            data[i] = rand() % 64 - 32;
+        }
+    }
+
+    std::vector<int> padded_shape = {
+        1, shape[1] + c.padding[0] + c.padding[1], shape[2] + c.padding[2] + c.padding[3], shape[3]};
+    dl::TensorBase *padded = new dl::TensorBase(padded_shape, nullptr, -4, dtype);
+    for (int y = 0; y < shape[1]; y++) {
+        memcpy((T *)padded->data + ((y + c.padding[0]) * padded_shape[2] + c.padding[2]) * shape[3],
+               (T *)input->data + y * shape[2] * shape[3],
+               shape[2] * shape[3] * sizeof(T));
+    }
+
+    dl::TensorBase *output = conv2d(input, filter, c.padding, c.stride, quant_type);
+    dl::TensorBase *reference = conv2d(padded, filter, {0, 0, 0, 0}, c.stride, quant_type);
+    bool same =
+        output->shape == reference->shape && memcmp(output->data, reference->data, output->get_bytes()) == 0;
+    if (!same) {
+        ESP_LOGE(TAG,
+                 "%s, input [%d, %d, %d], filter %dx%d -> %d, stride %d: the padded borders differ",
+                 dtype == dl::DATA_TYPE_INT8 ? "int8" : "int16",
+                 shape[1],
+                 shape[2],
+                 shape[3],
+                 c.filter_size,
+                 c.filter_size,
+                 c.output_channel,
+                 c.stride);
+    }
+    delete reference;
+    delete output;
+    delete padded;
+    delete filter;
+    delete input;
+    return same;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    // Input and output channels differ, the filter steps by one of them per column at the borders.
+    const conv_case_t cases[] = {
+        {{1, 6, 7, 8}, 3, 16, 1, {1, 1, 1, 1}},
+        {{1, 6, 7, 16}, 3, 8, 1, {1, 1, 1, 1}},
+        {{1, 9, 9, 16}, 3, 24, 2, {1, 1, 1, 1}},
+        {{1, 8, 8, 8}, 5, 16, 1, {2, 2, 2, 2}},
+        {{1, 8, 8, 16}, 3, 16, 1, {1, 1, 1, 1}},
+    };
+    srand(0);
+    bool pass = true;
+    for (const conv_case_t &c : cases) {
+        pass = check<int8_t>(c, dl::DATA_TYPE_INT8, dl::QUANT_TYPE_SYMM_8BIT) && pass;
+        pass = check<int16_t>(c, dl::DATA_TYPE_INT16, dl::QUANT_TYPE_SYMM_16BIT) && pass;
+    }
+    ESP_LOGI(TAG, "%s", pass ? "padded borders are identical to the zero padded input" : "FAIL");
+    return pass ? 0 : 1;
+}
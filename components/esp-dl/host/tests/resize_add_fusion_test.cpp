@@ -0,0 +1,115 @@
+#include "test_graph.hpp"
+
+/**
+ * Add(Resize(x), y) fused by the memory planners, see MemoryManagerGreedy::plan_resize_add_fusion(): small graphs run
+ * through dl::Model under both memory managers and a few internal ram budgets must give outputs byte identical to an
+ * unfused run, and fuse exactly the resizes expected.
+ */
+
+static const char *TAG = "resize_add_fusion_test";
+
+namespace {
+typedef struct {
+    const char *name;
+    std::vector<uint8_t> (*build)(dl::dtype_t dtype);
+    int fused_elements; /*<! elements of the resize outputs expected to be fused, -1 not to check */
+} graph_t;
+
+// The top down path of a FPN: nearest and linear resizes, each read by one Add only, so both are fused.
+std::vector<uint8_t> build_fpn(dl::dtype_t dtype)
+{
+    test::GraphBuilder graph("fpn", dtype);
+    graph.add_input("x0", {1, 4, 4, 16}, -4);
+    graph.add_input("x1", {1, 8, 8, 16}, -5);
+    graph.add_input("x2", {1, 16, 16, 16}, -4);
+    graph.add_value("r0", {1, 8, 8, 16}, -4);
+    graph.add_value("p1", {1, 8, 8, 16}, -4);
+    graph.add_value("r1", {1, 16, 16, 16}, -4);
+    graph.add_value("p2", {1, 16, 16, 16}, -3);
+    graph.add_output("p2");
+    graph.add_resize("x0", "r0", 2.f, "nearest", "asymmetric", "floor");
+    graph.add_node("Add", {"r0", "x1"}, {"p1"});
+    graph.add_resize("p1", "r1", 2.f, "linear", "half_pixel");
+    graph.add_node("Add", {"x2", "r1"}, {"p2"});
+    return graph.build();
+}
+
+// The resize output is read by two Adds, it has to be written.
+std::vector<uint8_t> build_shared(dl::dtype_t dtype)
+{
+    test::GraphBuilder graph("shared", dtype);
+    graph.add_input("x", {1, 6, 5, 8}, -4);
+    graph.add_input("y", {1, 12, 10, 8}, -4);
+    graph.add_input("z", {1, 12, 10, 8}, -5);
+    graph.add_value("r", {1, 12, 10, 8}, -4);
+    graph.add_value("a", {1, 12, 10, 8}, -4);
+    graph.add_value("b", {1, 12, 10, 8}, -4);
+    graph.add_output("a");
+    graph.add_output("b");
+    graph.add_resize("x", "r", 2.f, "linear", "align_corners");
+    graph.add_node("Add", {"r", "y"}, {"a"});
+    graph.add_node("Add", {"z", "r"}, {"b"});
+    return graph.build();
+}
+
+// The resize input is also read by a Relu, which the planner may inplace into it: the fused Add reads the resize
+// input after the Relu, which then must not change it anymore.
+std::vector<uint8_t> build_dirty_follower(dl::dtype_t dtype)
+{
+    test::GraphBuilder graph("dirty_follower", dtype);
+    graph.add_input("x", {1, 8, 8, 8}, -4);
+    graph.add_input("y", {1, 8, 8, 8}, -4);
+    graph.add_input("z", {1, 16, 16, 8}, -4);
+    graph.add_value("t", {1, 8, 8, 8}, -4);
+    graph.add_value("r", {1, 16, 16, 8}, -4);
+    graph.add_value("s", {1, 8, 8, 8}, -4);
+    graph.add_value("a", {1, 16, 16, 8}, -4);
+    graph.add_output("s");
+    graph.add_output("a");
+    graph.add_node("Add", {"x", "y"}, {"t"});
+    graph.add_resize("t", "r", 2.f, "nearest", "half_pixel");
+    graph.add_node("Relu", {"t"}, {"s"});
+    graph.add_node("Add", {"r", "z"}, {"a"});
+    return graph.build();
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const graph_t graphs[] = {
+        {"fpn", build_fpn, 8 * 8 * 16 + 16 * 16 * 16},
+        {"shared", build_shared, 0},
+        {"dirty_follower", build_dirty_follower, -1},
+    };
+    const dl::memory_manager_t mm_types[] = {dl::MEMORY_MANAGER_GREEDY, dl::LINEAR_MEMORY_MANAGER};
+    const int internal_sizes[] = {0, 4096, 1 << 20};
+
+    bool pass = true;
+    for (const graph_t &graph : graphs) {
+        for (dl::dtype_t dtype : {dl::DATA_TYPE_INT8, dl::DATA_TYPE_INT16}) {
+            std::vector<uint8_t> data = graph.build(dtype);
+            for (dl::memory_manager_t mm_type : mm_types) {
+                for (int internal_size : internal_sizes) {
+                    size_t fused_bytes = 0;
+                    bool same = test::check_graph(TAG, data, mm_type, internal_size, fused_bytes);
+                    size_t expected = graph.fused_elements * (dtype == dl::DATA_TYPE_INT8 ? 2 : 4);
+                    if (graph.fused_elements >= 0 && fused_bytes != expected) {
+                        ESP_LOGE(TAG, "fused %zu bytes of copy, expected %zu", fused_bytes, expected);
+                        same = false;
+                    }
+                    if (!same) {
+                        ESP_LOGE(TAG,
+                                 "%s, %s, memory manager %d, internal %d: FAIL",
+                                 graph.name,
+                                 dtype == dl::DATA_TYPE_INT8 ? "int8" : "int16",
+                                 mm_type,
+                                 internal_size);
+                    }
+                    pass = pass && same;
+                }
+            }
+        }
+    }
+    ESP_LOGI(TAG, "%s", pass ? "fused outputs are identical to the unfused run" : "FAIL");
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,450 @@
+#pragma once
+
+#include "dl_model_base.hpp"
+#include "dl_module_creator.hpp"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include <map>
+#include <memory>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+/**
+ * Synthetic graphs for the host tests. GraphBuilder writes the FlatBuffers of a small .espdl graph, laid out as
+ * fbs_schema.hpp reads it, and check_graph() runs it through dl::Model against a run module by module with a buffer
+ * per tensor, without any of the memory planning of the model.
+ */
+namespace test {
+
+/**
+ * @brief A FlatBuffers object: a table, a string, a vector of scalars or a vector of offsets to objects.
+ *
+ * Objects are written parent first, so every offset points forward like the uoffset_t of FlatBuffers, and a table
+ * writes its vtable right before itself.
+ */
+class FbsObject {
+public:
+    typedef std::shared_ptr<FbsObject> ptr_t;
+
+    static ptr_t table() { return ptr_t(new FbsObject(TABLE)); }
+
+    static ptr_t string(const std::string &value)
+    {
+        ptr_t object(new FbsObject(STRING));
+        object->m_bytes.assign(value.begin(), value.end());
+        return object;
+    }
+
+    template <typename T>
+    static ptr_t vector(const std::vector<T> &values)
+    {
+        return bytes(values.data(), values.size() * sizeof(T), sizeof(T), sizeof(T));
+    }
+
+    /**
+     * @brief A vector of size / element_size structs, its data aligned to alignment in the buffer.
+     */
+    static ptr_t bytes(const void *data, size_t size, int element_size, int alignment)
+    {
+        ptr_t object(new FbsObject(BYTES));
+        object->m_bytes.assign((const uint8_t *)data, (const uint8_t *)data + size);
+        object->m_element_size = element_size;
+        object->m_alignment = alignment;
+        return object;
+    }
+
+    static ptr_t offsets(const std::vector<ptr_t> &items)
+    {
+        ptr_t object(new FbsObject(OFFSETS));
+        object->m_items = items;
+        return object;
+    }
+
+    static ptr_t strings(const std::vector<std::string> &values)
+    {
+        std::vector<ptr_t> items;
+        for (const std::string &value : values) {
+            items.push_back(string(value));
+        }
+        return offsets(items);
+    }
+
+    template <typename T>
+    void set(int slot, T value)
+    {
+        field_t field = {slot, std::vector<uint8_t>(sizeof(T)), nullptr};
+        memcpy(field.scalar.data(), &value, sizeof(T));
+        m_fields.push_back(field);
+    }
+
+    void set(int slot, ptr_t child) { m_fields.push_back({slot, {}, child}); }
+
+    /**
+     * @brief The FlatBuffers data with this object as root table.
+     */
+    std::vector<uint8_t> finish() const
+    {
+        std::vector<uint8_t> buf(4, 0);
+        patch(buf, 0, this->write(buf));
+        return buf;
+    }
+
+private:
+    typedef enum { TABLE, STRING, BYTES, OFFSETS } kind_t;
+
+    typedef struct {
+        int slot;
+        std::vector<uint8_t> scalar; /*<! empty for an offset to child */
+        ptr_t child;
+    } field_t;
+
+    kind_t m_kind;
+    std::vector<field_t> m_fields;
+    std::vector<uint8_t> m_bytes;
+    int m_element_size = 1;
+    int m_alignment = 4;
+    std::vector<ptr_t> m_items;
+
+    FbsObject(kind_t kind) : m_kind(kind) {}
+
+    static void align(std::vector<uint8_t> &buf, size_t alignment)
+    {
+        buf.resize((buf.size() + alignment - 1) / alignment * alignment, 0);
+    }
+
+    template <typename T>
+    static void put(std::vector<uint8_t> &buf, size_t pos, T value)
+    {
+        memcpy(buf.data() + pos, &value, sizeof(T));
+    }
+
+    // The uoffset_t at pos points to target.
+    static void patch(std::vector<uint8_t> &buf, size_t pos, size_t target) { put<uint32_t>(buf, pos, target - pos); }
+
+    size_t write(std::vector<uint8_t> &buf) const
+    {
+        size_t pos;
+        if (m_kind == STRING || m_kind == BYTES) {
+            align(buf, 4);
+            while ((buf.size() + 4) % m_alignment) {
+                buf.resize(buf.size() + 4, 0);
+            }
+            pos = buf.size();
+            buf.resize(pos + 4, 0);
+            put<uint32_t>(buf, pos, m_bytes.size() / m_element_size);
+            buf.insert(buf.end(), m_bytes.begin(), m_bytes.end());
+            if (m_kind == STRING) {
+                buf.push_back(0);
+            }
+        } else if (m_kind == OFFSETS) {
+            align(buf, 4);
+            pos = buf.size();
+            buf.resize(pos + 4 + 4 * m_items.size(), 0);
+            put<uint32_t>(buf, pos, m_items.size());
+            for (size_t i = 0; i < m_items.size(); i++) {
+                size_t item = m_items[i]->write(buf);
+                patch(buf, pos + 4 + 4 * i, item);
+            }
+        } else {
+            // soffset_t to the vtable, then the fields at their natural alignment.
+            std::vector<uint16_t> field_offsets(m_fields.size());
+            uint16_t size = 4;
+            int slot_num = 0;
+            for (size_t i = 0; i < m_fields.size(); i++) {
+                uint16_t field_size = m_fields[i].child ? 4 : m_fields[i].scalar.size();
+                size = (size + field_size - 1) / field_size * field_size;
+                field_offsets[i] = size;
+                size += field_size;
+                slot_num = std::max(slot_num, m_fields[i].slot + 1);
+            }
+            align(buf, 2);
+            size_t vtable = buf.size();
+            buf.resize(vtable + 4 + 2 * slot_num, 0);
+            put<uint16_t>(buf, vtable, 4 + 2 * slot_num);
+            put<uint16_t>(buf, vtable + 2, size);
+            for (size_t i = 0; i < m_fields.size(); i++) {
+                put<uint16_t>(buf, vtable + 4 + 2 * m_fields[i].slot, field_offsets[i]);
+            }
+            align(buf, 8);
+            pos = buf.size();
+            buf.resize(pos + size, 0);
+            put<int32_t>(buf, pos, pos - vtable);
+            for (size_t i = 0; i < m_fields.size(); i++) {
+                if (!m_fields[i].child) {
+                    memcpy(buf.data() + pos + field_offsets[i], m_fields[i].scalar.data(), m_fields[i].scalar.size());
+                }
+            }
+            for (size_t i = 0; i < m_fields.size(); i++) {
+                if (m_fields[i].child) {
+                    size_t child = m_fields[i].child->write(buf);
+                    patch(buf, pos + field_offsets[i], child);
+                }
+            }
+        }
+        return pos;
+    }
+};
+
+// The attribute_type_t values of the espdl schema
+typedef enum { ATTRIBUTE_TYPE_INT = 2, ATTRIBUTE_TYPE_STRING = 3 } attribute_type_t;
+
+typedef struct {
+    std::string name;
+    attribute_type_t type;
+    int64_t i;
+    std::string s;
+} attribute_t;
+
+inline attribute_t int_attribute(const std::string &name, int64_t value)
+{
+    return {name, ATTRIBUTE_TYPE_INT, value, ""};
+}
+
+inline attribute_t string_attribute(const std::string &name, const std::string &value)
+{
+    return {name, ATTRIBUTE_TYPE_STRING, 0, value};
+}
+
+/**
+ * @brief Writes a graph of quantized activations, all of one dtype, with the fields of the espdl schema FbsModel reads.
+ */
+class GraphBuilder {
+public:
+    GraphBuilder(const std::string &name, dl::dtype_t dtype) : m_name(name), m_dtype(dtype) {}
+
+    void add_input(const std::string &name, const std::vector<int> &shape, int exponent)
+    {
+        m_inputs.push_back(value_info(name, shape, exponent));
+    }
+
+    void add_value(const std::string &name, const std::vector<int> &shape, int exponent)
+    {
+        m_values[name] = value_info(name, shape, exponent);
+    }
+
+    /**
+     * @brief Mark a value added by add_value() as an output of the graph.
+     */
+    void add_output(const std::string &name) { m_outputs.push_back(m_values.at(name)); }
+
+    void add_node(const std::string &op_type,
+                  const std::vector<std::string> &inputs,
+                  const std::vector<std::string> &outputs,
+                  std::vector<attribute_t> attributes = {})
+    {
+        attributes.push_back(string_attribute("quant_type", m_dtype == dl::DATA_TYPE_INT8 ? "S8" : "S16"));
+        std::vector<FbsObject::ptr_t> attribute_tables;
+        for (const attribute_t &attribute : attributes) {
+            FbsObject::ptr_t table = FbsObject::table();
+            table->set(0, FbsObject::string(attribute.name));
+            table->set<int32_t>(3, attribute.type);
+            if (attribute.type == ATTRIBUTE_TYPE_INT) {
+                table->set<int64_t>(5, attribute.i);
+            } else {
+                table->set(6, FbsObject::string(attribute.s));
+            }
+            attribute_tables.push_back(table);
+        }
+        FbsObject::ptr_t node = FbsObject::table();
+        node->set(0, FbsObject::strings(inputs));
+        node->set(1, FbsObject::strings(outputs));
+        node->set(2, FbsObject::string(op_type + "_" + std::to_string(m_nodes.size())));
+        node->set(3, FbsObject::string(op_type));
+        node->set(5, FbsObject::offsets(attribute_tables));
+        m_nodes.push_back(node);
+    }
+
+    /**
+     * @brief A Resize of the 4 dims NHWC input by the scales of H and W, as esp-ppq exports it.
+     */
+    void add_resize(const std::string &input,
+                    const std::string &output,
+                    float scale,
+                    const std::string &mode,
+                    const std::string &coordinate,
+                    const std::string &nearest_mode = "round_prefer_floor")
+    {
+        std::string scales = output + "_scales";
+        add_initializer(scales, {4}, dl::DATA_TYPE_FLOAT, std::vector<float>{1.f, 1.f, scale, scale}.data(), 16);
+        add_node("Resize",
+                 {input, "", scales},
+                 {output},
+                 {string_attribute("mode", mode),
+                  string_attribute("coordinate_transformation_mode", coordinate),
+                  string_attribute("nearest_mode", nearest_mode)});
+    }
+
+    void add_initializer(const std::string &name, const std::vector<int64_t> &dims, dl::dtype_t dtype, const void *data,
+                         size_t size)
+    {
+        // raw_data is a vector of 16 bytes structs
+        std::vector<uint8_t> raw((size + 15) / 16 * 16, 0);
+        memcpy(raw.data(), data, size);
+        FbsObject::ptr_t tensor = FbsObject::table();
+        tensor->set(0, FbsObject::vector(dims));
+        tensor->set<int32_t>(1, dtype);
+        tensor->set(6, FbsObject::string(name));
+        tensor->set(8, FbsObject::bytes(raw.data(), raw.size(), 16, 16));
+        m_initializers.push_back(tensor);
+    }
+
+    /**
+     * @brief The FlatBuffers data of the model, without the EDL2 file header.
+     */
+    std::vector<uint8_t> build() const
+    {
+        std::vector<FbsObject::ptr_t> values;
+        for (const auto &value : m_values) {
+            values.push_back(value.second);
+        }
+        FbsObject::ptr_t graph = FbsObject::table();
+        graph->set(0, FbsObject::offsets(m_nodes));
+        graph->set(1, FbsObject::string(m_name));
+        graph->set(2, FbsObject::offsets(m_initializers));
+        graph->set(4, FbsObject::offsets(m_inputs));
+        graph->set(5, FbsObject::offsets(m_outputs));
+        graph->set(6, FbsObject::offsets(values));
+        FbsObject::ptr_t model = FbsObject::table();
+        model->set<int64_t>(5, 1);
+        model->set(7, graph);
+        return model->finish();
+    }
+
+private:
+    std::string m_name;
+    dl::dtype_t m_dtype;
+    std::vector<FbsObject::ptr_t> m_nodes;
+    std::vector<FbsObject::ptr_t> m_initializers;
+    std::vector<FbsObject::ptr_t> m_inputs;
+    std::vector<FbsObject::ptr_t> m_outputs;
+    std::map<std::string, FbsObject::ptr_t> m_values;
+
+    FbsObject::ptr_t value_info(const std::string &name, const std::vector<int> &shape, int exponent) const
+    {
+        std::vector<FbsObject::ptr_t> dims;
+        for (int dim : shape) {
+            FbsObject::ptr_t dim_value = FbsObject::table();
+            dim_value->set<int8_t>(0, 1);
+            dim_value->set<int64_t>(1, dim);
+            FbsObject::ptr_t dimension = FbsObject::table();
+            dimension->set(0, dim_value);
+            dims.push_back(dimension);
+        }
+        FbsObject::ptr_t tensor_shape = FbsObject::table();
+        tensor_shape->set(0, FbsObject::offsets(dims));
+        FbsObject::ptr_t tensor_type = FbsObject::table();
+        tensor_type->set<int32_t>(0, m_dtype);
+        tensor_type->set(1, tensor_shape);
+        FbsObject::ptr_t type_info = FbsObject::table();
+        type_info->set<uint8_t>(0, 1);
+        type_info->set(1, tensor_type);
+        FbsObject::ptr_t info = FbsObject::table();
+        info->set(0, FbsObject::string(name));
+        info->set(1, type_info);
+        info->set(3, FbsObject::vector(std::vector<int64_t>{exponent}));
+        return info;
+    }
+};
+
+/**
+ * @brief Run the graph module by module, every tensor in a buffer of its own. Returns the graph outputs, which the
+ * caller deletes, and fills the graph inputs with random data, copied into model_inputs.
+ */
+inline std::map<std::string, dl::TensorBase *> run_reference(fbs::FbsModel *fbs_model,
+                                                            std::map<std::string, dl::TensorBase *> &model_inputs,
+                                                            int seed)
+{
+    std::vector<dl::TensorBase *> tensors;
+    std::map<std::string, int> index;
+    for (const std::string &name : fbs_model->get_graph_inputs()) {
+        dl::TensorBase *input = new dl::TensorBase(fbs_model->get_value_info_shape(name),
+                                                   nullptr,
+                                                   fbs_model->get_value_info_exponent(name),
+                                                   fbs_model->get_value_info_dtype(name));
+        srand(seed + tensors.size());
+        uint8_t *data = (uint8_t *)input->data;
+        for (int i = 0; i < input->get_bytes(); i++) {
+            data[i] = rand();
+        }
+        memcpy(model_inputs.at(name)->data, data, input->get_bytes());
+        index[name] = tensors.size();
+        tensors.push_back(input);
+    }
+
+    dl::module::ModuleCreator *creator = dl::module::ModuleCreator::get_instance();
+    std::vector<std::string> inputs, outputs;
+    for (const std::string &node : fbs_model->topological_sort()) {
+        dl::module::Module *module = creator->create(fbs_model, fbs_model->get_operation_type(node), node);
+        fbs_model->get_operation_inputs_and_outputs(node, inputs, outputs);
+        std::vector<std::vector<int>> input_shapes;
+        for (const std::string &name : inputs) {
+            if (index.count(name)) {
+                module->m_inputs_index.push_back(index[name]);
+                input_shapes.push_back(tensors[index[name]]->shape);
+            }
+        }
+        std::vector<std::vector<int>> output_shapes = module->get_output_shape(input_shapes);
+        for (int i = 0; i < outputs.size(); i++) {
+            index[outputs[i]] = tensors.size();
+            module->m_outputs_index.push_back(tensors.size());
+            tensors.push_back(new dl::TensorBase(output_shapes[i],
+                                                 nullptr,
+                                                 fbs_model->get_value_info_exponent(outputs[i]),
+                                                 fbs_model->get_value_info_dtype(outputs[i])));
+        }
+        module->forward(tensors, dl::RUNTIME_MODE_SINGLE_CORE);
+        delete module;
+    }
+
+    std::map<std::string, dl::TensorBase *> graph_outputs;
+    for (const std::string &name : fbs_model->get_graph_outputs()) {
+        graph_outputs[name] = tensors[index[name]];
+        tensors[index[name]] = nullptr;
+    }
+    for (dl::TensorBase *tensor : tensors) {
+        delete tensor;
+    }
+    return graph_outputs;
+}
+
+/**
+ * @brief Build the graph with a memory manager and an internal ram budget, run it twice on random inputs and compare
+ * every output byte for byte with run_reference().
+ *
+ * @param zero_copy_bytes  Set to MemoryManagerBase::zero_copy_bytes of the model
+ *
+ * @return Whether every output is identical.
+ */
+inline bool check_graph(const char *tag,
+                        const std::vector<uint8_t> &data,
+                        dl::memory_manager_t mm_type,
+                        int internal_size,
+                        size_t &zero_copy_bytes)
+{
+    uint8_t *fbs_data = (uint8_t *)heap_caps_aligned_alloc(16, data.size(), MALLOC_CAP_SPIRAM);
+    memcpy(fbs_data, data.data(), data.size());
+    fbs::FbsModel *fbs_model = new fbs::FbsModel(fbs_data, true);
+    dl::Model *model = new dl::Model(fbs_model, internal_size, mm_type);
+    zero_copy_bytes = model->get_memory_manager()->zero_copy_bytes;
+
+    bool same = true;
+    for (int seed = 0; seed < 2; seed++) {
+        std::map<std::string, dl::TensorBase *> reference = run_reference(fbs_model, model->get_inputs(), seed);
+        model->run(dl::RUNTIME_MODE_SINGLE_CORE);
+        for (auto &output : reference) {
+            dl::TensorBase *model_output = model->get_outputs().at(output.first);
+            if (model_output->shape != output.second->shape ||
+                memcmp(model_output->data, output.second->data, output.second->get_bytes()) != 0) {
+                ESP_LOGE(tag, "run %d: output %s differs from the reference", seed, output.first.c_str());
+                same = false;
+            }
+            delete output.second;
+        }
+    }
+    delete model;
+    delete fbs_model;
+    return same;
+}
+} // namespace test
@@ -0,0 +1,348 @@
+"""
+Compile an .espdl model ahead of time into a C++ translation unit for dl::Model.
+
+dl::Model::load walks the FlatBuffers graph at boot: it sorts the nodes, creates every module through ModuleCreator,
+parses the attributes and plans the activations. This tool does all of that on the host and emits
+
+    - the shape, exponent and arena offset of every activation, planned like MemoryManagerLinear
+    - the offset of every parameter inside the .espdl file
+    - one create_modules() function constructing the modules in execution order, with their attributes as constants
+      and their tensor indexes already resolved
+
+so that the chip only allocates the arenas and calls constructors. The generated source includes the headers of the
+ops the model uses and nothing else. The parameters stay in the .espdl file, which is still embedded or flashed as
+before, dl::Model checks at load that it is the file the model was compiled from.
+
+Usage:
+    python espdl_compiler.py -m pedestrian_detect_pico_s8_v1.espdl -o pedestrian_detect_pico_s8_v1_compiled.cpp \\
+        --internal 131072
+
+    dl::Model *model = new dl::Model(&pedestrian_detect_pico_s8_v1_compiled, rodata_address);
+"""
+
+import argparse
+import os
+import re
+import sys
+
+from espdl_reader import DATA_TYPES, EspdlModel
+from memory_planner_report import get_blocks, get_tensor_info, plan_by_size, plan_internal
+
+QUANT_TYPES = {"S8": "QUANT_TYPE_SYMM_8BIT", "S16": "QUANT_TYPE_SYMM_16BIT"}
+ACTIVATIONS = {None: "Linear", "Linear": "Linear", "Relu": "ReLU"}
+# Resize2D::deserialize resizes cubic as linear
+RESIZE_MODES = {"nearest": "RESIZE_NEAREST", "linear": "RESIZE_LINEAR", "cubic": "RESIZE_LINEAR"}
+RESIZE_COORDINATES = {
+    "half_pixel": "RESIZE_HALF_PIXEL",
+    "pytorch_half_pixel": "RESIZE_PYTORCH_HALF_PIXEL",
+    "align_corners": "RESIZE_ALIGN_CORNERS",
+    "asymmetric": "RESIZE_ASYMMETRIC",
+}
+RESIZE_NEAREST_MODES = {
+    "round_prefer_floor": "RESIZE_ROUND_PREFER_FLOOR",
+    "round_prefer_ceil": "RESIZE_ROUND_PREFER_CEIL",
+    "floor": "RESIZE_FLOOR",
+    "ceil": "RESIZE_CEIL",
+}
+
+# op_type: header of the module
+HEADERS = {
+    "Conv": "dl_module_conv.hpp",
+    "Gemm": "dl_module_gemm.hpp",
+    "Add": "dl_module_add.hpp",
+    "Sub": "dl_module_sub.hpp",
+    "Mul": "dl_module_mul.hpp",
+    "Relu": "dl_module_relu.hpp",
+    "Sigmoid": "dl_module_sigmoid.hpp",
+    "GlobalAveragePool": "dl_module_global_average_pool.hpp",
+    "Resize": "dl_module_resize.hpp",
+    "Concat": "dl_module_concat.hpp",
+}
+
+
+class CompileError(RuntimeError):
+    pass
+
+
+def dtype_name(dtype):
+    return "DATA_TYPE_" + DATA_TYPES[dtype][0].upper()
+
+
+def cpp_ints(values):
+    return "{" + ", ".join(str(v) for v in values) + "}"
+
+
+class Compiler:
+    def __init__(self, model, internal_size):
+        self.model = model
+        self.internal_size = internal_size
+        self.shapes = {}
+        self.headers = set()
+
+    def quant_type(self, node):
+        quant = node.attributes.get("quant_type")
+        if quant not in QUANT_TYPES:
+            raise CompileError("%s: quant_type %s is not supported" % (node.name, quant))
+        return QUANT_TYPES[quant]
+
+    def activation(self, node):
+        activation = node.attributes.get("activation")
+        if activation not in ACTIVATIONS:
+            raise CompileError("%s: activation %s is not supported" % (node.name, activation))
+        return ACTIVATIONS[activation]
+
+    def parameter(self, name):
+        """Expression creating the parameter, see dl::compiled::get_parameter"""
+        init = self.model.initializers[name]
+        exponent = init.exponents[0] if init.exponents else 0
+        return "get_parameter(model_data, param_copy, %d, %s, %d, %s)" % (
+            16 + init.data_offset,
+            cpp_ints(init.dims),
+            exponent,
+            dtype_name(init.dtype),
+        )
+
+    def optional_parameter(self, node, index):
+        if index < len(node.inputs) and node.inputs[index] in self.model.initializers:
+            return self.parameter(node.inputs[index])
+        return "nullptr"
+
+    def plan(self):
+        """Place the activations like MemoryManagerLinear, returns (tensors, psram size, internal size)"""
+        infos, node_num = get_tensor_info(self.model)
+        blocks = get_blocks(infos, node_num)
+        internal_bytes = 0
+        psram_blocks = blocks
+        if self.internal_size > 16:
+            internal_bytes = plan_internal(blocks, self.internal_size, node_num)
+            for b in blocks:
+                b.internal = b.placed
+            psram_blocks = [b for b in blocks if not b.internal]
+        psram_bytes = plan_by_size(psram_blocks)
+
+        block_of = {b.name: b for b in blocks}
+        tensors = []
+        for info in infos:
+            offset = 0
+            root = info
+            while root.leader:
+                offset += root.leader_offset
+                root = root.leader
+            block = block_of[root.name]
+            value_info = self.model.value_info[info.name]
+            tensors.append(
+                {
+                    "name": info.name,
+                    "dtype": value_info.dtype,
+                    "exponent": value_info.exponents[0] if value_info.exponents else 0,
+                    "shape": value_info.shape,
+                    "internal": block.internal,
+                    "offset": block.offset + offset,
+                }
+            )
+        return tensors, psram_bytes, internal_bytes
+
+    def module(self, node):
+        """Statements creating the module of node, the last one assigns it to module"""
+        op = node.op_type
+        if op not in HEADERS:
+            raise CompileError("%s: %s is not supported by the compiler, load the model with dl::Model" % (node.name, op))
+        self.headers.add(HEADERS[op])
+        name = '"%s"' % node.name
+        quant = self.quant_type(node)
+        lines = []
+        if op in ("Conv", "Gemm"):
+            group = node.attributes.get("group", 1)
+            lines.append("TensorBase *filter = %s;" % self.parameter(node.inputs[1]))
+            lines.append("TensorBase *bias = %s;" % self.optional_parameter(node, 2))
+            if len(node.inputs) > 2 and node.inputs[2] in self.model.initializers:
+                lines.append("bias->reset_bias_layout(%s, %s);" % (quant, "true" if group != 1 else "false"))
+            if op == "Conv":
+                pads = node.attributes.get("pads", [0, 0, 0, 0])
+                strides = node.attributes.get("strides", [1, 1])
+                dilations = node.attributes.get("dilations", [1, 1])
+                lines.append(
+                    "module = new Conv2D(filter, bias, %s, %s, %d, %d, %d, %d, %s, %d, %s);"
+                    % (
+                        self.activation(node),
+                        cpp_ints([pads[0], pads[2], pads[1], pads[3]]),
+                        strides[0],
+                        strides[1],
+                        dilations[0],
+                        dilations[1],
+                        name,
+                        group,
+                        quant,
+                    )
+                )
+            else:
+                lines.append("module = new Gemm(filter, bias, %s, %s, %s);" % (self.activation(node), name, quant))
+        elif op in ("Add", "Sub", "Mul"):
+            inplace = "MODULE_INPLACE_CHANGED_BUFFER" if op == "Add" else "MODULE_NON_INPLACE"
+            lines.append(
+                "module = new %s(%s, %s, %s, {%s, %s});"
+                % (op, name, inplace, quant, self.optional_parameter(node, 0), self.optional_parameter(node, 1))
+            )
+        elif op in ("Relu", "Sigmoid"):
+            lut = node.attributes.get("lut")
+            if quant == "QUANT_TYPE_SYMM_8BIT" and lut in self.model.initializers:
+                self.headers.add("dl_module_lut.hpp")
+                lines.append(
+                    "module = new LUT(%s, %s, MODULE_INPLACE_CHANGED_BUFFER, %s);" % (name, self.parameter(lut), quant)
+                )
+            else:
+                lines.append("module = new %s(%s, MODULE_INPLACE_CHANGED_BUFFER, %s);" % (op, name, quant))
+        elif op == "GlobalAveragePool":
+            lines.append("module = new GlobalAveragePool2D(%s, %s);" % (name, quant))
+        elif op == "Resize":
+            mode = node.attributes.get("mode", "nearest")
+            if mode not in RESIZE_MODES or len(node.inputs) < 3 or node.inputs[2] not in self.model.initializers:
+                raise CompileError("%s: only Resize by constant scales is supported" % node.name)
+            coordinate = node.attributes.get("coordinate_transformation_mode", "half_pixel")
+            nearest_mode = node.attributes.get("nearest_mode", "round_prefer_floor")
+            if coordinate not in RESIZE_COORDINATES or nearest_mode not in RESIZE_NEAREST_MODES:
+                raise CompileError("%s: Resize %s, %s is not supported" % (node.name, coordinate, nearest_mode))
+            scales = self.model.initializers[node.inputs[2]].values("f")
+            lines.append(
+                "module = new Resize2D(%s, %s, %rf, %rf, %s, %s, %s);"
+                % (
+                    name,
+                    RESIZE_MODES[mode],
+                    scales[2],
+                    scales[3],
+                    quant,
+                    RESIZE_COORDINATES[coordinate],
+                    RESIZE_NEAREST_MODES[nearest_mode],
+                )
+            )
+        elif op == "Concat":
+            lines.append("module = new Concat(%s, %d, %s);" % (name, node.attributes.get("axis", 0), quant))
+        return lines
+
+    def shape_symbol(self, shape):
+        key = tuple(shape)
+        if key not in self.shapes:
+            self.shapes[key] = "shape_%d" % len(self.shapes)
+        return self.shapes[key]
+
+    def compile(self, file_name, symbol):
+        tensors, psram_bytes, internal_bytes = self.plan()
+        index = {t["name"]: i for i, t in enumerate(tensors)}
+        plan = self.model.topological_sort()
+
+        body = []
+        for node in plan:
+            inputs = [index[name] for name in node.inputs if name in index]
+            outputs = [index[name] for name in node.outputs]
+            body.append("    // %s: %s" % (node.name, node.op_type))
+            body.append("    {")
+            body.extend("        " + line for line in self.module(node))
+            body.append("        push_module(execution_plan, module, %s, %s);" % (cpp_ints(inputs), cpp_ints(outputs)))
+            body.append("    }")
+
+        rows = []
+        for t in tensors:
+            rows.append(
+                '    {"%s", %s, %d, %d, %s, %s, %d},'
+                % (
+                    t["name"],
+                    dtype_name(t["dtype"]),
+                    t["exponent"],
+                    len(t["shape"]),
+                    self.shape_symbol(t["shape"]),
+                    "true" if t["internal"] else "false",
+                    t["offset"],
+                )
+            )
+
+        out = []
+        out.append("// Generated by espdl_compiler.py from %s, do not edit." % file_name)
+        out.append("// %d modules, %d tensors, psram: %d bytes, internal ram: %d bytes" % (
+            len(plan), len(tensors), psram_bytes, internal_bytes))
+        out.append('#include "dl_model_compiled.hpp"')
+        out.extend('#include "%s"' % h for h in sorted(self.headers))
+        out.append("")
+        out.append("using namespace dl;")
+        out.append("using namespace dl::module;")
+        out.append("using namespace dl::compiled;")
+        out.append("")
+        out.append("namespace {")
+        for shape, shape_symbol in self.shapes.items():
+            out.append("constexpr int %s[] = %s;" % (shape_symbol, cpp_ints(shape if shape else [1])))
+        out.append("")
+        out.append("const compiled_tensor_t tensors[] = {")
+        out.extend(rows)
+        out.append("};")
+        out.append("constexpr int inputs[] = %s;" % cpp_ints(index[v.name] for v in self.model.inputs))
+        out.append("constexpr int outputs[] = %s;" % cpp_ints(index[v.name] for v in self.model.outputs))
+        out.append("")
+        out.append("void create_modules(const uint8_t *model_data, bool param_copy, std::vector<Module *> &execution_plan)")
+        out.append("{")
+        out.append("    Module *module;")
+        out.extend(body)
+        out.append("}")
+        out.append("} // namespace")
+        out.append("")
+        out.append("extern const compiled_model_t %s = {" % symbol)
+        out.append('    "%s",' % self.model.name)
+        out.append('    "%s",' % file_name)
+        out.append("    %d," % self.model.version)
+        out.append("    %d," % self.model.fbs_size)
+        out.append("    tensors,")
+        out.append("    %d," % len(tensors))
+        out.append("    inputs,")
+        out.append("    %d," % len(self.model.inputs))
+        out.append("    outputs,")
+        out.append("    %d," % len(self.model.outputs))
+        out.append("    %d," % psram_bytes)
+        out.append("    %d," % internal_bytes)
+        out.append("    %d," % len(plan))
+        out.append("    create_modules,")
+        out.append("};")
+        return "\n".join(out) + "\n"
+
+
+def header(symbol):
+    return "\n".join(
+        [
+            "// Generated by espdl_compiler.py, do not edit.",
+            "#pragma once",
+            "",
+            '#include "dl_model_compiled.hpp"',
+            "",
+            "extern const dl::compiled_model_t %s;" % symbol,
+            "",
+        ]
+    )
+
+
+def main():
+    parser = argparse.ArgumentParser(description="esp-dl ahead of time model compiler")
+    parser.add_argument("-m", "--model", type=str, required=True, help="the path of the .espdl file")
+    parser.add_argument("-o", "--output", type=str, required=True, help="the path of the generated .cpp file")
+    parser.add_argument("--header", type=str, default=None, help="the path of the generated header, if any")
+    parser.add_argument(
+        "--symbol", type=str, default=None, help="name of the compiled_model_t, <file name>_compiled by default"
+    )
+    parser.add_argument(
+        "--internal", type=int, default=0, help="bytes of internal ram for the activations, 0 puts all in PSRAM"
+    )
+    args = parser.parse_args()
+
+    file_name = os.path.basename(args.model)
+    symbol = args.symbol or re.sub(r"\W", "_", os.path.splitext(file_name)[0]) + "_compiled"
+    try:
+        source = Compiler(EspdlModel(args.model), args.internal).compile(file_name, symbol)
+    except CompileError as e:
+        print("espdl_compiler: %s" % e, file=sys.stderr)
+        return 1
+    with open(args.output, "w") as f:
+        f.write(source)
+    if args.header:
+        with open(args.header, "w") as f:
+            f.write(header(symbol))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,247 @@
+"""
+Minimal reader of .espdl model files, for host side tools.
+
+It walks the FlatBuffers tables directly and only depends on the standard library. Field indexes follow the espdl
+schema written by esp-ppq:
+
+    Model:      ir_version(0), opset_import(1), ..., model_version(5), doc_string(6), graph(7)
+    Graph:      node(0), name(1), initializer(2), doc_string(3), input(4), output(5), value_info(6), ...
+    Node:       input(0), output(1), name(2), op_type(3), domain(4), attribute(5), doc_string(6)
+    Attribute:  name(0), ref_attr_name(1), doc_string(2), attr_type(3), f(4), i(5), s(6), t(7), g(8), ..., ints(11)
+    ValueInfo:  name(0), value_info_type(1) -> TypeInfo, doc_string(2), exponents(3)
+    TypeInfo:   value_type(0), value(1) -> TensorTypeInfo(elem_type(0), shape(1) -> TensorShape(dim(0)))
+    Tensor:     dims(0), data_type(1), ..., name(6), ..., raw_data(8), ..., exponents(13)
+"""
+
+import struct
+
+# TensorDataType of the schema, value: (name, element size in bytes)
+DATA_TYPES = {
+    0: ("undefined", 0),
+    1: ("float", 4),
+    2: ("uint8", 1),
+    3: ("int8", 1),
+    4: ("uint16", 2),
+    5: ("int16", 2),
+    6: ("int32", 4),
+    7: ("int64", 8),
+    9: ("bool", 1),
+    10: ("float16", 2),
+    11: ("double", 8),
+    12: ("uint32", 4),
+    13: ("uint64", 8),
+}
+
+# AttributeType of the schema
+ATTR_FLOAT = 1
+ATTR_INT = 2
+ATTR_STRING = 3
+ATTR_TENSOR = 4
+ATTR_FLOATS = 6
+ATTR_INTS = 7
+
+
+class _Table:
+    def __init__(self, buf, pos):
+        self.buf = buf
+        self.pos = pos
+        vtable = pos - struct.unpack_from("<i", buf, pos)[0]
+        vtable_size = struct.unpack_from("<H", buf, vtable)[0]
+        self.fields = [
+            struct.unpack_from("<H", buf, vtable + 4 + 2 * i)[0] for i in range((vtable_size - 4) // 2)
+        ]
+
+    def _field(self, index):
+        if index < len(self.fields) and self.fields[index]:
+            return self.pos + self.fields[index]
+        return None
+
+    def _deref(self, index):
+        pos = self._field(index)
+        if pos is None:
+            return None
+        return pos + struct.unpack_from("<I", self.buf, pos)[0]
+
+    def scalar(self, index, fmt, default=0):
+        pos = self._field(index)
+        if pos is None:
+            return default
+        return struct.unpack_from("<" + fmt, self.buf, pos)[0]
+
+    def table(self, index):
+        pos = self._deref(index)
+        return None if pos is None else _Table(self.buf, pos)
+
+    def string(self, index):
+        pos = self._deref(index)
+        if pos is None:
+            return ""
+        length = struct.unpack_from("<I", self.buf, pos)[0]
+        return bytes(self.buf[pos + 4 : pos + 4 + length]).decode()
+
+    def bytes_vector(self, index, element_size=1):
+        """Return (offset, bytes) of a vector of scalars or structs"""
+        pos = self._deref(index)
+        if pos is None:
+            return 0, b""
+        length = struct.unpack_from("<I", self.buf, pos)[0]
+        return pos + 4, bytes(self.buf[pos + 4 : pos + 4 + length * element_size])
+
+    def scalar_vector(self, index, fmt):
+        size = struct.calcsize(fmt)
+        _, data = self.bytes_vector(index, size)
+        return [struct.unpack_from("<" + fmt, data, i * size)[0] for i in range(len(data) // size)]
+
+    def tables(self, index):
+        pos = self._deref(index)
+        if pos is None:
+            return []
+        length = struct.unpack_from("<I", self.buf, pos)[0]
+        out = []
+        for i in range(length):
+            item = pos + 4 + 4 * i
+            out.append(_Table(self.buf, item + struct.unpack_from("<I", self.buf, item)[0]))
+        return out
+
+    def strings(self, index):
+        pos = self._deref(index)
+        if pos is None:
+            return []
+        length = struct.unpack_from("<I", self.buf, pos)[0]
+        out = []
+        for i in range(length):
+            item = pos + 4 + 4 * i
+            s = item + struct.unpack_from("<I", self.buf, item)[0]
+            n = struct.unpack_from("<I", self.buf, s)[0]
+            out.append(bytes(self.buf[s + 4 : s + 4 + n]).decode())
+        return out
+
+
+class Node:
+    def __init__(self, table):
+        self.inputs = table.strings(0)
+        self.outputs = table.strings(1)
+        self.name = table.string(2)
+        self.op_type = table.string(3)
+        self.attributes = {}
+        for attr in table.tables(5):
+            attr_type = attr.scalar(3, "i")
+            if attr_type == ATTR_INT:
+                value = attr.scalar(5, "q")
+            elif attr_type == ATTR_FLOAT:
+                value = attr.scalar(4, "f")
+            elif attr_type == ATTR_STRING:
+                value = attr.bytes_vector(6)[1].decode()
+            elif attr_type == ATTR_INTS:
+                value = attr.scalar_vector(11, "q")
+            elif attr_type == ATTR_FLOATS:
+                value = attr.scalar_vector(10, "f")
+            else:
+                value = None
+            self.attributes[attr.string(0)] = value
+
+
+class ValueInfo:
+    def __init__(self, table):
+        self.name = table.string(0)
+        self.exponents = table.scalar_vector(3, "q")
+        self.dtype = 0
+        self.shape = []
+        type_info = table.table(1)
+        tensor_type = type_info.table(1) if type_info else None
+        if tensor_type:
+            self.dtype = tensor_type.scalar(0, "i")
+            shape = tensor_type.table(1)
+            if shape:
+                for dim in shape.tables(0):
+                    value = dim.table(0)
+                    self.shape.append(value.scalar(1, "q") if value else 0)
+
+    @property
+    def element_size(self):
+        return DATA_TYPES.get(self.dtype, ("", 1))[1]
+
+    @property
+    def size(self):
+        """Size in bytes"""
+        n = self.element_size
+        for d in self.shape:
+            n *= d
+        return n
+
+
+class Initializer:
+    def __init__(self, table):
+        self.dims = table.scalar_vector(0, "q")
+        self.dtype = table.scalar(1, "i")
+        self.name = table.string(6)
+        # Offset of the data inside the FlatBuffers data, the file header of 16 bytes not included
+        self.data_offset, self.data = table.bytes_vector(8, 16)
+        self.exponents = table.scalar_vector(13, "q")
+
+    def values(self, fmt):
+        """Data as a list of scalars"""
+        size = struct.calcsize(fmt)
+        count = 1
+        for d in self.dims:
+            count *= d
+        return [struct.unpack_from("<" + fmt, self.data, i * size)[0] for i in range(count)]
+
+
+class EspdlModel:
+    """
+    One model of an .espdl file, EDL2 or the first model of a PDL2 pack. Encrypted models are not supported.
+    """
+
+    def __init__(self, path, index=0):
+        with open(path, "rb") as f:
+            data = f.read()
+        magic = data[:4].decode()
+        offset = 0
+        if magic == "PDL2":
+            offset = struct.unpack_from("<I", data, 8 + 12 * index)[0]
+            magic = data[offset : offset + 4].decode()
+        if magic != "EDL2":
+            raise RuntimeError("Unsupported model format %s." % magic)
+        mode, size = struct.unpack_from("<II", data, offset + 4)
+        if mode != 0:
+            raise RuntimeError("Encrypted models are not supported.")
+
+        self.offset = offset
+        self.fbs_size = size
+        self.buf = memoryview(data)[offset + 16 : offset + 16 + size]
+        root = _Table(self.buf, struct.unpack_from("<I", self.buf, 0)[0])
+        self.version = root.scalar(5, "q")
+        graph = root.table(7)
+        self.name = graph.string(1)
+        self.nodes = [Node(t) for t in graph.tables(0)]
+        self.initializers = {t.name: t for t in (Initializer(t) for t in graph.tables(2))}
+        self.inputs = [ValueInfo(t) for t in graph.tables(4)]
+        self.outputs = [ValueInfo(t) for t in graph.tables(5)]
+        self.value_info = {}
+        for info in [ValueInfo(t) for t in graph.tables(6)] + self.inputs + self.outputs:
+            self.value_info[info.name] = info
+
+    def topological_sort(self):
+        """Nodes in the order the runtime executes them: Kahn's algorithm, ties keep the order of the file"""
+        producer = {}
+        for i, node in enumerate(self.nodes):
+            for name in node.outputs:
+                producer[name] = i
+        pending = []
+        readers = [[] for _ in self.nodes]
+        for i, node in enumerate(self.nodes):
+            deps = {producer[name] for name in node.inputs if name in producer}
+            pending.append(len(deps))
+            for dep in deps:
+                readers[dep].append(i)
+        ready = [i for i, n in enumerate(pending) if n == 0]
+        order = []
+        while ready:
+            i = ready.pop(0)
+            order.append(self.nodes[i])
+            for j in readers[i]:
+                pending[j] -= 1
+                if pending[j] == 0:
+                    ready.append(j)
+        return order
@@ -0,0 +1,391 @@
+"""
+Compare the activation memory planners of dl::Model on the host.
+
+The tensor lifetimes and inplace links are derived like MemoryManagerGreedy::get_tensor_info_from_fbs and
+plan_zero_copy do on the chip, then every planner places them:
+
+    greedy          MemoryManagerGreedy, allocation in the order of the execution plan over a list of chunks
+    by-size         MemoryManagerLinear, largest tensor first, each one at the best fitting gap. With internal ram,
+                    the tensors with the most accesses per step of lifetime are packed into it first
+    exhaustive      MemoryManagerLinear, branch and bound over the placement order, only for small graphs
+    lower bound     largest sum of sizes alive at the same step, no planner can do better
+
+Usage:
+    python memory_planner_report.py -m ../../../main/pedestrian_detect_pico_s8_v1.espdl --internal 0 65536
+    python memory_planner_report.py -m ../../../main/pedestrian_detect_pico_s8_v1.espdl --internal 262144 --placement
+"""
+
+import argparse
+import sys
+
+from espdl_reader import EspdlModel
+
+INF = 1 << 62
+
+# Ops created with MODULE_INPLACE_CHANGED_BUFFER or MODULE_INPLACE_UNCHANGED_BUFFER by their deserialize().
+CHANGED_BUFFER_OPS = {
+    "Add", "And", "Clip", "Elu", "Equal", "Exp", "Gelu", "Greater", "GreaterOrEqual", "HardSigmoid", "HardSwish",
+    "LeakyRelu", "Less", "LessOrEqual", "Log", "LUT", "Max", "Min", "Not", "Or", "PRelu", "Relu", "QuantizeLinear",
+    "DequantizeLinear", "RequantizeLinear", "Sigmoid", "Sqrt", "Tanh", "Xor",
+}
+UNCHANGED_BUFFER_OPS = {"Flatten", "Reshape", "Squeeze", "Unsqueeze"}
+
+
+class TensorInfo:
+    def __init__(self, name, time_begin, size):
+        self.name = name
+        self.time_begin = time_begin
+        self.time_end = -1
+        self.size = size
+        self.leader = None
+        self.leader_offset = 0
+        self.follower = None
+        self.access_count = 0
+
+    def set_leader(self, leader, leader_offset=0):
+        self.leader = leader
+        self.leader_offset = leader_offset if leader else 0
+        if leader:
+            if leader.time_end != -1 and (leader.time_end < self.time_end or self.time_end == -1):
+                leader.update_time(self.time_end)
+            leader.time_begin = min(leader.time_begin, self.time_begin)
+
+    def update_time(self, t):
+        if self.leader:
+            self.leader.update_time(t)
+            self.time_end = self.leader.time_end
+        elif t == -1:
+            self.time_end = -1
+        elif t > self.time_end:
+            self.time_end = t
+
+    def root(self):
+        return self.leader.root() if self.leader else self
+
+
+def get_tensor_info(model):
+    """Tensor lifetimes and inplace links, see MemoryManagerGreedy::get_tensor_info_from_fbs"""
+    graph_outputs = {o.name for o in model.outputs}
+    graph_inputs = {i.name for i in model.inputs}
+    infos = []
+    index = {}
+    for info in model.inputs:
+        t = TensorInfo(info.name, 0, info.size)
+        index[t.name] = len(infos)
+        infos.append(t)
+
+    plan = model.topological_sort()
+    plan_io = []
+    for i, node in enumerate(plan):
+        inputs = []
+        for name in node.inputs:
+            if name not in index:
+                continue
+            t = infos[index[name]]
+            if t.follower:
+                t.follower.set_leader(None)
+                t.follower = None
+            if name not in graph_outputs:
+                t.update_time(i + 1)
+            inputs.append(index[name])
+            t.access_count += 1
+
+        outputs = []
+        inplace = node.op_type in CHANGED_BUFFER_OPS or node.op_type in UNCHANGED_BUFFER_OPS
+        for name in node.outputs:
+            t = TensorInfo(name, i, model.value_info[name].size)
+            if inplace and len(node.outputs) == 1:
+                leader = None
+                for in_name in node.inputs:
+                    if in_name not in index:
+                        continue
+                    leader = infos[index[in_name]]
+                    if leader.size >= t.size and in_name not in graph_outputs:
+                        break
+                    leader = None
+                if leader:
+                    if leader.follower:
+                        leader.follower.set_leader(None)
+                        leader.follower = None
+                    t.set_leader(leader)
+                    if node.op_type in CHANGED_BUFFER_OPS:
+                        leader.follower = t
+            t.access_count += 1
+            index[name] = len(infos)
+            outputs.append(len(infos))
+            infos.append(t)
+        plan_io.append((inputs, outputs))
+
+    plan_zero_copy(model, plan, plan_io, infos, graph_inputs, graph_outputs)
+    return infos, len(plan)
+
+
+def plan_zero_copy(model, plan, plan_io, infos, graph_inputs, graph_outputs, alignment=16):
+    """Concat inputs placed inside the concat output, see MemoryManagerGreedy::plan_zero_copy"""
+    leaders = {id(t.leader) for t in infos if t.leader}
+    for i, node in enumerate(plan):
+        inputs, outputs = plan_io[i]
+        if node.op_type != "Concat" or len(outputs) != 1 or len(inputs) != len(node.inputs):
+            continue
+        out = infos[outputs[0]]
+        shape = model.value_info[out.name].shape
+        axis = node.attributes.get("axis", 0)
+        axis = axis + len(shape) if axis < 0 else axis
+        outer = 1
+        for d in shape[:axis]:
+            outer *= d
+        if outer != 1 or out.leader:
+            continue
+        offset = 0
+        eligible = True
+        for index in inputs:
+            t = infos[index]
+            eligible = eligible and offset % alignment == 0 and t.root().time_end == i + 1 and not t.leader
+            eligible = eligible and id(t) not in leaders and not t.follower and inputs.count(index) == 1
+            eligible = eligible and t.name not in graph_inputs and t.name not in graph_outputs
+            offset += t.size
+        if not eligible or offset != out.size:
+            continue
+        offset = 0
+        for index in inputs:
+            infos[index].set_leader(out, offset)
+            offset += infos[index].size
+        leaders.add(id(out))
+
+
+def aligned(size, alignment=16):
+    return (size + alignment - 1) // alignment * alignment
+
+
+class Block:
+    def __init__(self, info, node_num):
+        self.name = info.name
+        self.size = aligned(info.size)
+        self.time_begin = info.time_begin
+        self.time_end = INF if info.time_end < 0 or info.time_end >= node_num else info.time_end
+        self.raw_end = info.time_end
+        self.access_count = 0
+        self.offset = 0
+        self.placed = False
+        self.internal = False
+
+    def overlaps(self, other):
+        return self.time_begin < other.time_end and other.time_begin < self.time_end
+
+
+def get_blocks(infos, node_num):
+    blocks = {id(t): Block(t, node_num) for t in infos if not t.leader}
+    for t in infos:
+        blocks[id(t.root())].access_count += t.access_count
+    return list(blocks.values())
+
+
+def lower_bound(blocks):
+    best = 0
+    for b in blocks:
+        best = max(best, sum(o.size for o in blocks if o.time_begin <= b.time_begin < o.time_end))
+    return best
+
+
+def plan_greedy(blocks, node_num, internal_size=0):
+    """MemoryManagerGreedy::simulate_with_internal_memory. Returns (psram bytes, internal bytes, psram blocks)"""
+
+    class Chunk:
+        def __init__(self, size, offset, block=None):
+            self.size = size
+            self.offset = offset
+            self.block = block
+
+    def free(block, chunks):
+        for k, c in enumerate(chunks):
+            if c.block is block:
+                c.block = None
+                if k + 1 < len(chunks) and chunks[k + 1].block is None:
+                    c.size += chunks[k + 1].size
+                    del chunks[k + 1]
+                if k > 0 and chunks[k - 1].block is None:
+                    chunks[k - 1].size += c.size
+                    del chunks[k]
+                return
+
+    def alloc(block, chunks, extend):
+        free_chunks = sorted((c for c in chunks if c.block is None), key=lambda c: c.size)
+        for c in free_chunks:
+            if c.size >= block.size:
+                k = chunks.index(c)
+                if c.size > block.size:
+                    chunks.insert(k + 1, Chunk(c.size - block.size, c.offset + block.size))
+                c.size = block.size
+                c.block = block
+                return True
+        if not extend:
+            return False
+        if chunks and chunks[-1].block is None:
+            chunks[-1].size = block.size
+            chunks[-1].block = block
+        else:
+            offset = chunks[-1].offset + chunks[-1].size if chunks else 0
+            chunks.append(Chunk(block.size, offset, block))
+        return True
+
+    psram = []
+    internal = [Chunk(internal_size, 0)] if internal_size > 16 else []
+    in_internal = set()
+    internal_used = 0
+    for i in range(node_num):
+        for b in blocks:
+            if b.raw_end == i:
+                free(b, internal if id(b) in in_internal else psram)
+        for b in blocks:
+            if b.time_begin == i:
+                if internal and alloc(b, internal, False):
+                    in_internal.add(id(b))
+                    internal_used = max(internal_used, max(c.offset + c.size for c in internal if c.block is b))
+                else:
+                    alloc(b, psram, True)
+    psram_size = psram[-1].offset + psram[-1].size if psram else 0
+    return psram_size, internal_used, [b for b in blocks if id(b) not in in_internal]
+
+
+def fit(block, blocks, best):
+    neighbors = sorted((o for o in blocks if o is not block and o.placed and block.overlaps(o)), key=lambda o: o.offset)
+    prev_end = 0
+    best_offset, best_gap = None, INF
+    for o in neighbors:
+        if o.offset >= prev_end + block.size:
+            if not best:
+                return prev_end
+            if o.offset - prev_end < best_gap:
+                best_offset, best_gap = prev_end, o.offset - prev_end
+        prev_end = max(prev_end, o.offset + o.size)
+    return prev_end if best_offset is None else best_offset
+
+
+def plan_by_size(blocks, capacity=0):
+    """MemoryManagerLinear::plan_by_size. Returns the arena size, blocks not fitting into capacity stay unplaced"""
+    for b in blocks:
+        b.placed = False
+    arena = 0
+    for b in sorted(blocks, key=lambda b: (-b.size, -(b.time_end - b.time_begin))):
+        offset = fit(b, blocks, True)
+        if capacity and offset + b.size > capacity:
+            offset = fit(b, blocks, False)
+            if offset + b.size > capacity:
+                continue
+        b.offset, b.placed = offset, True
+        arena = max(arena, offset + b.size)
+    return arena
+
+
+def plan_internal(blocks, capacity, node_num):
+    """MemoryManagerLinear::plan_internal, the most accesses per step of lifetime first"""
+    for b in blocks:
+        b.placed = False
+    arena = 0
+
+    def density(b):
+        return b.access_count / max(min(b.time_end, node_num) - b.time_begin, 1)
+
+    for b in sorted(blocks, key=lambda b: (-density(b), -b.size)):
+        offset = fit(b, blocks, True)
+        if offset + b.size > capacity:
+            offset = fit(b, blocks, False)
+            if offset + b.size > capacity:
+                continue
+        b.offset, b.placed = offset, True
+        arena = max(arena, offset + b.size)
+    return arena
+
+
+def plan_exhaustive(blocks, upper_bound, search_limit=200000):
+    """MemoryManagerLinear::plan_exhaustive. Returns (arena size, search nodes)"""
+    state = {"best": upper_bound, "nodes": 0}
+    bound = lower_bound(blocks)
+    for b in blocks:
+        b.placed = False
+
+    def search(placed, arena):
+        if placed == len(blocks):
+            state["best"] = min(state["best"], arena)
+            return
+        for i, b in enumerate(blocks):
+            if state["best"] <= bound or state["nodes"] >= search_limit:
+                return
+            if b.placed or any(
+                not o.placed and (o.size, o.time_begin, o.time_end) == (b.size, b.time_begin, b.time_end)
+                for o in blocks[:i]
+            ):
+                continue
+            offset = fit(b, blocks, False)
+            new_arena = max(arena, offset + b.size)
+            if new_arena >= state["best"]:
+                continue
+            state["nodes"] += 1
+            b.offset, b.placed = offset, True
+            search(placed + 1, new_arena)
+            b.placed = False
+
+    search(0, 0)
+    return state["best"], state["nodes"]
+
+
+def report(path, internal_sizes, exhaustive_max, placement=False):
+    model = EspdlModel(path)
+    infos, node_num = get_tensor_info(model)
+    blocks = get_blocks(infos, node_num)
+    print("model: %s, nodes: %d, tensors: %d, buffers: %d" % (path, node_num, len(infos), len(blocks)))
+    print("%-10s %-12s %14s %14s %14s" % ("internal", "planner", "psram", "internal", "total"))
+
+    for internal_size in internal_sizes:
+        psram_size, internal_bytes, psram_blocks = plan_greedy(blocks, node_num, internal_size)
+        rows = [("greedy", psram_size, internal_bytes)]
+
+        internal_bytes = 0
+        psram_blocks = blocks
+        if internal_size > 16:
+            internal_bytes = plan_internal(blocks, internal_size, node_num)
+            for b in blocks:
+                b.internal = b.placed
+            psram_blocks = [b for b in blocks if not b.internal]
+        psram_size = plan_by_size(psram_blocks)
+        rows.append(("by-size", psram_size, internal_bytes))
+        if 1 < len(psram_blocks) <= exhaustive_max:
+            best, nodes = plan_exhaustive(psram_blocks, psram_size)
+            rows.append(("exhaustive", best, internal_bytes))
+        rows.append(("lower bound", lower_bound(psram_blocks), internal_bytes))
+
+        for name, psram, internal in rows:
+            print("%-10d %-12s %14d %14d %14d" % (internal_size, name, psram, internal, psram + internal))
+
+    if placement:
+        # Placement of the last budget by MemoryManagerLinear, like Model::print_memory_placement() on the chip.
+        internal_traffic = sum(b.size * b.access_count for b in blocks if b.internal)
+        psram_traffic = sum(b.size * b.access_count for b in blocks if not b.internal)
+        print("\n%-24s %10s %12s %8s %10s" % ("tensor", "bytes", "time", "access", "location"))
+        for b in sorted(blocks, key=lambda b: b.time_begin):
+            end = "inf" if b.time_end == INF else str(b.time_end)
+            print(
+                "%-24s %10d %12s %8d %10s"
+                % (b.name, b.size, "[%d, %s)" % (b.time_begin, end), b.access_count, "internal" if b.internal else "psram")
+            )
+        print(
+            "tensor traffic per run: internal %d bytes, psram %d bytes (%.1f%% internal)"
+            % (internal_traffic, psram_traffic, 100.0 * internal_traffic / max(internal_traffic + psram_traffic, 1))
+        )
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="esp-dl memory planner report")
+    parser.add_argument("-m", "--model", type=str, required=True, help="the path of the .espdl file")
+    parser.add_argument(
+        "--internal", type=int, nargs="+", default=[0], help="internal ram budgets of the tensors, in bytes"
+    )
+    parser.add_argument(
+        "--exhaustive_max", type=int, default=12, help="search exhaustively if an arena has at most this many tensors"
+    )
+    parser.add_argument(
+        "--placement", action="store_true", help="print where every tensor lives with the last internal ram budget"
+    )
+    args = parser.parse_args()
+    report(args.model, args.internal, args.exhaustive_max, args.placement)
+    sys.exit(0)
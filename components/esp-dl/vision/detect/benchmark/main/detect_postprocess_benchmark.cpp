@@ -0,0 +1,221 @@
+#include "dl_detect_pico_postprocessor.hpp"
+#include "dl_math.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <stdlib.h>
+
+/**
+ * The candidate decoding of PicoPostprocessor against the float decoding it replaced, on the outputs of the pedestrian
+ * detect model filled with synthetic score maps: a sparse one, a few scores above the threshold like most frames, and
+ * a dense one with a quarter of the scores above it.
+ *
+ * Both postprocess the same tensors, the time is the average over the runs and the boxes NMS keeps are compared. The
+ * exp table of the int8 DFL can move a box edge by a pixel where the float expectation is next to an integer, and
+ * with -ffast-math the host vectorizes the square roots of the scores, which can round them differently by an ulp.
+ */
+
+static const char *TAG = "detect_postprocess_benchmark";
+
+namespace {
+using namespace dl::detect;
+
+// PicoPostprocessor before the candidate buffer: dequantize, float DFL and a sorted insert per score into a list, which
+// goes into the result arena for NMS.
+class ReferencePicoPostprocessor : public AnchorPointDetectPostprocessor {
+private:
+    dl::TensorHandle m_score[3];
+    dl::TensorHandle m_bbox[3];
+    std::list<result_t> m_box_list;
+
+    template <typename T>
+    void parse_stage(dl::TensorBase *score, dl::TensorBase *box, const int stage_index)
+    {
+        int stride_y = m_stages[stage_index].stride_y;
+        int stride_x = m_stages[stage_index].stride_x;
+
+        int offset_y = m_stages[stage_index].offset_y;
+        int offset_x = m_stages[stage_index].offset_x;
+
+        int H = score->shape[1];
+        int W = score->shape[2];
+        int C = score->shape[3];
+
+        T *score_ptr = (T *)score->data;
+        T *box_ptr = (T *)box->data;
+        float score_exp = DL_SCALE(score->exponent);
+        float box_exp = DL_SCALE(box->exponent);
+        T score_thr_quant = dl::quantize<T>(m_score_thr * m_score_thr, 1.f / score_exp);
+        float inv_resize_scale_x = 1.f / m_resize_scale_x;
+        float inv_resize_scale_y = 1.f / m_resize_scale_y;
+
+        for (size_t y = 0; y < H; y++) {
+            for (size_t x = 0; x < W; x++) {
+                for (size_t c = 0; c < C; c++) {
+                    if (*score_ptr > score_thr_quant) {
+                        int center_y = y * stride_y + offset_y;
+                        int center_x = x * stride_x + offset_x;
+
+                        float box_data[32];
+                        for (int i = 0; i < 32; i++) {
+                            box_data[i] = dl::dequantize(box_ptr[i], box_exp);
+                        }
+
+                        result_t new_box = {
+                            (int)c,
+                            sqrtf(dl::dequantize(*score_ptr, score_exp)),
+                            {(int)((center_x - dl::math::dfl_integral(box_data, 7) * stride_x) * inv_resize_scale_x),
+                             (int)((center_y - dl::math::dfl_integral(box_data + 8, 7) * stride_y) *
+                                   inv_resize_scale_y),
+                             (int)((center_x + dl::math::dfl_integral(box_data + 16, 7) * stride_x) *
+                                   inv_resize_scale_x),
+                             (int)((center_y + dl::math::dfl_integral(box_data + 24, 7) * stride_y) *
+                                   inv_resize_scale_y)},
+                            {},
+                            0};
+
+                        m_box_list.insert(
+                            std::upper_bound(m_box_list.begin(), m_box_list.end(), new_box, greater_box), new_box);
+                    }
+                    score_ptr++;
+                }
+                box_ptr += 32;
+            }
+        }
+    }
+
+public:
+    ReferencePicoPostprocessor(dl::Model *model,
+                               const float score_thr,
+                               const float nms_thr,
+                               const int top_k,
+                               const std::vector<anchor_point_stage_t> &stages) :
+        AnchorPointDetectPostprocessor(model, score_thr, nms_thr, top_k, stages),
+        m_score{model->resolve("score0"), model->resolve("score1"), model->resolve("score2")},
+        m_bbox{model->resolve("bbox0"), model->resolve("bbox1"), model->resolve("bbox2")}
+    {
+    }
+
+    void postprocess() override
+    {
+        for (int i = 0; i < 3; i++) {
+            dl::TensorBase *score = m_model->get_tensor(m_score[i]);
+            dl::TensorBase *bbox = m_model->get_tensor(m_bbox[i]);
+            if (score->dtype == dl::DATA_TYPE_INT8) {
+                parse_stage<int8_t>(score, bbox, i);
+            } else {
+                parse_stage<int16_t>(score, bbox, i);
+            }
+        }
+        for (const result_t &res : m_box_list) {
+            m_results.push_back(res);
+        }
+        m_box_list.clear();
+        nms();
+    }
+};
+
+// Scores below the threshold but for one in every `above_every`, DFL bins anywhere in the int8 range.
+void fill_outputs(dl::Model *model, int above_every)
+{
+    srand(above_every);
+    for (int i = 0; i < 3; i++) {
+        dl::TensorBase *score = model->get_tensor(model->resolve("score" + std::to_string(i)));
+        dl::TensorBase *bbox = model->get_tensor(model->resolve("bbox" + std::to_string(i)));
+        float inv_score_exp = 1.f / DL_SCALE(score->exponent);
+        int8_t low = dl::quantize<int8_t>(0.05f, inv_score_exp);
+        int8_t high_min = dl::quantize<int8_t>(0.3f, inv_score_exp);
+        int8_t high_max = dl::quantize<int8_t>(1.f, inv_score_exp);
+        int8_t *score_ptr = (int8_t *)score->data;
+        int score_size = score->shape[1] * score->shape[2] * score->shape[3];
+        for (int j = 0; j < score_size; j++) {
+            score_ptr[j] = rand() % above_every ? low : high_min + rand() % (high_max - high_min + 1);
+        }
+        int8_t *bbox_ptr = (int8_t *)bbox->data;
+        int bbox_size = bbox->shape[1] * bbox->shape[2] * bbox->shape[3];
+        for (int j = 0; j < bbox_size; j++) {
+            bbox_ptr[j] = rand() % 256 - 128;
+        }
+    }
+}
+
+int64_t time_postprocess(DetectPostprocessor *postprocessor, int runs)
+{
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < runs; i++) {
+        postprocessor->clear_result();
+        postprocessor->set_resize_scale_x(1.f);
+        postprocessor->set_resize_scale_y(1.f);
+        postprocessor->postprocess();
+    }
+    return esp_timer_get_time() - start;
+}
+
+bool benchmark(dl::Model *model, const char *name, int above_every, int runs)
+{
+    std::vector<anchor_point_stage_t> stages = {{8, 8, 4, 4}, {16, 16, 8, 8}, {32, 32, 16, 16}};
+    ReferencePicoPostprocessor reference(model, 0.5, 0.5, 10, stages);
+    PicoPostprocessor candidate(model, 0.5, 0.5, 10, stages);
+    fill_outputs(model, above_every);
+
+    int64_t reference_time = time_postprocess(&reference, runs);
+    int64_t candidate_time = time_postprocess(&candidate, runs);
+    std::span<const result_t> reference_result = reference.get_result(640, 480);
+    std::span<const result_t> candidate_result = candidate.get_result(640, 480);
+
+    bool same = reference_result.size() == candidate_result.size();
+    int max_box_diff = 0;
+    for (size_t i = 0; same && i < reference_result.size(); i++) {
+        const result_t &ref = reference_result[i];
+        const result_t &res = candidate_result[i];
+        same = ref.category == res.category && fabsf(ref.score - res.score) < 1e-6f;
+        for (int j = 0; j < 4; j++) {
+            max_box_diff = DL_MAX(max_box_diff, DL_ABS(ref.box[j] - res.box[j]));
+        }
+    }
+    same = same && max_box_diff <= 1;
+    ESP_LOGI(TAG,
+             "%-7s one score in %4d above: float %9.1f us, candidates %8.1f us, x%.1f, %d boxes, %s (box edges %d px)",
+             name,
+             above_every,
+             (float)reference_time / runs,
+             (float)candidate_time / runs,
+             (float)reference_time / candidate_time,
+             (int)candidate_result.size(),
+             same ? "same results" : "MISMATCH",
+             max_box_diff);
+    return same;
+}
+
+bool benchmark_all(const char *model_path, fbs::model_location_type_t location, int runs)
+{
+    dl::Model *model = new dl::Model(model_path, location);
+    bool same = benchmark(model, "sparse", 1000, runs);
+    same = benchmark(model, "medium", 50, runs) && same;
+    same = benchmark(model, "dense", 4, runs) && same;
+    delete model;
+    return same;
+}
+} // namespace
+
+#if defined(ESP_PLATFORM)
+extern const uint8_t model_espdl[] asm("_binary_pedestrian_detect_pico_s8_v1_espdl_start");
+bool nms_benchmark_all(int runs); // nms_benchmark.cpp, a host executable of its own
+
+extern "C" void app_main(void)
+{
+    benchmark_all((const char *)model_espdl, fbs::MODEL_LOCATION_IN_FLASH_RODATA, 20);
+    nms_benchmark_all(5);
+}
+#else
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        printf("usage: %s <model.espdl> [runs]\n", argv[0]);
+        return 1;
+    }
+    return benchmark_all(argv[1], fbs::MODEL_LOCATION_IN_SDCARD, argc > 2 ? atoi(argv[2]) : 100) ? 0 : 1;
+}
+#endif
@@ -0,0 +1,190 @@
+#include "dl_detect_postprocessor.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <algorithm>
+#include <list>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * The NMS engine of dl_detect_nms.hpp against the std::list NMS it replaced, from 10 to 5000 candidates in a crowded
+ * 640x480 frame: clusters of boxes jittered around objects of 24 to 160 pixels, four categories.
+ *
+ * Every mode runs with top_k = 10, what the detect models use, and with top_k = 0, every box NMS keeps. Hard NMS,
+ * with the grid or not, must keep the boxes the list NMS keeps.
+ */
+
+static const char *TAG = "nms_benchmark";
+
+namespace {
+using namespace dl::detect;
+
+// DetectPostprocessor::nms before the engine, top_k = 0 keeps every box.
+void list_nms(std::list<result_t> &box_list, float nms_thr, int top_k)
+{
+    int kept_number = 0;
+    for (std::list<result_t>::iterator kept = box_list.begin(); kept != box_list.end(); kept++) {
+        kept_number++;
+
+        if (kept_number == top_k) {
+            box_list.erase(++kept, box_list.end());
+            break;
+        }
+
+        int kept_area = (kept->box[2] - kept->box[0] + 1) * (kept->box[3] - kept->box[1] + 1);
+
+        std::list<result_t>::iterator other = kept;
+        other++;
+        for (; other != box_list.end();) {
+            int inter_lt_x = DL_MAX(kept->box[0], other->box[0]);
+            int inter_lt_y = DL_MAX(kept->box[1], other->box[1]);
+            int inter_rb_x = DL_MIN(kept->box[2], other->box[2]);
+            int inter_rb_y = DL_MIN(kept->box[3], other->box[3]);
+
+            int inter_height = inter_rb_y - inter_lt_y + 1;
+            int inter_width = inter_rb_x - inter_lt_x + 1;
+
+            if (inter_height > 0 && inter_width > 0) {
+                int other_area = (other->box[2] - other->box[0] + 1) * (other->box[3] - other->box[1] + 1);
+                int inter_area = inter_height * inter_width;
+                float iou = (float)inter_area / (kept_area + other_area - inter_area);
+                if (iou > nms_thr) {
+                    other = box_list.erase(other);
+                    continue;
+                }
+            }
+            other++;
+        }
+    }
+}
+
+void make_boxes(std::vector<nms_box_t> &boxes, int num)
+{
+    srand(num);
+    boxes.resize(num);
+    int objects = DL_MAX(num / 8, 1);
+    for (int i = 0; i < num; i++) {
+        // Object i % objects, the same for every box of the cluster.
+        int object = i % objects;
+        srand(object * 7919 + 1);
+        int size = 24 + rand() % 137;
+        int x = rand() % (640 - size);
+        int y = rand() % (480 - size);
+        srand(num * 31 + i);
+        int jitter = size / 5 + 1;
+        nms_box_t &box = boxes[i];
+        box.box[0] = x + rand() % jitter - jitter / 2;
+        box.box[1] = y + rand() % jitter - jitter / 2;
+        box.box[2] = box.box[0] + size + rand() % jitter - jitter / 2;
+        box.box[3] = box.box[1] + size + rand() % jitter - jitter / 2;
+        box.score = 0.3f + 0.7f * (rand() % 10000) / 10000.f;
+        box.category = object % 4;
+    }
+    std::stable_sort(
+        boxes.begin(), boxes.end(), [](const nms_box_t &a, const nms_box_t &b) { return a.score > b.score; });
+}
+
+bool same_boxes(const NMS &nms, int kept, const std::vector<nms_box_t> &boxes, const std::list<result_t> &box_list)
+{
+    if (kept != (int)box_list.size()) {
+        return false;
+    }
+    std::list<result_t>::const_iterator res = box_list.begin();
+    for (int i = 0; i < kept; i++, res++) {
+        if (memcmp(boxes[nms.get_keep()[i]].box, res->box, sizeof(int) * 4)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+float time_nms(NMS &nms, const std::vector<nms_box_t> &boxes, int runs, int &kept)
+{
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < runs; i++) {
+        kept = nms.run(boxes.data(), boxes.size());
+    }
+    return (float)(esp_timer_get_time() - start) / runs;
+}
+
+bool benchmark(int num, int top_k, int runs)
+{
+    std::vector<nms_box_t> boxes;
+    make_boxes(boxes, num);
+    std::list<result_t> box_list;
+    for (const nms_box_t &box : boxes) {
+        box_list.push_back({box.category, box.score, {box.box[0], box.box[1], box.box[2], box.box[3]}, {}, 0});
+    }
+
+    int64_t list_time = 0;
+    std::list<result_t> list_result;
+    for (int i = 0; i < runs; i++) {
+        list_result = box_list;
+        int64_t start = esp_timer_get_time();
+        list_nms(list_result, 0.5f, top_k);
+        list_time += esp_timer_get_time() - start;
+    }
+
+    nms_config_t config = {NMS_MODE_HARD, 0.5f, top_k, false, 0.5f, 0.3f, NMS_GRID_OFF};
+    NMS nms(config);
+    int kept, grid_kept, class_kept, linear_kept, gaussian_kept;
+    float pairs_time = time_nms(nms, boxes, runs, kept);
+    // Hard NMS over every category keeps what the list NMS keeps, with and without the grid.
+    bool same = same_boxes(nms, kept, boxes, list_result);
+    config.grid = NMS_GRID_ON;
+    nms.set_config(config);
+    float grid_time = time_nms(nms, boxes, runs, grid_kept);
+    same = same && same_boxes(nms, grid_kept, boxes, list_result);
+    config.grid = NMS_GRID_AUTO;
+    config.class_aware = true;
+    nms.set_config(config);
+    float class_time = time_nms(nms, boxes, runs, class_kept);
+    config.class_aware = false;
+    config.mode = NMS_MODE_SOFT_LINEAR;
+    nms.set_config(config);
+    float linear_time = time_nms(nms, boxes, runs, linear_kept);
+    config.mode = NMS_MODE_SOFT_GAUSSIAN;
+    nms.set_config(config);
+    float gaussian_time = time_nms(nms, boxes, runs, gaussian_kept);
+
+    ESP_LOGI(TAG,
+             "%5d %5d | %10.1f | %8.1f %8.1f %5d | %8.1f %5d | %9.1f %5d | %9.1f %5d | %s",
+             num,
+             top_k,
+             (float)list_time / runs,
+             pairs_time,
+             grid_time,
+             kept,
+             class_time,
+             class_kept,
+             linear_time,
+             linear_kept,
+             gaussian_time,
+             gaussian_kept,
+             same ? "same" : "MISMATCH");
+    return same;
+}
+} // namespace
+
+bool nms_benchmark_all(int runs)
+{
+    ESP_LOGI(TAG, "time in us, kept boxes");
+    ESP_LOGI(TAG,
+             "boxes top_k |  list NMS  |   hard   +grid    kept | class    kept | soft lin   kept | soft gauss kept |");
+    bool same = true;
+    const int nums[] = {10, 50, 100, 200, 500, 1000, 2000, 5000};
+    for (int top_k : {10, 0}) {
+        for (int num : nums) {
+            // Fewer runs for the larger sets, the list NMS is quadratic.
+            same = benchmark(num, top_k, DL_MAX(runs * 100 / num, 1)) && same;
+        }
+    }
+    return same;
+}
+
+#if !defined(ESP_PLATFORM)
+int main(int argc, char **argv)
+{
+    return nms_benchmark_all(argc > 1 ? atoi(argv[1]) : 100) ? 0 : 1;
+}
+#endif
@@ -19,27 +19,69 @@ DetectImpl::~DetectImpl()
     }
 }
 
-std::list<dl::detect::result_t> &DetectImpl::run(const dl::image::img_t &img)
+std::span<const dl::detect::result_t> DetectImpl::run(const dl::image::img_t &img)
 {
     DL_LOG_INFER_LATENCY_INIT();
     DL_LOG_INFER_LATENCY_START();
+    dl::ProfilerPhases phases(m_model->get_profiler(), "detect");
+    phases.next("preprocess");
     m_image_preprocessor->preprocess(img);
     DL_LOG_INFER_LATENCY_END_PRINT("detect", "pre");
 
     DL_LOG_INFER_LATENCY_START();
+    phases.next("model");
     m_model->run();
     DL_LOG_INFER_LATENCY_END_PRINT("detect", "model");
 
     DL_LOG_INFER_LATENCY_START();
+    phases.next("postprocess");
     m_postprocessor->clear_result();
     m_postprocessor->set_resize_scale_x(m_image_preprocessor->get_resize_scale_x());
     m_postprocessor->set_resize_scale_y(m_image_preprocessor->get_resize_scale_y());
     m_postprocessor->postprocess();
-    std::list<dl::detect::result_t> &result = m_postprocessor->get_result(img.width, img.height);
+    std::span<const dl::detect::result_t> result = m_postprocessor->get_result(img.width, img.height);
     DL_LOG_INFER_LATENCY_END_PRINT("detect", "post");
 
     return result;
 }
 
+#if CONFIG_IDF_TARGET_ESP32S3 || CONFIG_IDF_TARGET_ESP32P4
+std::span<const dl::detect::result_t> DetectImpl::run(const dl::image::jpeg_img_t &jpeg_img, bool swap_color_bytes)
+{
+    DL_LOG_INFER_LATENCY_INIT();
+    DL_LOG_INFER_LATENCY_START();
+    dl::ProfilerPhases phases(m_model->get_profiler(), "detect");
+    phases.next("preprocess");
+    if (m_image_preprocessor->preprocess(jpeg_img, swap_color_bytes) != ESP_OK) {
+        m_postprocessor->clear_result();
+        return m_postprocessor->get_result(jpeg_img.width, jpeg_img.height);
+    }
+    DL_LOG_INFER_LATENCY_END_PRINT("detect", "pre");
+
+    DL_LOG_INFER_LATENCY_START();
+    phases.next("model");
+    m_model->run();
+    DL_LOG_INFER_LATENCY_END_PRINT("detect", "model");
+
+    DL_LOG_INFER_LATENCY_START();
+    phases.next("postprocess");
+    m_postprocessor->clear_result();
+    m_postprocessor->set_resize_scale_x(m_image_preprocessor->get_resize_scale_x());
+    m_postprocessor->set_resize_scale_y(m_image_preprocessor->get_resize_scale_y());
+    m_postprocessor->postprocess();
+    std::span<const dl::detect::result_t> result = m_postprocessor->get_result(jpeg_img.width, jpeg_img.height);
+    DL_LOG_INFER_LATENCY_END_PRINT("detect", "post");
+
+    return result;
+}
+
+esp_jpeg_image_scale_t DetectImpl::get_jpeg_scale(const dl::image::jpeg_img_t &jpeg_img)
+{
+    return dl::image::get_jpeg_scale(jpeg_img,
+                                     m_image_preprocessor->get_model_input_width(),
+                                     m_image_preprocessor->get_model_input_height());
+}
+#endif
+
 } // namespace detect
 } // namespace dl
@@ -9,7 +9,22 @@ namespace detect {
 class Detect {
 public:
     virtual ~Detect() {};
-    virtual std::list<dl::detect::result_t> &run(const dl::image::img_t &img) = 0;
+    /**
+     * @brief Detect the objects of img. The results are read in place from the arena of the postprocessor, the span is
+     * valid until the next run.
+     */
+    virtual std::span<const dl::detect::result_t> run(const dl::image::img_t &img) = 0;
+#if CONFIG_IDF_TARGET_ESP32S3 || CONFIG_IDF_TARGET_ESP32P4
+    /**
+     * @brief Decode the jpeg straight into the model input, skipping the full resolution RGB888 img.
+     */
+    virtual std::span<const dl::detect::result_t> run(const dl::image::jpeg_img_t &jpeg_img,
+                                                      bool swap_color_bytes = false) = 0;
+    /**
+     * @brief The jpeg decoder scale which run(jpeg_img) would use, for callers decoding the jpeg themselves.
+     */
+    virtual esp_jpeg_image_scale_t get_jpeg_scale(const dl::image::jpeg_img_t &jpeg_img) = 0;
+#endif
 };
 
 class DetectWrapper : public Detect {
@@ -24,7 +39,17 @@ public:
             m_model = nullptr;
         }
     }
-    std::list<dl::detect::result_t> &run(const dl::image::img_t &img) { return m_model->run(img); }
+    std::span<const dl::detect::result_t> run(const dl::image::img_t &img) { return m_model->run(img); }
+#if CONFIG_IDF_TARGET_ESP32S3 || CONFIG_IDF_TARGET_ESP32P4
+    std::span<const dl::detect::result_t> run(const dl::image::jpeg_img_t &jpeg_img, bool swap_color_bytes = false)
+    {
+        return m_model->run(jpeg_img, swap_color_bytes);
+    }
+    esp_jpeg_image_scale_t get_jpeg_scale(const dl::image::jpeg_img_t &jpeg_img)
+    {
+        return m_model->get_jpeg_scale(jpeg_img);
+    }
+#endif
 };
 
 class DetectImpl : public Detect {
@@ -35,7 +60,12 @@ protected:
 
 public:
     ~DetectImpl();
-    std::list<dl::detect::result_t> &run(const dl::image::img_t &img) override;
+    std::span<const dl::detect::result_t> run(const dl::image::img_t &img) override;
+#if CONFIG_IDF_TARGET_ESP32S3 || CONFIG_IDF_TARGET_ESP32P4
+    std::span<const dl::detect::result_t> run(const dl::image::jpeg_img_t &jpeg_img,
+                                              bool swap_color_bytes = false) override;
+    esp_jpeg_image_scale_t get_jpeg_scale(const dl::image::jpeg_img_t &jpeg_img) override;
+#endif
 };
 } // namespace detect
 } // namespace dl
@@ -0,0 +1,147 @@
+#include "dl_detect_candidate.hpp"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include <algorithm>
+#include <cmath>
+
+static const char *TAG = "dl::detect";
+
+namespace dl {
+namespace detect {
+static inline bool better_candidate(const candidate_t &a, const candidate_t &b)
+{
+    if (a.score != b.score) {
+        return a.score > b.score;
+    }
+    return a.stage != b.stage ? a.stage < b.stage : a.index < b.index;
+}
+
+CandidateBuffer::CandidateBuffer(int capacity) : m_capacity(capacity), m_size(0)
+{
+    m_candidates = (candidate_t *)heap_caps_malloc(capacity * sizeof(candidate_t), MALLOC_CAP_INTERNAL);
+    if (!m_candidates) {
+        m_candidates = (candidate_t *)heap_caps_malloc(capacity * sizeof(candidate_t), MALLOC_CAP_DEFAULT);
+    }
+    if (!m_candidates) {
+        ESP_LOGE(TAG, "Fail to allocate %d candidates", capacity);
+        m_capacity = 0;
+    }
+}
+
+CandidateBuffer::~CandidateBuffer()
+{
+    heap_caps_free(m_candidates);
+}
+
+void CandidateBuffer::push(float score, uint32_t index, int stage)
+{
+    candidate_t candidate = {score, index, (uint16_t)stage};
+    if (m_size < m_capacity) {
+        m_candidates[m_size++] = candidate;
+        // From here on the buffer is a heap with the lowest candidate on top.
+        if (m_size == m_capacity) {
+            std::make_heap(this->begin(), this->end(), better_candidate);
+        }
+    } else if (m_capacity && better_candidate(candidate, m_candidates[0])) {
+        std::pop_heap(this->begin(), this->end(), better_candidate);
+        m_candidates[m_size - 1] = candidate;
+        std::push_heap(this->begin(), this->end(), better_candidate);
+    }
+}
+
+void CandidateBuffer::sort()
+{
+    std::sort(this->begin(), this->end(), better_candidate);
+}
+
+ResultArena::ResultArena(int capacity) : m_capacity(capacity), m_size(0)
+{
+    // Each result is written and read once a frame, unlike the candidates it can live in PSRAM.
+    m_results = (result_t *)heap_caps_malloc(capacity * sizeof(result_t), MALLOC_CAP_DEFAULT);
+    if (!m_results) {
+        ESP_LOGE(TAG, "Fail to allocate %d results", capacity);
+        m_capacity = 0;
+    }
+}
+
+ResultArena::~ResultArena()
+{
+    heap_caps_free(m_results);
+}
+
+void ExpTable::set_exponent(int exponent)
+{
+    if (exponent == m_exponent) {
+        return;
+    }
+    m_exponent = exponent;
+    m_scale = DL_SCALE(exponent);
+    for (int i = 0; i < 256; i++) {
+        m_table[i] = (uint32_t)lroundf(expf(-i * m_scale) * (1 << frac_bits));
+    }
+}
+
+float ExpTable::dfl_integral(const int8_t *data, int bins) const
+{
+    int max_value = data[0];
+    for (int i = 1; i < bins; i++) {
+        max_value = DL_MAX(max_value, data[i]);
+    }
+    // The largest bin adds 1 << frac_bits, the sum is never 0.
+    uint32_t sum = 0;
+    uint32_t weighted_sum = 0;
+    for (int i = 0; i < bins; i++) {
+        uint32_t value = m_table[max_value - data[i]];
+        sum += value;
+        weighted_sum += value * i;
+    }
+    return (float)weighted_sum / sum;
+}
+
+float ExpTable::dfl_integral(const int16_t *data, int bins) const
+{
+    int max_value = data[0];
+    for (int i = 1; i < bins; i++) {
+        max_value = DL_MAX(max_value, data[i]);
+    }
+    float sum = 0;
+    float weighted_sum = 0;
+    for (int i = 0; i < bins; i++) {
+        float value = expf((data[i] - max_value) * m_scale);
+        sum += value;
+        weighted_sum += value * i;
+    }
+    return weighted_sum / sum;
+}
+
+float ExpTable::softmax_max(const int8_t *data, int num, int &index) const
+{
+    index = 0;
+    for (int i = 1; i < num; i++) {
+        if (data[i] > data[index]) {
+            index = i;
+        }
+    }
+    uint32_t sum = 0;
+    for (int i = 0; i < num; i++) {
+        sum += m_table[data[index] - data[i]];
+    }
+    return (float)(1 << frac_bits) / sum;
+}
+
+float ExpTable::softmax_max(const int16_t *data, int num, int &index) const
+{
+    index = 0;
+    for (int i = 1; i < num; i++) {
+        if (data[i] > data[index]) {
+            index = i;
+        }
+    }
+    float sum = 0;
+    for (int i = 0; i < num; i++) {
+        sum += expf((data[i] - data[index]) * m_scale);
+    }
+    return 1.f / sum;
+}
+} // namespace detect
+} // namespace dl
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "dl_define.hpp"
+#include "dl_detect_define.hpp"
+#include <stdint.h>
+#include <string.h>
+
+namespace dl {
+namespace detect {
+/**
+ * @brief A score above the threshold. Only its place in the score map is kept while the maps are scanned, the box is
+ * decoded once the candidate made the top k.
+ */
+typedef struct {
+    float score;    /*<! dequantized score while scanning, score of the result once the candidates are sorted */
+    uint32_t index; /*<! index of the score in the score map of its stage */
+    uint16_t stage; /*<! stage of the score map */
+} candidate_t;
+
+/**
+ * @brief The candidates of a frame, in a buffer of fixed capacity allocated once. Once it is full, a new candidate
+ * replaces the lowest one, so the buffer keeps the top k of the frame and nothing is allocated per candidate.
+ */
+class CandidateBuffer {
+private:
+    candidate_t *m_candidates;
+    int m_capacity;
+    int m_size;
+
+public:
+    CandidateBuffer(int capacity);
+    ~CandidateBuffer();
+    CandidateBuffer(const CandidateBuffer &) = delete;
+    CandidateBuffer &operator=(const CandidateBuffer &) = delete;
+
+    void clear() { m_size = 0; }
+    void push(float score, uint32_t index, int stage);
+    /**
+     * @brief Sort by score, ties keep the order of the scan like the sorted insert into the box list did.
+     */
+    void sort();
+    int size() const { return m_size; }
+    candidate_t *begin() { return m_candidates; }
+    candidate_t *end() { return m_candidates + m_size; }
+};
+
+/**
+ * @brief The results of a frame, in an array allocated once with the postprocessor and reset each frame. The results
+ * are laid out inline, a frame allocates nothing per result and the caller reads them in place through a span.
+ */
+class ResultArena {
+private:
+    result_t *m_results;
+    int m_capacity;
+    int m_size;
+
+public:
+    ResultArena(int capacity);
+    ~ResultArena();
+    ResultArena(const ResultArena &) = delete;
+    ResultArena &operator=(const ResultArena &) = delete;
+
+    void clear() { m_size = 0; }
+    /**
+     * @brief Append a result, dropped once the arena is full. It holds as many results as the candidate buffer holds
+     * candidates, so a postprocessor decoding its candidates never fills it.
+     */
+    void push_back(const result_t &result)
+    {
+        if (m_size < m_capacity) {
+            m_results[m_size++] = result;
+        }
+    }
+    /**
+     * @brief Keep the first size results.
+     */
+    void resize(int size) { m_size = DL_MIN(size, m_size); }
+    int size() const { return m_size; }
+    result_t *begin() { return m_results; }
+    result_t *end() { return m_results + m_size; }
+    result_t &operator[](int index) { return m_results[index]; }
+};
+
+/**
+ * @brief The first element of [ptr, end) above threshold, or end. 16 bytes are compared at a time with the vector
+ * extensions of GCC, the sparse score maps of a frame go by without a branch per score.
+ */
+template <typename T>
+inline const T *find_above(const T *ptr, const T *end, T threshold)
+{
+    typedef T vector_t __attribute__((vector_size(16)));
+    const int lanes = 16 / sizeof(T);
+    vector_t threshold_vector = {};
+    threshold_vector += threshold;
+    while (end - ptr >= lanes) {
+        vector_t value;
+        memcpy(&value, ptr, sizeof(vector_t));
+        vector_t mask = value > threshold_vector;
+        uint64_t mask_words[2];
+        memcpy(mask_words, &mask, sizeof(mask_words));
+        if (mask_words[0] | mask_words[1]) {
+            break;
+        }
+        ptr += lanes;
+    }
+    for (; ptr < end; ptr++) {
+        if (*ptr > threshold) {
+            return ptr;
+        }
+    }
+    return end;
+}
+
+/**
+ * @brief Softmax of quantized data with the exponent of a tensor. int8 data looks exp(x - max) up in a table of the
+ * 256 differences two int8 values can have and sums in fixed point, int16 data goes through expf.
+ */
+class ExpTable {
+private:
+    static const int frac_bits = 20; /*<! exp(0) is 1 << frac_bits, 64 bins sum up without overflow */
+    int m_exponent;
+    float m_scale;
+    uint32_t m_table[256];
+
+public:
+    ExpTable() : m_exponent(INT32_MAX), m_scale(1.f) {}
+
+    /**
+     * @brief Build the table for the exponent of the data, nothing is done when it is already built for it.
+     */
+    void set_exponent(int exponent);
+
+    /**
+     * @brief Expectation of the bin index under the softmax of the bins, the distance decoded by DFL.
+     */
+    float dfl_integral(const int8_t *data, int bins) const;
+    float dfl_integral(const int16_t *data, int bins) const;
+
+    /**
+     * @brief The largest probability of the softmax and its index, the first one on ties.
+     */
+    float softmax_max(const int8_t *data, int num, int &index) const;
+    float softmax_max(const int16_t *data, int num, int &index) const;
+};
+} // namespace detect
+} // namespace dl
@@ -4,13 +4,29 @@
 #include "dl_tool.hpp"
 #include <vector>
 
+/**
+ * Capacity of the candidate buffer of a postprocessor. A frame with more scores above the threshold keeps the highest
+ * ones, which hold the top k boxes of NMS unless it suppresses hundreds of them.
+ */
+#ifndef DL_DETECT_MAX_CANDIDATES
+#define DL_DETECT_MAX_CANDIDATES 512
+#endif
+
+/**
+ * Keypoints a result holds inline, 5 for the face landmarks of MNP.
+ */
+#ifndef DL_DETECT_MAX_KEYPOINTS
+#define DL_DETECT_MAX_KEYPOINTS 5
+#endif
+
 namespace dl {
 namespace detect {
 typedef struct {
-    int category;              /*<! category index */
-    float score;               /*<! score of box */
-    std::vector<int> box;      /*<! [left_up_x, left_up_y, right_down_x, right_down_y] */
-    std::vector<int> keypoint; /*<! [x1, y1, x2, y2, ...] */
+    int category;                              /*<! category index */
+    float score;                               /*<! score of box */
+    int box[4];                                /*<! [left_up_x, left_up_y, right_down_x, right_down_y] */
+    int keypoint[DL_DETECT_MAX_KEYPOINTS * 2]; /*<! [x1, y1, x2, y2, ...] */
+    int keypoint_num;                          /*<! number of keypoint coordinates, 0 for a box only */
     void limit_box(int width, int height)
     {
         box[0] = DL_CLIP(box[0], 0, width - 1);
@@ -20,7 +36,7 @@ typedef struct {
     }
     void limit_keypoint(int width, int height)
     {
-        for (int i = 0; i < keypoint.size(); i++) {
+        for (int i = 0; i < keypoint_num; i++) {
             if (i % 2 == 0)
                 keypoint[i] = DL_CLIP(keypoint[i], 0, width - 1);
             else
@@ -30,7 +46,7 @@ typedef struct {
     int box_area() const { return (box[2] - box[0]) * (box[3] - box[1]); }
 } result_t;
 
-inline bool greater_box(result_t a, result_t b)
+inline bool greater_box(const result_t &a, const result_t &b)
 {
     return a.score > b.score;
 }
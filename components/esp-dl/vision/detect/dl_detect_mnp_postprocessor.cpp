@@ -1,107 +1,95 @@
 #include "dl_detect_mnp_postprocessor.hpp"
-#include "dl_math.hpp"
-#include <algorithm>
-#include <cmath>
+
+static_assert(DL_DETECT_MAX_KEYPOINTS >= 5, "MNP decodes 5 face landmarks");
 
 namespace dl {
 namespace detect {
+MNPPostprocessor::MNPPostprocessor(Model *model,
+                                  const float score_thr,
+                                  const float nms_thr,
+                                  const int top_k,
+                                  const std::vector<anchor_box_stage_t> &stages) :
+    AnchorBoxDetectPostprocessor(model, score_thr, nms_thr, top_k, stages),
+    m_score(model->resolve("score")),
+    m_bbox(model->resolve("box")),
+    m_landmark(model->resolve("landmark"))
+{
+}
+
 template <typename T>
-void MNPPostprocessor::parse_stage(TensorBase *score, TensorBase *box, TensorBase *landmark, const int stage_index)
+void MNPPostprocessor::parse_stage(TensorBase *score, const int stage_index)
 {
-    std::vector<std::vector<int>> &anchor_shape = m_stages[stage_index].anchor_shape;
+    int A = m_stages[stage_index].anchor_shape.size();
+    int C = score->shape[3] / A;
+    int num = score->shape[1] * score->shape[2] * A;
+    const T *score_ptr = (const T *)score->data;
+
+    for (int i = 0; i < num; i++) {
+        int category;
+        float max_score = m_softmax.softmax_max(score_ptr, C, category);
+        if (max_score > m_score_thr) {
+            m_candidates.push(max_score, i, stage_index);
+        }
+        score_ptr += C;
+    }
+}
 
-    int H = score->shape[1];
-    int W = score->shape[2];
-    int A = anchor_shape.size();
+template <typename T>
+result_t MNPPostprocessor::decode(const candidate_t &candidate,
+                                  TensorBase *score,
+                                  TensorBase *box,
+                                  TensorBase *landmark)
+{
+    const anchor_box_stage_t &stage = m_stages[candidate.stage];
+    int A = stage.anchor_shape.size();
     int C = score->shape[3] / A;
-    T *score_ptr = (T *)score->data;
-    T *box_ptr = (T *)box->data;
-    T *landmark_ptr = (T *)landmark->data;
-    float score_exp = DL_SCALE(score->exponent);
+    int anchor = candidate.index % A;
+    int anchor_h = stage.anchor_shape[anchor][0];
+    int anchor_w = stage.anchor_shape[anchor][1];
+    int category;
+    m_softmax.softmax_max((const T *)score->data + candidate.index * C, C, category);
+    const T *box_ptr = (const T *)box->data + candidate.index * 4;
+    const T *landmark_ptr = (const T *)landmark->data + candidate.index * 10;
     float box_exp = DL_SCALE(box->exponent);
     float landmark_exp = DL_SCALE(landmark->exponent);
     float inv_resize_scale_x = 1.f / m_resize_scale_x;
     float inv_resize_scale_y = 1.f / m_resize_scale_y;
 
-    for (size_t y = 0; y < H; y++) // height
-    {
-        for (size_t x = 0; x < W; x++) // width
-        {
-            for (size_t a = 0; a < A; a++) // anchor number
-            {
-                // softmax
-                float scores[C];
-                scores[0] = dequantize(score_ptr[0], score_exp);
-                float max_score = scores[0];
-                int max_score_c = 0;
-                for (int i = 1; i < C; i++) {
-                    scores[i] = dequantize(score_ptr[i], score_exp);
-                    if (max_score < scores[i]) {
-                        max_score_c = i;
-                        max_score = scores[i];
-                    }
-                }
-                float sum = 0;
-                for (int i = 0; i < C; i++) {
-                    sum += expf(scores[i] - max_score);
-                }
-                max_score = 1. / sum;
-
-                if (max_score > m_score_thr) {
-                    int anchor_h = anchor_shape[a][0];
-                    int anchor_w = anchor_shape[a][1];
-                    result_t new_box = {
-                        max_score_c,
-                        max_score,
-                        {(int)(anchor_w * dequantize(box_ptr[0], box_exp) * inv_resize_scale_x + m_top_left_x),
-                         (int)(anchor_h * dequantize(box_ptr[1], box_exp) * inv_resize_scale_y + m_top_left_y),
-                         (int)((anchor_w * dequantize(box_ptr[2], box_exp) + anchor_w) * inv_resize_scale_x +
-                               m_top_left_x),
-                         (int)((anchor_h * dequantize(box_ptr[3], box_exp) + anchor_h) * inv_resize_scale_y +
-                               m_top_left_y)},
-                        {
-                            (int)(anchor_w * dequantize(landmark_ptr[0], landmark_exp) * inv_resize_scale_x +
-                                  m_top_left_x),
-                            (int)(anchor_h * dequantize(landmark_ptr[1], landmark_exp) * inv_resize_scale_y +
-                                  m_top_left_y),
-                            (int)(anchor_w * dequantize(landmark_ptr[2], landmark_exp) * inv_resize_scale_x +
-                                  m_top_left_x),
-                            (int)(anchor_h * dequantize(landmark_ptr[3], landmark_exp) * inv_resize_scale_y +
-                                  m_top_left_y),
-                            (int)(anchor_w * dequantize(landmark_ptr[4], landmark_exp) * inv_resize_scale_x +
-                                  m_top_left_x),
-                            (int)(anchor_h * dequantize(landmark_ptr[5], landmark_exp) * inv_resize_scale_y +
-                                  m_top_left_y),
-                            (int)(anchor_w * dequantize(landmark_ptr[6], landmark_exp) * inv_resize_scale_x +
-                                  m_top_left_x),
-                            (int)(anchor_h * dequantize(landmark_ptr[7], landmark_exp) * inv_resize_scale_y +
-                                  m_top_left_y),
-                            (int)(anchor_w * dequantize(landmark_ptr[8], landmark_exp) * inv_resize_scale_x +
-                                  m_top_left_x),
-                            (int)(anchor_h * dequantize(landmark_ptr[9], landmark_exp) * inv_resize_scale_y +
-                                  m_top_left_y),
-                        }};
-
-                    m_box_list.insert(std::upper_bound(m_box_list.begin(), m_box_list.end(), new_box, greater_box),
-                                      new_box);
-                }
-                score_ptr += C;
-                box_ptr += 4;
-                landmark_ptr += 10;
-            }
-        }
+    result_t result = {
+        category,
+        candidate.score,
+        {(int)(anchor_w * dequantize(box_ptr[0], box_exp) * inv_resize_scale_x + m_top_left_x),
+         (int)(anchor_h * dequantize(box_ptr[1], box_exp) * inv_resize_scale_y + m_top_left_y),
+         (int)((anchor_w * dequantize(box_ptr[2], box_exp) + anchor_w) * inv_resize_scale_x + m_top_left_x),
+         (int)((anchor_h * dequantize(box_ptr[3], box_exp) + anchor_h) * inv_resize_scale_y + m_top_left_y)},
+        {},
+        10};
+    for (int i = 0; i < 10; i += 2) {
+        result.keypoint[i] =
+            (int)(anchor_w * dequantize(landmark_ptr[i], landmark_exp) * inv_resize_scale_x + m_top_left_x);
+        result.keypoint[i + 1] =
+            (int)(anchor_h * dequantize(landmark_ptr[i + 1], landmark_exp) * inv_resize_scale_y + m_top_left_y);
     }
+    return result;
 }
 
 void MNPPostprocessor::postprocess()
 {
-    TensorBase *score = m_model->get_intermediate("score");
-    TensorBase *bbox = m_model->get_intermediate("box");
-    TensorBase *landmark = m_model->get_intermediate("landmark");
-    if (score->dtype == DATA_TYPE_INT8) {
-        parse_stage<int8_t>(score, bbox, landmark, 0);
+    TensorBase *score = m_model->get_tensor(m_score);
+    TensorBase *bbox = m_model->get_tensor(m_bbox);
+    TensorBase *landmark = m_model->get_tensor(m_landmark);
+    m_softmax.set_exponent(score->exponent);
+
+    bool int8 = score->dtype == DATA_TYPE_INT8;
+    if (int8) {
+        parse_stage<int8_t>(score, 0);
     } else {
-        parse_stage<int16_t>(score, bbox, landmark, 0);
+        parse_stage<int16_t>(score, 0);
+    }
+    m_candidates.sort();
+    for (const candidate_t &candidate : m_candidates) {
+        m_results.push_back(int8 ? decode<int8_t>(candidate, score, bbox, landmark)
+                                  : decode<int16_t>(candidate, score, bbox, landmark));
     }
 }
 } // namespace detect
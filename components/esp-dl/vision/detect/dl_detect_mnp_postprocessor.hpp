@@ -5,12 +5,22 @@ namespace dl {
 namespace detect {
 class MNPPostprocessor : public AnchorBoxDetectPostprocessor {
 private:
+    TensorHandle m_score; /*<! resolved once, postprocess() runs without name lookups */
+    TensorHandle m_bbox;
+    TensorHandle m_landmark;
+    ExpTable m_softmax; /*<! built for the exponent of the score output */
     template <typename T>
-    void parse_stage(TensorBase *score, TensorBase *box, TensorBase *landmark, const int stage_index);
+    void parse_stage(TensorBase *score, const int stage_index);
+    template <typename T>
+    result_t decode(const candidate_t &candidate, TensorBase *score, TensorBase *box, TensorBase *landmark);
 
 public:
+    MNPPostprocessor(Model *model,
+                    const float score_thr,
+                    const float nms_thr,
+                    const int top_k,
+                    const std::vector<anchor_box_stage_t> &stages);
     void postprocess() override;
-    using AnchorBoxDetectPostprocessor::AnchorBoxDetectPostprocessor;
 };
 } // namespace detect
 } // namespace dl
@@ -1,88 +1,91 @@
 #include "dl_detect_msr_postprocessor.hpp"
 #include "dl_math.hpp"
-#include <algorithm>
-#include <cmath>
 
 namespace dl {
 namespace detect {
-template <typename T>
-void MSRPostprocessor::parse_stage(TensorBase *score, TensorBase *box, const int stage_index)
+MSRPostprocessor::MSRPostprocessor(Model *model,
+                                  const float score_thr,
+                                  const float nms_thr,
+                                  const int top_k,
+                                  const std::vector<anchor_box_stage_t> &stages) :
+    AnchorBoxDetectPostprocessor(model, score_thr, nms_thr, top_k, stages),
+    m_score{model->resolve("score0"), model->resolve("score1")},
+    m_bbox{model->resolve("box0"), model->resolve("box1")}
 {
-    int stride_y = m_stages[stage_index].stride_y;
-    int stride_x = m_stages[stage_index].stride_x;
+}
 
-    int offset_y = m_stages[stage_index].offset_y;
-    int offset_x = m_stages[stage_index].offset_x;
+template <typename T>
+void MSRPostprocessor::parse_stage(TensorBase *score, const int stage_index)
+{
+    int size = score->shape[1] * score->shape[2] * score->shape[3];
+    const T *score_ptr = (const T *)score->data;
+    const T *score_end = score_ptr + size;
+    float score_exp = DL_SCALE(score->exponent);
+    T score_thr_quant = quantize<T>(dl::math::inverse_sigmoid(m_score_thr), 1.f / score_exp);
 
-    std::vector<std::vector<int>> &anchor_shape = m_stages[stage_index].anchor_shape;
+    for (const T *ptr = find_above(score_ptr, score_end, score_thr_quant); ptr != score_end;
+         ptr = find_above(ptr + 1, score_end, score_thr_quant)) {
+        m_candidates.push(dequantize(*ptr, score_exp), ptr - score_ptr, stage_index);
+    }
+}
 
-    int H = score->shape[1];
+template <typename T>
+result_t MSRPostprocessor::decode(const candidate_t &candidate, TensorBase *score, TensorBase *box)
+{
+    const anchor_box_stage_t &stage = m_stages[candidate.stage];
     int W = score->shape[2];
-    int A = anchor_shape.size();
+    int A = stage.anchor_shape.size();
     int C = score->shape[3] / A;
-    T *score_ptr = (T *)score->data;
-    T *box_ptr = (T *)box->data;
-    float score_exp = DL_SCALE(score->exponent);
+    int anchor = candidate.index / C % A;
+    int position = candidate.index / C / A;
+    int center_y = position / W * stage.stride_y + stage.offset_y;
+    int center_x = position % W * stage.stride_x + stage.offset_x;
+    int anchor_h = stage.anchor_shape[anchor][0];
+    int anchor_w = stage.anchor_shape[anchor][1];
+    // Every score of the map has its own box.
+    const T *box_ptr = (const T *)box->data + candidate.index * 4;
     float box_exp = DL_SCALE(box->exponent);
-    T score_thr_quant = quantize<T>(dl::math::inverse_sigmoid(m_score_thr), 1.f / score_exp);
     float inv_resize_scale_x = 1.f / m_resize_scale_x;
     float inv_resize_scale_y = 1.f / m_resize_scale_y;
 
-    for (size_t y = 0; y < H; y++) // height
-    {
-        for (size_t x = 0; x < W; x++) // width
-        {
-            for (size_t a = 0; a < A; a++) // anchor number
-            {
-                for (size_t c = 0; c < C; c++) // category number
-                {
-                    if (*score_ptr > score_thr_quant) {
-                        int center_y = y * stride_y + offset_y;
-                        int center_x = x * stride_x + offset_x;
-                        int anchor_h = anchor_shape[a][0];
-                        int anchor_w = anchor_shape[a][1];
-                        result_t new_box = {
-                            (int)c,
-                            dl::math::sigmoid(dequantize(*score_ptr, score_exp)),
-                            {(int)((center_x - (anchor_w >> 1) + anchor_w * dequantize(box_ptr[0], box_exp)) *
-                                   inv_resize_scale_x),
-                             (int)((center_y - (anchor_h >> 1) + anchor_h * dequantize(box_ptr[1], box_exp)) *
-                                   inv_resize_scale_y),
-                             (int)((center_x + anchor_w - (anchor_w >> 1) +
-                                    anchor_w * dequantize(box_ptr[2], box_exp)) *
-                                   inv_resize_scale_x),
-                             (int)((center_y + anchor_h - (anchor_h >> 1) +
-                                    anchor_h * dequantize(box_ptr[3], box_exp)) *
-                                   inv_resize_scale_y)},
-                            {}};
-
-                        m_box_list.insert(std::upper_bound(m_box_list.begin(), m_box_list.end(), new_box, greater_box),
-                                          new_box);
-                    }
-                    score_ptr++;
-                    box_ptr += 4;
-                }
-            }
-        }
-    }
+    return {(int)(candidate.index % C),
+            candidate.score,
+            {(int)((center_x - (anchor_w >> 1) + anchor_w * dequantize(box_ptr[0], box_exp)) * inv_resize_scale_x),
+             (int)((center_y - (anchor_h >> 1) + anchor_h * dequantize(box_ptr[1], box_exp)) * inv_resize_scale_y),
+             (int)((center_x + anchor_w - (anchor_w >> 1) + anchor_w * dequantize(box_ptr[2], box_exp)) *
+                   inv_resize_scale_x),
+             (int)((center_y + anchor_h - (anchor_h >> 1) + anchor_h * dequantize(box_ptr[3], box_exp)) *
+                   inv_resize_scale_y)},
+            {},
+            0};
 }
 
-template void MSRPostprocessor::parse_stage<int8_t>(TensorBase *score, TensorBase *box, const int stage_index);
-template void MSRPostprocessor::parse_stage<int16_t>(TensorBase *score, TensorBase *box, const int stage_index);
-
 void MSRPostprocessor::postprocess()
 {
-    TensorBase *score0 = m_model->get_intermediate("score0");
-    TensorBase *bbox0 = m_model->get_intermediate("box0");
-    TensorBase *score1 = m_model->get_intermediate("score1");
-    TensorBase *bbox1 = m_model->get_intermediate("box1");
+    TensorBase *score[2];
+    TensorBase *bbox[2];
+    for (int i = 0; i < 2; i++) {
+        score[i] = m_model->get_tensor(m_score[i]);
+        bbox[i] = m_model->get_tensor(m_bbox[i]);
+    }
 
-    if (score0->dtype == DATA_TYPE_INT8) {
-        parse_stage<int8_t>(score0, bbox0, 0);
-        parse_stage<int8_t>(score1, bbox1, 1);
-    } else {
-        parse_stage<int16_t>(score0, bbox0, 0);
-        parse_stage<int16_t>(score1, bbox1, 1);
+    bool int8 = score[0]->dtype == DATA_TYPE_INT8;
+    for (int i = 0; i < 2; i++) {
+        if (int8) {
+            parse_stage<int8_t>(score[i], i);
+        } else {
+            parse_stage<int16_t>(score[i], i);
+        }
+    }
+    for (candidate_t &candidate : m_candidates) {
+        candidate.score = dl::math::sigmoid(candidate.score);
+    }
+    m_candidates.sort();
+    for (const candidate_t &candidate : m_candidates) {
+        TensorBase *candidate_score = score[candidate.stage];
+        TensorBase *candidate_box = bbox[candidate.stage];
+        m_results.push_back(int8 ? decode<int8_t>(candidate, candidate_score, candidate_box)
+                                  : decode<int16_t>(candidate, candidate_score, candidate_box));
     }
     nms();
 }
@@ -5,12 +5,20 @@ namespace dl {
 namespace detect {
 class MSRPostprocessor : public AnchorBoxDetectPostprocessor {
 private:
+    TensorHandle m_score[2]; /*<! resolved once, postprocess() runs without name lookups */
+    TensorHandle m_bbox[2];
     template <typename T>
-    void parse_stage(TensorBase *score, TensorBase *box, const int stage_index);
+    void parse_stage(TensorBase *score, const int stage_index);
+    template <typename T>
+    result_t decode(const candidate_t &candidate, TensorBase *score, TensorBase *box);
 
 public:
+    MSRPostprocessor(Model *model,
+                    const float score_thr,
+                    const float nms_thr,
+                    const int top_k,
+                    const std::vector<anchor_box_stage_t> &stages);
     void postprocess() override;
-    using AnchorBoxDetectPostprocessor::AnchorBoxDetectPostprocessor;
 };
 } // namespace detect
 } // namespace dl
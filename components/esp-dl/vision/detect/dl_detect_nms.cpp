@@ -0,0 +1,264 @@
+#include "dl_detect_nms.hpp"
+#include "dl_define.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace dl {
+namespace detect {
+NMS::NMS(const nms_config_t &config) :
+    m_config(config),
+    m_query(0),
+    m_use_grid(false),
+    m_cols(1),
+    m_rows(1),
+    m_x0(0),
+    m_y0(0),
+    m_inv_cell_w(1),
+    m_inv_cell_h(1)
+{
+}
+
+bool NMS::use_grid(int num) const
+{
+    if (m_config.grid != NMS_GRID_AUTO) {
+        return m_config.grid == NMS_GRID_ON;
+    }
+    // Hard NMS compares a box with the boxes kept so far, at most top_k of them, soft-NMS with every box left.
+    if (m_config.mode == NMS_MODE_HARD && m_config.top_k > 0 && m_config.top_k <= 32) {
+        return num >= 1024;
+    }
+    return num >= 64;
+}
+
+void NMS::build_grid(const nms_box_t *boxes, int num)
+{
+    int x_min = boxes[0].box[0], y_min = boxes[0].box[1];
+    int x_max = boxes[0].box[2], y_max = boxes[0].box[3];
+    float width_sum = 0, height_sum = 0;
+    for (int i = 0; i < num; i++) {
+        const int *box = boxes[i].box;
+        x_min = DL_MIN(x_min, box[0]);
+        y_min = DL_MIN(y_min, box[1]);
+        x_max = DL_MAX(x_max, box[2]);
+        y_max = DL_MAX(y_max, box[3]);
+        width_sum += box[2] - box[0] + 1;
+        height_sum += box[3] - box[1] + 1;
+    }
+    // Cells of the mean box, so a box covers about four cells.
+    float extent_w = DL_MAX(x_max - x_min + 1, 1);
+    float extent_h = DL_MAX(y_max - y_min + 1, 1);
+    float cell_w = DL_MAX(width_sum / num, 1.f);
+    float cell_h = DL_MAX(height_sum / num, 1.f);
+    m_cols = DL_CLIP((int)ceilf(extent_w / cell_w), 1, 64);
+    m_rows = DL_CLIP((int)ceilf(extent_h / cell_h), 1, 64);
+    m_x0 = x_min;
+    m_y0 = y_min;
+    m_inv_cell_w = m_cols / extent_w;
+    m_inv_cell_h = m_rows / extent_h;
+    m_cell_head.assign(m_cols * m_rows, -1);
+    m_entry_next.clear();
+    m_entry_box.clear();
+}
+
+void NMS::cell_range(const int *box, int &col0, int &row0, int &col1, int &row1) const
+{
+    col0 = DL_CLIP((int)((box[0] - m_x0) * m_inv_cell_w), 0, m_cols - 1);
+    row0 = DL_CLIP((int)((box[1] - m_y0) * m_inv_cell_h), 0, m_rows - 1);
+    col1 = DL_CLIP((int)((box[2] - m_x0) * m_inv_cell_w), 0, m_cols - 1);
+    row1 = DL_CLIP((int)((box[3] - m_y0) * m_inv_cell_h), 0, m_rows - 1);
+}
+
+void NMS::insert(const nms_box_t *boxes, int index)
+{
+    int col0, row0, col1, row1;
+    this->cell_range(boxes[index].box, col0, row0, col1, row1);
+    for (int row = row0; row <= row1; row++) {
+        for (int col = col0; col <= col1; col++) {
+            int cell = row * m_cols + col;
+            m_entry_next.push_back(m_cell_head[cell]);
+            m_entry_box.push_back(index);
+            m_cell_head[cell] = m_entry_box.size() - 1;
+        }
+    }
+}
+
+float NMS::iou(const nms_box_t *boxes, int a, int b) const
+{
+    const int *box_a = boxes[a].box;
+    const int *box_b = boxes[b].box;
+    int inter_height = DL_MIN(box_a[3], box_b[3]) - DL_MAX(box_a[1], box_b[1]) + 1;
+    int inter_width = DL_MIN(box_a[2], box_b[2]) - DL_MAX(box_a[0], box_b[0]) + 1;
+    if (inter_height <= 0 || inter_width <= 0) {
+        return 0;
+    }
+    int inter_area = inter_height * inter_width;
+    return (float)inter_area / (m_area[a] + m_area[b] - inter_area);
+}
+
+bool NMS::suppressed(const nms_box_t *boxes, int index)
+{
+    if (!m_use_grid) {
+        for (int kept : m_keep) {
+            if ((!m_config.class_aware || boxes[kept].category == boxes[index].category) &&
+                this->iou(boxes, kept, index) > m_config.iou_thr) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    m_query++;
+    int col0, row0, col1, row1;
+    this->cell_range(boxes[index].box, col0, row0, col1, row1);
+    for (int row = row0; row <= row1; row++) {
+        for (int col = col0; col <= col1; col++) {
+            for (int entry = m_cell_head[row * m_cols + col]; entry >= 0; entry = m_entry_next[entry]) {
+                int kept = m_entry_box[entry];
+                if (m_stamp[kept] == m_query) {
+                    continue;
+                }
+                m_stamp[kept] = m_query;
+                if ((!m_config.class_aware || boxes[kept].category == boxes[index].category) &&
+                    this->iou(boxes, kept, index) > m_config.iou_thr) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+int NMS::run_hard(const nms_box_t *boxes, int num)
+{
+    for (int i = 0; i < num; i++) {
+        if (!this->suppressed(boxes, i)) {
+            m_keep.push_back(i);
+            m_scores.push_back(boxes[i].score);
+            if ((int)m_keep.size() == m_config.top_k) {
+                break;
+            }
+            if (m_use_grid) {
+                this->insert(boxes, i);
+            }
+        }
+    }
+    return m_keep.size();
+}
+
+void NMS::decay(const nms_box_t *boxes, int kept, int index)
+{
+    if (m_config.class_aware && boxes[kept].category != boxes[index].category) {
+        return;
+    }
+    float overlap = this->iou(boxes, kept, index);
+    if (m_config.mode == NMS_MODE_SOFT_LINEAR) {
+        if (overlap > m_config.iou_thr) {
+            m_decayed[index] *= 1 - overlap;
+        }
+    } else if (overlap > 0) {
+        m_decayed[index] *= expf(-overlap * overlap / m_config.sigma);
+    }
+    if (m_decayed[index] < m_config.score_thr) {
+        m_removed[index] = 1;
+    }
+}
+
+static inline bool lower_entry(const NMS::heap_entry_t &a, const NMS::heap_entry_t &b)
+{
+    return a.score != b.score ? a.score < b.score : a.index > b.index;
+}
+
+int NMS::run_soft(const nms_box_t *boxes, int num)
+{
+    m_decayed.resize(num);
+    m_removed.assign(num, 0);
+    m_heap.clear();
+    for (int i = 0; i < num; i++) {
+        m_decayed[i] = boxes[i].score;
+        if (m_decayed[i] < m_config.score_thr) {
+            m_removed[i] = 1;
+            continue;
+        }
+        m_heap.push_back({m_decayed[i], i});
+        if (m_use_grid) {
+            this->insert(boxes, i);
+        }
+    }
+    std::make_heap(m_heap.begin(), m_heap.end(), lower_entry);
+
+    // Scores only decay, so an entry whose score is still current is the highest box left, the first on ties. An entry
+    // which decayed since it was pushed goes back with its current score.
+    while (!m_heap.empty()) {
+        heap_entry_t top = m_heap.front();
+        std::pop_heap(m_heap.begin(), m_heap.end(), lower_entry);
+        m_heap.pop_back();
+        if (m_removed[top.index]) {
+            continue;
+        }
+        if (top.score != m_decayed[top.index]) {
+            m_heap.push_back({m_decayed[top.index], top.index});
+            std::push_heap(m_heap.begin(), m_heap.end(), lower_entry);
+            continue;
+        }
+
+        int best = top.index;
+        m_keep.push_back(best);
+        m_scores.push_back(m_decayed[best]);
+        m_removed[best] = 1;
+        if ((int)m_keep.size() == m_config.top_k) {
+            break;
+        }
+
+        if (!m_use_grid) {
+            for (int index = 0; index < num; index++) {
+                if (!m_removed[index]) {
+                    this->decay(boxes, best, index);
+                }
+            }
+            continue;
+        }
+        m_query++;
+        int col0, row0, col1, row1;
+        this->cell_range(boxes[best].box, col0, row0, col1, row1);
+        for (int row = row0; row <= row1; row++) {
+            for (int col = col0; col <= col1; col++) {
+                for (int entry = m_cell_head[row * m_cols + col]; entry >= 0; entry = m_entry_next[entry]) {
+                    int index = m_entry_box[entry];
+                    if (m_removed[index] || m_stamp[index] == m_query) {
+                        continue;
+                    }
+                    m_stamp[index] = m_query;
+                    this->decay(boxes, best, index);
+                }
+            }
+        }
+    }
+    return m_keep.size();
+}
+
+int NMS::run(const nms_box_t *boxes, int num)
+{
+    m_keep.clear();
+    m_scores.clear();
+    if (num <= 0) {
+        return 0;
+    }
+    m_area.resize(num);
+    for (int i = 0; i < num; i++) {
+        const int *box = boxes[i].box;
+        m_area[i] = (box[2] - box[0] + 1) * (box[3] - box[1] + 1);
+    }
+    m_use_grid = this->use_grid(num);
+    if (m_use_grid) {
+        m_stamp.assign(num, -1);
+        m_query = 0;
+        this->build_grid(boxes, num);
+    }
+
+    if (m_config.mode == NMS_MODE_HARD) {
+        return this->run_hard(boxes, num);
+    }
+    return this->run_soft(boxes, num);
+}
+} // namespace detect
+} // namespace dl
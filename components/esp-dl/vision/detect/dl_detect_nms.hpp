@@ -0,0 +1,103 @@
+#pragma once
+
+#include <limits.h>
+#include <vector>
+
+namespace dl {
+namespace detect {
+typedef enum {
+    NMS_MODE_HARD = 0,         /*<! drop the boxes overlapping a kept box by more than iou_thr */
+    NMS_MODE_SOFT_LINEAR = 1,  /*<! scale their score by 1 - IoU instead */
+    NMS_MODE_SOFT_GAUSSIAN = 2 /*<! scale the score of every overlapping box by exp(-IoU^2 / sigma) */
+} nms_mode_t;
+
+typedef enum {
+    NMS_GRID_AUTO = 0, /*<! use the grid when it pays off for the number of boxes and top_k */
+    NMS_GRID_OFF = 1,  /*<! compare every pair */
+    NMS_GRID_ON = 2    /*<! compare only the boxes sharing a grid cell */
+} nms_grid_t;
+
+typedef struct {
+    nms_mode_t mode;
+    float iou_thr;     /*<! IoU above which hard and linear NMS act */
+    int top_k;         /*<! stop once top_k boxes are kept, 0 keeps every box */
+    bool class_aware;  /*<! only boxes of the same category suppress each other */
+    float sigma;       /*<! gaussian soft-NMS */
+    float score_thr;   /*<! soft-NMS drops the boxes whose score decays below it */
+    nms_grid_t grid;
+} nms_config_t;
+
+/**
+ * @brief A box of NMS, [left_up_x, left_up_y, right_down_x, right_down_y] in pixels, both corners included.
+ */
+typedef struct {
+    int box[4];
+    float score;
+    int category;
+} nms_box_t;
+
+/**
+ * @brief Greedy NMS over a contiguous array of boxes. The buffers grow to the largest frame and are reused, a frame
+ * allocates nothing once they have.
+ *
+ * With the grid, the boxes are put into every cell of a uniform grid they cover, the cells sized after the mean box,
+ * and a box is only compared with the boxes sharing a cell with it: two boxes which overlap share a cell, so the
+ * result is the same as comparing every pair.
+ */
+class NMS {
+public:
+    typedef struct {
+        float score;
+        int index;
+    } heap_entry_t;
+
+private:
+    nms_config_t m_config;
+    std::vector<int> m_keep;
+    std::vector<float> m_scores;
+    std::vector<int> m_area;
+    std::vector<float> m_decayed;     /*<! soft-NMS: scores of the boxes as they decay */
+    std::vector<heap_entry_t> m_heap; /*<! soft-NMS: boxes left, by the score they had when pushed */
+    std::vector<char> m_removed;      /*<! soft-NMS: kept or decayed below score_thr */
+    std::vector<int> m_stamp;         /*<! query of each box, a box sharing several cells is compared once */
+    int m_query;
+    // grid
+    bool m_use_grid;
+    int m_cols;
+    int m_rows;
+    float m_x0;
+    float m_y0;
+    float m_inv_cell_w;
+    float m_inv_cell_h;
+    std::vector<int> m_cell_head; /*<! first entry of each cell, -1 for none */
+    std::vector<int> m_entry_next;
+    std::vector<int> m_entry_box;
+
+    bool use_grid(int num) const;
+    void build_grid(const nms_box_t *boxes, int num);
+    void cell_range(const int *box, int &col0, int &row0, int &col1, int &row1) const;
+    void insert(const nms_box_t *boxes, int index);
+    float iou(const nms_box_t *boxes, int a, int b) const;
+    bool suppressed(const nms_box_t *boxes, int index);
+    void decay(const nms_box_t *boxes, int kept, int index);
+    int run_hard(const nms_box_t *boxes, int num);
+    int run_soft(const nms_box_t *boxes, int num);
+
+public:
+    NMS(const nms_config_t &config);
+    void set_config(const nms_config_t &config) { m_config = config; }
+    const nms_config_t &get_config() const { return m_config; }
+
+    /**
+     * @brief Run NMS.
+     *
+     * @param boxes  hard NMS takes them sorted by score, highest first, which is the order of the postprocessors
+     * @param num    number of boxes
+     * @return number of boxes kept, their indexes and scores are in get_keep() and get_scores(), highest first
+     */
+    int run(const nms_box_t *boxes, int num);
+    const int *get_keep() const { return m_keep.data(); }
+    const float *get_scores() const { return m_scores.data(); }
+};
+} // namespace detect
+} // namespace dl
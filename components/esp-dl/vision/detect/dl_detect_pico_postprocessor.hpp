@@ -5,12 +5,21 @@ namespace dl {
 namespace detect {
 class PicoPostprocessor : public AnchorPointDetectPostprocessor {
 private:
+    TensorHandle m_score[3]; /*<! resolved once, postprocess() runs without name lookups */
+    TensorHandle m_bbox[3];
+    ExpTable m_dfl[3]; /*<! built for the exponent of each bbox output */
     template <typename T>
-    void parse_stage(TensorBase *score, TensorBase *box, const int stage_index);
+    void parse_stage(TensorBase *score, const int stage_index);
+    template <typename T>
+    result_t decode(const candidate_t &candidate, TensorBase *score, TensorBase *box);
 
 public:
+    PicoPostprocessor(Model *model,
+                     const float score_thr,
+                     const float nms_thr,
+                     const int top_k,
+                     const std::vector<anchor_point_stage_t> &stages);
     void postprocess() override;
-    using AnchorPointDetectPostprocessor::AnchorPointDetectPostprocessor;
 };
 } // namespace detect
 } // namespace dl
@@ -1,52 +1,35 @@
 #include "dl_detect_postprocessor.hpp"
+#include <algorithm>
 
 namespace dl {
 namespace detect {
 void DetectPostprocessor::nms()
 {
-    int kept_number = 0;
-    for (std::list<result_t>::iterator kept = m_box_list.begin(); kept != m_box_list.end(); kept++) {
-        kept_number++;
-
-        if (kept_number >= m_top_k) {
-            m_box_list.erase(++kept, m_box_list.end());
-            break;
-        }
-
-        int kept_area = (kept->box[2] - kept->box[0] + 1) * (kept->box[3] - kept->box[1] + 1);
-
-        std::list<result_t>::iterator other = kept;
-        other++;
-        for (; other != m_box_list.end();) {
-            int inter_lt_x = DL_MAX(kept->box[0], other->box[0]);
-            int inter_lt_y = DL_MAX(kept->box[1], other->box[1]);
-            int inter_rb_x = DL_MIN(kept->box[2], other->box[2]);
-            int inter_rb_y = DL_MIN(kept->box[3], other->box[3]);
-
-            int inter_height = inter_rb_y - inter_lt_y + 1;
-            int inter_width = inter_rb_x - inter_lt_x + 1;
+    m_nms_boxes.clear();
+    for (const result_t &res : m_results) {
+        m_nms_boxes.push_back({{res.box[0], res.box[1], res.box[2], res.box[3]}, res.score, res.category});
+    }
 
-            if (inter_height > 0 && inter_width > 0) {
-                int other_area = (other->box[2] - other->box[0] + 1) * (other->box[3] - other->box[1] + 1);
-                int inter_area = inter_height * inter_width;
-                float iou = (float)inter_area / (kept_area + other_area - inter_area);
-                if (iou > m_nms_thr) {
-                    other = m_box_list.erase(other);
-                    continue;
-                }
-            }
-            other++;
-        }
+    int kept_number = m_nms.run(m_nms_boxes.data(), m_nms_boxes.size());
+    const int *keep = m_nms.get_keep();
+    const float *scores = m_nms.get_scores();
+    // Soft-NMS keeps the boxes out of order, gather them before moving them to the front of the arena.
+    m_nms_kept.clear();
+    for (int i = 0; i < kept_number; i++) {
+        m_nms_kept.push_back(m_results[keep[i]]);
+        m_nms_kept.back().score = scores[i];
     }
+    std::copy(m_nms_kept.begin(), m_nms_kept.end(), m_results.begin());
+    m_results.resize(kept_number);
 }
 
-std::list<result_t> &DetectPostprocessor::get_result(int width, int height)
+std::span<const result_t> DetectPostprocessor::get_result(int width, int height)
 {
-    for (result_t &res : m_box_list) {
+    for (result_t &res : m_results) {
         res.limit_box(width, height);
         res.limit_keypoint(width, height);
     }
-    return m_box_list;
+    return std::span<const result_t>(m_results.begin(), m_results.size());
 }
 } // namespace detect
 } // namespace dl
@@ -1,9 +1,11 @@
 #pragma once
+#include "dl_detect_candidate.hpp"
 #include "dl_detect_define.hpp"
+#include "dl_detect_nms.hpp"
 #include "dl_model_base.hpp"
 #include "dl_tensor_base.hpp"
-#include <list>
 #include <map>
+#include <span>
 
 namespace dl {
 namespace detect {
@@ -17,20 +19,43 @@ protected:
     float m_resize_scale_y;
     float m_top_left_x;
     float m_top_left_y;
-    std::list<result_t> m_box_list; /*<! Detected box list */
+    ResultArena m_results;        /*<! Detected boxes of the frame */
+    CandidateBuffer m_candidates; /*<! Scores above score_thr of the frame, decoded into m_results once sorted */
+    NMS m_nms;
+    std::vector<nms_box_t> m_nms_boxes; /*<! m_results laid out for m_nms */
+    std::vector<result_t> m_nms_kept;   /*<! results kept by m_nms, in its order */
 
 public:
     DetectPostprocessor(Model *model, const float score_thr, const float nms_thr, const int top_k) :
-        m_model(model), m_score_thr(score_thr), m_nms_thr(nms_thr), m_top_k(top_k) {};
+        m_model(model),
+        m_score_thr(score_thr),
+        m_nms_thr(nms_thr),
+        m_top_k(top_k),
+        m_results(DL_MAX(top_k, DL_DETECT_MAX_CANDIDATES)),
+        m_candidates(DL_MAX(top_k, DL_DETECT_MAX_CANDIDATES)),
+        m_nms({NMS_MODE_HARD, nms_thr, top_k, false, 0.5f, score_thr, NMS_GRID_AUTO}) {};
     virtual ~DetectPostprocessor() {};
     virtual void postprocess() = 0;
     void nms();
+    /**
+     * @brief Switch nms() to per-class or soft-NMS, or set the grid. It starts as hard NMS over every category with
+     * nms_thr and top_k, soft-NMS drops the boxes decaying below score_thr.
+     */
+    void set_nms_config(const nms_config_t &config) { m_nms.set_config(config); }
     void set_resize_scale_x(float resize_scale_x) { m_resize_scale_x = resize_scale_x; };
     void set_resize_scale_y(float resize_scale_y) { m_resize_scale_y = resize_scale_y; };
     void set_top_left_x(float top_left_x) { m_top_left_x = top_left_x; };
     void set_top_left_y(float top_left_y) { m_top_left_y = top_left_y; };
-    void clear_result() { m_box_list.clear(); };
-    std::list<result_t> &get_result(int width, int height);
+    void clear_result()
+    {
+        m_results.clear();
+        m_candidates.clear();
+    };
+    /**
+     * @brief The results of the frame, limited to the image. The span points into the arena of the postprocessor, it
+     * is valid until the next clear_result().
+     */
+    std::span<const result_t> get_result(int width, int height);
 };
 
 class AnchorPointDetectPostprocessor : public DetectPostprocessor {
@@ -1,91 +1,87 @@
 #include "dl_detect_yolo11_postprocessor.hpp"
 #include "dl_math.hpp"
-#include <algorithm>
-#include <cmath>
 
 namespace dl {
 namespace detect {
+yolo11PostProcessor::yolo11PostProcessor(Model *model,
+                                        const float score_thr,
+                                        const float nms_thr,
+                                        const int top_k,
+                                        const std::vector<anchor_point_stage_t> &stages) :
+    AnchorPointDetectPostprocessor(model, score_thr, nms_thr, top_k, stages),
+    m_score{model->resolve("490"), model->resolve("510"), model->resolve("530")},
+    m_bbox{model->resolve("output0"), model->resolve("497"), model->resolve("517")}
+{
+}
+
 template <typename T>
-void yolo11PostProcessor::parse_stage(TensorBase *score, TensorBase *box, const int stage_index)
+void yolo11PostProcessor::parse_stage(TensorBase *score, const int stage_index)
 {
-    int stride_y = m_stages[stage_index].stride_y;
-    int stride_x = m_stages[stage_index].stride_x;
+    int size = score->shape[1] * score->shape[2] * score->shape[3];
+    const T *score_ptr = (const T *)score->data;
+    const T *score_end = score_ptr + size;
+    float score_exp = DL_SCALE(score->exponent);
+    T score_thr_quant = quantize<T>(dl::math::inverse_sigmoid(m_score_thr), 1.f / score_exp);
 
-    int offset_y = m_stages[stage_index].offset_y;
-    int offset_x = m_stages[stage_index].offset_x;
+    for (const T *ptr = find_above(score_ptr, score_end, score_thr_quant); ptr != score_end;
+         ptr = find_above(ptr + 1, score_end, score_thr_quant)) {
+        m_candidates.push(dequantize(*ptr, score_exp), ptr - score_ptr, stage_index);
+    }
+}
 
-    int H = score->shape[1];
+template <typename T>
+result_t yolo11PostProcessor::decode(const candidate_t &candidate, TensorBase *score, TensorBase *box)
+{
+    const anchor_point_stage_t &stage = m_stages[candidate.stage];
+    const ExpTable &dfl = m_dfl[candidate.stage];
     int W = score->shape[2];
     int C = score->shape[3];
-
-    T *score_ptr = (T *)score->data;
-    T *box_ptr = (T *)box->data;
-    float score_exp = DL_SCALE(score->exponent);
-    float box_exp = DL_SCALE(box->exponent);
-    T score_thr_quant = quantize<T>(dl::math::inverse_sigmoid(m_score_thr), 1.f / score_exp);
+    int position = candidate.index / C;
+    int center_y = position / W * stage.stride_y + stage.offset_y;
+    int center_x = position % W * stage.stride_x + stage.offset_x;
+    int reg_max = 16;
+    const T *box_ptr = (const T *)box->data + position * 4 * reg_max;
     float inv_resize_scale_x = 1.f / m_resize_scale_x;
     float inv_resize_scale_y = 1.f / m_resize_scale_y;
 
-    int reg_max = 16;
-
-    for (size_t y = 0; y < H; y++) {
-        for (size_t x = 0; x < W; x++) {
-            for (size_t c = 0; c < C; c++) {
-                if (*score_ptr > score_thr_quant) {
-                    int center_y = y * stride_y + offset_y;
-                    int center_x = x * stride_x + offset_x;
-
-                    float box_data[reg_max * 4];
-                    for (int i = 0; i < reg_max * 4; i++) {
-                        box_data[i] = dequantize(box_ptr[i], box_exp);
-                    }
-
-                    result_t new_box = {
-                        (int)c,
-                        dl::math::sigmoid(dequantize(*score_ptr, score_exp)),
-                        {(int)((center_x - dl::math::dfl_integral(box_data, reg_max - 1) * stride_x) *
-                               inv_resize_scale_x),
-                         (int)((center_y - dl::math::dfl_integral(box_data + reg_max, reg_max - 1) * stride_y) *
-                               inv_resize_scale_y),
-                         (int)((center_x + dl::math::dfl_integral(box_data + 2 * reg_max, reg_max - 1) * stride_x) *
-                               inv_resize_scale_x),
-                         (int)((center_y + dl::math::dfl_integral(box_data + 3 * reg_max, reg_max - 1) * stride_y) *
-                               inv_resize_scale_y)},
-                        {}};
-
-                    m_box_list.insert(std::upper_bound(m_box_list.begin(), m_box_list.end(), new_box, greater_box),
-                                      new_box);
-                }
-                score_ptr++;
-            }
-
-            box_ptr += 4 * reg_max;
-        }
-    }
+    return {
+        (int)(candidate.index % C),
+        candidate.score,
+        {(int)((center_x - dfl.dfl_integral(box_ptr, reg_max) * stage.stride_x) * inv_resize_scale_x),
+         (int)((center_y - dfl.dfl_integral(box_ptr + reg_max, reg_max) * stage.stride_y) * inv_resize_scale_y),
+         (int)((center_x + dfl.dfl_integral(box_ptr + 2 * reg_max, reg_max) * stage.stride_x) * inv_resize_scale_x),
+         (int)((center_y + dfl.dfl_integral(box_ptr + 3 * reg_max, reg_max) * stage.stride_y) * inv_resize_scale_y)},
+        {},
+        0};
 }
 
-template void yolo11PostProcessor::parse_stage<int8_t>(TensorBase *score, TensorBase *box, const int stage_index);
-template void yolo11PostProcessor::parse_stage<int16_t>(TensorBase *score, TensorBase *box, const int stage_index);
-
 void yolo11PostProcessor::postprocess()
 {
-    TensorBase *bbox0 = m_model->get_intermediate("output0");
-    TensorBase *score0 = m_model->get_intermediate("490");
-
-    TensorBase *bbox1 = m_model->get_intermediate("497");
-    TensorBase *score1 = m_model->get_intermediate("510");
-
-    TensorBase *bbox2 = m_model->get_intermediate("517");
-    TensorBase *score2 = m_model->get_intermediate("530");
+    TensorBase *score[3];
+    TensorBase *bbox[3];
+    for (int i = 0; i < 3; i++) {
+        score[i] = m_model->get_tensor(m_score[i]);
+        bbox[i] = m_model->get_tensor(m_bbox[i]);
+        m_dfl[i].set_exponent(bbox[i]->exponent);
+    }
 
-    if (bbox0->dtype == DATA_TYPE_INT8) {
-        parse_stage<int8_t>(score0, bbox0, 0);
-        parse_stage<int8_t>(score1, bbox1, 1);
-        parse_stage<int8_t>(score2, bbox2, 2);
-    } else {
-        parse_stage<int16_t>(score0, bbox0, 0);
-        parse_stage<int16_t>(score1, bbox1, 1);
-        parse_stage<int16_t>(score2, bbox2, 2);
+    bool int8 = bbox[0]->dtype == DATA_TYPE_INT8;
+    for (int i = 0; i < 3; i++) {
+        if (int8) {
+            parse_stage<int8_t>(score[i], i);
+        } else {
+            parse_stage<int16_t>(score[i], i);
+        }
+    }
+    for (candidate_t &candidate : m_candidates) {
+        candidate.score = dl::math::sigmoid(candidate.score);
+    }
+    m_candidates.sort();
+    for (const candidate_t &candidate : m_candidates) {
+        TensorBase *candidate_score = score[candidate.stage];
+        TensorBase *candidate_box = bbox[candidate.stage];
+        m_results.push_back(int8 ? decode<int8_t>(candidate, candidate_score, candidate_box)
+                                  : decode<int16_t>(candidate, candidate_score, candidate_box));
     }
     nms();
 }
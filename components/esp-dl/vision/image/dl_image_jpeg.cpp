@@ -1,17 +1,66 @@
 #include "dl_image_jpeg.hpp"
+#include <algorithm>
+#include <cstring>
+#if DL_IMAGE_JPEG_STREAM_SUPPORTED
+#include "rom/tjpgd.h"
+#endif
 
 static const char *TAG = "dl_image_jpeg";
 namespace dl {
 namespace image {
 #if CONFIG_IDF_TARGET_ESP32S3 || CONFIG_IDF_TARGET_ESP32P4
+esp_jpeg_image_scale_t get_jpeg_scale(const jpeg_img_t &jpeg_img, int dst_width, int dst_height)
+{
+    const esp_jpeg_image_scale_t scales[] = {JPEG_IMAGE_SCALE_1_8, JPEG_IMAGE_SCALE_1_4, JPEG_IMAGE_SCALE_1_2};
+    for (esp_jpeg_image_scale_t scale : scales) {
+        int width, height;
+        get_jpeg_decoded_shape(jpeg_img, scale, width, height);
+        if (width >= dst_width && height >= dst_height) {
+            return scale;
+        }
+    }
+    return JPEG_IMAGE_SCALE_0;
+}
+
+void get_jpeg_decoded_shape(const jpeg_img_t &jpeg_img, esp_jpeg_image_scale_t scale, int &width, int &height)
+{
+    int shift = get_jpeg_scale_shift(scale);
+    width = jpeg_img.width >> shift;
+    height = jpeg_img.height >> shift;
+}
+
 // software decode
 esp_err_t sw_decode_jpeg(const jpeg_img_t &jpeg_img,
                          img_t &decoded_img,
                          bool swap_color_bytes,
                          esp_jpeg_image_scale_t scale)
 {
-    uint32_t outbuf_size = jpeg_img.height * jpeg_img.width * 3;
-    uint8_t *outbuf = (uint8_t *)heap_caps_malloc(outbuf_size, MALLOC_CAP_SPIRAM);
+    if (!(decoded_img.pix_type == DL_IMAGE_PIX_TYPE_RGB565 || decoded_img.pix_type == DL_IMAGE_PIX_TYPE_RGB888)) {
+        ESP_LOGE(TAG, "Unsupported img pix format.");
+        return ESP_FAIL;
+    }
+    img_t shape_img = decoded_img;
+    get_jpeg_decoded_shape(jpeg_img, scale, shape_img.width, shape_img.height);
+    size_t outbuf_size = get_img_byte_size(shape_img);
+    void *outbuf = heap_caps_malloc(outbuf_size, MALLOC_CAP_SPIRAM);
+    if (!outbuf) {
+        ESP_LOGE(TAG, "Failed to allocate memory for jpeg decoder output.");
+        return ESP_FAIL;
+    }
+    esp_err_t ret = sw_decode_jpeg(jpeg_img, decoded_img, outbuf, outbuf_size, swap_color_bytes, scale);
+    if (ret != ESP_OK) {
+        heap_caps_free(outbuf);
+    }
+    return ret;
+}
+
+esp_err_t sw_decode_jpeg(const jpeg_img_t &jpeg_img,
+                         img_t &decoded_img,
+                         void *outbuf,
+                         size_t outbuf_size,
+                         bool swap_color_bytes,
+                         esp_jpeg_image_scale_t scale)
+{
     if (!(decoded_img.pix_type == DL_IMAGE_PIX_TYPE_RGB565 || decoded_img.pix_type == DL_IMAGE_PIX_TYPE_RGB888)) {
         ESP_LOGE(TAG, "Unsupported img pix format.");
         return ESP_FAIL;
@@ -26,7 +75,7 @@ esp_err_t sw_decode_jpeg(const jpeg_img_t &jpeg_img,
     // JPEG decode config
     esp_jpeg_image_cfg_t jpeg_cfg = {.indata = jpeg_img.data,
                                      .indata_size = jpeg_img.data_size,
-                                     .outbuf = outbuf,
+                                     .outbuf = (uint8_t *)outbuf,
                                      .outbuf_size = outbuf_size,
                                      .out_format = out_format,
                                      .out_scale = scale,
@@ -39,10 +88,320 @@ esp_err_t sw_decode_jpeg(const jpeg_img_t &jpeg_img,
 
     esp_jpeg_image_output_t outimg;
     ESP_RETURN_ON_ERROR(esp_jpeg_decode(&jpeg_cfg, &outimg), TAG, "Failed to decode img.");
-    assert(outimg.height == jpeg_img.height && outimg.width == jpeg_img.width);
-    decoded_img.data = (void *)outbuf;
-    decoded_img.height = jpeg_img.height;
-    decoded_img.width = jpeg_img.width;
+    decoded_img.data = outbuf;
+    decoded_img.height = outimg.height;
+    decoded_img.width = outimg.width;
+    return ESP_OK;
+}
+#endif
+#if DL_IMAGE_JPEG_STREAM_SUPPORTED
+// tjpgd needs about 3100 bytes of work area for baseline jpeg
+#define DL_IMAGE_JPEG_STREAM_WORK_BUF_SIZE (3100)
+// fixed point bits of the bilinear weights
+#define DL_IMAGE_JPEG_STREAM_WEIGHT_BITS (11)
+
+/**
+ * @brief Receives the MCU rects of tjpgd in raster order, keeps one MCU band plus the last row of the previous band,
+ * and emits every dst row as soon as the source rows it depends on have been decoded.
+ */
+class JpegBandResizer {
+public:
+    JpegBandResizer(img_t &dst_img,
+                    int src_width,
+                    int src_height,
+                    int band_height,
+                    interpolate_type_t interpolate_type,
+                    void *norm_lut,
+                    uint32_t caps,
+                    bool swap_rb) :
+        m_dst(dst_img),
+        m_src_width(src_width),
+        m_src_height(src_height),
+        m_band_height(band_height),
+        m_bilinear(interpolate_type == DL_IMAGE_INTERPOLATE_BILINEAR),
+        m_norm_lut(norm_lut),
+        m_scale_y_inv((float)src_height / dst_img.height),
+        m_band_top(0),
+        m_prev_y(-1),
+        m_next_row(0),
+        m_band(nullptr),
+        m_prev_row(nullptr),
+        m_x_offset(nullptr),
+        m_x_weight(nullptr)
+    {
+        // dst channel c reads decoded channel k, which tjpgd delivers at src_channel[c]
+        for (int c = 0; c < 3; c++) {
+            int k = (caps & DL_IMAGE_CAP_RGB_SWAP) ? 2 - c : c;
+            m_src_channel[c] = swap_rb ? 2 - k : k;
+        }
+    }
+
+    ~JpegBandResizer()
+    {
+        heap_caps_free(m_band);
+        heap_caps_free(m_prev_row);
+        heap_caps_free(m_x_offset);
+        heap_caps_free(m_x_weight);
+    }
+
+    esp_err_t init()
+    {
+        size_t row_size = m_src_width * 3;
+        m_band = (uint8_t *)heap_caps_malloc(row_size * m_band_height, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        m_prev_row = (uint8_t *)heap_caps_malloc(row_size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        m_x_offset = (int *)heap_caps_malloc(m_dst.width * 2 * sizeof(int), MALLOC_CAP_INTERNAL);
+        m_x_weight = (uint16_t *)heap_caps_malloc(m_dst.width * sizeof(uint16_t), MALLOC_CAP_INTERNAL);
+        if (!m_band || !m_prev_row || !m_x_offset || !m_x_weight) {
+            return ESP_ERR_NO_MEM;
+        }
+        // same coordinate mapping as resize_loop()
+        float scale_x_inv = (float)m_src_width / m_dst.width;
+        for (int j = 0; j < m_dst.width; j++) {
+            float x = std::max(std::min((j + 0.5f) * scale_x_inv - 0.5f, (float)(m_src_width - 1)), 0.f);
+            int x1, x2;
+            if (m_bilinear) {
+                x1 = (int)x;
+                x2 = std::min(x1 + 1, m_src_width - 1);
+                m_x_weight[j] = (uint16_t)((x - x1) * (1 << DL_IMAGE_JPEG_STREAM_WEIGHT_BITS) + 0.5f);
+            } else {
+                x1 = x2 = (int)(x + 0.5f);
+                m_x_weight[j] = 0;
+            }
+            m_x_offset[2 * j] = x1 * 3;
+            m_x_offset[2 * j + 1] = x2 * 3;
+        }
+        return ESP_OK;
+    }
+
+    void push(const uint8_t *rgb, const JRECT *rect)
+    {
+        if (rect->left == 0) {
+            m_band_top = rect->top;
+        }
+        int width = rect->right - rect->left + 1;
+        int height = rect->bottom - rect->top + 1;
+        if (rect->right >= m_src_width || rect->bottom - m_band_top >= m_band_height) {
+            return;
+        }
+        size_t row_size = m_src_width * 3;
+        uint8_t *band_ptr = m_band + (rect->top - m_band_top) * row_size + rect->left * 3;
+        for (int i = 0; i < height; i++) {
+            memcpy(band_ptr, rgb, width * 3);
+            band_ptr += row_size;
+            rgb += width * 3;
+        }
+        if (rect->right == m_src_width - 1) {
+            flush(rect->bottom);
+        }
+    }
+
+    /**
+     * @brief Emit the dst rows left when the decoder delivered fewer source rows than announced.
+     */
+    void finish()
+    {
+        if (m_prev_y < 0) {
+            return;
+        }
+        for (; m_next_row < m_dst.height; m_next_row++) {
+            write_row(m_next_row, m_prev_row, m_prev_row, 0);
+        }
+    }
+
+private:
+    void get_src_rows(int i, int &y1, int &y2, uint32_t &wy)
+    {
+        float y = std::max(std::min((i + 0.5f) * m_scale_y_inv - 0.5f, (float)(m_src_height - 1)), 0.f);
+        if (m_bilinear) {
+            y1 = (int)y;
+            y2 = std::min(y1 + 1, m_src_height - 1);
+            wy = (uint32_t)((y - y1) * (1 << DL_IMAGE_JPEG_STREAM_WEIGHT_BITS) + 0.5f);
+        } else {
+            y1 = y2 = (int)(y + 0.5f);
+            wy = 0;
+        }
+    }
+
+    const uint8_t *get_src_row(int y)
+    {
+        return (y == m_prev_y) ? m_prev_row : m_band + (y - m_band_top) * m_src_width * 3;
+    }
+
+    void flush(int band_bottom)
+    {
+        while (m_next_row < m_dst.height) {
+            int y1, y2;
+            uint32_t wy;
+            get_src_rows(m_next_row, y1, y2, wy);
+            if (y2 > band_bottom) {
+                break;
+            }
+            write_row(m_next_row, get_src_row(y1), get_src_row(y2), wy);
+            m_next_row++;
+        }
+        // bilinear rows may straddle two bands, keep the last row of this one
+        memcpy(m_prev_row, get_src_row(band_bottom), m_src_width * 3);
+        m_prev_y = band_bottom;
+    }
+
+    void write_row(int i, const uint8_t *row1, const uint8_t *row2, uint32_t wy)
+    {
+        switch (m_dst.pix_type) {
+        case DL_IMAGE_PIX_TYPE_RGB888:
+            write_row((uint8_t *)m_dst.data + i * m_dst.width * 3, row1, row2, wy);
+            break;
+        case DL_IMAGE_PIX_TYPE_RGB888_QINT8:
+            write_row((int8_t *)m_dst.data + i * m_dst.width * 3, row1, row2, wy);
+            break;
+        case DL_IMAGE_PIX_TYPE_RGB888_QINT16:
+            write_row((int16_t *)m_dst.data + i * m_dst.width * 3, row1, row2, wy);
+            break;
+        default:
+            break;
+        }
+    }
+
+    template <typename T>
+    void write_row(T *dst_ptr, const uint8_t *row1, const uint8_t *row2, uint32_t wy)
+    {
+        const T *lut = (const T *)m_norm_lut;
+        const uint32_t one = 1 << DL_IMAGE_JPEG_STREAM_WEIGHT_BITS;
+        const uint32_t half = 1 << (2 * DL_IMAGE_JPEG_STREAM_WEIGHT_BITS - 1);
+        for (int j = 0; j < m_dst.width; j++, dst_ptr += 3) {
+            const uint8_t *q1 = row1 + m_x_offset[2 * j];
+            uint8_t pix[3];
+            if (m_bilinear) {
+                const uint8_t *q2 = row1 + m_x_offset[2 * j + 1];
+                const uint8_t *q3 = row2 + m_x_offset[2 * j];
+                const uint8_t *q4 = row2 + m_x_offset[2 * j + 1];
+                uint32_t wx = m_x_weight[j];
+                uint32_t a = (one - wx) * (one - wy), b = wx * (one - wy), c = (one - wx) * wy, d = wx * wy;
+                for (int k = 0; k < 3; k++) {
+                    pix[k] = (uint8_t)((a * q1[k] + b * q2[k] + c * q3[k] + d * q4[k] + half) >>
+                                       (2 * DL_IMAGE_JPEG_STREAM_WEIGHT_BITS));
+                }
+            } else {
+                pix[0] = q1[0];
+                pix[1] = q1[1];
+                pix[2] = q1[2];
+            }
+            if (lut) {
+                dst_ptr[0] = lut[pix[m_src_channel[0]]];
+                dst_ptr[1] = lut[256 + pix[m_src_channel[1]]];
+                dst_ptr[2] = lut[512 + pix[m_src_channel[2]]];
+            } else {
+                dst_ptr[0] = pix[m_src_channel[0]];
+                dst_ptr[1] = pix[m_src_channel[1]];
+                dst_ptr[2] = pix[m_src_channel[2]];
+            }
+        }
+    }
+
+    img_t &m_dst;
+    int m_src_width;
+    int m_src_height;
+    int m_band_height;
+    bool m_bilinear;
+    void *m_norm_lut;
+    float m_scale_y_inv;
+    int m_src_channel[3];
+    int m_band_top;        /*<! first source row held in m_band */
+    int m_prev_y;          /*<! source row held in m_prev_row, -1 if none */
+    int m_next_row;        /*<! next dst row to emit */
+    uint8_t *m_band;       /*<! one MCU band of decoded RGB888 */
+    uint8_t *m_prev_row;   /*<! last row of the previous band */
+    int *m_x_offset;       /*<! byte offsets of the two source columns of every dst column */
+    uint16_t *m_x_weight;  /*<! fixed point weight of the right source column */
+};
+
+typedef struct {
+    const uint8_t *data;
+    uint32_t data_size;
+    uint32_t pos;
+    JpegBandResizer *resizer;
+} jpeg_stream_ctx_t;
+
+// The ROM tjpgd callbacks take and return UINT, which is unsigned int and not uint32_t on Xtensa.
+static unsigned int jpeg_stream_input(JDEC *jd, uint8_t *buf, unsigned int len)
+{
+    jpeg_stream_ctx_t *ctx = (jpeg_stream_ctx_t *)jd->device;
+    len = std::min<unsigned int>(len, ctx->data_size - ctx->pos);
+    if (buf) {
+        memcpy(buf, ctx->data + ctx->pos, len);
+    }
+    ctx->pos += len;
+    return len;
+}
+
+static unsigned int jpeg_stream_output(JDEC *jd, void *bitmap, JRECT *rect)
+{
+    jpeg_stream_ctx_t *ctx = (jpeg_stream_ctx_t *)jd->device;
+    ctx->resizer->push((const uint8_t *)bitmap, rect);
+    return 1;
+}
+
+esp_err_t sw_decode_jpeg_stream(const jpeg_img_t &jpeg_img,
+                                img_t &dst_img,
+                                interpolate_type_t interpolate_type,
+                                void *norm_lut,
+                                uint32_t caps,
+                                bool swap_color_bytes,
+                                esp_jpeg_image_scale_t scale,
+                                float *scale_x_ret,
+                                float *scale_y_ret)
+{
+    if (!(dst_img.pix_type == DL_IMAGE_PIX_TYPE_RGB888 || dst_img.pix_type == DL_IMAGE_PIX_TYPE_RGB888_QINT8 ||
+          dst_img.pix_type == DL_IMAGE_PIX_TYPE_RGB888_QINT16)) {
+        ESP_LOGE(TAG, "Unsupported img pix format.");
+        return ESP_FAIL;
+    }
+    if (DL_IMAGE_IS_PIX_TYPE_QUANT(dst_img.pix_type) && !norm_lut) {
+        ESP_LOGE(TAG, "Quant img needs a norm lut.");
+        return ESP_FAIL;
+    }
+
+    void *work_buf = heap_caps_malloc(DL_IMAGE_JPEG_STREAM_WORK_BUF_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!work_buf) {
+        ESP_LOGE(TAG, "Failed to allocate jpeg decoder work buffer.");
+        return ESP_ERR_NO_MEM;
+    }
+    jpeg_stream_ctx_t ctx = {.data = jpeg_img.data, .data_size = jpeg_img.data_size, .pos = 0, .resizer = nullptr};
+    JDEC jd;
+    JRESULT res = jd_prepare(&jd, jpeg_stream_input, work_buf, DL_IMAGE_JPEG_STREAM_WORK_BUF_SIZE, &ctx);
+    if (res != JDR_OK) {
+        heap_caps_free(work_buf);
+        ESP_LOGE(TAG, "Failed to parse jpeg header, %d.", res);
+        return ESP_FAIL;
+    }
+
+    int shift = get_jpeg_scale_shift(scale);
+    int src_width = jd.width >> shift;
+    int src_height = jd.height >> shift;
+    int band_height = std::max((jd.msy * 8) >> shift, 1);
+    // tjpgd emits RGB, sw_decode_jpeg() swaps to BGR for RGB888 unless asked otherwise
+    JpegBandResizer resizer(
+        dst_img, src_width, src_height, band_height, interpolate_type, norm_lut, caps, !swap_color_bytes);
+    esp_err_t ret = resizer.init();
+    if (ret != ESP_OK) {
+        heap_caps_free(work_buf);
+        ESP_LOGE(TAG, "Failed to allocate jpeg band buffer.");
+        return ret;
+    }
+    ctx.resizer = &resizer;
+    res = jd_decomp(&jd, jpeg_stream_output, (uint8_t)shift);
+    heap_caps_free(work_buf);
+    if (res != JDR_OK) {
+        ESP_LOGE(TAG, "Failed to decode img, %d.", res);
+        return ESP_FAIL;
+    }
+    resizer.finish();
+
+    if (scale_x_ret) {
+        *scale_x_ret = (float)dst_img.width / jd.width;
+    }
+    if (scale_y_ret) {
+        *scale_y_ret = (float)dst_img.height / jd.height;
+    }
     return ESP_OK;
 }
 #endif
@@ -7,6 +7,12 @@
 #if CONFIG_IDF_TARGET_ESP32S3 || CONFIG_IDF_TARGET_ESP32P4
 #include "jpeg_decoder.h"
 #endif
+// The streaming decoder drives tjpgd directly, which is only public API when esp_jpeg runs the ROM decoder.
+#if (CONFIG_IDF_TARGET_ESP32S3 || CONFIG_IDF_TARGET_ESP32P4) && CONFIG_JD_USE_ROM
+#define DL_IMAGE_JPEG_STREAM_SUPPORTED 1
+#else
+#define DL_IMAGE_JPEG_STREAM_SUPPORTED 0
+#endif
 #if CONFIG_IDF_TARGET_ESP32P4
 #include "driver/jpeg_decode.h"
 #include "driver/jpeg_encode.h"
@@ -19,6 +25,66 @@ esp_err_t sw_decode_jpeg(const jpeg_img_t &jpeg_img,
                          img_t &decoded_img,
                          bool swap_color_bytes = false,
                          esp_jpeg_image_scale_t scale = JPEG_IMAGE_SCALE_0);
+/**
+ * @brief Software decode into a caller owned buffer, no allocation.
+ *
+ * @param outbuf       Output buffer, at least get_jpeg_decoded_size() bytes.
+ * @param outbuf_size  Size of outbuf, in bytes.
+ */
+esp_err_t sw_decode_jpeg(const jpeg_img_t &jpeg_img,
+                         img_t &decoded_img,
+                         void *outbuf,
+                         size_t outbuf_size,
+                         bool swap_color_bytes = false,
+                         esp_jpeg_image_scale_t scale = JPEG_IMAGE_SCALE_0);
+inline int get_jpeg_scale_shift(esp_jpeg_image_scale_t scale)
+{
+    switch (scale) {
+    case JPEG_IMAGE_SCALE_1_2:
+        return 1;
+    case JPEG_IMAGE_SCALE_1_4:
+        return 2;
+    case JPEG_IMAGE_SCALE_1_8:
+        return 3;
+    default:
+        return 0;
+    }
+}
+/**
+ * @brief Pick the strongest decoder downscale which still keeps the decoded img at least dst_width x dst_height,
+ * so the following resize only ever shrinks the img.
+ */
+esp_jpeg_image_scale_t get_jpeg_scale(const jpeg_img_t &jpeg_img, int dst_width, int dst_height);
+/**
+ * @brief Width and height of the jpeg img after decoding with the given scale.
+ */
+void get_jpeg_decoded_shape(const jpeg_img_t &jpeg_img, esp_jpeg_image_scale_t scale, int &width, int &height);
+#endif
+#if DL_IMAGE_JPEG_STREAM_SUPPORTED
+/**
+ * @brief Streaming software decode. Every MCU band produced by the decoder is resized, normalized and quantized into
+ * dst_img right away, so only a few MCU rows of RGB888 are ever held in memory.
+ *
+ * @param jpeg_img          Input jpeg img.
+ * @param dst_img           Output img, RGB888, RGB888_QINT8 or RGB888_QINT16. dst_img.data must be allocated.
+ * @param interpolate_type  Nearest or bilinear.
+ * @param norm_lut          Normalize and quantize lut of ImagePreprocessor, 3 * 256 entries. Required for quant
+ *                          dst_img, ignored otherwise.
+ * @param caps              DL_IMAGE_CAP_RGB_SWAP is supported.
+ * @param swap_color_bytes  Same meaning as in sw_decode_jpeg().
+ * @param scale             Decoder downscale applied before resizing.
+ * @param scale_x_ret       dst_img.width / jpeg_img.width.
+ * @param scale_y_ret       dst_img.height / jpeg_img.height.
+ */
+esp_err_t sw_decode_jpeg_stream(const jpeg_img_t &jpeg_img,
+                                img_t &dst_img,
+                                interpolate_type_t interpolate_type,
+                                void *norm_lut,
+                                uint32_t caps = 0,
+                                bool swap_color_bytes = false,
+                                esp_jpeg_image_scale_t scale = JPEG_IMAGE_SCALE_0,
+                                float *scale_x_ret = nullptr,
+                                float *scale_y_ret = nullptr);
 #endif
 #if CONFIG_IDF_TARGET_ESP32P4
 esp_err_t hw_decode_jpeg(const jpeg_img_t &jpeg_img, img_t &decoded_img, bool swap_color_bytes = false);
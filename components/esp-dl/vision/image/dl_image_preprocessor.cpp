@@ -8,8 +8,12 @@ ImagePreprocessor::ImagePreprocessor(Model *model,
                                      const std::vector<float> &std,
                                      uint32_t caps,
                                      const std::string &input_name) :
-    m_mean(mean), m_std(std), m_caps(caps)
+    m_mean(mean), m_std(std), m_caps(caps), m_interpolate_type(DL_IMAGE_INTERPOLATE_NEAREST)
 {
+#if CONFIG_IDF_TARGET_ESP32S3 || CONFIG_IDF_TARGET_ESP32P4
+    m_jpeg_buffer = nullptr;
+    m_jpeg_buffer_size = 0;
+#endif
     if (input_name.empty()) {
         std::map<std::string, dl::TensorBase *> model_inputs_map = model->get_inputs();
         assert(model_inputs_map.size() == 1);
@@ -51,6 +55,12 @@ ImagePreprocessor::~ImagePreprocessor()
         heap_caps_free(m_norm_lut);
         m_norm_lut = nullptr;
     }
+#if CONFIG_IDF_TARGET_ESP32S3 || CONFIG_IDF_TARGET_ESP32P4
+    if (m_jpeg_buffer) {
+        heap_caps_free(m_jpeg_buffer);
+        m_jpeg_buffer = nullptr;
+    }
+#endif
 #if CONFIG_IDF_TARGET_ESP32P4
     if (m_caps & DL_IMAGE_CAP_PPA) {
         if (m_ppa_buffer) {
@@ -102,7 +112,7 @@ void ImagePreprocessor::preprocess(const img_t &img, const std::vector<int> &cro
                    &m_resize_scale_y) == ESP_FAIL) {
         resize(img,
                m_output,
-               DL_IMAGE_INTERPOLATE_NEAREST,
+               m_interpolate_type,
                m_caps,
                m_norm_lut,
                crop_area,
@@ -112,7 +122,7 @@ void ImagePreprocessor::preprocess(const img_t &img, const std::vector<int> &cro
 #else
     resize(img,
            m_output,
-           DL_IMAGE_INTERPOLATE_NEAREST,
+           m_interpolate_type,
            m_caps,
            m_norm_lut,
            crop_area,
@@ -124,7 +134,77 @@ void ImagePreprocessor::preprocess(const img_t &img, const std::vector<int> &cro
 void ImagePreprocessor::preprocess(const img_t &img, dl::math::Matrix<float> *M_inv)
 {
     assert(get_img_channel(img) == m_mean.size());
-    warp_affine(img, m_output, DL_IMAGE_INTERPOLATE_NEAREST, M_inv, m_caps, m_norm_lut);
+    warp_affine(img, m_output, m_interpolate_type, M_inv, m_caps, m_norm_lut);
+}
+
+#if CONFIG_IDF_TARGET_ESP32S3 || CONFIG_IDF_TARGET_ESP32P4
+esp_err_t ImagePreprocessor::preprocess(const jpeg_img_t &jpeg_img,
+                                        bool swap_color_bytes,
+                                        const std::vector<int> &crop_area)
+{
+    int dst_width = m_output.width;
+    int dst_height = m_output.height;
+    if (!crop_area.empty()) {
+        assert(crop_area.size() == 4);
+        // The crop area is resized to the model input, so the decoded crop must still cover it.
+        dst_width = DL_MAX(1, m_output.width * jpeg_img.width / (crop_area[2] - crop_area[0]));
+        dst_height = DL_MAX(1, m_output.height * jpeg_img.height / (crop_area[3] - crop_area[1]));
+    }
+    esp_jpeg_image_scale_t scale = get_jpeg_scale(jpeg_img, dst_width, dst_height);
+    int shift = get_jpeg_scale_shift(scale);
+
+#if DL_IMAGE_JPEG_STREAM_SUPPORTED
+    if (crop_area.empty()) {
+        m_crop_area = crop_area;
+        ESP_RETURN_ON_ERROR(sw_decode_jpeg_stream(jpeg_img,
+                                                  m_output,
+                                                  m_interpolate_type,
+                                                  m_norm_lut,
+                                                  m_caps,
+                                                  swap_color_bytes,
+                                                  scale,
+                                                  &m_resize_scale_x,
+                                                  &m_resize_scale_y),
+                            "ImagePreprocessor",
+                            "Failed to decode jpeg img.");
+        return ESP_OK;
+    }
+#endif
+
+    img_t decoded_img = {.data = nullptr, .width = 0, .height = 0, .pix_type = DL_IMAGE_PIX_TYPE_RGB888};
+    get_jpeg_decoded_shape(jpeg_img, scale, decoded_img.width, decoded_img.height);
+    size_t decoded_size = get_img_byte_size(decoded_img);
+    if (decoded_size > m_jpeg_buffer_size) {
+        if (m_jpeg_buffer) {
+            heap_caps_free(m_jpeg_buffer);
+        }
+        m_jpeg_buffer = heap_caps_malloc(decoded_size, MALLOC_CAP_SPIRAM);
+        m_jpeg_buffer_size = m_jpeg_buffer ? decoded_size : 0;
+        if (!m_jpeg_buffer) {
+            ESP_LOGE("ImagePreprocessor", "Failed to allocate jpeg decode buffer.");
+            return ESP_FAIL;
+        }
+    }
+    ESP_RETURN_ON_ERROR(
+        sw_decode_jpeg(jpeg_img, decoded_img, m_jpeg_buffer, m_jpeg_buffer_size, swap_color_bytes, scale),
+        "ImagePreprocessor",
+        "Failed to decode jpeg img.");
+
+    if (crop_area.empty()) {
+        preprocess(decoded_img);
+    } else {
+        std::vector<int> decoded_crop_area = {crop_area[0] >> shift,
+                                              crop_area[1] >> shift,
+                                              DL_MIN(decoded_img.width, crop_area[2] >> shift),
+                                              DL_MIN(decoded_img.height, crop_area[3] >> shift)};
+        preprocess(decoded_img, decoded_crop_area);
+        m_crop_area = crop_area;
+    }
+    // Report scales against the jpeg img, so postprocess maps boxes back to the original resolution.
+    m_resize_scale_x = m_resize_scale_x / (1 << shift);
+    m_resize_scale_y = m_resize_scale_y / (1 << shift);
+    return ESP_OK;
 }
+#endif
 } // namespace image
 } // namespace dl
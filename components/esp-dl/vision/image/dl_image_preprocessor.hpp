@@ -2,6 +2,7 @@
 
 #include "cmath"
 #include "dl_image.hpp"
+#include "dl_image_jpeg.hpp"
 #include "dl_model_base.hpp"
 #include "dl_tensor_base.hpp"
 #include "esp_cache.h"
@@ -26,7 +27,12 @@ private:
     std::vector<int> m_crop_area;
     float m_resize_scale_x;
     float m_resize_scale_y;
+    interpolate_type_t m_interpolate_type;
     img_t m_output;
+#if CONFIG_IDF_TARGET_ESP32S3 || CONFIG_IDF_TARGET_ESP32P4
+    void *m_jpeg_buffer;
+    size_t m_jpeg_buffer_size;
+#endif
 #if CONFIG_IDF_TARGET_ESP32P4
     ppa_client_handle_t m_ppa_srm_handle;
     size_t m_ppa_buffer_size;
@@ -48,10 +54,29 @@ public:
     float get_resize_scale_y() { return m_resize_scale_y; };
     float get_top_left_x() { return m_crop_area[0]; };
     float get_top_left_y() { return m_crop_area[1]; };
+    int get_model_input_width() { return m_output.width; };
+    int get_model_input_height() { return m_output.height; };
+    interpolate_type_t get_interpolate_type() { return m_interpolate_type; };
+    /**
+     * @brief Interpolation of every resize into the model input, the streamed jpeg decode included. Nearest by
+     * default, bilinear costs four pixel reads per output pixel.
+     */
+    void set_interpolate_type(interpolate_type_t interpolate_type) { m_interpolate_type = interpolate_type; };
 
     void preprocess(const img_t &img, const std::vector<int> &crop_area = {});
     void preprocess(const img_t &img, uint16_t rescaled_w, uint16_t rescaled_h, const std::vector<int> &crop_area = {});
     void preprocess(const img_t &img, dl::math::Matrix<float> *M_inv);
+#if CONFIG_IDF_TARGET_ESP32S3 || CONFIG_IDF_TARGET_ESP32P4
+    /**
+     * @brief jpeg decode at the smallest decoder scale that still covers the model input, then resize, normalize
+     * and quantize into the model input. Without crop area and with the ROM decoder, every MCU band is resized
+     * straight into the model input and only a few decoded rows are held at a time. Otherwise the decoded img lives
+     * in a buffer reused across calls. Resize scales and crop area are in the jpeg img coordinates.
+     */
+    esp_err_t preprocess(const jpeg_img_t &jpeg_img,
+                         bool swap_color_bytes = false,
+                         const std::vector<int> &crop_area = {});
+#endif
 };
 
 } // namespace image
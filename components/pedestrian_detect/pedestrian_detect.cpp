@@ -6,16 +6,50 @@ static const char *path = (const char *)pedestrian_detect_espdl;
 #elif CONFIG_PEDESTRIAN_DETECT_MODEL_IN_FLASH_PARTITION
 static const char *path = "pedestrian_det";
 #endif
+#if CONFIG_PEDESTRIAN_DETECT_COMPILED_MODEL
+extern const dl::compiled_model_t pedestrian_detect_pico_s8_v1_compiled;
+#endif
 namespace pedestrian_detect {
 
 Pico::Pico(const char *model_name)
 {
-#if !CONFIG_PEDESTRIAN_DETECT_MODEL_IN_SDCARD
-    m_model = new dl::Model(
-        path, model_name, static_cast<fbs::model_location_type_t>(CONFIG_PEDESTRIAN_DETECT_MODEL_LOCATION));
+#if CONFIG_PEDESTRIAN_DETECT_INTERNAL_RAM_AUTO
+    int internal_size = DL_INTERNAL_SIZE_AUTO;
+    dl::memory_manager_t mm_type = dl::LINEAR_MEMORY_MANAGER;
+#else
+    int internal_size = 0;
+    dl::memory_manager_t mm_type = dl::MEMORY_MANAGER_GREEDY;
+#endif
+#if CONFIG_PEDESTRIAN_DETECT_PARAM_IN_PLACE || CONFIG_PEDESTRIAN_DETECT_PARAM_LAZY_COPY
+    bool param_copy = false;
 #else
-    m_model =
-        new dl::Model(model_name, static_cast<fbs::model_location_type_t>(CONFIG_PEDESTRIAN_DETECT_MODEL_LOCATION));
+    bool param_copy = true;
+#endif
+#if CONFIG_PEDESTRIAN_DETECT_COMPILED_MODEL
+    // Planned at build time, see CONFIG_PEDESTRIAN_DETECT_COMPILED_INTERNAL_SIZE.
+    (void)internal_size;
+    (void)mm_type;
+    m_model = new dl::Model(&pedestrian_detect_pico_s8_v1_compiled, path, param_copy);
+#elif !CONFIG_PEDESTRIAN_DETECT_MODEL_IN_SDCARD
+    m_model = new dl::Model(path,
+                            model_name,
+                            static_cast<fbs::model_location_type_t>(CONFIG_PEDESTRIAN_DETECT_MODEL_LOCATION),
+                            internal_size,
+                            mm_type,
+                            nullptr,
+                            param_copy);
+#else
+    (void)param_copy;
+    m_model = new dl::Model(model_name,
+                            static_cast<fbs::model_location_type_t>(CONFIG_PEDESTRIAN_DETECT_MODEL_LOCATION),
+                            internal_size,
+                            mm_type);
+#endif
+#if CONFIG_PEDESTRIAN_DETECT_PARAM_LAZY_COPY
+    m_model->set_lazy_param_copy(true);
+#endif
+#if CONFIG_PEDESTRIAN_DETECT_WEIGHT_PREFETCH
+    m_model->set_weight_prefetch(true);
 #endif
 #if CONFIG_IDF_TARGET_ESP32P4
     m_image_preprocessor =
@@ -23,8 +57,8 @@ Pico::Pico(const char *model_name)
 #else
     m_image_preprocessor = new dl::image::ImagePreprocessor(m_model, {0, 0, 0}, {1, 1, 1});
 #endif
-    m_postprocessor =
-        new dl::detect::PicoPostprocessor(m_model, 0.5, 0.5, 10, {{8, 8, 4, 4}, {16, 16, 8, 8}, {32, 32, 16, 16}});
+    m_postprocessor = new dl::detect::PicoPostprocessor(
+        m_model, 0.5, 0.5, TOP_K, {{8, 8, 4, 4}, {16, 16, 8, 8}, {32, 32, 16, 16}});
 }
 
 } // namespace pedestrian_detect
@@ -6,6 +6,8 @@
 namespace pedestrian_detect {
 class Pico : public dl::detect::DetectImpl {
 public:
+    static constexpr int TOP_K = 10; /*<! most boxes kept per image, after nms */
+
     Pico(const char *model_name);
 };
 } // namespace pedestrian_detect
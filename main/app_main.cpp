@@ -9,6 +9,7 @@
 #include "mu_detector.hpp"
 #include "mu_wifi.h"
 #include "mu_server.hpp"
+#include "mu_pipeline.hpp"
 #include "take_picture.h"
 
 
@@ -20,6 +21,7 @@ const char *TAG = "MAIN";
 
 mu::MuDetector my_detector;
 mu::MuServer my_server;
+mu::MuPipeline my_pipeline(my_detector, my_server);
 
 esp_err_t app_init(void);
 
@@ -47,42 +49,23 @@ extern "C" void app_main(void)
     //     vTaskDelay(500 / portTICK_PERIOD_MS);
     // }
 
-    while (1) {
-        // Take a picture
-        camera_fb_t *pic = take_picture();
-        if (!pic) {
-            ESP_LOGE(TAG, "Failed to take picture");
-            my_server.display_system_message("ERROR: Failed to take picture");
-            vTaskDelay(2000 / portTICK_PERIOD_MS);
-            continue;
-        }
-        ESP_LOGI(TAG, "Picture taken successfully");
-
-        // Run detection
-        mu::DetectionData detection_results = my_detector.detect(pic);
-        ESP_LOGI(TAG, "Detection completed successfully");
-
-        // Check if objects were detected
-        if (detection_results.detection_boxes.empty()) {
-            ESP_LOGI(TAG, "No objects detected");
-        } else {
-            ESP_LOGI(TAG, "Objects detected: %zu", detection_results.detection_boxes.size());
-            // my_server.display_system_message("Objects detected: " + std::to_string(detection_results.detection_boxes.size()));
-        }
-
-        // Update the server with detection results
-        my_server.update_detection_display(detection_results);
-        ESP_LOGI(TAG, "Detection results updated on server");
-
-        // Release the picture buffer
-        esp_camera_fb_return(pic);
+    // Capture, decode, inference and publish run as separate stages across both cores
+    mu::PipelineConfig pipeline_config = MU_PIPELINE_DEFAULT_CONFIG();
+    esp_err_t pipeline_err = 
+        my_pipeline.start(pipeline_config);
+    if (pipeline_err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start pipeline");
+        my_server.display_system_message("ERROR: Failed to start detection pipeline");
+        return;
+    }
 
+    while (1) {
         // Debug
-        ESP_LOGI(TAG, "Free Heap: %lu bytes", esp_get_free_heap_size());
-        
+        mu::PipelineStats stats = my_pipeline.get_stats();
+        ESP_LOGI(TAG, "FPS: %.2f, dropped frames: %lu, Free Heap: %lu bytes",
+                 stats.fps, stats.dropped, esp_get_free_heap_size());
 
-        // Delay for a while to reset watchdog
-        vTaskDelay(20 / portTICK_PERIOD_MS);
+        vTaskDelay(10000 / portTICK_PERIOD_MS);
     }
 
 }
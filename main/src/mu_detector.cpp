@@ -1,5 +1,4 @@
 #include "mu_detector.hpp"
-#include <cstring>
 #include <sys/time.h>
 
 static const char* TAG = "MuDetector";
@@ -36,76 +35,92 @@ esp_err_t MuDetector::init() {
     return ESP_OK;
 }
 
-DetectionData MuDetector::detect(camera_fb_t *pic) {
-    // Create a new detection data structure
-    DetectionData result;
-    result.timestamp = get_current_timestamp();
-    result.pic = pic;  // Store pointer to camera frame buffer
-    // Ensure detection_boxes is empty at the start
-    result.detection_boxes.clear();
-
+// Helper to wrap a camera frame as a jpeg image for esp-dl
+static dl::image::jpeg_img_t to_jpeg_img(const FrameHandle& frame) {
+    camera_fb_t *pic = frame.get();
     dl::image::jpeg_img_t jpeg_img = {
         .data = pic->buf,
         .width = int(pic->width),
         .height = int(pic->height),
         .data_size = pic->len,
     };
-    
-    dl::image::img_t img;
-    img.pix_type = dl::image::DL_IMAGE_PIX_TYPE_RGB888;
+    return jpeg_img;
+}
 
+DetectionData MuDetector::detect(const FrameHandle& frame) {
+    // Decode straight into the model input at reduced scale, no full resolution RGB888 buffer
     // uint64_t infer_start = get_current_timestamp(); // 推理前时间戳
-    if (sw_decode_jpeg(jpeg_img, img, true) == ESP_OK) {
-        // Detect
-        auto &detect_results = my_detect_->run(img);
-        // uint64_t infer_end = get_current_timestamp(); // 推理后时间戳
-        // ESP_LOGI(TAG, "Model inference latency: %llu ms", (infer_end - infer_start));
-        heap_caps_free(img.data); // IMPORTANT!! Memory leak point
-        
-        // Check if we have any valid detections above threshold
-        bool has_valid_detection = false;
+    auto detect_results = my_detect_->run(to_jpeg_img(frame), true);
+    // uint64_t infer_end = get_current_timestamp(); // 推理后时间戳
+    // ESP_LOGI(TAG, "Model inference latency: %llu ms", (infer_end - infer_start));
+    return collect_results_(frame, detect_results, 1.0f, 1.0f);
+}
+
+esp_err_t MuDetector::decode(const FrameHandle& frame, dl::image::img_t &img) {
+    dl::image::jpeg_img_t jpeg_img = to_jpeg_img(frame);
+
+    // Only decode as many pixels as the model input needs (e.g. 1/2 scale of VGA for a 224x224 input)
+    img.data = nullptr;
+    img.pix_type = dl::image::DL_IMAGE_PIX_TYPE_RGB888;
+    return sw_decode_jpeg(jpeg_img, img, true, my_detect_->get_jpeg_scale(jpeg_img));
+}
+
+DetectionData MuDetector::detect(const FrameHandle& frame, const dl::image::img_t &img) {
+    // Detect
+    auto detect_results = my_detect_->run(img);
+
+    // img may have been decoded at reduced scale, map boxes back to the camera frame
+    float scale_x = static_cast<float>(frame->width) / img.width;
+    float scale_y = static_cast<float>(frame->height) / img.height;
+    return collect_results_(frame, detect_results, scale_x, scale_y);
+}
+
+DetectionData MuDetector::collect_results_(const FrameHandle& frame,
+                                           std::span<const dl::detect::result_t> detect_results,
+                                           float scale_x, float scale_y) {
+    // Create a new detection data structure
+    DetectionData result;
+    result.timestamp = get_current_timestamp();
+    result.frame = frame;  // Keep the camera frame buffer alive along with its results
+    // Ensure detection_boxes is empty at the start
+    result.detection_boxes.clear();
+
+    // Check if we have any valid detections above threshold
+    bool has_valid_detection = false;
+    for (const auto &res : detect_results) {
+        if (res.score > 0.3) { // 只包括置信度较高的结果
+            has_valid_detection = true;
+            break;
+        }
+    }
+
+    if (!has_valid_detection) {
+        ESP_LOGI(TAG, "No pedestrians detected in this frame");
+        // result.detection_boxes is already empty, we just log the information
+    } else {
+        // Process detection results and convert to DetectionBox format
         for (const auto &res : detect_results) {
             if (res.score > 0.3) { // 只包括置信度较高的结果
-                has_valid_detection = true;
-                break;
-            }
-        }
-        
-        if (!has_valid_detection) {
-            ESP_LOGI(TAG, "No pedestrians detected in this frame");
-            // result.detection_boxes is already empty, we just log the information
-        } else {
-            // Process detection results and convert to DetectionBox format
-            for (const auto &res : detect_results) {
-                if (res.score > 0.3) { // 只包括置信度较高的结果
-                    DetectionBox box;
-                    box.x1 = static_cast<float>(res.box[0]);
-                    box.y1 = static_cast<float>(res.box[1]);
-                    box.x2 = static_cast<float>(res.box[2]);
-                    box.y2 = static_cast<float>(res.box[3]);
-                    box.score = res.score;
-                    
-                    // Set class name as "person"
-                    strncpy(box.class_name, "person", sizeof(box.class_name) - 1);
-                    box.class_name[sizeof(box.class_name) - 1] = '\0'; // Ensure null termination
-                    
-                    // Add to detection boxes vector
-                    result.detection_boxes.push_back(box);
-                    
-                    ESP_LOGI(TAG, "Pedestrian detected [score: %.2f, x1: %.1f, y1: %.1f, x2: %.1f, y2: %.1f]",
-                            box.score, box.x1, box.y1, box.x2, box.y2);
-                }
+                DetectionBox box;
+                box.x1 = static_cast<float>(res.box[0]) * scale_x;
+                box.y1 = static_cast<float>(res.box[1]) * scale_y;
+                box.x2 = static_cast<float>(res.box[2]) * scale_x;
+                box.y2 = static_cast<float>(res.box[3]) * scale_y;
+                box.score = res.score;
+                box.class_name = "person";
+
+                // Add to the inline detection boxes
+                result.detection_boxes.push_back(box);
+
+                ESP_LOGI(TAG, "Pedestrian detected [score: %.2f, x1: %.1f, y1: %.1f, x2: %.1f, y2: %.1f]",
+                        box.score, box.x1, box.y1, box.x2, box.y2);
             }
-            
-            // Log the detection summary
-            ESP_LOGI(TAG, "Detection completed: found %d pedestrians", result.detection_boxes.size());
         }
-    } else {
-        ESP_LOGW(TAG, "Failed to decode JPEG image for detection");
+
+        // Log the detection summary
+        ESP_LOGI(TAG, "Detection completed: found %d pedestrians", (int)result.detection_boxes.size());
     }
-    
-    // Update the current detection and return the result
-    current_detection_ = result;
+
     return result;
 }
 
@@ -3,11 +3,13 @@
 #include <vector>
 #include <cstdint>
 #include <memory>
+#include <span>
 
 #include <esp_err.h>
 
 #include "pedestrian_detect.hpp"
 #include "esp_camera.h"
+#include "mu_frame.hpp"
 
 namespace mu {
 
@@ -20,7 +22,31 @@ struct DetectionBox {
     float x2;       ///< x-coordinate of bottom-right corner
     float y2;       ///< y-coordinate of bottom-right corner
     float score;    ///< confidence score of the detection
-    char class_name[16];   ///< name of the detected object (e.g., "person") as C-style string
+    const char* class_name;   ///< name of the detected object (e.g., "person"), a string literal
+};
+
+/**
+ * @brief Detection boxes of a frame, stored inline so a frame allocates nothing per detection
+ * @details Holds as many boxes as the detector keeps, pedestrian_detect::Pico::TOP_K
+ */
+struct DetectionBoxes {
+    static constexpr size_t CAPACITY = pedestrian_detect::Pico::TOP_K;
+
+    DetectionBox boxes[CAPACITY];
+    size_t count = 0;
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    void clear() { count = 0; }
+    // Boxes past the capacity are dropped
+    void push_back(const DetectionBox& box) {
+        if (count < CAPACITY) {
+            boxes[count++] = box;
+        }
+    }
+    const DetectionBox& operator[](size_t i) const { return boxes[i]; }
+    const DetectionBox* begin() const { return boxes; }
+    const DetectionBox* end() const { return boxes + count; }
 };
 
 /**
@@ -28,8 +54,8 @@ struct DetectionBox {
  */
 struct DetectionData {
     uint64_t timestamp;                  ///< Current time in milliseconds
-    camera_fb_t* pic;                         ///< Pointer to the esp_camera image data
-    std::vector<DetectionBox> detection_boxes;     ///< Detection boxes results
+    FrameHandle frame;                   ///< Reference to the esp_camera image data, keeps the frame alive
+    DetectionBoxes detection_boxes;      ///< Detection boxes results
 };
 
 /**
@@ -48,16 +74,30 @@ public:
     
     /**
      * @brief Perform detection on an input image
-     * @param pic Pointer to the image data
+     * @param frame Handle to the image data
      * @return Detection results
+     * @details Decodes the JPEG straight into the model input at reduced scale
      */
-    DetectionData detect(camera_fb_t *pic);
-    
+    DetectionData detect(const FrameHandle& frame);
+
+    /**
+     * @brief Decode the JPEG frame into an RGB888 image
+     * @param frame Handle to the image data
+     * @param img Decoded image, img.data must be released with heap_caps_free()
+     * @return ESP_OK if decoding successful, otherwise error code
+     * @details Decodes at the smallest JPEG scale that still covers the model input
+     * @details First half of detect(), split out so it can run on its own pipeline stage
+     */
+    esp_err_t decode(const FrameHandle& frame, dl::image::img_t &img);
+
     /**
-     * @brief Get the current detection data (const version)
-     * @return Const reference to the current detection data
+     * @brief Perform detection on an already decoded image
+     * @param frame Handle to the image data the decoded image came from
+     * @param img Decoded RGB888 image, may be smaller than the frame
+     * @return Detection results, in frame coordinates
+     * @details Second half of detect(), does not take ownership of img
      */
-    const DetectionData& getCurrentDetection() const { return current_detection_; }
+    DetectionData detect(const FrameHandle& frame, const dl::image::img_t &img);
     
     /**
      * @brief Get the detection history
@@ -67,7 +107,12 @@ public:
 
 private:
     PedestrianDetect* my_detect_;
-    DetectionData current_detection_;
+
+    // Convert esp-dl results to DetectionData, scaling boxes back to the frame
+    // The results are read in place from the detector arena, which the next run resets
+    DetectionData collect_results_(const FrameHandle& frame,
+                                   std::span<const dl::detect::result_t> detect_results,
+                                   float scale_x, float scale_y);
     // std::vector<DetectionData> detection_history_;
 };
 
@@ -0,0 +1,55 @@
+#include "mu_frame.hpp"
+
+namespace mu {
+
+FrameHandle::FrameHandle(const FrameHandle& other) : ref_(other.ref_) {
+    if (ref_) {
+        ref_->count.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+FrameHandle::FrameHandle(FrameHandle&& other) noexcept : ref_(other.ref_) {
+    other.ref_ = nullptr;
+}
+
+FrameHandle& FrameHandle::operator=(const FrameHandle& other) {
+    if (ref_ != other.ref_) {
+        if (other.ref_) {
+            other.ref_->count.fetch_add(1, std::memory_order_relaxed);
+        }
+        reset();
+        ref_ = other.ref_;
+    }
+    return *this;
+}
+
+FrameHandle& FrameHandle::operator=(FrameHandle&& other) noexcept {
+    if (this != &other) {
+        reset();
+        ref_ = other.ref_;
+        other.ref_ = nullptr;
+    }
+    return *this;
+}
+
+FrameHandle FrameHandle::wrap(camera_fb_t* pic) {
+    FrameHandle handle;
+    if (pic) {
+        handle.ref_ = new Ref{pic, {1}};
+    }
+    return handle;
+}
+
+void FrameHandle::reset() {
+    if (!ref_) {
+        return;
+    }
+    // acq_rel: every reader's accesses to the buffer happen before it goes back to the driver
+    if (ref_->count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        esp_camera_fb_return(ref_->pic);
+        delete ref_;
+    }
+    ref_ = nullptr;
+}
+
+} // namespace mu
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "esp_camera.h"
+
+namespace mu {
+
+/**
+ * @brief Reference counted handle to a camera frame buffer
+ * @details The frame buffer is handed back to the camera driver with esp_camera_fb_return()
+ *          when the last handle referencing it is reset or destroyed, so a frame stays valid
+ *          for every reader that still holds a handle. Copying a handle is one atomic increment.
+ *          A single handle object must not be modified by two tasks at once, but copies of it
+ *          can be used and released from any task.
+ */
+class FrameHandle {
+public:
+    FrameHandle() : ref_(nullptr) {}
+    ~FrameHandle() { reset(); }
+
+    FrameHandle(const FrameHandle& other);
+    FrameHandle(FrameHandle&& other) noexcept;
+    FrameHandle& operator=(const FrameHandle& other);
+    FrameHandle& operator=(FrameHandle&& other) noexcept;
+
+    /**
+     * @brief Take ownership of a frame buffer obtained from esp_camera_fb_get()
+     * @param pic Camera frame buffer, must not be returned by the caller afterwards
+     * @return Handle with a reference count of 1, or an empty handle if pic is NULL
+     */
+    static FrameHandle wrap(camera_fb_t* pic);
+
+    /**
+     * @brief Drop this reference, returning the frame buffer if it was the last one
+     */
+    void reset();
+
+    camera_fb_t* get() const { return ref_ ? ref_->pic : nullptr; }
+    camera_fb_t* operator->() const { return get(); }
+    explicit operator bool() const { return ref_ != nullptr; }
+
+    /**
+     * @brief Number of handles currently referencing the frame, for debugging
+     */
+    uint32_t use_count() const { return ref_ ? ref_->count.load(std::memory_order_relaxed) : 0; }
+
+private:
+    struct Ref {
+        camera_fb_t* pic;
+        std::atomic<uint32_t> count;
+    };
+    Ref* ref_;
+};
+
+} // namespace mu
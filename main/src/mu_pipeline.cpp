@@ -0,0 +1,251 @@
+#include "mu_pipeline.hpp"
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include "take_picture.h"
+
+static const char* TAG = "MuPipeline";
+
+// How long a stage blocks on its input queue before re-checking the running flag
+#define PIPELINE_QUEUE_WAIT_MS  100
+// Window over which the published FPS is computed and logged
+#define PIPELINE_FPS_WINDOW_US  (5 * 1000 * 1000)
+
+namespace mu {
+
+MuPipeline::MuPipeline(MuDetector& detector, MuServer& server)
+    : detector_(detector),
+      server_(server),
+      decode_queue_(nullptr),
+      infer_queue_(nullptr),
+      publish_queue_(nullptr),
+      capture_task_(nullptr),
+      decode_task_(nullptr),
+      infer_task_(nullptr),
+      publish_task_(nullptr),
+      running_(false),
+      captured_(0),
+      published_(0),
+      dropped_(0),
+      decode_failed_(0),
+      fps_(0.0f) {
+}
+
+MuPipeline::~MuPipeline() {
+    stop();
+}
+
+esp_err_t MuPipeline::start(const PipelineConfig& config) {
+    if (running_) {
+        ESP_LOGW(TAG, "Pipeline already running");
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (config.queue_depth == 0) {
+        ESP_LOGE(TAG, "Queue depth must be at least 1");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    decode_queue_ = xQueueCreate(config.queue_depth, sizeof(PipelineFrame*));
+    infer_queue_ = xQueueCreate(config.queue_depth, sizeof(PipelineFrame*));
+    publish_queue_ = xQueueCreate(config.queue_depth, sizeof(PipelineFrame*));
+    if (!decode_queue_ || !infer_queue_ || !publish_queue_) {
+        ESP_LOGE(TAG, "Failed to create pipeline queues");
+        stop();
+        return ESP_ERR_NO_MEM;
+    }
+
+    running_ = true;
+    // Start from the consumer end so no stage pushes into a queue nobody reads
+    esp_err_t ret = create_stage_(publish_task_fn_, "mu_publish", config.publish, &publish_task_);
+    if (ret == ESP_OK) {
+        ret = create_stage_(infer_task_fn_, "mu_infer", config.infer, &infer_task_);
+    }
+    if (ret == ESP_OK) {
+        ret = create_stage_(decode_task_fn_, "mu_decode", config.decode, &decode_task_);
+    }
+    if (ret == ESP_OK) {
+        ret = create_stage_(capture_task_fn_, "mu_capture", config.capture, &capture_task_);
+    }
+    if (ret != ESP_OK) {
+        stop();
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Pipeline started (capture: core %d, decode: core %d, infer: core %d, publish: core %d)",
+             config.capture.core_id, config.decode.core_id, config.infer.core_id, config.publish.core_id);
+    return ESP_OK;
+}
+
+void MuPipeline::stop() {
+    running_ = false;
+
+    // Every stage wakes up at least once per PIPELINE_QUEUE_WAIT_MS, clears its handle and deletes itself
+    while (capture_task_ || decode_task_ || infer_task_ || publish_task_) {
+        vTaskDelay(PIPELINE_QUEUE_WAIT_MS / portTICK_PERIOD_MS);
+    }
+
+    QueueHandle_t* queues[] = { &decode_queue_, &infer_queue_, &publish_queue_ };
+    for (QueueHandle_t* queue : queues) {
+        if (*queue) {
+            drain_queue_(*queue);
+            vQueueDelete(*queue);
+            *queue = nullptr;
+        }
+    }
+}
+
+PipelineStats MuPipeline::get_stats() const {
+    PipelineStats stats;
+    stats.captured = captured_;
+    stats.published = published_;
+    stats.dropped = dropped_;
+    stats.decode_failed = decode_failed_;
+    stats.fps = fps_;
+    return stats;
+}
+
+esp_err_t MuPipeline::create_stage_(TaskFunction_t fn, const char* name, const PipelineStageConfig& config,
+                                    TaskHandle_t* handle) {
+    BaseType_t ret = xTaskCreatePinnedToCore(fn, name, config.stack_size, this, config.priority, handle,
+                                             config.core_id);
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create stage task %s", name);
+        *handle = nullptr;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void MuPipeline::push_drop_oldest_(QueueHandle_t queue, PipelineFrame* frame) {
+    // Each queue has a single producer, so once the oldest entry is gone the send cannot fail
+    while (xQueueSend(queue, &frame, 0) != pdTRUE) {
+        PipelineFrame* oldest = nullptr;
+        if (xQueueReceive(queue, &oldest, 0) == pdTRUE) {
+            ESP_LOGD(TAG, "Dropping frame %lu", oldest->sequence);
+            release_frame_(oldest);
+            dropped_++;
+        }
+    }
+}
+
+void MuPipeline::release_frame_(PipelineFrame* frame) {
+    if (!frame) {
+        return;
+    }
+    if (frame->img.data) {
+        heap_caps_free(frame->img.data);
+        frame->img.data = nullptr;
+    }
+    delete frame;
+}
+
+void MuPipeline::drain_queue_(QueueHandle_t queue) {
+    PipelineFrame* frame = nullptr;
+    while (xQueueReceive(queue, &frame, 0) == pdTRUE) {
+        release_frame_(frame);
+    }
+}
+
+void MuPipeline::capture_task_fn_(void* arg) {
+    MuPipeline* self = static_cast<MuPipeline*>(arg);
+    uint32_t sequence = 0;
+
+    while (self->running_) {
+        camera_fb_t* pic = take_picture();
+        if (!pic) {
+            ESP_LOGE(TAG, "Failed to take picture");
+            vTaskDelay(PIPELINE_QUEUE_WAIT_MS / portTICK_PERIOD_MS);
+            continue;
+        }
+
+        PipelineFrame* frame = new PipelineFrame();
+        frame->sequence = sequence++;
+        frame->frame = FrameHandle::wrap(pic);
+        frame->img.data = nullptr;
+        self->captured_++;
+        self->push_drop_oldest_(self->decode_queue_, frame);
+    }
+
+    self->capture_task_ = nullptr;
+    vTaskDelete(NULL);
+}
+
+void MuPipeline::decode_task_fn_(void* arg) {
+    MuPipeline* self = static_cast<MuPipeline*>(arg);
+
+    while (self->running_) {
+        PipelineFrame* frame = nullptr;
+        if (xQueueReceive(self->decode_queue_, &frame, PIPELINE_QUEUE_WAIT_MS / portTICK_PERIOD_MS) != pdTRUE) {
+            continue;
+        }
+
+        if (self->detector_.decode(frame->frame, frame->img) != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to decode frame %lu", frame->sequence);
+            self->decode_failed_++;
+            release_frame_(frame);
+            continue;
+        }
+        self->push_drop_oldest_(self->infer_queue_, frame);
+    }
+
+    self->decode_task_ = nullptr;
+    vTaskDelete(NULL);
+}
+
+void MuPipeline::infer_task_fn_(void* arg) {
+    MuPipeline* self = static_cast<MuPipeline*>(arg);
+
+    while (self->running_) {
+        PipelineFrame* frame = nullptr;
+        if (xQueueReceive(self->infer_queue_, &frame, PIPELINE_QUEUE_WAIT_MS / portTICK_PERIOD_MS) != pdTRUE) {
+            continue;
+        }
+
+        frame->detection = self->detector_.detect(frame->frame, frame->img);
+
+        // The decoded image is not needed downstream, give the PSRAM back early
+        heap_caps_free(frame->img.data);
+        frame->img.data = nullptr;
+        self->push_drop_oldest_(self->publish_queue_, frame);
+    }
+
+    self->infer_task_ = nullptr;
+    vTaskDelete(NULL);
+}
+
+void MuPipeline::publish_task_fn_(void* arg) {
+    MuPipeline* self = static_cast<MuPipeline*>(arg);
+    int64_t window_start = esp_timer_get_time();
+    uint32_t window_frames = 0;
+
+    while (self->running_) {
+        PipelineFrame* frame = nullptr;
+        if (xQueueReceive(self->publish_queue_, &frame, PIPELINE_QUEUE_WAIT_MS / portTICK_PERIOD_MS) != pdTRUE) {
+            continue;
+        }
+
+        if (!frame->detection.detection_boxes.empty()) {
+            ESP_LOGI(TAG, "Frame %lu: objects detected: %zu", frame->sequence,
+                     frame->detection.detection_boxes.size());
+        }
+        self->server_.update_detection_display(frame->detection);
+        release_frame_(frame);
+        self->published_++;
+
+        window_frames++;
+        int64_t now = esp_timer_get_time();
+        if (now - window_start >= PIPELINE_FPS_WINDOW_US) {
+            self->fps_ = window_frames * 1000000.0f / (now - window_start);
+            ESP_LOGI(TAG, "FPS: %.2f, captured: %lu, published: %lu, dropped: %lu, Free Heap: %lu bytes",
+                     self->fps_.load(), self->captured_.load(), self->published_.load(), self->dropped_.load(),
+                     esp_get_free_heap_size());
+            window_start = now;
+            window_frames = 0;
+        }
+    }
+
+    self->publish_task_ = nullptr;
+    vTaskDelete(NULL);
+}
+
+} // namespace mu
@@ -0,0 +1,143 @@
+#ifndef MU_PIPELINE_H
+#define MU_PIPELINE_H
+
+#include <atomic>
+#include <cstdint>
+
+#include <esp_err.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+#include "esp_camera.h"
+#include "mu_detector.hpp"
+#include "mu_server.hpp"
+
+namespace mu {
+
+/**
+ * @brief Configuration of a single pipeline stage task
+ */
+struct PipelineStageConfig {
+    BaseType_t core_id;     ///< Core the stage task is pinned to (0, 1 or tskNO_AFFINITY)
+    UBaseType_t priority;   ///< FreeRTOS priority of the stage task
+    uint32_t stack_size;    ///< Stack size of the stage task, in bytes
+};
+
+/**
+ * @brief Configuration of the whole capture -> decode -> infer -> publish pipeline
+ */
+struct PipelineConfig {
+    PipelineStageConfig capture;    ///< Takes frames from the camera
+    PipelineStageConfig decode;     ///< JPEG decode of the camera frame
+    PipelineStageConfig infer;      ///< Preprocess, model and postprocess
+    PipelineStageConfig publish;    ///< Hands results to the web server and returns the frame
+    UBaseType_t queue_depth;        ///< Capacity of each inter-stage queue
+};
+
+/**
+ * @brief Default pipeline layout for ESP32-S3
+ * @details Capture, decode and publish share core 0 with WiFi and the HTTP server,
+ *          inference owns core 1 so decode of frame N+1 overlaps inference of frame N.
+ */
+#define MU_PIPELINE_DEFAULT_CONFIG() {               \
+    .capture = { .core_id = 0, .priority = 5, .stack_size = 4096 },  \
+    .decode  = { .core_id = 0, .priority = 5, .stack_size = 8192 },  \
+    .infer   = { .core_id = 1, .priority = 5, .stack_size = 8192 },  \
+    .publish = { .core_id = 0, .priority = 4, .stack_size = 4096 },  \
+    .queue_depth = 1,                                \
+}
+
+/**
+ * @brief Frame travelling through the pipeline
+ */
+struct PipelineFrame {
+    uint32_t sequence;          ///< Monotonic frame number assigned by the capture stage
+    FrameHandle frame;          ///< Camera frame buffer, returned to the driver once every holder released it
+    dl::image::img_t img;       ///< Decoded RGB888 image, img.data owned by the frame
+    DetectionData detection;    ///< Detection results, filled by the infer stage
+};
+
+/**
+ * @brief Pipeline statistics, all counters are cumulative
+ */
+struct PipelineStats {
+    uint32_t captured;          ///< Frames taken from the camera
+    uint32_t published;         ///< Frames that made it to the server
+    uint32_t dropped;           ///< Frames dropped because a downstream stage fell behind
+    uint32_t decode_failed;     ///< Frames whose JPEG could not be decoded
+    float fps;                  ///< Published frames per second over the last report window
+};
+
+/**
+ * @brief Staged capture -> decode -> infer -> publish pipeline
+ * @details Every stage is a FreeRTOS task pinned to a configurable core. Stages are
+ *          connected by bounded queues with a drop-oldest policy: when a consumer
+ *          falls behind, the oldest queued frame is released so the pipeline always
+ *          works on the most recent picture.
+ */
+class MuPipeline {
+public:
+    MuPipeline(MuDetector& detector, MuServer& server);
+    ~MuPipeline();
+
+    /**
+     * @brief Create the queues and start all stage tasks
+     * @param config Pipeline layout
+     * @return ESP_OK if the pipeline started, otherwise error code
+     */
+    esp_err_t start(const PipelineConfig& config);
+
+    /**
+     * @brief Stop all stage tasks and release in-flight frames
+     */
+    void stop();
+
+    /**
+     * @brief Get a copy of the pipeline statistics
+     */
+    PipelineStats get_stats() const;
+
+private:
+    MuDetector& detector_;
+    MuServer& server_;
+
+    QueueHandle_t decode_queue_;    // capture -> decode
+    QueueHandle_t infer_queue_;     // decode -> infer
+    QueueHandle_t publish_queue_;   // infer -> publish
+
+    TaskHandle_t capture_task_;
+    TaskHandle_t decode_task_;
+    TaskHandle_t infer_task_;
+    TaskHandle_t publish_task_;
+
+    std::atomic<bool> running_;
+    std::atomic<uint32_t> captured_;
+    std::atomic<uint32_t> published_;
+    std::atomic<uint32_t> dropped_;
+    std::atomic<uint32_t> decode_failed_;
+    std::atomic<float> fps_;
+
+    // Stage task bodies
+    static void capture_task_fn_(void* arg);
+    static void decode_task_fn_(void* arg);
+    static void infer_task_fn_(void* arg);
+    static void publish_task_fn_(void* arg);
+
+    // Push a frame, dropping the oldest queued frame if the queue is full
+    void push_drop_oldest_(QueueHandle_t queue, PipelineFrame* frame);
+
+    // Release the decoded image and camera buffer reference of a frame and delete it
+    static void release_frame_(PipelineFrame* frame);
+
+    // Drain and release every frame left in a queue
+    static void drain_queue_(QueueHandle_t queue);
+
+    esp_err_t create_stage_(TaskFunction_t fn, const char* name, const PipelineStageConfig& config,
+                            TaskHandle_t* handle);
+};
+
+} // namespace mu
+
+#endif // MU_PIPELINE_H
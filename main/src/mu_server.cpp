@@ -136,7 +136,15 @@ void MuServer::display_system_message(const std::string& message) {
 }
 
 void MuServer::update_detection_display(const DetectionData& detection_data) {
-    current_detection_ = detection_data;
+    DetectionData& snapshot = detections_.back();
+    snapshot.timestamp = detection_data.timestamp;
+    snapshot.frame = detection_data.frame;
+    // The boxes are inline, copying them into the recycled buffer allocates nothing
+    snapshot.detection_boxes = detection_data.detection_boxes;
+    detections_.publish();
+
+    // The recycled back buffer holds a stale snapshot, let its camera frame go right away
+    detections_.back().frame.reset();
 }
 
 esp_err_t MuServer::index_handler_(httpd_req_t *req) {
@@ -178,14 +186,21 @@ esp_err_t MuServer::stream_handler_(httpd_req_t *req) {
     httpd_resp_set_hdr(req, "Cache-Control", "no-store, must-revalidate");
     httpd_resp_set_hdr(req, "Pragma", "no-cache");
     
-    if (!server_instance_ || !server_instance_->current_detection_.pic) {
+    // All URI handlers run on the single httpd task, which makes it the only snapshot reader
+    const DetectionData* detection = server_instance_ ? server_instance_->detections_.acquire() : nullptr;
+    if (!detection || !detection->frame) {
         httpd_resp_set_type(req, "text/plain");
         httpd_resp_send(req, "No detection image available yet", -1);
         return ESP_OK;
     }
+    // Hold our own reference while the socket drains so the frame can't go back to the camera
+    FrameHandle frame = detection->frame;
+    // Lets the page pair this image with the matching /detection-data response
+    char timestamp[24];
+    snprintf(timestamp, sizeof(timestamp), "%llu", detection->timestamp);
+    httpd_resp_set_hdr(req, "X-Frame-Timestamp", timestamp);
     httpd_resp_set_type(req, "image/jpeg");
-    httpd_resp_send(req, reinterpret_cast<const char*>(server_instance_->current_detection_.pic->buf),
-                    server_instance_->current_detection_.pic->len);
+    httpd_resp_send(req, reinterpret_cast<const char*>(frame->buf), frame->len);
     return ESP_OK;
 }
 
@@ -249,17 +264,19 @@ esp_err_t MuServer::detection_data_handler_(httpd_req_t *req) {
         return ESP_FAIL;
     }
 
-    const DetectionData& detection = server_instance_->current_detection_;
+    static const DetectionData empty_detection = {};
+    const DetectionData* latest = server_instance_->detections_.acquire();
+    const DetectionData& detection = latest ? *latest : empty_detection;
     std::string json = "{";
 
     // Add timestamp
     json += "\"timestamp\": " + std::to_string(detection.timestamp) + ",";
 
     // Add image information
-    if (detection.pic) {
+    if (detection.frame) {
         json += "\"image\": {";
-        json += "\"width\": " + std::to_string(detection.pic->width) + ",";
-        json += "\"height\": " + std::to_string(detection.pic->height) + ",";
+        json += "\"width\": " + std::to_string(detection.frame->width) + ",";
+        json += "\"height\": " + std::to_string(detection.frame->height) + ",";
         json += "\"format\": \"jpeg\"";
         json += "},";
     } else {
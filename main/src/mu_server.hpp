@@ -5,6 +5,7 @@
 #include <vector>
 #include "esp_http_server.h"
 #include "mu_detector.hpp"
+#include "mu_snapshot.hpp"
 
 #define MAX_SYSTEM_MESSAGES 255
 
@@ -52,7 +53,8 @@ public:
     /**
      * @brief Update the web page with provided detection data
      * @param detection_data The detection data to display
-     * @details Updates web UI with the provided detection data
+     * @details Publishes a frame+result snapshot without locking. Must be called from a single
+     *          task (the pipeline's publish stage); the frame stays alive while the server holds it.
      */
     void update_detection_display(const DetectionData& detection_data);
 
@@ -65,7 +67,8 @@ public:
 private:
     httpd_handle_t server_handle_;             // HTTP server handle
     std::vector<std::string> system_messages_; // Store system messages
-    DetectionData current_detection_;           // Store the most recent detection data
+    TripleBuffer<DetectionData> detections_;   // Most recent detection snapshots, written by the publisher,
+                                               // read by the HTTP server task
     
     // Static handler functions for HTTP endpoints
     static esp_err_t index_handler_(httpd_req_t *req);
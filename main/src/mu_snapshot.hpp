@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace mu {
+
+/**
+ * @brief Lock-free triple buffer for handing snapshots from one writer task to one reader task
+ * @details The writer fills back() and calls publish(), which swaps the back buffer with the
+ *          shared middle slot. The reader calls acquire(), which swaps the middle slot into its
+ *          front buffer if a newer snapshot was published. Neither side ever waits for the other,
+ *          and the front buffer returned by acquire() stays untouched by the writer until the
+ *          reader calls acquire() again.
+ *
+ * @tparam T Snapshot type, must be default constructible
+ */
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : back_(0), front_(1), middle_(2), has_front_(false) {}
+
+    /**
+     * @brief Buffer owned by the writer, fill it before calling publish()
+     * @note May still contain an old snapshot that was never read, overwrite every field
+     */
+    T& back() { return buffers_[back_]; }
+
+    /**
+     * @brief Make the back buffer the newest snapshot (writer side)
+     */
+    void publish() {
+        uint8_t prev = middle_.exchange(back_ | FRESH_BIT, std::memory_order_acq_rel);
+        back_ = prev & INDEX_MASK;
+    }
+
+    /**
+     * @brief Get the newest published snapshot (reader side)
+     * @return Pointer to the reader's front buffer, nullptr if nothing was published yet
+     */
+    const T* acquire() {
+        if (middle_.load(std::memory_order_relaxed) & FRESH_BIT) {
+            uint8_t prev = middle_.exchange(front_, std::memory_order_acq_rel);
+            front_ = prev & INDEX_MASK;
+            has_front_ = true;
+        }
+        return has_front_ ? &buffers_[front_] : nullptr;
+    }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH_BIT = 0x4;
+
+    T buffers_[3];
+    uint8_t back_;                  // Only touched by the writer
+    uint8_t front_;                 // Only touched by the reader
+    std::atomic<uint8_t> middle_;   // Shared slot index, FRESH_BIT set if not yet seen by the reader
+    bool has_front_;                // Only touched by the reader
+};
+
+} // namespace mu
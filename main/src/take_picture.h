@@ -40,9 +40,9 @@ extern "C" {
 #define CAM_PIXEL_FORMAT    PIXFORMAT_JPEG  // YUV422, GRAYSCALE, RGB565, JPEG
 #define CAM_FRAME_SIZE      FRAMESIZE_VGA  // QQVGA-UXGA
 #define CAM_JPEG_QUALITY    10  // 0-63, lower means higher quality
-#define CAM_FB_COUNT        3   // Frame buffer count
-#define CAM_FB_LOCATION     CAMERA_FB_IN_DRAM  // Frame buffer location
-#define CAM_GRAB_MODE       CAMERA_GRAB_WHEN_EMPTY  // CAMERA_GRAB_LATEST also available
+#define CAM_FB_COUNT        6   // Frame buffer count, covers pipeline stages plus the frames held by the server
+#define CAM_FB_LOCATION     CAMERA_FB_IN_PSRAM  // Frame buffer location
+#define CAM_GRAB_MODE       CAMERA_GRAB_LATEST  // CAMERA_GRAB_WHEN_EMPTY also available
 
 // Stream control parameters
 #define CAM_STREAM_FPS      5   // Target frames per second for streaming